@@ -108,6 +108,19 @@ typedef struct st_heap_block
 } HP_BLOCK;
 
 struct st_heap_info;			/* For referense */
+struct st_hp_blob_chunk;
+
+/*
+  BLOB column of a heap table. The record holds the length of the blob
+  (packlength bytes) followed by a pointer to the data, as in Field_blob.
+  The data is stored out of line in a separately allocated chunk that
+  belongs to the table.
+*/
+typedef struct st_hp_blobdef
+{
+  uint offset;				/* Offset of the column in record */
+  uint packlength;			/* Bytes used for the blob length */
+} HP_BLOBDEF;
 
 typedef struct st_hp_keydef		/* Key definition with open */
 {
@@ -134,6 +147,8 @@ typedef struct st_heap_share
 {
   HP_BLOCK block;
   HP_KEYDEF  *keydef;
+  HP_BLOBDEF *blobdef;
+  struct st_hp_blob_chunk *blob_chunks;	/* All blob chunks of the table */
   ulonglong data_length,index_length,max_table_size;
   ulonglong auto_increment;
   ulong min_records,max_records;	/* Params to open */
@@ -147,6 +162,7 @@ typedef struct st_heap_share
   uint visible;                         /* Offset to the visible/deleted mark */
   uint changed;
   uint keys,max_key_length;
+  uint blobs;				/* Number of BLOB columns */
   uint currently_disabled_keys;    /* saved value from "keys" when disabled */
   uint open_count;
   uchar *del_link;			/* Link to next block with del. rec */
@@ -173,6 +189,7 @@ typedef struct st_heap_info
   uint opt_flag,update;
   uchar *lastkey;			/* Last used key with rkey */
   uchar *recbuf;                         /* Record buffer for rb-tree keys */
+  uchar **blob_buff;                    /* New blob versions in heap_update */
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -188,9 +205,11 @@ typedef struct st_heap_info
 typedef struct st_heap_create_info
 {
   HP_KEYDEF *keydef;
+  HP_BLOBDEF *blobdef;
   uint auto_key;                        /* keynr [1 - maxkey] for auto key */
   uint auto_key_type;
   uint keys;
+  uint blobs;
   uint reclength;
   ulong max_records;
   ulong min_records;
@@ -925,6 +925,28 @@ extern void *my_az_allocator(void *dummy, unsigned int items, unsigned int size)
 extern void my_az_free(void *dummy, void *address);
 extern int my_compress_buffer(uchar *dest, size_t *destLen,
                               const uchar *source, size_t sourceLen);
+
+/* Compression algorithms of the client/server protocol */
+#define MY_COMPRESS_ZLIB 0
+#define MY_COMPRESS_ZSTD 1
+#define MY_COMPRESS_LZ4  2
+#define MY_COMPRESS_ALGORITHMS 3
+typedef struct st_my_compress_stream MY_COMPRESS_STREAM;
+extern const char *my_compress_algorithm_names[];
+extern my_bool my_compress_stream_supported(uint algorithm);
+extern MY_COMPRESS_STREAM *my_compress_stream_init(uint algorithm, uint level,
+                                                   myf flags);
+extern void my_compress_stream_end(MY_COMPRESS_STREAM *stream);
+extern void my_compress_stream_set_level(MY_COMPRESS_STREAM *stream,
+                                         uint level);
+extern size_t my_compress_stream_bound(MY_COMPRESS_STREAM *stream,
+                                       size_t len);
+extern my_bool my_compress_stream(MY_COMPRESS_STREAM *stream, uchar *dest,
+                                  size_t *dest_len, const uchar *src,
+                                  size_t len);
+extern my_bool my_uncompress_stream(MY_COMPRESS_STREAM *stream,
+                                    uchar *packet, size_t len,
+                                    size_t *complen);
 extern int packfrm(const uchar *, size_t, uchar **, size_t *);
 extern int unpackfrm(uchar **, size_t *, const uchar *);
 
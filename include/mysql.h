@@ -196,7 +196,10 @@ enum mysql_option
   /* MariaDB options */
   MYSQL_PROGRESS_CALLBACK=5999,
   MYSQL_OPT_NONBLOCK,
-  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY
+  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY,
+  /* "zlib", "zstd" or "lz4"; used with MYSQL_OPT_COMPRESS */
+  MYSQL_OPT_COMPRESSION_ALGORITHM,
+  MYSQL_OPT_COMPRESSION_LEVEL
 };
 
 /**
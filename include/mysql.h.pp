@@ -50,7 +50,7 @@ typedef struct st_net {
   char net_skip_rest_factor;
   my_bool thread_specific_malloc;
   unsigned char compress;
-  my_bool unused3;
+  unsigned char compress_algorithm;
   void *thd;
   unsigned int last_errno;
   unsigned char error;
@@ -320,7 +320,9 @@ enum mysql_option
   MYSQL_OPT_CAN_HANDLE_EXPIRED_PASSWORDS,
   MYSQL_PROGRESS_CALLBACK=5999,
   MYSQL_OPT_NONBLOCK,
-  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY
+  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY,
+  MYSQL_OPT_COMPRESSION_ALGORITHM,
+  MYSQL_OPT_COMPRESSION_LEVEL
 };
 struct st_mysql_options_extention;
 struct st_mysql_options {
@@ -302,6 +302,14 @@ enum enum_indicator_type
 #define MARIADB_CLIENT_STMT_BULK_OPERATIONS (1ULL << 34)
 /* support of extended metadata (e.g. type/format information) */
 #define MARIADB_CLIENT_EXTENDED_METADATA (1ULL << 35)
+/*
+  zstd or lz4 instead of zlib for the compressed protocol. A client sets
+  at most one of them, together with CLIENT_COMPRESS.
+  Bits 36 and 37 are reserved for these flags; Connector/C
+  (include/mariadb_com.h) must not use them for anything else.
+*/
+#define MARIADB_CLIENT_ZSTD_COMPRESSION (1ULL << 36)
+#define MARIADB_CLIENT_LZ4_COMPRESSION (1ULL << 37)
 
 #ifdef HAVE_COMPRESS
 #define CAN_CLIENT_COMPRESS CLIENT_COMPRESS
@@ -344,6 +352,8 @@ enum enum_indicator_type
                            MARIADB_CLIENT_COM_MULTI |\
                            MARIADB_CLIENT_STMT_BULK_OPERATIONS |\
                            MARIADB_CLIENT_EXTENDED_METADATA|\
+                           MARIADB_CLIENT_ZSTD_COMPRESSION |\
+                           MARIADB_CLIENT_LZ4_COMPRESSION |\
                            CLIENT_CAN_HANDLE_EXPIRED_PASSWORDS)
 
 /*
@@ -353,7 +363,9 @@ enum enum_indicator_type
 */
 #define CLIENT_BASIC_FLAGS (((CLIENT_ALL_FLAGS & ~CLIENT_SSL) \
                                                & ~CLIENT_COMPRESS) \
-                                               & ~CLIENT_SSL_VERIFY_SERVER_CERT)
+                                               & ~CLIENT_SSL_VERIFY_SERVER_CERT \
+                                               & ~MARIADB_CLIENT_ZSTD_COMPRESSION \
+                                               & ~MARIADB_CLIENT_LZ4_COMPRESSION)
 
 enum mariadb_field_attr_t
 {
@@ -474,7 +486,7 @@ typedef struct st_net {
   char net_skip_rest_factor;
   my_bool thread_specific_malloc;
   unsigned char compress;
-  my_bool unused3; /* Please remove with the next incompatible ABI change. */
+  unsigned char compress_algorithm;		/* MY_COMPRESS_* */
   /*
     Pointer to query object in query cache, do not equal NULL (0) for
     queries in cache that have not stored its results yet
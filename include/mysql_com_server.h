@@ -29,13 +29,30 @@ typedef void (*before_header_callback_fn)
 typedef void (*after_header_callback_fn)
   (struct st_net *net, void *user_data, size_t count, my_bool rc);
 
+struct st_my_compress_stream;
+
 struct st_net_server
 {
   before_header_callback_fn m_before_header;
   after_header_callback_fn m_after_header;
   void *m_user_data;
+  /*
+    Compression state of the connection, if it uses an algorithm other
+    than zlib or a non-default level. See my_net_set_compression().
+  */
+  struct st_my_compress_stream *m_compress_stream;
 };
 
 typedef struct st_net_server NET_SERVER;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+my_bool my_net_set_compression(struct st_net *net, unsigned int algorithm,
+                               unsigned int level);
+void my_net_set_compression_level(struct st_net *net, unsigned int level);
+#ifdef __cplusplus
+}
+#endif
+
 #endif
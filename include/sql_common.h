@@ -44,6 +44,9 @@ struct st_mysql_options_extention {
   struct mysql_async_context *async_context;
   HASH connection_attributes;
   size_t connection_attributes_length;
+  /* MY_COMPRESS_* and level for the compressed protocol */
+  unsigned int compression_algorithm;
+  unsigned int compression_level;
 };
 
 typedef struct st_mysql_methods
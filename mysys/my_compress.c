@@ -22,6 +22,12 @@
 #include <m_string.h>
 #endif
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
 
 /*
    This replaces the packet with a compressed packet
@@ -94,11 +100,12 @@ void my_az_free(void *dummy __attribute__((unused)), void *address)
 }
 
 /*
-  This works like zlib compress(), but using custom memory allocators to work
+  This works like zlib compress2(), but using custom memory allocators to work
   better with my_malloc leak detection and Valgrind.
 */
-int my_compress_buffer(uchar *dest, size_t *destLen,
-                       const uchar *source, size_t sourceLen)
+static int my_compress_buffer_level(uchar *dest, size_t *destLen,
+                                    const uchar *source, size_t sourceLen,
+                                    int level)
 {
     z_stream stream;
     int err;
@@ -114,7 +121,7 @@ int my_compress_buffer(uchar *dest, size_t *destLen,
     stream.zfree = (free_func)my_az_free;
     stream.opaque = (voidpf)0;
 
-    err = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+    err = deflateInit(&stream, level);
     if (err != Z_OK) return err;
 
     err = deflate(&stream, Z_FINISH);
@@ -128,6 +135,13 @@ int my_compress_buffer(uchar *dest, size_t *destLen,
     return err;
 }
 
+int my_compress_buffer(uchar *dest, size_t *destLen,
+                       const uchar *source, size_t sourceLen)
+{
+  return my_compress_buffer_level(dest, destLen, source, sourceLen,
+                                  Z_DEFAULT_COMPRESSION);
+}
+
 uchar *my_compress_alloc(const uchar *packet, size_t *len, size_t *complen)
 {
   uchar *compbuf;
@@ -206,4 +220,326 @@ my_bool my_uncompress(uchar *packet, size_t len, size_t *complen)
   DBUG_RETURN(0);
 }
 
+
+
+/*
+  Compression streams for the client/server protocol
+
+  my_compress() compresses every packet on its own, with a fresh zlib
+  dictionary. A MY_COMPRESS_STREAM belongs to one connection and is used
+  for all packets sent and received on it, in order:
+
+  MY_COMPRESS_ZLIB  Packets are compressed on their own, as by my_compress(),
+                    but with a selectable level.
+  MY_COMPRESS_ZSTD  One zstd stream per direction. Every packet is flushed
+                    to a complete block, so that the peer can decode it
+                    immediately, but the compressor keeps its window, so
+                    later packets can refer to data in earlier ones.
+  MY_COMPRESS_LZ4   Packets are compressed on their own by LZ4, which is
+                    much cheaper than zlib. The level is ignored.
+
+  As the zstd decompressor must see exactly the packets that went through
+  the compressor, my_compress_stream() never reports a zstd packet as not
+  compressed, even if it got longer. The caller must decide before calling
+  it whether the packet is to be compressed at all.
+*/
+
+#ifdef HAVE_ZSTD
+/*
+  zstd window size. Each connection has a compressor and a decompressor
+  with a window this size; the zstd default would be several megabytes.
+  The decompressor refuses frames that ask for a larger window, so that
+  the peer can not make it allocate more.
+*/
+#define MY_ZSTD_WINDOW_LOG 17
+#endif
+
+/* Names of MY_COMPRESS_*, for options and status */
+const char *my_compress_algorithm_names[]= {"zlib", "zstd", "lz4", NullS};
+
+struct st_my_compress_stream
+{
+  uint algorithm;
+  uint level;
+  myf flags;
+#ifdef HAVE_ZSTD
+  ZSTD_CCtx *cctx;
+  ZSTD_DCtx *dctx;
+  /* Level to switch to at the end of the current zstd frame */
+  uint new_level;
+#endif
+  /* Buffer for uncompressing, see my_uncompress_stream() */
+  uchar *buf;
+  size_t buf_size;
+};
+
+
+my_bool my_compress_stream_supported(uint algorithm)
+{
+  switch (algorithm) {
+  case MY_COMPRESS_ZLIB:
+    return 1;
+#ifdef HAVE_ZSTD
+  case MY_COMPRESS_ZSTD:
+    return 1;
+#endif
+#ifdef HAVE_LZ4
+  case MY_COMPRESS_LZ4:
+    return 1;
+#endif
+  }
+  return 0;
+}
+
+
+#ifdef HAVE_ZSTD
+static my_bool zstd_set_level(ZSTD_CCtx *cctx, uint level)
+{
+  int zlevel= level ? (int) MY_MIN(level, (uint) ZSTD_maxCLevel())
+                    : ZSTD_CLEVEL_DEFAULT;
+  return ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                                             zlevel));
+}
+#endif
+
+
+/*
+  Create a compression stream for a connection
+
+  SYNOPSIS
+    my_compress_stream_init()
+    algorithm   One of MY_COMPRESS_*
+    level       Compression level, 0 for the default of the algorithm
+    flags       Flags for my_malloc(), like MY_THREAD_SPECIFIC
+
+  RETURN
+    The stream, or NULL if the algorithm is not supported or out of memory
+*/
+
+MY_COMPRESS_STREAM *my_compress_stream_init(uint algorithm, uint level,
+                                            myf flags)
+{
+  MY_COMPRESS_STREAM *stream;
+  DBUG_ENTER("my_compress_stream_init");
+
+  if (!my_compress_stream_supported(algorithm))
+    DBUG_RETURN(NULL);
+  if (!(stream= (MY_COMPRESS_STREAM*) my_malloc(key_memory_my_compress_alloc,
+                                                sizeof(*stream),
+                                                MYF(MY_WME | MY_ZEROFILL |
+                                                    flags))))
+    DBUG_RETURN(NULL);
+  stream->algorithm= algorithm;
+  stream->level= level;
+  stream->flags= flags;
+#ifdef HAVE_ZSTD
+  if (algorithm == MY_COMPRESS_ZSTD)
+  {
+    stream->new_level= level;
+    if (!(stream->cctx= ZSTD_createCCtx()) ||
+        !(stream->dctx= ZSTD_createDCtx()) ||
+        zstd_set_level(stream->cctx, level) ||
+        ZSTD_isError(ZSTD_CCtx_setParameter(stream->cctx, ZSTD_c_windowLog,
+                                            MY_ZSTD_WINDOW_LOG)) ||
+        ZSTD_isError(ZSTD_DCtx_setParameter(stream->dctx,
+                                            ZSTD_d_windowLogMax,
+                                            MY_ZSTD_WINDOW_LOG)))
+    {
+      my_compress_stream_end(stream);
+      DBUG_RETURN(NULL);
+    }
+  }
+#endif
+  DBUG_RETURN(stream);
+}
+
+
+void my_compress_stream_end(MY_COMPRESS_STREAM *stream)
+{
+  if (!stream)
+    return;
+#ifdef HAVE_ZSTD
+  ZSTD_freeCCtx(stream->cctx);
+  ZSTD_freeDCtx(stream->dctx);
+#endif
+  my_free(stream->buf);
+  my_free(stream);
+}
+
+
+/*
+  Change the compression level of a stream
+
+  zstd can not change the level in the middle of a frame. The current
+  frame is ended with the next packet, and a new frame with the new level
+  is started after it.
+*/
+
+void my_compress_stream_set_level(MY_COMPRESS_STREAM *stream, uint level)
+{
+#ifdef HAVE_ZSTD
+  if (stream->algorithm == MY_COMPRESS_ZSTD)
+  {
+    stream->new_level= level;
+    return;
+  }
+#endif
+  stream->level= level;
+}
+
+
+/*
+  Size of the buffer needed by my_compress_stream() for 'len' bytes
+
+  Only zstd can produce output that is longer than the input. For the
+  other algorithms, a packet that does not get shorter is sent as it is.
+*/
+
+size_t my_compress_stream_bound(MY_COMPRESS_STREAM *stream, size_t len)
+{
+#ifdef HAVE_ZSTD
+  if (stream->algorithm == MY_COMPRESS_ZSTD)
+    return ZSTD_compressBound(len);
+#endif
+  return len;
+}
+
+
+/*
+  Compress a packet
+
+  SYNOPSIS
+    my_compress_stream()
+    stream      Compression stream of the connection
+    dest        Buffer for the compressed data
+    dest_len    in: size of dest, at least my_compress_stream_bound(len)
+                out: length of the compressed data, or 0 if the packet is
+                to be sent uncompressed
+    src         Data to compress
+    len         Length of data to compress
+
+  RETURN
+    1   error. The stream can not be used any more.
+    0   ok
+*/
+
+my_bool my_compress_stream(MY_COMPRESS_STREAM *stream, uchar *dest,
+                           size_t *dest_len, const uchar *src, size_t len)
+{
+  DBUG_ENTER("my_compress_stream");
+  switch (stream->algorithm) {
+#ifdef HAVE_ZSTD
+  case MY_COMPRESS_ZSTD:
+  {
+    ZSTD_inBuffer in= { src, len, 0 };
+    ZSTD_outBuffer out= { dest, *dest_len, 0 };
+    my_bool new_frame= stream->new_level != stream->level;
+    size_t res= ZSTD_compressStream2(stream->cctx, &out, &in,
+                                     new_frame ? ZSTD_e_end : ZSTD_e_flush);
+    /* A non-zero result means that dest was too small */
+    if (ZSTD_isError(res) || res)
+      DBUG_RETURN(1);
+    if (new_frame)
+    {
+      if (ZSTD_isError(ZSTD_CCtx_reset(stream->cctx,
+                                       ZSTD_reset_session_only)) ||
+          zstd_set_level(stream->cctx, stream->new_level))
+        DBUG_RETURN(1);
+      stream->level= stream->new_level;
+    }
+    *dest_len= out.pos;
+    DBUG_RETURN(0);
+  }
+#endif
+#ifdef HAVE_LZ4
+  case MY_COMPRESS_LZ4:
+  {
+    /* Returns 0 if the output does not fit, that is, got longer */
+    int res= LZ4_compress_default((const char*) src, (char*) dest, (int) len,
+                                  (int) MY_MIN(*dest_len, len - 1));
+    *dest_len= res > 0 ? (size_t) res : 0;
+    DBUG_RETURN(0);
+  }
+#endif
+  case MY_COMPRESS_ZLIB:
+    *dest_len= MY_MIN(*dest_len, len - 1);
+    if (my_compress_buffer_level(dest, dest_len, src, len,
+                                 stream->level ? (int) MY_MIN(stream->level, 9)
+                                               : Z_DEFAULT_COMPRESSION) !=
+        Z_OK)
+      *dest_len= 0;
+    DBUG_RETURN(0);
+  }
+  DBUG_RETURN(1);
+}
+
+
+/*
+  Uncompress a packet that was compressed by my_compress_stream()
+
+  Works like my_uncompress(): 'packet' must have room for *complen bytes,
+  and a packet with *complen == 0 was not compressed.
+*/
+
+my_bool my_uncompress_stream(MY_COMPRESS_STREAM *stream, uchar *packet,
+                             size_t len, size_t *complen)
+{
+  DBUG_ENTER("my_uncompress_stream");
+
+  if (!*complen)
+  {
+    *complen= len;
+    DBUG_RETURN(0);
+  }
+  if (stream->algorithm == MY_COMPRESS_ZLIB)
+    DBUG_RETURN(my_uncompress(packet, len, complen));
+
+  if (*complen > stream->buf_size)
+  {
+    my_free(stream->buf);
+    stream->buf_size= 0;
+    if (!(stream->buf= (uchar*) my_malloc(key_memory_my_compress_alloc,
+                                          *complen,
+                                          MYF(MY_WME | stream->flags))))
+      DBUG_RETURN(1);
+    stream->buf_size= *complen;
+  }
+
+  switch (stream->algorithm) {
+#ifdef HAVE_ZSTD
+  case MY_COMPRESS_ZSTD:
+  {
+    ZSTD_inBuffer in= { packet, len, 0 };
+    ZSTD_outBuffer out= { stream->buf, *complen, 0 };
+    while (in.pos < in.size)
+    {
+      size_t pos= in.pos + out.pos;
+      size_t res= ZSTD_decompressStream(stream->dctx, &out, &in);
+      if (ZSTD_isError(res) || in.pos + out.pos == pos)
+      {
+        DBUG_PRINT("error", ("Can't uncompress packet: %s",
+                             ZSTD_isError(res) ? ZSTD_getErrorName(res)
+                                               : "no progress"));
+        DBUG_RETURN(1);
+      }
+    }
+    if (out.pos != *complen)
+      DBUG_RETURN(1);
+    break;
+  }
+#endif
+#ifdef HAVE_LZ4
+  case MY_COMPRESS_LZ4:
+    if (LZ4_decompress_safe((const char*) packet, (char*) stream->buf,
+                            (int) len, (int) *complen) != (int) *complen)
+      DBUG_RETURN(1);
+    break;
+#endif
+  default:
+    DBUG_RETURN(1);
+  }
+  memcpy(packet, stream->buf, *complen);
+  DBUG_RETURN(0);
+}
+
 #endif /* HAVE_COMPRESS */
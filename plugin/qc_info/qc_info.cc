@@ -79,6 +79,16 @@ bool schema_table_store_record(THD *thd, TABLE *table);
 #define COLUMN_PKT_NR 22
 #define COLUMN_HITS 23
 
+#define COLUMN_PARTITION_NUMBER 0
+#define COLUMN_PARTITION_SIZE 1
+#define COLUMN_PARTITION_FREE_MEMORY 2
+#define COLUMN_PARTITION_QUERIES 3
+#define COLUMN_PARTITION_HITS 4
+#define COLUMN_PARTITION_MISSES 5
+#define COLUMN_PARTITION_INSERTS 6
+#define COLUMN_PARTITION_LOWMEM_PRUNES 7
+#define COLUMN_PARTITION_LOCK_WAITS 8
+
 
 namespace Show {
 
@@ -112,24 +122,33 @@ static ST_FIELD_INFO qc_info_fields[]=
   CEnd()
 };
 
+static ST_FIELD_INFO qc_partitions_fields[]=
+{
+  Column("PARTITION_NUMBER",      ULong(),                            NOT_NULL),
+  Column("SIZE",                  ULonglong(),                        NOT_NULL),
+  Column("FREE_MEMORY",           ULonglong(),                        NOT_NULL),
+  Column("QUERIES",               ULonglong(),                        NOT_NULL),
+  Column("HITS",                  ULonglong(),                        NOT_NULL),
+  Column("MISSES",                ULonglong(),                        NOT_NULL),
+  Column("INSERTS",               ULonglong(),                        NOT_NULL),
+  Column("LOWMEM_PRUNES",         ULonglong(),                        NOT_NULL),
+  Column("LOCK_WAITS",            ULonglong(),                        NOT_NULL),
+  CEnd()
+};
+
 } // namespace Show
 
 
 static const char unknown[]= "#UNKNOWN#";
 
-static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
-                                              COND *cond)
+static int qc_info_fill_partition(THD *thd, TABLE *table,
+                                  Accessible_Query_Cache *partition)
 {
   int status= 1;
   CHARSET_INFO *scs= system_charset_info;
-  TABLE *table= tables->table;
-  HASH *queries = qc->get_queries();
+  HASH *queries = partition->get_queries();
 
-  /* one must have PROCESS privilege to see others' queries */
-  if (check_global_access(thd, PROCESS_ACL, true))
-    return 0;
-
-  if (qc->try_lock(thd))
+  if (partition->try_lock(thd))
     return 0; // QC is or is being disabled
 
   /* loop through all queries in the query cache */
@@ -273,17 +292,63 @@ static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
   status = 0;
 
 cleanup:
-  qc->unlock();
+  partition->unlock();
   return status;
 }
 
-static int qc_info_plugin_init(void *p)
+static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
+                                              COND *cond)
 {
-  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+  /* one must have PROCESS privilege to see others' queries */
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
 
-  schema->fields_info= Show::qc_info_fields;
-  schema->fill_table= qc_info_fill_table;
+  for (uint i= 0; i < qc->partition_count(); i++)
+  {
+    if (qc_info_fill_partition(thd, tables->table,
+                               (Accessible_Query_Cache *) qc->partition(i)))
+      return 1;
+  }
+  return 0;
+}
+
+/*
+  The statistics of the query cache partitions. They are read without
+  locking the partitions, like the Qcache_% status variables.
+*/
+static int qc_partitions_fill_table(THD *thd, TABLE_LIST *tables,
+                                    COND *cond)
+{
+  TABLE *table= tables->table;
+
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
+
+  for (uint i= 0; i < qc->partition_count(); i++)
+  {
+    Query_cache *partition= qc->partition(i);
+    table->field[COLUMN_PARTITION_NUMBER]->store(i, 1);
+    table->field[COLUMN_PARTITION_SIZE]->
+      store(partition->query_cache_size, 1);
+    table->field[COLUMN_PARTITION_FREE_MEMORY]->
+      store(partition->free_memory, 1);
+    table->field[COLUMN_PARTITION_QUERIES]->
+      store(partition->queries_in_cache, 1);
+    table->field[COLUMN_PARTITION_HITS]->store(partition->hits, 1);
+    table->field[COLUMN_PARTITION_MISSES]->store(partition->misses, 1);
+    table->field[COLUMN_PARTITION_INSERTS]->store(partition->inserts, 1);
+    table->field[COLUMN_PARTITION_LOWMEM_PRUNES]->
+      store(partition->lowmem_prunes, 1);
+    table->field[COLUMN_PARTITION_LOCK_WAITS]->
+      store(partition->lock_waits, 1);
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+  return 0;
+}
 
+static int find_query_cache()
+{
 #ifdef _WIN32
   qc = (Accessible_Query_Cache *)
     GetProcAddress(GetModuleHandle(NULL), "?query_cache@@3VQuery_cache@@A");
@@ -294,6 +359,26 @@ static int qc_info_plugin_init(void *p)
   return qc == 0;
 }
 
+static int qc_info_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= Show::qc_info_fields;
+  schema->fill_table= qc_info_fill_table;
+
+  return find_query_cache();
+}
+
+static int qc_partitions_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= Show::qc_partitions_fields;
+  schema->fill_table= qc_partitions_fill_table;
+
+  return find_query_cache();
+}
+
 
 static struct st_mysql_information_schema qc_info_plugin=
 { MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
@@ -317,6 +402,21 @@ maria_declare_plugin(query_cache_info)
   NULL,                       /* system variables     */
   "1.1",                      /* version as a string  */
   MariaDB_PLUGIN_MATURITY_STABLE
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &qc_info_plugin,
+  "QUERY_CACHE_PARTITION_INFO",
+  "MariaDB Corporation",
+  "Statistics of the query cache partitions.",
+  PLUGIN_LICENSE_BSD,
+  qc_partitions_plugin_init,  /* Plugin Init */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_BETA
 }
 maria_declare_plugin_end;
 
@@ -38,6 +38,9 @@
 #include <my_default.h>
 #include "mysql.h"
 #include "hash.h"
+#ifdef MYSQL_SERVER
+#include <mysql_com_server.h>
+#endif
 
 /* Remove client convenience wrappers */
 #undef max_allowed_packet
@@ -732,6 +735,11 @@ void end_server(MYSQL *mysql)
     mysql_prune_stmt_list(mysql);
   }
   net_end(&mysql->net);
+#ifdef MYSQL_SERVER
+  /* Allocated for a compression stream, see mysql_real_connect() */
+  my_free(mysql->net.extension);
+  mysql->net.extension= 0;
+#endif
   free_old_query(mysql);
   errno= save_errno;
   DBUG_VOID_RETURN;
@@ -2099,13 +2107,28 @@ static int send_client_reply_packet(MCPVIO_EXT *mpvio,
   mysql->client_flag&= ~CLIENT_COMPRESS;
 #endif
 
+  if (!(mysql->client_flag & CLIENT_COMPRESS) ||
+      !(mysql->client_flag & CLIENT_PROTOCOL_41))
+    net->compress_algorithm= MY_COMPRESS_ZLIB;
+
   if (mysql->client_flag & CLIENT_PROTOCOL_41)
   {
+    ulong client_flag= mysql->client_flag;
+    ulonglong ext_client_flag= 0;
+    if (net->compress_algorithm != MY_COMPRESS_ZLIB)
+    {
+      /* The server reads extended flags only from non-MySQL clients */
+      client_flag&= ~CLIENT_MYSQL;
+      ext_client_flag= net->compress_algorithm == MY_COMPRESS_ZSTD ?
+                       MARIADB_CLIENT_ZSTD_COMPRESSION :
+                       MARIADB_CLIENT_LZ4_COMPRESSION;
+    }
     /* 4.1 server and 4.1 client has a 32 byte option flag */
-    int4store(buff,mysql->client_flag);
+    int4store(buff,client_flag);
     int4store(buff+4, net->max_packet_size);
     buff[8]= (char) mysql->charset->number;
     bzero(buff+9, 32-9);
+    int4store(buff+28, (uint32) (ext_client_flag >> 32));
     end= buff+32;
   }
   else
@@ -2652,6 +2675,30 @@ set_connect_attributes(MYSQL *mysql, char *buff, size_t buf_len)
 }
 
 
+#ifdef MYSQL_SERVER
+/*
+  Choose the compression algorithm to ask the server for: the one set with
+  MYSQL_OPT_COMPRESSION_ALGORITHM if the server supports it, else zlib.
+  It is only used if CLIENT_COMPRESS is used, too.
+*/
+
+static uint choose_compress_algorithm(MYSQL *mysql, uint32 ext_capabilities)
+{
+  ulonglong server_ext= ((ulonglong) ext_capabilities) << 32;
+  uint algorithm= mysql->options.extension ?
+                  mysql->options.extension->compression_algorithm :
+                  MY_COMPRESS_ZLIB;
+
+  if ((algorithm == MY_COMPRESS_ZSTD &&
+       (server_ext & MARIADB_CLIENT_ZSTD_COMPRESSION)) ||
+      (algorithm == MY_COMPRESS_LZ4 &&
+       (server_ext & MARIADB_CLIENT_LZ4_COMPRESSION)))
+    return algorithm;
+  return MY_COMPRESS_ZLIB;
+}
+#endif
+
+
 MYSQL * STDCALL 
 CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
 		       const char *passwd, const char *db,
@@ -3019,6 +3066,11 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
     mysql->server_language=end[2];
     mysql->server_status=uint2korr(end+3);
     mysql->server_capabilities|= uint2korr(end+5) << 16;
+#ifdef MYSQL_SERVER
+    if (!(mysql->server_capabilities & CLIENT_MYSQL))
+      net->compress_algorithm= choose_compress_algorithm(mysql,
+                                                         uint4korr(end+14));
+#endif
     pkt_scramble_len= end[7];
     if (pkt_scramble_len < 0)
     {
@@ -3118,7 +3170,30 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
   */
 
   if (mysql->client_flag & CLIENT_COMPRESS)      /* We will use compression */
+  {
+#ifdef MYSQL_SERVER
+    uint level= mysql->options.extension ?
+                mysql->options.extension->compression_level : 0;
+    /* Other algorithms and levels need a compression stream */
+    if ((net->compress_algorithm != MY_COMPRESS_ZLIB || level) &&
+        !(net->extension=
+          my_malloc(key_memory_mysql_options, sizeof(NET_SERVER),
+                    MYF(MY_WME | MY_ZEROFILL |
+                        (mysql->options.use_thread_specific_memory ?
+                         MY_THREAD_SPECIFIC : 0)))))
+    {
+      set_mysql_error(mysql, CR_OUT_OF_MEMORY, unknown_sqlstate);
+      goto error;
+    }
+    if (my_net_set_compression(net, net->compress_algorithm, level))
+    {
+      set_mysql_error(mysql, CR_OUT_OF_MEMORY, unknown_sqlstate);
+      goto error;
+    }
+#else
     net->compress=1;
+#endif
+  }
 
   if (db && !mysql->db && mysql_select_db(mysql, db))
   {
@@ -3869,6 +3944,27 @@ mysql_options(MYSQL *mysql,enum mysql_option option, const void *arg)
   case MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY:
     mysql->options.use_thread_specific_memory= *(my_bool *) arg;
     break;
+  case MYSQL_OPT_COMPRESSION_ALGORITHM:
+  {
+    uint i;
+    for (i= 0; my_compress_algorithm_names[i]; i++)
+      if (!my_strcasecmp(&my_charset_latin1, (const char*) arg,
+                         my_compress_algorithm_names[i]))
+        break;
+    if (!my_compress_algorithm_names[i] || !my_compress_stream_supported(i))
+      DBUG_RETURN(1);
+    ENSURE_EXTENSIONS_PRESENT(&mysql->options);
+    if (!mysql->options.extension)
+      DBUG_RETURN(1);
+    mysql->options.extension->compression_algorithm= i;
+    break;
+  }
+  case MYSQL_OPT_COMPRESSION_LEVEL:
+    ENSURE_EXTENSIONS_PRESENT(&mysql->options);
+    if (!mysql->options.extension)
+      DBUG_RETURN(1);
+    mysql->options.extension->compression_level= *(uint *) arg;
+    break;
   case MYSQL_OPT_SSL_VERIFY_SERVER_CERT:
     if (*(my_bool*) arg)
       mysql->options.client_flag|= CLIENT_SSL_VERIFY_SERVER_CERT;
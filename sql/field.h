@@ -1853,6 +1853,8 @@ class Field: public Value_source
   void register_field_in_read_map();
 
   virtual Compression_method *compression_method() const { return 0; }
+  /* Whether the stored bytes are binary JSON, see json_binary.h */
+  virtual bool is_json_binary() const { return false; }
 
   virtual Virtual_tmp_table **virtual_tmp_table_addr()
   {
@@ -4338,7 +4340,8 @@ class Field_blob :public Field_longstr {
       return do_field_int;
     */
     if (!(from->flags & BLOB_FLAG) || from->charset() != charset() ||
-        !from->compression_method() != !compression_method())
+        !from->compression_method() != !compression_method() ||
+        from->is_json_binary() != is_json_binary())
       return do_conv_blob;
     if (from->pack_length() != Field_blob::pack_length())
       return do_copy_blob;
@@ -4364,6 +4367,7 @@ class Field_blob :public Field_longstr {
   {
     return Field_str::memcpy_field_possible(from) &&
            !compression_method() == !from->compression_method() &&
+           is_json_binary() == from->is_json_binary() &&
            !table->copy_blobs;
   }
   bool make_empty_rec_store_default_value(THD *thd, Item *item) override;
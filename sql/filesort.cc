@@ -252,6 +252,7 @@ SORT_INFO *filesort(THD *thd, TABLE *table, Filesort *filesort,
                             &allow_packing_for_sortkeys);
 
   param.init_for_filesort(sort_len, table, max_rows, filesort->sort_positions);
+  param.sort_threads= (uint) thd->variables.sort_parallel_threads;
 
   sort->addon_fields=  param.addon_fields;
   sort->sort_keys= param.sort_keys;
@@ -435,6 +436,7 @@ SORT_INFO *filesort(THD *thd, TABLE *table, Filesort *filesort,
     // If find_all_keys() produced more results than the query LIMIT.
     num_rows= param.max_rows;
   }
+  tracker->report_sort_threads(param.sort_threads_used);
   error= 0;
 
   err:
@@ -2482,6 +2484,13 @@ void change_double_for_sort(double nr,uchar *to)
   }
 }
 
+void SORT_INFO::sort_buffer(Sort_param *param, uint count)
+{
+  uint threads= filesort_buffer.sort_buffer(param, count);
+  set_if_bigger(param->sort_threads_used, threads);
+}
+
+
 bool SORT_INFO::using_packed_addons()
 {
   return addon_fields != NULL && addon_fields->using_packed_addons();
@@ -147,8 +147,7 @@ class SORT_INFO
   ha_rows   found_rows;         /* How many rows was accepted */
 
   /** Sort filesort_buffer */
-  void sort_buffer(Sort_param *param, uint count)
-  { filesort_buffer.sort_buffer(param, count); }
+  void sort_buffer(Sort_param *param, uint count);
 
   uchar **get_sort_keys()
   { return filesort_buffer.get_sort_keys(); }
@@ -19,6 +19,11 @@
 #include "sql_sort.h"
 #include "table.h"
 
+#include <tpool.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 
 PSI_memory_key key_memory_Filesort_buffer_sort_keys;
 
@@ -166,18 +171,361 @@ void Filesort_buffer::free_sort_buffer()
 }
 
 
-void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+/*
+  Parallel sorting of the sort buffer.
+
+  The record pointers are divided into slices which are sorted concurrently,
+  one by the connection thread and the others by threads of a thread pool
+  shared by all connections. The sorted slices are then merged, also in
+  parallel: a few keys sampled from the slices are used as splitters that
+  divide the output into ranges of about the same size, and every thread
+  does a k-way merge of the parts of all slices that belong to its range.
+
+  The workers only compare keys and move pointers, so they need neither a
+  THD nor any memory allocation; everything is allocated up front by the
+  connection thread.
+*/
+
+/* Do not use more threads than this for sorting fewer keys */
+static const uint MIN_ROWS_PER_SORT_THREAD= 1024;
+
+static std::atomic<tpool::thread_pool*> sort_thread_pool;
+static std::mutex sort_thread_pool_mutex;
+
+static void sort_thread_init()
+{
+  my_thread_init();
+}
+
+static void sort_thread_end()
+{
+  my_thread_end();
+}
+
+static tpool::thread_pool *get_sort_thread_pool()
+{
+  tpool::thread_pool *pool= sort_thread_pool.load(std::memory_order_acquire);
+  if (!pool)
+  {
+    std::lock_guard<std::mutex> lk(sort_thread_pool_mutex);
+    if (!(pool= sort_thread_pool.load(std::memory_order_relaxed)))
+    {
+      pool= tpool::create_thread_pool_generic(1, MAX_SORT_THREADS);
+      pool->set_thread_callbacks(sort_thread_init, sort_thread_end);
+      sort_thread_pool.store(pool, std::memory_order_release);
+    }
+  }
+  return pool;
+}
+
+
+void filesort_thread_pool_end()
+{
+  delete sort_thread_pool.exchange(nullptr);
+}
+
+
+namespace {
+
+class Parallel_sort
+{
+public:
+  Parallel_sort(uchar **keys, uint count, uint n_threads, size_t radix_length,
+                qsort2_cmp cmp, void *cmp_arg)
+    : m_keys(keys), m_count(count), m_threads(n_threads),
+      m_radix_length(radix_length), m_cmp(cmp), m_cmp_arg(cmp_arg),
+      m_tmp(NULL)
+  {}
+  ~Parallel_sort() { my_free(m_tmp); }
+
+  bool sort();
+
+private:
+  /** Cursor into one slice, for the k-way merge */
+  struct Merge_src
+  {
+    uchar **pos;
+    uchar **end;
+  };
+
+  /*
+    Completion is signalled from release(), which is the last access of
+    the thread pool to the task, as the tasks go away with the sort.
+  */
+  struct Task : public tpool::task
+  {
+    Parallel_sort *sort;
+    uint n;
+    Task() : tpool::task(execute, this) {}
+    static void execute(void *arg)
+    {
+      Task *t= static_cast<Task*>(arg);
+      t->sort->run_job(t->n);
+    }
+    void release() override { sort->job_done(); }
+  };
+
+  bool less(uchar **a, uchar **b) const
+  { return m_cmp(m_cmp_arg, a, b) < 0; }
+
+  void run_phase(bool merge);
+  void run_job(uint n) { m_merge ? merge_range(n) : sort_slice(n); }
+  void job_done();
+  void sort_slice(uint n);
+  void choose_splitters();
+  void merge_range(uint n);
+  void heap_down(Merge_src *heap, uint size, uint i) const;
+
+  uchar **m_keys;
+  uint m_count;
+  uint m_threads;
+  /* Sort length if the keys can be compared with memcmp(), otherwise 0 */
+  size_t m_radix_length;
+  qsort2_cmp m_cmp;
+  void *m_cmp_arg;
+
+  /*
+    One allocation for: the sorted slices (count pointers), the splitter
+    samples (threads * threads pointers) and the cut positions of every
+    output range in every slice ((threads + 1) * threads offsets).
+  */
+  uchar *m_tmp;
+  uchar **m_sorted;
+  uchar **m_samples;
+  uint *m_cuts;
+
+  bool m_merge;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  uint m_pending;
+  Task m_tasks[MAX_SORT_THREADS];
+};
+
+
+/** Start of slice n in m_keys, and of its sorted copy in m_sorted */
+#define SLICE_START(n) (uint) ((ulonglong) m_count * (n) / m_threads)
+
+
+void Parallel_sort::job_done()
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  if (!--m_pending)
+    m_cond.notify_one();
+}
+
+
+/**
+  Run job 0 of a phase in this thread and the others in the thread pool,
+  and wait until all of them are finished.
+*/
+void Parallel_sort::run_phase(bool merge)
+{
+  tpool::thread_pool *pool= get_sort_thread_pool();
+  m_merge= merge;
+  m_pending= m_threads - 1;
+  for (uint n= 1; n < m_threads; n++)
+  {
+    m_tasks[n].sort= this;
+    m_tasks[n].n= n;
+    pool->submit_task(&m_tasks[n]);
+  }
+  run_job(0);
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (m_pending)
+    m_cond.wait(lk);
+}
+
+
+/**
+  Sort one slice of m_keys and copy it to m_sorted. The destination area
+  doubles as the work buffer of radixsort.
+*/
+void Parallel_sort::sort_slice(uint n)
+{
+  uint start= SLICE_START(n), end= SLICE_START(n + 1);
+  uchar **keys= m_keys + start;
+  uint count= end - start;
+
+  if (m_radix_length && radixsort_is_appliccable(count, m_radix_length))
+    radixsort_for_str_ptr(keys, count, m_radix_length, m_sorted + start);
+  else
+    my_qsort2(keys, count, sizeof(uchar*), m_cmp, m_cmp_arg);
+  memcpy(m_sorted + start, keys, count * sizeof(uchar*));
+}
+
+
+/**
+  Choose m_threads - 1 splitters from a sample of every slice, and find
+  for every splitter the first key in every slice that is not smaller.
+  m_cuts[r * m_threads + s] is where output range r starts in slice s.
+*/
+void Parallel_sort::choose_splitters()
+{
+  uint n_samples= 0;
+  for (uint s= 0; s < m_threads; s++)
+  {
+    uint start= SLICE_START(s), count= SLICE_START(s + 1) - start;
+    for (uint i= 1; i < m_threads; i++)
+      m_samples[n_samples++]=
+        m_sorted[start + (uint) ((ulonglong) count * i / m_threads)];
+  }
+  my_qsort2(m_samples, n_samples, sizeof(uchar*), m_cmp, m_cmp_arg);
+
+  for (uint s= 0; s < m_threads; s++)
+  {
+    m_cuts[s]= SLICE_START(s);
+    m_cuts[m_threads * m_threads + s]= SLICE_START(s + 1);
+  }
+  for (uint r= 1; r < m_threads; r++)
+  {
+    uchar **splitter= &m_samples[r * (m_threads - 1)];
+    for (uint s= 0; s < m_threads; s++)
+    {
+      /* The previous cut is a lower bound, as the splitters are sorted */
+      uint lo= m_cuts[(r - 1) * m_threads + s], hi= SLICE_START(s + 1);
+      while (lo < hi)
+      {
+        uint mid= lo + (hi - lo) / 2;
+        if (less(m_sorted + mid, splitter))
+          lo= mid + 1;
+        else
+          hi= mid;
+      }
+      m_cuts[r * m_threads + s]= lo;
+    }
+  }
+}
+
+
+void Parallel_sort::heap_down(Merge_src *heap, uint size, uint i) const
+{
+  Merge_src top= heap[i];
+  for (;;)
+  {
+    uint child= 2 * i + 1;
+    if (child >= size)
+      break;
+    if (child + 1 < size && less(heap[child + 1].pos, heap[child].pos))
+      child++;
+    if (!less(heap[child].pos, top.pos))
+      break;
+    heap[i]= heap[child];
+    i= child;
+  }
+  heap[i]= top;
+}
+
+
+/** Merge the parts of all slices that belong to output range n */
+void Parallel_sort::merge_range(uint n)
+{
+  const uint *from= m_cuts + n * m_threads, *to= from + m_threads;
+  Merge_src heap[MAX_SORT_THREADS];
+  uint size= 0, out= 0;
+
+  for (uint s= 0; s < m_threads; s++)
+  {
+    out+= from[s] - SLICE_START(s);
+    if (from[s] < to[s])
+    {
+      heap[size].pos= m_sorted + from[s];
+      heap[size].end= m_sorted + to[s];
+      size++;
+    }
+  }
+  for (uint i= size / 2; i-- > 0; )
+    heap_down(heap, size, i);
+
+  uchar **dst= m_keys + out;
+  while (size > 1)
+  {
+    *dst++= *heap[0].pos;
+    if (++heap[0].pos == heap[0].end)
+      heap[0]= heap[--size];
+    heap_down(heap, size, 0);
+  }
+  if (size)
+    memcpy(dst, heap[0].pos, (heap[0].end - heap[0].pos) * sizeof(uchar*));
+}
+
+
+/**
+  @retval false  keys are sorted
+  @retval true   out of memory, nothing was done
+*/
+bool Parallel_sort::sort()
+{
+  size_t sorted_size= m_count * sizeof(uchar*);
+  size_t samples_size= m_threads * m_threads * sizeof(uchar*);
+  size_t cuts_size= (m_threads + 1) * m_threads * sizeof(uint);
+
+  if (!(m_tmp= (uchar*) my_malloc(key_memory_Filesort_buffer_sort_keys,
+                                  sorted_size + samples_size + cuts_size,
+                                  MYF(MY_THREAD_SPECIFIC))))
+    return true;
+  m_sorted= (uchar**) m_tmp;
+  m_samples= (uchar**) (m_tmp + sorted_size);
+  m_cuts= (uint*) (m_tmp + sorted_size + samples_size);
+
+  run_phase(false);
+  choose_splitters();
+  run_phase(true);
+  return false;
+}
+
+#undef SLICE_START
+
+} // namespace
+
+
+/**
+  Sort an array of record pointers using several threads.
+
+  @param keys          The record pointers
+  @param count         Number of record pointers
+  @param threads       Number of threads to use, including this one
+  @param radix_length  Key length if the keys can be sorted with radixsort,
+                       otherwise 0
+  @param cmp           Compare function, as for my_qsort2()
+  @param cmp_arg       Argument of the compare function
+
+  @retval false  ok
+  @retval true   out of memory; the caller should sort in this thread
+*/
+
+static bool parallel_sort(uchar **keys, uint count, uint threads,
+                          size_t radix_length, qsort2_cmp cmp, void *cmp_arg)
+{
+  DBUG_ASSERT(threads > 1 && threads <= MAX_SORT_THREADS);
+  Parallel_sort sort(keys, count, threads, radix_length, cmp, cmp_arg);
+  return sort.sort();
+}
+
+
+uint Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
 {
   size_t size= param->sort_length;
   m_sort_keys= get_sort_keys();
 
   if (count <= 1 || size == 0)
-    return;
+    return 1;
 
   // don't reverse for PQ, it is already done
   if (!param->using_pq)
     reverse_record_pointers();
 
+  if (param->sort_threads > 1)
+  {
+    uint threads= MY_MIN(param->sort_threads,
+                         count / MIN_ROWS_PER_SORT_THREAD);
+    if (threads > 1 &&
+        !parallel_sort(m_sort_keys, count, threads,
+                       param->using_packed_sortkeys() ? 0 : size,
+                       param->get_compare_function(),
+                       param->get_compare_argument(&size)))
+      return threads;
+  }
+
   uchar **buffer= NULL;
   if (!param->using_packed_sortkeys() &&
       radixsort_is_appliccable(count, param->sort_length) &&
@@ -186,10 +534,11 @@ void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
   {
     radixsort_for_str_ptr(m_sort_keys, count, param->sort_length, buffer);
     my_free(buffer);
-    return;
+    return 1;
   }
 
   my_qsort2(m_sort_keys, count, sizeof(uchar*),
             param->get_compare_function(),
             param->get_compare_argument(&size));
+  return 1;
 }
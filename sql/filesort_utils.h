@@ -81,8 +81,11 @@ class Filesort_buffer
     m_size_in_bytes(0), m_idx(0)
   {}
 
-  /** Sort me... */
-  void sort_buffer(const Sort_param *param, uint count);
+  /**
+    Sort me...
+    @returns the number of threads that were used for sorting
+  */
+  uint sort_buffer(const Sort_param *param, uint count);
 
   /**
     Reverses the record pointer array, to avoid recording new results for
@@ -279,6 +282,9 @@ class Filesort_buffer
   longlong m_idx;
 };
 
+/** Stop the threads that are used for parallel sorting */
+void filesort_thread_pool_end();
+
 int compare_packed_sort_keys(void *sort_keys, unsigned char **a,
                              unsigned char **b);
 qsort2_cmp get_packed_keys_compare_ptr();
@@ -0,0 +1,306 @@
+/* Copyright (c) 2020, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+/* Sparse GTID index for binlog files, see gtid_index.h. */
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "mysqld.h"
+#include "log.h"
+#include "gtid_index.h"
+
+const uchar gtid_index_magic[4]= { 0xfe, 'G', 'I', 'X' };
+
+
+void
+gtid_index_file_name(char *buf, const char *binlog_name)
+{
+  strxnmov(buf, FN_REFLEN - 1, binlog_name, GTID_INDEX_FILE_EXT, NullS);
+}
+
+
+void
+gtid_index_delete(const char *binlog_name)
+{
+  char buf[FN_REFLEN];
+  gtid_index_file_name(buf, binlog_name);
+  /* Not having an index is normal (old binlog or index disabled). */
+  mysql_file_delete(key_file_binlog_gtid_index, buf, MYF(0));
+}
+
+
+Gtid_index_writer::Gtid_index_writer()
+  : index_file(-1), next_offset(0), span(0), buf(NULL), buf_size(0),
+    list(NULL), list_size(0)
+{
+  index_name[0]= '\0';
+}
+
+
+bool
+Gtid_index_writer::reserve(size_t size)
+{
+  if (size <= buf_size)
+    return false;
+  uchar *new_buf= (uchar *)my_realloc(PSI_INSTRUMENT_ME, buf, size,
+                                      MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+  if (!new_buf)
+    return true;
+  buf= new_buf;
+  buf_size= size;
+  return false;
+}
+
+
+/*
+  Create the GTID index for a new binlog file.
+
+  start_offset is the offset in the binlog just after the initial events
+  (Format_description, Gtid_list, ...). Event groups before
+  start_offset + span_min are found quickly from the Gtid_list event, so the
+  first record is only written after that point.
+*/
+bool
+Gtid_index_writer::open(const char *binlog_name, my_off_t start_offset,
+                        uint32 span_min)
+{
+  uchar header[GTID_INDEX_HEADER_SIZE];
+  DBUG_ENTER("Gtid_index_writer::open");
+
+  close();
+  gtid_index_file_name(index_name, binlog_name);
+  if ((index_file= mysql_file_open(key_file_binlog_gtid_index, index_name,
+                                   O_WRONLY | O_CREAT | O_TRUNC | O_BINARY,
+                                   MYF(MY_WME))) < 0)
+  {
+    sql_print_warning("Could not create GTID index file '%s'; slaves "
+                      "connecting with GTID will scan the binlog instead",
+                      index_name);
+    DBUG_RETURN(true);
+  }
+
+  memcpy(header, gtid_index_magic, sizeof(gtid_index_magic));
+  header[4]= GTID_INDEX_VERSION;
+  header[5]= header[6]= header[7]= 0;
+  int4store(header + 8, span_min);
+  int4store(header + 12, my_checksum(0, header, 12));
+  if (mysql_file_write(index_file, header, sizeof(header),
+                       MYF(MY_WME | MY_NABP)))
+  {
+    close();
+    gtid_index_delete(binlog_name);
+    DBUG_RETURN(true);
+  }
+
+  span= span_min;
+  next_offset= start_offset + span;
+  DBUG_RETURN(false);
+}
+
+
+void
+Gtid_index_writer::close()
+{
+  if (index_file >= 0)
+  {
+    mysql_file_close(index_file, MYF(MY_WME));
+    index_file= -1;
+  }
+  my_free(buf);
+  buf= NULL;
+  buf_size= 0;
+  my_free(list);
+  list= NULL;
+  list_size= 0;
+}
+
+
+void
+Gtid_index_writer::add_record(my_off_t offset, rpl_binlog_state *state)
+{
+  uint32 count= state->count();
+
+  if (count > list_size)
+  {
+    rpl_gtid *new_list= (rpl_gtid *)
+      my_realloc(PSI_INSTRUMENT_ME, list, count * sizeof(rpl_gtid),
+                 MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+    if (!new_list)
+    {
+      close();
+      return;
+    }
+    list= new_list;
+    list_size= count;
+  }
+  /* If the state grew meanwhile, just try again at the next GTID. */
+  if (state->get_gtid_list(list, count))
+    return;
+  add_record(offset, list, count);
+}
+
+
+void
+Gtid_index_writer::add_record(my_off_t offset, const rpl_gtid *gtid_list,
+                              uint32 count)
+{
+  size_t rec_size= GTID_INDEX_RECORD_HEADER_SIZE +
+                   count * GTID_INDEX_GTID_SIZE + 4;
+  uchar *p;
+  DBUG_ENTER("Gtid_index_writer::add_record");
+
+  if (index_file < 0)
+    DBUG_VOID_RETURN;
+  if (reserve(rec_size))
+  {
+    close();
+    DBUG_VOID_RETURN;
+  }
+
+  p= buf;
+  int8store(p, offset);
+  int4store(p + 8, count);
+  p+= GTID_INDEX_RECORD_HEADER_SIZE;
+  for (uint32 i= 0; i < count; ++i)
+  {
+    int4store(p, gtid_list[i].domain_id);
+    int4store(p + 4, gtid_list[i].server_id);
+    int8store(p + 8, gtid_list[i].seq_no);
+    p+= GTID_INDEX_GTID_SIZE;
+  }
+  int4store(p, my_checksum(0, buf, (size_t)(p - buf)));
+
+  if (mysql_file_write(index_file, buf, rec_size, MYF(MY_WME | MY_NABP)))
+  {
+    /*
+      Records written so far remain valid (a partial record fails the
+      checksum), so just stop extending the index for this binlog file.
+    */
+    sql_print_warning("Error writing GTID index file '%s', index will not "
+                      "be extended for this binlog file", index_name);
+    close();
+    DBUG_VOID_RETURN;
+  }
+  next_offset= offset + span;
+  DBUG_VOID_RETURN;
+}
+
+
+Gtid_index_reader::Gtid_index_reader()
+  : rec_offset(0), gtid_list(NULL), gtid_count(0), index_file(-1),
+    buf(NULL), buf_size(0)
+{
+}
+
+
+bool
+Gtid_index_reader::open(const char *binlog_name)
+{
+  char name[FN_REFLEN];
+  uchar header[GTID_INDEX_HEADER_SIZE];
+
+  close();
+  gtid_index_file_name(name, binlog_name);
+  if ((index_file= mysql_file_open(key_file_binlog_gtid_index, name,
+                                   O_RDONLY | O_BINARY, MYF(0))) < 0)
+    return true;
+  if (init_io_cache(&cache, index_file, IO_SIZE*2, READ_CACHE, 0, 0,
+                    MYF(MY_WME|MY_DONT_CHECK_FILESIZE)))
+  {
+    mysql_file_close(index_file, MYF(0));
+    index_file= -1;
+    return true;
+  }
+  if (my_b_read(&cache, header, sizeof(header)) ||
+      memcmp(header, gtid_index_magic, sizeof(gtid_index_magic)) ||
+      header[4] != GTID_INDEX_VERSION ||
+      uint4korr(header + 12) != my_checksum(0, header, 12))
+  {
+    close();
+    return true;
+  }
+  return false;
+}
+
+
+void
+Gtid_index_reader::close()
+{
+  if (index_file >= 0)
+  {
+    end_io_cache(&cache);
+    mysql_file_close(index_file, MYF(0));
+    index_file= -1;
+  }
+  my_free(buf);
+  buf= NULL;
+  buf_size= 0;
+  my_free(gtid_list);
+  gtid_list= NULL;
+  gtid_count= 0;
+}
+
+
+bool
+Gtid_index_reader::read_record()
+{
+  uchar rec_header[GTID_INDEX_RECORD_HEADER_SIZE];
+  uchar crc_buf[4];
+  uint32 count;
+  size_t size;
+  ha_checksum crc;
+
+  if (index_file < 0 ||
+      my_b_read(&cache, rec_header, sizeof(rec_header)))
+    return true;
+  count= uint4korr(rec_header + 8);
+  /* Sanity limit, same as for Gtid_list_log_event. */
+  if (count >= (1 << 28))
+    return true;
+  size= (size_t)count * GTID_INDEX_GTID_SIZE;
+  if (size > buf_size)
+  {
+    uchar *new_buf= (uchar *)my_realloc(PSI_INSTRUMENT_ME, buf, size,
+                                        MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+    rpl_gtid *new_list= (rpl_gtid *)
+      my_realloc(PSI_INSTRUMENT_ME, gtid_list, count * sizeof(rpl_gtid),
+                 MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+    if (new_buf)
+      buf= new_buf;
+    if (new_list)
+      gtid_list= new_list;
+    if (!new_buf || !new_list)
+      return true;
+    buf_size= size;
+  }
+  if ((size && my_b_read(&cache, buf, size)) ||
+      my_b_read(&cache, crc_buf, sizeof(crc_buf)))
+    return true;
+  crc= my_checksum(0, rec_header, sizeof(rec_header));
+  crc= my_checksum(crc, buf, size);
+  if (crc != uint4korr(crc_buf))
+    return true;
+
+  rec_offset= uint8korr(rec_header);
+  for (uint32 i= 0; i < count; ++i)
+  {
+    const uchar *p= buf + i * GTID_INDEX_GTID_SIZE;
+    gtid_list[i].domain_id= uint4korr(p);
+    gtid_list[i].server_id= uint4korr(p + 4);
+    gtid_list[i].seq_no= uint8korr(p + 8);
+  }
+  gtid_count= count;
+  return false;
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2020, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+#ifndef GTID_INDEX_H
+#define GTID_INDEX_H
+
+#include "my_sys.h"
+#include "rpl_gtid.h"
+
+/*
+  Sparse GTID index for binlog files.
+
+  Next to each binlog file master-bin.NNNNNN, a file master-bin.NNNNNN.idx is
+  written. It contains a list of (offset, binlog state) records. Each record
+  says that the event group starting at byte <offset> in the binlog file is
+  the first one that is not included in the GTID binlog state of the record.
+  The state is stored in the same format as a Gtid_list_log_event (sorted by
+  domain, with the most recent GTID last within each domain), so a record can
+  be used exactly like the Gtid_list_log_event at the start of the binlog file
+  to decide whether a connecting slave can start from that point.
+
+  Records are written at most every --binlog-gtid-index-span-min bytes of
+  binlog, so the index is small and cheap to maintain. The dump thread reads
+  the index to find the last record at or before the slave's requested GTID
+  position, and then starts reading the binlog from that offset instead of
+  from the start of the file.
+
+  File format (all integers little-endian):
+
+    Header:  4 bytes magic 0xfe 'G' 'I' 'X'
+             1 byte  format version
+             3 bytes reserved (zero)
+             4 bytes span_min used when the index was written
+             4 bytes CRC32 of the preceding 12 bytes
+
+    Record:  8 bytes binlog offset
+             4 bytes number N of GTIDs in the state
+             N * 16 bytes GTIDs (4 bytes domain_id, 4 bytes server_id,
+                                 8 bytes seq_no)
+             4 bytes CRC32 of the preceding bytes of the record
+
+  The index is only a hint. It is not fsync'ed, and a missing, truncated or
+  corrupt index just means that the slave connect falls back to scanning the
+  binlog file from the start. After a crash, the index of the last binlog
+  file is rebuilt from scratch during binlog crash recovery.
+*/
+
+#define GTID_INDEX_FILE_EXT ".idx"
+#define GTID_INDEX_HEADER_SIZE 16
+#define GTID_INDEX_RECORD_HEADER_SIZE 12
+#define GTID_INDEX_GTID_SIZE 16
+#define GTID_INDEX_VERSION 1
+
+extern const uchar gtid_index_magic[4];
+
+/* Construct the name of the GTID index file for a given binlog file. */
+void gtid_index_file_name(char *buf, const char *binlog_name);
+/* Remove the GTID index of a binlog file, if it exists. */
+void gtid_index_delete(const char *binlog_name);
+
+
+class Gtid_index_writer
+{
+public:
+  Gtid_index_writer();
+  ~Gtid_index_writer() { close(); }
+
+  bool open(const char *binlog_name, my_off_t start_offset, uint32 span_min);
+  void close();
+  bool is_open() const { return index_file >= 0; }
+
+  /*
+    Return true if an index record is due for an event group starting at
+    the given binlog offset. This is a cheap check done for every GTID
+    written; only when it returns true is the binlog state copied out.
+  */
+  bool need_record(my_off_t offset) const
+  {
+    return index_file >= 0 && offset >= next_offset;
+  }
+  void add_record(my_off_t offset, rpl_binlog_state *state);
+  void add_record(my_off_t offset, const rpl_gtid *gtid_list, uint32 count);
+
+private:
+  bool reserve(size_t size);
+
+  File index_file;
+  my_off_t next_offset;
+  uint32 span;
+  uchar *buf;
+  size_t buf_size;
+  /* Scratch space for copying out the binlog state. */
+  rpl_gtid *list;
+  uint32 list_size;
+  char index_name[FN_REFLEN];
+};
+
+
+class Gtid_index_reader
+{
+public:
+  Gtid_index_reader();
+  ~Gtid_index_reader() { close(); }
+
+  /* Returns true if there is no usable index for the binlog file. */
+  bool open(const char *binlog_name);
+  void close();
+  /*
+    Read the next record. Returns false on success, with the record available
+    in rec_offset/gtid_list/gtid_count. Returns true at end-of-file or at the
+    first truncated or corrupt record.
+  */
+  bool read_record();
+
+  my_off_t rec_offset;
+  rpl_gtid *gtid_list;
+  uint32 gtid_count;
+
+private:
+  File index_file;
+  IO_CACHE cache;
+  uchar *buf;
+  size_t buf_size;
+};
+
+#endif /* GTID_INDEX_H */
@@ -2977,6 +2977,122 @@ int handler::ha_rnd_next(uchar *buf)
   DBUG_RETURN(result);
 }
 
+/**
+  Read a batch of rows of a table scan.
+
+  Statistics are not updated here; see update_rnd_batch_statistics().
+  Virtual columns are not computed either, so this must not be used for
+  tables that have them.
+
+  @see rnd_next_batch()
+*/
+
+int handler::ha_rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+{
+  int result;
+  DBUG_ENTER("handler::ha_rnd_next_batch");
+  DBUG_ASSERT(table_share->tmp_table != NO_TMP_TABLE ||
+              m_lock_type != F_UNLCK);
+  DBUG_ASSERT(inited == RND);
+  DBUG_ASSERT(max_rows);
+  DBUG_ASSERT(!table->vfield);
+
+  *n_rows= 0;
+  TABLE_IO_WAIT(tracker, PSI_TABLE_FETCH_ROW, MAX_KEY, result,
+    { result= rnd_next_batch(buf, max_rows, n_rows); })
+  DBUG_ASSERT(*n_rows <= max_rows);
+  DBUG_ASSERT(result || *n_rows == max_rows);
+  table->status= *n_rows ? 0 : STATUS_NOT_FOUND;
+  DBUG_RETURN(result);
+}
+
+
+/**
+  Default implementation of rnd_next_batch() that calls rnd_next() for
+  every row.
+*/
+
+int handler::rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+{
+  const uint rec_buff_length= table_share->rec_buff_length;
+
+  while (*n_rows < max_rows)
+  {
+    int error= rnd_next(buf);
+    if (likely(!error))
+    {
+      buf+= rec_buff_length;
+      (*n_rows)++;
+      continue;
+    }
+    if (error != HA_ERR_RECORD_DELETED)
+      return error;
+    status_var_increment(table->in_use->status_var.ha_read_rnd_deleted_count);
+    if (table->in_use->check_killed(1))
+      return HA_ERR_ABORTED_BY_USER;
+  }
+  return 0;
+}
+
+
+/*
+  Size of the blocks of a HA_SAMPLE_SYSTEM scan. Big enough to cover a few
+  pages of most engines, so that skipping a block saves real reads.
+*/
+static const size_t SAMPLE_BLOCK_SIZE= 64*1024;
+
+int handler::ha_sample_init(double fraction, ha_sample_mode mode,
+                            uint readers)
+{
+  DBUG_ENTER("handler::ha_sample_init");
+  DBUG_ASSERT(fraction > 0 && fraction <= 1);
+  DBUG_ASSERT(readers > 0);
+  sample_fraction= fraction;
+  sample_mode= mode;
+  sample_readers= readers;
+  sample_block_rows= MY_MAX(SAMPLE_BLOCK_SIZE / table_share->reclength, 1);
+  sample_rows_left= 0;
+  sample_block_taken= false;
+  DBUG_RETURN(ha_rnd_init(TRUE));
+}
+
+
+int handler::ha_sample_next(uchar *buf)
+{
+  DBUG_ENTER("handler::ha_sample_next");
+  DBUG_ASSERT(inited == RND);
+  DBUG_RETURN(sample_next(buf));
+}
+
+
+int handler::sample_next(uchar *buf)
+{
+  THD *thd= ha_thd();
+  int error;
+
+  while (!(error= ha_rnd_next(buf)))
+  {
+    if (unlikely(thd->killed))
+      return HA_ERR_ABORTED_BY_USER;
+    if (sample_mode == HA_SAMPLE_BERNOULLI)
+    {
+      if (thd_rnd(thd) <= sample_fraction)
+        return 0;
+      continue;
+    }
+    if (!sample_rows_left)
+    {
+      sample_block_taken= thd_rnd(thd) <= sample_fraction;
+      sample_rows_left= sample_block_rows;
+    }
+    sample_rows_left--;
+    if (sample_block_taken)
+      return 0;
+  }
+  return error;
+}
+
+
 int handler::ha_rnd_pos(uchar *buf, uchar *pos)
 {
   int result;
@@ -331,7 +331,13 @@ enum enum_alter_inplace_result {
 
 /* Support native hash index */
 #define HA_CAN_HASH_KEYS        (1ULL << 58)
-#define HA_LAST_TABLE_FLAG HA_CAN_HASH_KEYS
+
+/*
+  rnd_next_batch() is cheaper than calling rnd_next() for every row,
+  so the server should read table scans in batches when possible.
+*/
+#define HA_CAN_RND_BATCH        (1ULL << 59)
+#define HA_LAST_TABLE_FLAG HA_CAN_RND_BATCH
 
 /* bits in index_flags(index_number) for what you can do with index */
 #define HA_READ_NEXT            1       /* TODO really use this flag */
@@ -1949,6 +1955,12 @@ struct st_partition_iter;
 
 enum ha_choice { HA_CHOICE_UNDEF, HA_CHOICE_NO, HA_CHOICE_YES, HA_CHOICE_MAX };
 
+/*
+  How a sampled table scan (handler::ha_sample_init()) picks its rows:
+  every row independently, or whole blocks of consecutive rows.
+*/
+enum ha_sample_mode { HA_SAMPLE_BERNOULLI, HA_SAMPLE_SYSTEM };
+
 enum enum_stats_auto_recalc { HA_STATS_AUTO_RECALC_DEFAULT= 0,
                               HA_STATS_AUTO_RECALC_ON,
                               HA_STATS_AUTO_RECALC_OFF };
@@ -3181,6 +3193,15 @@ class handler :public Sql_alloc
   Field **top_table_field;
   uint top_table_fields;
 
+protected:
+  /* State of a sampled table scan, see ha_sample_init() */
+  double sample_fraction;
+  enum ha_sample_mode sample_mode;
+  uint sample_readers;        /* threads that may read the sample */
+  ha_rows sample_block_rows;  /* rows per block with HA_SAMPLE_SYSTEM */
+  ha_rows sample_rows_left;   /* rows left in the current block */
+  bool sample_block_taken;    /* whether the current block is in the sample */
+
 private:
   /**
     The lock type set by when calling::ha_external_lock(). This is 
@@ -3801,6 +3822,38 @@ class handler :public Sql_alloc
 public:
   virtual int ft_read(uchar *buf) { return HA_ERR_WRONG_COMMAND; }
   virtual int rnd_next(uchar *buf)=0;
+  /**
+    Read the next rows of a table scan started with rnd_init(true).
+
+    @param buf       buffer for the rows; row i is stored at
+                     buf + i * table_share->rec_buff_length
+    @param max_rows  maximum number of rows to read (at least 1)
+    @param n_rows    OUT: number of rows that were read
+
+    Deleted rows are skipped. The engine may leave the columns that are
+    not in the read_set untouched, just like rnd_next() does.
+
+    @return 0 if max_rows rows were read, otherwise the error that ended
+    the batch (HA_ERR_END_OF_FILE at the end of the table); the rows read
+    before the error are valid. HA_ERR_WRONG_COMMAND with *n_rows == 0
+    means that the rows cannot be read in batches in the current state,
+    and the caller must use rnd_next() for this scan.
+  */
+  virtual int rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows);
+  /**
+    Read the next row of a sampled table scan started with ha_sample_init().
+
+    The default implementation reads every row with rnd_next() and keeps
+    a row (HA_SAMPLE_BERNOULLI) or a block of sample_block_rows rows
+    (HA_SAMPLE_SYSTEM) with probability sample_fraction. An engine can
+    override it to skip the blocks that are not in the sample without
+    reading them, and to read the table with up to sample_readers
+    threads of its own, in which case the rows are returned in no
+    particular order.
+
+    @return 0, HA_ERR_END_OF_FILE at the end of the table, or an error
+  */
+  virtual int sample_next(uchar *buf);
   virtual int rnd_pos(uchar * buf, uchar *pos)=0;
   /**
     This function only works for handlers having
@@ -3828,6 +3881,26 @@ class handler :public Sql_alloc
   inline int ha_ft_read(uchar *buf);
   inline void ha_ft_end() { ft_end(); ft_handler=NULL; }
   int ha_rnd_next(uchar *buf);
+  int ha_rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows);
+  /**
+    Update the statistics for a row returned by ha_rnd_next_batch() when
+    the caller actually consumes it (found=true), or for reaching the end
+    of the batched scan (found=false), the same way as ha_rnd_next() does.
+    Rows that were read ahead but never used are thus not counted.
+  */
+  inline void update_rnd_batch_statistics(bool found);
+  /**
+    Start a table scan that returns a random sample of about
+    fraction * records() rows, for collecting statistics. The engine
+    may read the table with up to 'readers' threads.
+  */
+  int ha_sample_init(double fraction, ha_sample_mode mode, uint readers= 1)
+    __attribute__ ((warn_unused_result));
+  int ha_sample_next(uchar *buf);
+  int ha_sample_end() { return ha_rnd_end(); }
+  /* Number of consecutive rows that the sampled scan takes or skips at once */
+  ha_rows sample_unit_rows() const
+  { return sample_mode == HA_SAMPLE_SYSTEM ? sample_block_rows : 1; }
   int ha_rnd_pos(uchar *buf, uchar *pos);
   inline int ha_rnd_pos_by_record(uchar *buf);
   inline int ha_read_first_row(uchar *buf, uint primary_key);
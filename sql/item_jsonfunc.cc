@@ -18,6 +18,8 @@
 #include "sql_priv.h"
 #include "sql_class.h"
 #include "item.h"
+#include "sql_type_json.h"
+#include "json_binary.h"
 
 
 /*
@@ -455,6 +457,44 @@ bool Item_func_json_query::fix_length_and_dec()
 }
 
 
+/*
+  Return the JSONB column that a JSON argument reads, if any, so that
+  a path can be looked up in the binary document with no parsing.
+*/
+static Field_jsonb *json_binary_field(Item *item)
+{
+  if (item->type() != Item::FIELD_ITEM)
+    return NULL;
+  Field *field= ((Item_field *) item)->field;
+  return field->is_json_binary() ? static_cast<Field_jsonb*>(field) : NULL;
+}
+
+
+/*
+  Look the path up in the binary document of a JSONB column.
+
+  @retval  0  the value was found
+  @retval  1  the value is NULL
+  @retval -1  the text of the document has to be searched
+*/
+int Json_path_extractor::extract_binary(String *str, Field_jsonb *field,
+                                        CHARSET_INFO *cs)
+{
+  Json_binary_value doc, v;
+  int res;
+
+  if (field->val_json_binary(&doc) ||
+      (res= json_binary_find_path(&doc, &p, &tmp_key, &v)) < 0)
+    return -1;
+  if (res)
+    return 1;
+
+  str->length(0);
+  str->set_charset(cs);
+  return check_and_get_binary_value(&v, str) ? -1 : 0;
+}
+
+
 /*
   Returns NULL, not an error if the found value
   is not a scalar.
@@ -462,7 +502,8 @@ bool Item_func_json_query::fix_length_and_dec()
 bool Json_path_extractor::extract(String *str, Item *item_js, Item *item_jp,
                                   CHARSET_INFO *cs)
 {
-  String *js= item_js->val_json(&tmp_js);
+  Field_jsonb *field;
+  String *js;
   int error= 0;
   uint array_counters[JSON_DEPTH_LIMIT];
 
@@ -476,6 +517,15 @@ bool Json_path_extractor::extract(String *str, Item *item_js, Item *item_jp,
     parsed= constant;
   }
 
+  if ((field= json_binary_field(item_js)) && !item_jp->null_value &&
+      !field->is_null())
+  {
+    int res= extract_binary(str, field, cs);
+    if (res >= 0)
+      return res;
+  }
+
+  js= item_js->val_json(&tmp_js);
   if (item_js->null_value || item_jp->null_value)
     return true;
 
@@ -535,6 +585,39 @@ bool Json_engine_scan::check_and_get_value_scalar(String *res, int *error)
 }
 
 
+/*
+  A found array or object is not returned, but the text may hold
+  another member with the same key that is a scalar.
+*/
+bool Item_func_json_value::check_and_get_binary_value(const Json_binary_value *v,
+                                                      String *res)
+{
+  switch (v->type())
+  {
+  case JSON_VALUE_OBJECT:
+  case JSON_VALUE_ARRAY:
+    return true;
+  case JSON_VALUE_TRUE:
+    return st_append_json(res, &my_charset_utf8mb4_bin, (const uchar *) "1", 1);
+  case JSON_VALUE_FALSE:
+    return st_append_json(res, &my_charset_utf8mb4_bin, (const uchar *) "0", 1);
+  case JSON_VALUE_NULL:
+    return st_append_json(res, &my_charset_utf8mb4_bin,
+                          (const uchar *) STRING_WITH_LEN("null"));
+  default:
+    return st_append_json(res, &my_charset_utf8mb4_bin,
+                          v->scalar_ptr(), v->scalar_length());
+  }
+}
+
+
+bool Item_func_json_query::check_and_get_binary_value(const Json_binary_value *v,
+                                                      String *res)
+{
+  return v->is_scalar() || v->to_text(res);
+}
+
+
 bool Json_engine_scan::check_and_get_value_complex(String *res, int *error)
 {
   if (json_value_scalar(this))
@@ -750,11 +833,43 @@ static bool path_ok(const json_path_with_flags *paths_list, int n_paths,
 }
 
 
+/*
+  Look a single path up in the binary document of a JSONB column.
+
+  @retval  0  the value was found
+  @retval  1  the value is NULL
+  @retval -1  the text of the document has to be searched
+*/
+int Item_func_json_extract::read_json_binary(Field_jsonb *field, String *str,
+                                             json_value_types *type,
+                                             char **out_val, int *value_len)
+{
+  Json_binary_value doc, v;
+  int res;
+
+  if (field->val_json_binary(&doc) ||
+      (res= json_binary_find_path(&doc, &paths[0].p, &tmp_key, &v)) < 0)
+    return -1;
+  if (res)
+    return 1;
+
+  *type= v.type();
+  *out_val= (char *) v.scalar_ptr();
+  *value_len= (int) v.scalar_length();
+  tmp_js.length(0);
+  tmp_js.set_charset(field->charset());
+  if (str && v.to_text(&tmp_js))
+    return -1;
+  return 0;
+}
+
+
 String *Item_func_json_extract::read_json(String *str,
                                           json_value_types *type,
                                           char **out_val, int *value_len)
 {
-  String *js= args[0]->val_json(&tmp_js);
+  Field_jsonb *field= json_binary_field(args[0]);
+  String *js= field ? NULL : args[0]->val_json(&tmp_js);
   json_engine_t je, sav_je;
   json_path_t p;
   const uchar *value;
@@ -763,7 +878,7 @@ String *Item_func_json_extract::read_json(String *str,
   size_t v_len;
   int possible_multiple_values;
 
-  if ((null_value= args[0]->null_value))
+  if ((null_value= field ? field->is_null() : args[0]->null_value))
     return 0;
 
   for (n_arg=1; n_arg < arg_count; n_arg++)
@@ -789,6 +904,21 @@ String *Item_func_json_extract::read_json(String *str,
   possible_multiple_values= arg_count > 2 ||
     (paths[0].p.types_used & (JSON_PATH_WILD | JSON_PATH_DOUBLE_WILD));
 
+  if (field)
+  {
+    if (!possible_multiple_values)
+    {
+      switch (read_json_binary(field, str, type, out_val, value_len))
+      {
+      case 0:
+        return &tmp_js;
+      case 1:
+        goto return_null;
+      }
+    }
+    js= args[0]->val_json(&tmp_js);
+  }
+
   *type= possible_multiple_values ? JSON_VALUE_ARRAY : JSON_VALUE_NULL;
 
   if (str)
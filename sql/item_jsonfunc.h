@@ -25,6 +25,9 @@
 #include "item_strfunc.h"      // Item_str_func
 #include "item_sum.h"
 
+class Field_jsonb;
+class Json_binary_value;
+
 
 class json_path_with_flags
 {
@@ -60,10 +63,14 @@ class Json_engine_scan: public json_engine_t
 class Json_path_extractor: public json_path_with_flags
 {
 protected:
-  String tmp_js, tmp_path;
+  String tmp_js, tmp_path, tmp_key;
   virtual ~Json_path_extractor() { }
   virtual bool check_and_get_value(Json_engine_scan *je,
                                    String *to, int *error)=0;
+  /* Returns true if the value is not of the kind looked for */
+  virtual bool check_and_get_binary_value(const Json_binary_value *v,
+                                          String *to)=0;
+  int extract_binary(String *to, Field_jsonb *js, CHARSET_INFO *cs);
   bool extract(String *to, Item *js, Item *jp, CHARSET_INFO *cs);
 };
 
@@ -152,6 +159,8 @@ class Item_func_json_value: public Item_str_func,
   {
     return je->check_and_get_value_scalar(res, error);
   }
+  bool check_and_get_binary_value(const Json_binary_value *v,
+                                  String *res) override;
   Item *get_copy(THD *thd) override
   { return get_item_copy<Item_func_json_value>(thd, this); }
 };
@@ -176,6 +185,8 @@ class Item_func_json_query: public Item_json_func,
   {
     return je->check_and_get_value_complex(res, error);
   }
+  bool check_and_get_binary_value(const Json_binary_value *v,
+                                  String *res) override;
   Item *get_copy(THD *thd) override
   { return get_item_copy<Item_func_json_query>(thd, this); }
 };
@@ -228,7 +239,9 @@ class Item_json_str_multipath: public Item_json_func
 class Item_func_json_extract: public Item_json_str_multipath
 {
 protected:
-  String tmp_js;
+  String tmp_js, tmp_key;
+  int read_json_binary(Field_jsonb *js, String *str, json_value_types *type,
+                       char **out_val, int *value_len);
 public:
   String *read_json(String *str, json_value_types *type,
                     char **out_val, int *value_len);
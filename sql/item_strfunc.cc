@@ -494,12 +494,65 @@ String *Item_func_from_base64::val_str(String *str)
 
 
 const char *histogram_types[] =
-           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", 0};
+           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", "ENDPOINT_HB", 0};
 static TYPELIB hystorgam_types_typelib=
   { array_elements(histogram_types),
     "histogram_types",
     histogram_types, NULL};
-const char *representation_by_type[]= {"%.3f", "%.5f"};
+const char *representation_by_type[]= {"%.3f", "%.5f", "%.5f"};
+
+
+/*
+  Print an ENDPOINT_HB histogram (see class Histogram) as a comma separated
+  list of "=value:frequency" for the most common values, followed by
+  "<=endpoint:frequency:distinct_values" for the buckets.
+
+  @retval true  The histogram is malformed
+*/
+
+static bool decode_endpoint_histogram(String *str, const String *res)
+{
+  const uchar *p= (const uchar *) res->ptr();
+  const uchar *end= p + res->length();
+  double prev= 0.0;
+  char numbuf[64];
+
+  if (res->length() < 8)
+    return true;
+  uint mcvs= uint4korr(p);
+  ulonglong n= (ulonglong) mcvs + uint4korr(p + 4);
+  p+= 8;
+  for (ulonglong i= 0; i < n; i++)
+  {
+    bool is_mcv= i < mcvs;
+    uint header= is_mcv ? 10 : 22;
+    double val;
+    size_t size;
+    if ((size_t) (end - p) < header)
+      return true;
+    float8get(val, p);
+    uint len= uint2korr(p + header - 2);
+    if ((size_t) (end - p) < header + len)
+      return true;
+    if (i)
+      str->append(",");
+    str->append(is_mcv ? "=" : "<=");
+    str->append((const char *) p + header, len);
+    if (is_mcv)
+      size= my_snprintf(numbuf, sizeof(numbuf), ":%.5f", val);
+    else
+    {
+      /* show the frequency of the bucket rather than the cumulative one */
+      size= my_snprintf(numbuf, sizeof(numbuf), ":%.5f:%u", val - prev,
+                        (uint) uint4korr(p + 16));
+      prev= val;
+    }
+    str->append(numbuf, size);
+    p+= header + len;
+  }
+  return p != end;
+}
+
 
 String *Item_func_decode_histogram::val_str(String *str)
 {
@@ -530,6 +583,16 @@ String *Item_func_decode_histogram::val_str(String *str)
   double prev= 0.0;
   uint i;
   str->length(0);
+  if (type == ENDPOINT_HB)
+  {
+    if (decode_endpoint_histogram(str, res))
+    {
+      null_value= 1;
+      return 0;
+    }
+    null_value= 0;
+    return str;
+  }
   char numbuf[32];
   const uchar *p= (uchar*)res->c_ptr_safe();
   for (i= 0; i < res->length(); i++)
@@ -0,0 +1,440 @@
+/*
+   Copyright (c) 2020, MariaDB
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "mariadb.h"
+#include "sql_string.h"
+#include "sql_array.h"
+#include "json_binary.h"
+
+
+static const uint ARRAY_ENTRY_LENGTH= 8;
+static const uint OBJECT_ENTRY_LENGTH= 16;
+
+
+static bool append_uint32(String *to, size_t nr)
+{
+  char buf[4];
+  int4store(buf, (uint32) nr);
+  return to->append(buf, 4);
+}
+
+
+/***************************************************************************
+  Conversion from text
+***************************************************************************/
+
+struct Json_binary_member
+{
+  uint32 key_offset, key_length, value_offset, value_length;
+  uint order;
+};
+
+
+static int cmp_members(void *arg, const Json_binary_member *a,
+                       const Json_binary_member *b)
+{
+  const uchar *start= (const uchar *) arg;
+  int res= memcmp(start + a->key_offset, start + b->key_offset,
+                  MY_MIN(a->key_length, b->key_length));
+  if (res)
+    return res;
+  if (a->key_length != b->key_length)
+    return a->key_length < b->key_length ? -1 : 1;
+  return a->order < b->order ? -1 : 1;
+}
+
+
+static bool encode_value(json_engine_t *je, String *to);
+
+
+static bool encode_array(json_engine_t *je, String *to)
+{
+  size_t start= to->length();
+  StringBuffer<ARRAY_ENTRY_LENGTH * 16> table;
+  uint n= 0;
+
+  if (to->append((char) JSON_VALUE_ARRAY))
+    return true;
+
+  while (json_scan_next(je) == 0 && je->state == JST_VALUE)
+  {
+    size_t offset= to->length() - start;
+    if (json_read_value(je) || encode_value(je, to) ||
+        append_uint32(&table, offset) ||
+        append_uint32(&table, to->length() - start - offset))
+      return true;
+    n++;
+  }
+
+  return je->s.error || to->append(table) || append_uint32(to, n);
+}
+
+
+static bool encode_object(json_engine_t *je, String *to)
+{
+  size_t start= to->length();
+  Dynamic_array<Json_binary_member> members(PSI_INSTRUMENT_MEM);
+  Json_binary_member m;
+  int key_length;
+
+  if (to->append((char) JSON_VALUE_OBJECT))
+    return true;
+
+  for (m.order= 0; json_scan_next(je) == 0 && je->state == JST_KEY; m.order++)
+  {
+    const uchar *key_start= je->s.c_str, *key_end;
+    do
+    {
+      key_end= je->s.c_str;
+    } while (json_read_keyname_chr(je) == 0);
+
+    if (je->s.error)
+      return true;
+
+    /* Unescaping never makes an utf8mb4 key longer. */
+    m.key_offset= (uint32) (to->length() - start);
+    if (to->reserve(key_end - key_start) ||
+        (key_length= json_unescape(je->s.cs, key_start, key_end,
+                                   &my_charset_utf8mb4_bin,
+                                   (uchar *) to->end(),
+                                   (uchar *) to->end() +
+                                   (key_end - key_start))) < 0)
+      return true;
+    to->length(to->length() + key_length);
+    m.key_length= (uint32) key_length;
+
+    m.value_offset= (uint32) (to->length() - start);
+    if (json_read_value(je) || encode_value(je, to))
+      return true;
+    m.value_length= (uint32) (to->length() - start - m.value_offset);
+
+    if (members.append(m))
+      return true;
+  }
+
+  if (je->s.error)
+    return true;
+
+  members.sort(cmp_members, (void *) (to->ptr() + start));
+
+  for (size_t i= 0; i < members.elements(); i++)
+  {
+    const Json_binary_member &e= members.at(i);
+    if (append_uint32(to, e.key_offset) || append_uint32(to, e.key_length) ||
+        append_uint32(to, e.value_offset) ||
+        append_uint32(to, e.value_length))
+      return true;
+  }
+  return append_uint32(to, members.elements());
+}
+
+
+static bool encode_value(json_engine_t *je, String *to)
+{
+  switch (je->value_type)
+  {
+  case JSON_VALUE_OBJECT:
+    return encode_object(je, to);
+  case JSON_VALUE_ARRAY:
+    return encode_array(je, to);
+  case JSON_VALUE_STRING:
+  case JSON_VALUE_NUMBER:
+    return to->append((char) je->value_type) ||
+           to->append((const char *) je->value, je->value_len);
+  case JSON_VALUE_TRUE:
+  case JSON_VALUE_FALSE:
+  case JSON_VALUE_NULL:
+    return to->append((char) je->value_type);
+  }
+  DBUG_ASSERT(0);
+  return true;
+}
+
+
+bool json_binary_from_text(String *to, const char *js, size_t length)
+{
+  json_engine_t je;
+
+  json_scan_start(&je, &my_charset_utf8mb4_bin,
+                  (const uchar *) js, (const uchar *) js + length);
+  if (to->append((char) JSON_BINARY_VERSION) ||
+      json_read_value(&je) || encode_value(&je, to))
+    return true;
+
+  /* Make sure nothing but spaces follows the value. */
+  while (json_scan_next(&je) == 0)
+  {}
+  return je.s.error != 0;
+}
+
+
+/***************************************************************************
+  Access to the binary format
+***************************************************************************/
+
+static bool valid_type(uchar type)
+{
+  return type >= JSON_VALUE_OBJECT && type <= JSON_VALUE_NULL;
+}
+
+
+bool Json_binary_value::init(const uchar *doc, size_t length)
+{
+  if (length < 2 || doc[0] != JSON_BINARY_VERSION || !valid_type(doc[1]))
+    return true;
+  m_ptr= doc + 1;
+  m_length= length - 1;
+  return false;
+}
+
+
+/*
+  Locate the entry table of a container.
+  Returns true if the value is broken.
+*/
+bool Json_binary_value::entries(uint entry_length, uint *count,
+                                const uchar **table) const
+{
+  DBUG_ASSERT(!is_scalar());
+  if (m_length < 5)
+    return true;
+  *count= uint4korr(m_ptr + m_length - 4);
+  if (*count > (m_length - 5) / entry_length)
+    return true;
+  *table= m_ptr + m_length - 4 - (size_t) *count * entry_length;
+  return false;
+}
+
+
+/* Point to the value at the {offset, length} pair of an entry */
+bool Json_binary_value::set_from_entry(const uchar *entry, const uchar *table)
+{
+  size_t offset= uint4korr(entry), length= uint4korr(entry + 4);
+  if (offset == 0 || length == 0 || length > (size_t) (table - m_ptr) ||
+      offset > (size_t) (table - m_ptr) - length ||
+      !valid_type(m_ptr[offset]))
+    return true;
+  m_ptr+= offset;
+  m_length= length;
+  return false;
+}
+
+
+uint Json_binary_value::count() const
+{
+  uint n;
+  const uchar *table;
+  return entries(type() == JSON_VALUE_OBJECT ? OBJECT_ENTRY_LENGTH :
+                                               ARRAY_ENTRY_LENGTH,
+                 &n, &table) ? 0 : n;
+}
+
+
+bool Json_binary_value::get_element(uint n, Json_binary_value *to) const
+{
+  uint count;
+  const uchar *table;
+
+  if (type() == JSON_VALUE_ARRAY)
+  {
+    if (entries(ARRAY_ENTRY_LENGTH, &count, &table) || n >= count)
+      return true;
+    *to= *this;
+    return to->set_from_entry(table + n * ARRAY_ENTRY_LENGTH, table);
+  }
+
+  DBUG_ASSERT(type() == JSON_VALUE_OBJECT);
+  if (entries(OBJECT_ENTRY_LENGTH, &count, &table) || n >= count)
+    return true;
+  *to= *this;
+  return to->set_from_entry(table + n * OBJECT_ENTRY_LENGTH + 8, table);
+}
+
+
+bool Json_binary_value::get_key(uint n, LEX_CUSTRING *to) const
+{
+  uint count;
+  const uchar *table, *entry;
+  size_t offset, length;
+
+  DBUG_ASSERT(type() == JSON_VALUE_OBJECT);
+  if (entries(OBJECT_ENTRY_LENGTH, &count, &table) || n >= count)
+    return true;
+  entry= table + n * OBJECT_ENTRY_LENGTH;
+  offset= uint4korr(entry);
+  length= uint4korr(entry + 4);
+  if (offset == 0 || length > (size_t) (table - m_ptr) ||
+      offset > (size_t) (table - m_ptr) - length)
+    return true;
+  to->str= m_ptr + offset;
+  to->length= length;
+  return false;
+}
+
+
+bool Json_binary_value::find_key(const uchar *key, size_t length,
+                                 Json_binary_value *to) const
+{
+  uint count, low, high;
+  const uchar *table;
+
+  if (type() != JSON_VALUE_OBJECT ||
+      entries(OBJECT_ENTRY_LENGTH, &count, &table))
+    return true;
+
+  /* Find the first member whose key is not less than the one looked for */
+  for (low= 0, high= count; low < high; )
+  {
+    uint mid= low + (high - low) / 2;
+    LEX_CUSTRING k;
+    int res;
+    if (get_key(mid, &k))
+      return true;
+    if (!(res= memcmp(k.str, key, MY_MIN(k.length, length))))
+      res= k.length < length ? -1 : (k.length > length ? 1 : 0);
+    if (res < 0)
+      low= mid + 1;
+    else
+      high= mid;
+  }
+
+  LEX_CUSTRING k;
+  if (low == count || get_key(low, &k) || k.length != length ||
+      memcmp(k.str, key, length))
+    return true;
+  return get_element(low, to);
+}
+
+
+/***************************************************************************
+  Conversion to text
+***************************************************************************/
+
+static bool append_escaped_key(String *to, const LEX_CUSTRING &key)
+{
+  /* A byte turns into \u00XX at most. */
+  int length;
+  if (to->append('"') || to->reserve(key.length * 6 + 1) ||
+      (length= json_escape(&my_charset_utf8mb4_bin,
+                           key.str, key.str + key.length,
+                           &my_charset_utf8mb4_bin,
+                           (uchar *) to->end(),
+                           (uchar *) to->end() + key.length * 6)) < 0)
+    return true;
+  to->length(to->length() + length);
+  return to->append('"');
+}
+
+
+bool Json_binary_value::to_text(String *to, uint depth) const
+{
+  Json_binary_value v;
+  uint n;
+
+  switch (type())
+  {
+  case JSON_VALUE_NULL:
+    return to->append(STRING_WITH_LEN("null"));
+  case JSON_VALUE_TRUE:
+    return to->append(STRING_WITH_LEN("true"));
+  case JSON_VALUE_FALSE:
+    return to->append(STRING_WITH_LEN("false"));
+  case JSON_VALUE_NUMBER:
+    return to->append((const char *) scalar_ptr(), scalar_length());
+  case JSON_VALUE_STRING:
+    return to->append('"') ||
+           to->append((const char *) scalar_ptr(), scalar_length()) ||
+           to->append('"');
+  case JSON_VALUE_ARRAY:
+    if (depth >= JSON_DEPTH_LIMIT || to->append('['))
+      return true;
+    n= count();
+    for (uint i= 0; i < n; i++)
+    {
+      if ((i && to->append(STRING_WITH_LEN(", "))) ||
+          get_element(i, &v) || v.to_text(to, depth + 1))
+        return true;
+    }
+    return to->append(']');
+  case JSON_VALUE_OBJECT:
+    if (depth >= JSON_DEPTH_LIMIT || to->append('{'))
+      return true;
+    n= count();
+    for (uint i= 0; i < n; i++)
+    {
+      LEX_CUSTRING key;
+      if ((i && to->append(STRING_WITH_LEN(", "))) ||
+          get_key(i, &key) || append_escaped_key(to, key) ||
+          to->append(STRING_WITH_LEN(": ")) ||
+          get_element(i, &v) || v.to_text(to, depth + 1))
+        return true;
+    }
+    return to->append('}');
+  }
+  return true;
+}
+
+
+/***************************************************************************
+  Path lookup
+***************************************************************************/
+
+int json_binary_find_path(const Json_binary_value *doc, const json_path_t *p,
+                          String *buffer, Json_binary_value *to)
+{
+  if (p->types_used & (JSON_PATH_WILD | JSON_PATH_DOUBLE_WILD))
+    return -1;
+
+  *to= *doc;
+  /* steps[0] stands for the '$' */
+  for (const json_path_step_t *step= p->steps + 1; step <= p->last_step;
+       step++)
+  {
+    if (step->type & JSON_PATH_ARRAY)
+    {
+      /* Like json_find_path(), [0] of a non-array is the value itself */
+      if (to->type() != JSON_VALUE_ARRAY)
+      {
+        if (step->n_item)
+          return 1;
+        continue;
+      }
+      if (step->n_item >= to->count())
+        return 1;
+      if (to->get_element(step->n_item, to))
+        return -1;
+      continue;
+    }
+
+    if (to->type() != JSON_VALUE_OBJECT)
+      return 1;
+
+    size_t key_length= step->key_end - step->key;
+    int length;
+    buffer->length(0);
+    if (buffer->reserve(key_length * 4) ||
+        (length= json_unescape(p->s.cs, step->key, step->key_end,
+                               &my_charset_utf8mb4_bin,
+                               (uchar *) buffer->ptr(),
+                               (uchar *) buffer->ptr() + key_length * 4)) < 0)
+      return -1;
+    if (to->find_key((const uchar *) buffer->ptr(), length, to))
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+#ifndef JSON_BINARY_INCLUDED
+#define JSON_BINARY_INCLUDED
+/*
+   Copyright (c) 2020, MariaDB
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/*
+  Binary JSON, as stored in JSONB columns.
+
+  A document is the format version byte followed by a value. A value is
+  a type byte (one of enum json_value_types) followed by its body:
+
+    JSON_VALUE_NULL, _TRUE, _FALSE   no body
+    JSON_VALUE_NUMBER                the number as written in the text
+    JSON_VALUE_STRING                the string as written in the text,
+                                     with its escapes but without quotes
+    JSON_VALUE_ARRAY                 the elements, then n entries
+                                     {offset, length}, then n
+    JSON_VALUE_OBJECT                the keys and the values, then n
+                                     entries {key offset, key length,
+                                     value offset, value length}
+                                     sorted by key, then n
+
+  All integers are 4 byte little-endian, and offsets are relative to the
+  type byte of the container. The length of a value is always known from
+  the entry that refers to it, so the entry table of a container is found
+  from its end and no value needs a length of its own.
+
+  Keys are stored unescaped in utf8mb4 and the object table is sorted by
+  their bytes, so a member is found with a binary search. Members with
+  equal keys keep their document order, and a lookup returns the first
+  one, like the text search in json_find_path() does. JSON_VALUE() and
+  JSON_QUERY() go on to the next member of the text when the first one
+  is not a scalar, or is one, so they search the text in that case.
+*/
+
+#include <json_lib.h>
+
+class String;
+
+#define JSON_BINARY_VERSION 1
+
+
+class Json_binary_value
+{
+  const uchar *m_ptr;                        // The type byte
+  size_t m_length;                           // Including the type byte
+  bool entries(uint entry_length, uint *count, const uchar **table) const;
+  bool set_from_entry(const uchar *entry, const uchar *table);
+public:
+  Json_binary_value(): m_ptr(NULL), m_length(0) {}
+  /*
+    Start at the top value of a stored document.
+    Returns true if the document is broken.
+  */
+  bool init(const uchar *doc, size_t length);
+  json_value_types type() const { return (json_value_types) m_ptr[0]; }
+  bool is_scalar() const { return type() > JSON_VALUE_ARRAY; }
+  /* The text of a number, or the escaped text of a string */
+  const uchar *scalar_ptr() const { return m_ptr + 1; }
+  uint scalar_length() const { return (uint) (m_length - 1); }
+  /* The number of elements of an array or members of an object */
+  uint count() const;
+  /* The n-th element of an array, or the n-th value of an object */
+  bool get_element(uint n, Json_binary_value *to) const;
+  bool get_key(uint n, LEX_CUSTRING *to) const;
+  /*
+    Find an object member by its unescaped utf8mb4 key.
+    Returns true if there is none.
+  */
+  bool find_key(const uchar *key, size_t length, Json_binary_value *to) const;
+  /* Append the JSON text of the value in utf8mb4 */
+  bool to_text(String *to, uint depth= 0) const;
+};
+
+
+/*
+  Convert utf8mb4 JSON text to the binary format, appending it to 'to'.
+  Returns true if the text is not valid JSON or on out of memory.
+*/
+bool json_binary_from_text(String *to, const char *js, size_t length);
+
+/*
+  Look up a path without wildcards in a binary document.
+  'buffer' is used to unescape the keys of the path.
+
+  @retval  0  the value was found
+  @retval  1  the path does not exist in the document
+  @retval -1  the path has wildcards or the document is broken,
+              so the caller should search the text instead
+*/
+int json_binary_find_path(const Json_binary_value *doc, const json_path_t *p,
+                          String *buffer, Json_binary_value *to);
+
+#endif // JSON_BINARY_INCLUDED
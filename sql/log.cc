@@ -54,6 +54,7 @@
 #include "sql_show.h"
 #include "my_pthread.h"
 #include "semisync_master.h"
+#include "gtid_index.h"
 #include "sp_rcontext.h"
 #include "sp_head.h"
 
@@ -103,6 +104,9 @@ static const LEX_CSTRING write_error_msg=
 
 static my_bool opt_optimize_thread_scheduling= TRUE;
 ulong binlog_checksum_options;
+my_bool opt_binlog_gtid_index= TRUE;
+uint opt_binlog_gtid_index_span_min= 65536;
+static uint opt_binlog_writeset_max_keys= 0;
 #ifndef DBUG_OFF
 ulong opt_binlog_dbug_fsync_sleep= 0;
 #endif
@@ -119,6 +123,8 @@ static ulonglong binlog_status_group_commit_trigger_lock_wait;
 static ulonglong binlog_status_group_commit_trigger_timeout;
 static char binlog_snapshot_file[FN_REFLEN];
 static ulonglong binlog_snapshot_position;
+static ulonglong binlog_status_gtid_index_hit;
+static ulonglong binlog_status_gtid_index_miss;
 
 static const char *fatal_log_error=
   "Could not use %s for logging (error %d). "
@@ -139,6 +145,10 @@ static SHOW_VAR binlog_status_vars_detail[]=
     (char *)&binlog_status_group_commit_trigger_lock_wait, SHOW_LONGLONG},
   {"group_commit_trigger_timeout",
     (char *)&binlog_status_group_commit_trigger_timeout, SHOW_LONGLONG},
+  {"gtid_index_hit",
+    (char *)&binlog_status_gtid_index_hit, SHOW_LONGLONG},
+  {"gtid_index_miss",
+    (char *)&binlog_status_gtid_index_miss, SHOW_LONGLONG},
   {"snapshot_file",
     (char *)&binlog_snapshot_file, SHOW_CHAR},
   {"snapshot_position",
@@ -263,6 +273,153 @@ void make_default_log_name(char **out, const char* log_ext, bool once)
 }
 
 
+/*
+  Hashes of the primary and unique key values of the rows changed by a
+  transaction, logged in its GTID event when --binlog-writeset-max-keys is
+  non-zero. Two transactions without a common hash did not change the same
+  row, so a slave using --slave-parallel-mode=writeset can apply them in
+  parallel even if they did not group commit together here.
+
+  Hash collisions only cost parallelism. When the rows can not be described
+  this way (statement-based events, foreign keys, keys on column prefixes or
+  on non-stored columns, too many rows), the writeset is invalidated and the
+  transaction is logged without one.
+*/
+class Binlog_writeset
+{
+public:
+  Binlog_writeset()
+    : hashes(PSI_INSTRUMENT_MEM), valid(true), checked_table_id(~0UL),
+      checked_table_ok(false)
+  { }
+
+  void reset()
+  {
+    hashes.clear();
+    valid= true;
+    checked_table_id= ~0UL;
+  }
+
+  void invalidate()
+  {
+    hashes.clear();
+    valid= false;
+  }
+
+  bool usable() const { return valid && hashes.elements() > 0; }
+
+  void add_row(TABLE *table, const uchar *record, const MY_BITMAP *read_cols,
+               const MY_BITMAP *write_cols);
+
+  Dynamic_array<uint64> hashes;
+
+private:
+  bool valid;
+  /*
+    Whether the last table seen can be described by its keys, which
+    requires checking the engine for foreign keys.
+  */
+  ulong checked_table_id;
+  bool checked_table_ok;
+};
+
+
+/*
+  Add the hashes of the primary and unique keys of one row
+
+  @param table       The table of the row
+  @param record      The row, in the format of table->record[0]
+  @param read_cols   Columns with a valid value in the record, NULL if all
+  @param write_cols  More valid columns, or NULL
+*/
+
+void Binlog_writeset::add_row(TABLE *table, const uchar *record,
+                              const MY_BITMAP *read_cols,
+                              const MY_BITMAP *write_cols)
+{
+  my_ptrdiff_t offset= record - table->record[0];
+  bool added= false;
+
+  if (!valid)
+    return;
+  if (table->s->table_map_id != checked_table_id)
+  {
+    checked_table_id= table->s->table_map_id;
+    /* Changes may cascade to, or depend on, rows of other tables */
+    checked_table_ok= table->file->can_switch_engines();
+  }
+  if (!checked_table_ok)
+  {
+    invalidate();
+    return;
+  }
+
+  for (uint keynr= 0; keynr < table->s->keys; keynr++)
+  {
+    KEY *key= table->key_info + keynr;
+    ulong nr1= 1, nr2= 4;
+    bool has_null= false;
+    uchar keynr_buf[2];
+
+    if (!(key->flags & HA_NOSAME))
+      continue;
+    if (key->algorithm == HA_KEY_ALG_LONG_HASH)
+    {
+      invalidate();
+      return;
+    }
+
+    my_charset_bin.hash_sort((const uchar*) table->s->table_cache_key.str,
+                             table->s->table_cache_key.length, &nr1, &nr2);
+    int2store(keynr_buf, keynr);
+    my_charset_bin.hash_sort(keynr_buf, sizeof(keynr_buf), &nr1, &nr2);
+
+    for (uint i= 0; i < key->user_defined_key_parts && !has_null; i++)
+    {
+      KEY_PART_INFO *key_part= key->key_part + i;
+      Field *field= key_part->field;
+
+      /*
+        Equal hashes must follow from equal key values: a prefix can be
+        equal for different values, a virtual column is not in the record,
+        and -0.0 = 0.0 with different bytes.
+      */
+      if ((key_part->key_part_flag & HA_PART_KEY_SEG) ||
+          (field->flags & BLOB_FLAG) || !field->stored_in_db() ||
+          field->result_type() == REAL_RESULT ||
+          (read_cols && !bitmap_is_set(read_cols, field->field_index) &&
+           !(write_cols && bitmap_is_set(write_cols, field->field_index))))
+      {
+        invalidate();
+        return;
+      }
+      field->move_field_offset(offset);
+      if (field->is_null())
+        has_null= true;                         // NULLs never conflict
+      else
+        field->hash(&nr1, &nr2);
+      field->move_field_offset(-offset);
+    }
+    if (has_null)
+      continue;
+
+    added= true;
+    uint64 hash= (uint64) nr1;
+    /* Consecutive changes of the same row are common, store them once */
+    if (hashes.elements() && *hashes.back() == hash)
+      continue;
+    if (hashes.elements() >= opt_binlog_writeset_max_keys ||
+        hashes.append(hash))
+    {
+      invalidate();
+      return;
+    }
+  }
+  if (!added)
+    invalidate();
+}
+
+
 /*
   Helper classes to store non-transactional and transactional data
   before copying it to the binary log.
@@ -346,6 +503,7 @@ class binlog_cache_data
     status= 0;
     incident= FALSE;
     before_stmt_pos= MY_OFF_T_UNDEF;
+    writeset.reset();
     DBUG_ASSERT(empty());
   }
 
@@ -416,6 +574,9 @@ class binlog_cache_data
   */
   IO_CACHE cache_log;
 
+  /* Keys of the rows logged in the cache, see Binlog_writeset. */
+  Binlog_writeset writeset;
+
 private:
   /*
     Pending binrows event. This event is the event where the rows are currently
@@ -3380,14 +3541,14 @@ MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
    group_commit_queue(0), group_commit_queue_busy(FALSE),
    num_commits(0), num_group_commits(0),
    group_commit_trigger_count(0), group_commit_trigger_timeout(0),
-   group_commit_trigger_lock_wait(0),
+   group_commit_trigger_lock_wait(0), gtid_index(0),
    sync_period_ptr(sync_period), sync_counter(0),
    state_file_deleted(false), binlog_state_recover_done(false),
    is_relay_log(0), relay_signal_cnt(0),
    checksum_alg_reset(BINLOG_CHECKSUM_ALG_UNDEF),
    relay_log_checksum_alg(BINLOG_CHECKSUM_ALG_UNDEF),
    description_event_for_exec(0), description_event_for_queue(0),
-   current_binlog_id(0)
+   current_binlog_id(0), gtid_index_hits(0), gtid_index_misses(0)
 {
   /*
     We don't want to initialize locks here as such initialization depends on
@@ -3882,6 +4043,23 @@ bool MYSQL_BIN_LOG::open(const char *log_name,
 
     if (!is_relay_log)
     {
+      if (opt_binlog_gtid_index)
+      {
+        /*
+          Failure to create the index is not fatal, slaves then just scan
+          the binlog file from the start, as without the index.
+        */
+        if (!gtid_index)
+          gtid_index= new Gtid_index_writer();
+        if (gtid_index &&
+            gtid_index->open(log_file_name, offset,
+                             opt_binlog_gtid_index_span_min))
+        {
+          delete gtid_index;
+          gtid_index= NULL;
+        }
+      }
+
       /* update binlog_end_pos so that it can be read by after sync hook */
       reset_binlog_end_pos(log_file_name, offset);
 
@@ -4372,6 +4550,8 @@ bool MYSQL_BIN_LOG::reset_logs(THD *thd, bool create_new_log,
 
   for (;;)
   {
+    if (!is_relay_log)
+      gtid_index_delete(linfo.log_file_name);
     if (unlikely((error= my_delete(linfo.log_file_name, MYF(0)))))
     {
       if (my_errno == ENOENT) 
@@ -4987,6 +5167,8 @@ int MYSQL_BIN_LOG::purge_index_entry(THD *thd, ulonglong *reclaimed_space,
         error= 0;
 
         DBUG_PRINT("info",("purging %s",log_info.log_file_name));
+        if (!is_relay_log)
+          gtid_index_delete(log_info.log_file_name);
         if (!my_delete(log_info.log_file_name, MYF(0)))
         {
           if (reclaimed_space)
@@ -6022,6 +6204,35 @@ THD::binlog_set_pending_rows_event(Rows_log_event* ev, bool is_transactional)
 }
 
 
+/**
+  Add the keys of a row logged by binlog_write_row() and friends to the
+  writeset of the cache that the row is logged in.
+
+  @param table             the table of the row
+  @param is_transactional  selects the cache, like for the row event
+  @param record            the row, in the format of table->record[0]
+  @param read_cols         columns with a valid value, NULL if all are valid
+  @param write_cols        more columns with a valid value, or NULL
+*/
+void
+THD::binlog_add_writeset(TABLE *table, bool is_transactional,
+                         const uchar *record, const MY_BITMAP *read_cols,
+                         const MY_BITMAP *write_cols)
+{
+  if (!opt_binlog_writeset_max_keys)
+    return;
+
+  binlog_cache_mngr *const cache_mngr= binlog_setup_trx_data();
+  if (!cache_mngr)
+    return;
+
+  binlog_cache_data *cache_data=
+    cache_mngr->get_binlog_cache_data(use_trans_cache(this, is_transactional));
+
+  cache_data->writeset.add_row(table, record, read_cols, write_cols);
+}
+
+
 /**
   This function removes the pending rows event, discarding any outstanding
   rows. If there is no pending rows event available, this is effectively a
@@ -6117,7 +6328,8 @@ MYSQL_BIN_LOG::flush_and_set_pending_rows_event(THD *thd,
 
 bool
 MYSQL_BIN_LOG::write_gtid_event(THD *thd, bool standalone,
-                                bool is_transactional, uint64 commit_id)
+                                bool is_transactional, uint64 commit_id,
+                                Binlog_writeset *writeset)
 {
   rpl_gtid gtid;
   uint32 domain_id;
@@ -6141,6 +6353,14 @@ MYSQL_BIN_LOG::write_gtid_event(THD *thd, bool standalone,
     thd->variables.option_bits&= ~OPTION_GTID_BEGIN;
   }
 
+  /*
+    Add a GTID index record for this event group if due. This must be done
+    before the new GTID is added to the binlog state, as the record describes
+    the state just before the event group.
+  */
+  if (gtid_index && gtid_index->need_record(my_b_tell(&log_file)))
+    gtid_index->add_record(my_b_tell(&log_file), &rpl_global_gtid_binlog_state);
+
   /*
     Reset the session variable gtid_seq_no, to reduce the risk of accidentally
     producing a duplicate GTID.
@@ -6171,6 +6391,17 @@ MYSQL_BIN_LOG::write_gtid_event(THD *thd, bool standalone,
   Gtid_log_event gtid_event(thd, seq_no, domain_id, standalone,
                             LOG_EVENT_SUPPRESS_USE_F, is_transactional,
                             commit_id);
+  /*
+    Only transactions that the slave can roll back and retry are given a
+    writeset, as row locks on other indexes can still make them wait for
+    each other.
+  */
+  if (writeset && writeset->usable() &&
+      (gtid_event.flags2 & Gtid_log_event::FL_TRANSACTIONAL) &&
+      !(gtid_event.flags2 & (Gtid_log_event::FL_PREPARED_XA |
+                             Gtid_log_event::FL_COMPLETED_XA)))
+    gtid_event.set_writeset(writeset->hashes.front(),
+                            (uint32) writeset->hashes.elements());
 
   /* Write the event to the binary log. */
   DBUG_ASSERT(this == &mysql_bin_log);
@@ -6504,6 +6735,9 @@ bool MYSQL_BIN_LOG::write(Log_event *event_info, my_bool *with_annotate)
 
       if (thd->lex->stmt_accessed_non_trans_temp_table())
         cache_data->set_changes_to_non_trans_temp_table();
+      /* Only row events are described by the writeset */
+      if (event_info->get_type_code() != TABLE_MAP_EVENT)
+        cache_data->writeset.invalidate();
 
       thd->binlog_start_trans_and_stmt();
     }
@@ -8305,7 +8539,10 @@ MYSQL_BIN_LOG::write_transaction_or_stmt(group_commit_entry *entry,
   DBUG_ENTER("MYSQL_BIN_LOG::write_transaction_or_stmt");
 
   if (write_gtid_event(entry->thd, is_prepared_xa(entry->thd),
-                       entry->using_trx_cache, commit_id))
+                       entry->using_trx_cache, commit_id,
+                       entry->using_trx_cache &&
+                       (!entry->using_stmt_cache || mngr->stmt_cache.empty()) ?
+                       &mngr->trx_cache.writeset : NULL))
     DBUG_RETURN(ER_ERROR_ON_WRITE);
 
   if (entry->using_stmt_cache && !mngr->stmt_cache.empty() &&
@@ -8644,6 +8881,12 @@ void MYSQL_BIN_LOG::close(uint exiting)
       mysql_file_seek(log_file.file, org_position, MY_SEEK_SET, MYF(0));
     }
 
+    if (gtid_index)
+    {
+      delete gtid_index;
+      gtid_index= NULL;
+    }
+
     /* this will cleanup IO_CACHE, sync and close the file */
     MYSQL_LOG::close(exiting);
   }
@@ -10251,10 +10494,17 @@ int TC_LOG_BINLOG::recover(LOG_INFO *linfo, const char *last_log_name,
   IO_CACHE log;
   File file= -1;
   const char *errmsg;
+  my_off_t ev_start;
 #ifdef HAVE_REPLICATION
   rpl_gtid last_gtid;
   bool last_gtid_standalone= false;
   bool last_gtid_valid= false;
+  /*
+    The GTID index of the crashed binlog file may be incomplete, or reference
+    binlog data that never made it to disk. So rebuild it from scratch while
+    scanning the file.
+  */
+  Gtid_index_writer gtid_index_rebuild;
 #endif
 
   if (! fdle->is_valid() ||
@@ -10280,6 +10530,7 @@ int TC_LOG_BINLOG::recover(LOG_INFO *linfo, const char *last_log_name,
   first_round= true;
   for (;;)
   {
+    ev_start= my_b_tell(first_round ? first_log : &log);
     while ((ev= Log_event::read_log_event(first_round ? first_log : &log,
                                           fdle, opt_master_verify_checksum))
            && ev->is_valid())
@@ -10328,6 +10579,11 @@ int TC_LOG_BINLOG::recover(LOG_INFO *linfo, const char *last_log_name,
           /* Initialise the binlog state from the Gtid_list event. */
           if (rpl_global_gtid_binlog_state.load(glev->list, glev->count))
             goto err2;
+#ifdef HAVE_REPLICATION
+          if (opt_binlog_gtid_index)
+            gtid_index_rebuild.open(last_log_name, my_b_tell(first_log),
+                                    opt_binlog_gtid_index_span_min);
+#endif
         }
         break;
 
@@ -10337,6 +10593,10 @@ int TC_LOG_BINLOG::recover(LOG_INFO *linfo, const char *last_log_name,
         {
           Gtid_log_event *gev= (Gtid_log_event *)ev;
 
+          if (gtid_index_rebuild.need_record(ev_start))
+            gtid_index_rebuild.add_record(ev_start,
+                                          &rpl_global_gtid_binlog_state);
+
           /* Update the binlog state with any GTID logged after Gtid_list. */
           last_gtid.domain_id= gev->domain_id;
           last_gtid.server_id= gev->server_id;
@@ -10378,6 +10638,7 @@ int TC_LOG_BINLOG::recover(LOG_INFO *linfo, const char *last_log_name,
 
       delete ev;
       ev= NULL;
+      ev_start= my_b_tell(first_round ? first_log : &log);
     }
 
     if (!do_xa)
@@ -10666,10 +10927,49 @@ static MYSQL_SYSVAR_ENUM(
   BINLOG_CHECKSUM_ALG_CRC32,
   &binlog_checksum_typelib);
 
+static MYSQL_SYSVAR_BOOL(
+  gtid_index,
+  opt_binlog_gtid_index,
+  PLUGIN_VAR_OPCMDARG,
+  "Write a sparse GTID index file next to each binlog file. The index lets "
+  "slaves connecting with MASTER_USE_GTID start reading the binlog close to "
+  "their GTID position instead of scanning the binlog file from the start. "
+  "Takes effect from the next binlog file",
+  NULL,
+  NULL,
+  1);
+
+static MYSQL_SYSVAR_UINT(
+  gtid_index_span_min,
+  opt_binlog_gtid_index_span_min,
+  PLUGIN_VAR_RQCMDARG,
+  "Minimum number of bytes of binlog between two records in the GTID index. "
+  "Smaller values make the index larger, but reduce the amount of binlog a "
+  "slave connect needs to scan. Takes effect from the next binlog file",
+  NULL,
+  NULL,
+  65536, 1, UINT_MAX32, 1);
+
+static MYSQL_SYSVAR_UINT(
+  writeset_max_keys,
+  opt_binlog_writeset_max_keys,
+  PLUGIN_VAR_RQCMDARG,
+  "If non-zero, log the hashes of the primary and unique key values of the "
+  "rows changed by a row-based transaction in its GTID event, so that slaves "
+  "using --slave-parallel-mode=writeset can apply transactions that change "
+  "different rows in parallel. Transactions that change more keys than this "
+  "are logged without them",
+  NULL,
+  NULL,
+  0, 0, 65536, 1);
+
 static struct st_mysql_sys_var *binlog_sys_vars[]=
 {
   MYSQL_SYSVAR(optimize_thread_scheduling),
   MYSQL_SYSVAR(checksum),
+  MYSQL_SYSVAR(gtid_index),
+  MYSQL_SYSVAR(gtid_index_span_min),
+  MYSQL_SYSVAR(writeset_max_keys),
   NULL
 };
 
@@ -10706,6 +11006,8 @@ TC_LOG_BINLOG::set_status_variables(THD *thd)
   mysql_mutex_lock(&LOCK_commit_ordered);
   binlog_status_var_num_commits= this->num_commits;
   binlog_status_var_num_group_commits= this->num_group_commits;
+  binlog_status_gtid_index_hit= this->gtid_index_hits;
+  binlog_status_gtid_index_miss= this->gtid_index_misses;
   if (!have_snapshot)
   {
     set_binlog_snapshot_file(last_commit_pos_file);
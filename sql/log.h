@@ -20,10 +20,12 @@
 #include "handler.h"                            /* my_xid */
 #include "wsrep_mysqld.h"
 #include "rpl_constants.h"
+#include "my_counter.h"
 
 class Relay_log_info;
 
 class Format_description_log_event;
+class Gtid_index_writer;
 
 bool reopen_fstreams(const char *filename, FILE *outstream, FILE *errstream);
 void setup_log_handling();
@@ -416,6 +418,7 @@ class MYSQL_QUERY_LOG: public MYSQL_LOG
 
 class binlog_cache_mngr;
 class binlog_cache_data;
+class Binlog_writeset;
 struct rpl_gtid;
 struct wait_for_commit;
 
@@ -539,6 +542,9 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   /* binlog encryption data */
   struct Binlog_crypt_data crypto;
 
+  /* GTID index of the current binlog file (NULL if not enabled). */
+  Gtid_index_writer *gtid_index;
+
   /* pointer to the sync period variable, for binlog this will be
      sync_binlog_period, for relay log this will be
      sync_relay_log_period
@@ -889,8 +895,13 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   inline uint32 get_open_count() { return open_count; }
   void set_status_variables(THD *thd);
   bool is_xidlist_idle();
+  /*
+    Number of slave connects where the start position was found through the
+    GTID index, and where the binlog file had to be scanned from the start.
+  */
+  Atomic_counter<ulonglong> gtid_index_hits, gtid_index_misses;
   bool write_gtid_event(THD *thd, bool standalone, bool is_transactional,
-                        uint64 commit_id);
+                        uint64 commit_id, Binlog_writeset *writeset= NULL);
   int read_state_from_file();
   int write_state_to_file();
   int get_most_recent_gtid_list(rpl_gtid **list, uint32 *size);
@@ -2567,10 +2567,12 @@ Binlog_checkpoint_log_event::Binlog_checkpoint_log_event(
 
 Gtid_log_event::Gtid_log_event(const char *buf, uint event_len,
                const Format_description_log_event *description_event)
-  : Log_event(buf, description_event), seq_no(0), commit_id(0)
+  : Log_event(buf, description_event), seq_no(0), commit_id(0),
+    flags_extra(0), writeset_count(0), writeset(0), writeset_allocated(false)
 {
   uint8 header_size= description_event->common_header_len;
   uint8 post_header_len= description_event->post_header_len[GTID_EVENT-1];
+  const char *buf_0= buf;
   if (event_len < (uint) header_size + (uint) post_header_len ||
       post_header_len < GTID_HEADER_LEN)
     return;
@@ -2604,6 +2606,38 @@ Gtid_log_event::Gtid_log_event(const char *buf, uint event_len,
     memcpy(xid.data, buf, data_length);
     buf+= data_length;
   }
+
+  /* The extra flags come after the (padded) post-header, if present. */
+  if (buf < buf_0 + header_size + GTID_HEADER_LEN)
+    buf= buf_0 + header_size + GTID_HEADER_LEN;
+  if (buf >= buf_0 + event_len)
+    return;
+  flags_extra= *(buf++);
+  if (flags_extra & FL_EXTRA_WRITESET)
+  {
+    /*
+      The writeset is only a scheduling hint for the slave, so a writeset
+      that is truncated, that cannot be allocated or that cannot be located
+      because other extra flags (unknown to this server) come with data of
+      their own is ignored. The GTID itself remains valid.
+    */
+    const char *end= buf_0 + event_len;
+    uint32 count= end - buf >= 4 ? uint4korr(buf) : 0;
+    if (!(flags_extra & ~FL_EXTRA_WRITESET) && end - buf >= 4 &&
+        (ulonglong) (end - buf - 4) >= (ulonglong) count * 8 &&
+        (writeset= (uint64*) my_malloc(PSI_INSTRUMENT_ME,
+                                       MY_MAX(count, 1) * sizeof(uint64),
+                                       MYF(0))))
+    {
+      buf+= 4;
+      writeset_allocated= true;
+      writeset_count= count;
+      for (uint32 i= 0; i < count; i++, buf+= 8)
+        writeset[i]= uint8korr(buf);
+    }
+    else
+      flags_extra&= (uchar) ~FL_EXTRA_WRITESET;
+  }
 }
 
 
@@ -3176,7 +3210,7 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
     , m_curr_row(NULL), m_curr_row_end(NULL),
     m_key(NULL), m_key_info(NULL), m_key_nr(0),
-    master_had_triggers(0)
+    master_had_triggers(0), m_use_hash_scan(false), m_hash_scan(NULL)
 #endif
 {
   DBUG_ENTER("Rows_log_event::Rows_log_event(const char*,...)");
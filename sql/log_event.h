@@ -802,6 +802,7 @@ enum Int_event_type
 class String;
 class MYSQL_BIN_LOG;
 class THD;
+class Rows_hash_scan;
 #endif
 
 class Format_description_log_event;
@@ -3562,8 +3563,39 @@ class Binlog_checkpoint_log_event: public Log_event
   </tr>
   </table>
 
-  The Body of Gtid_log_event is empty. The total event size is 19 bytes +
-  the normal 19 bytes common-header.
+  The Body of Gtid_log_event is empty, unless the extra flags byte is
+  present. The total event size is then 19 bytes (or more, with commit id
+  or XA data) + the normal 19 bytes common-header.
+
+  If there are more bytes after the post-header (after the commit id and XA
+  data, or after the 19 bytes, whichever comes last), they are:
+
+  <table>
+  <caption>Body</caption>
+
+  <tr>
+    <th>Name</th>
+    <th>Format</th>
+    <th>Description</th>
+  </tr>
+
+  <tr>
+    <td>flags_extra</td>
+    <td>1 byte bitfield</td>
+    <td>Bit 7 set indicates that a writeset follows. Bits 0-6 are left to
+        other uses; a writeset is only logged with no other bit set.</td>
+  </tr>
+
+  <tr>
+    <td>writeset (see flags_extra bit 7)</td>
+    <td>4 byte unsigned integer N, then N * 8 byte unsigned integers</td>
+    <td>Hashes of the primary and unique key values of all rows changed by
+        the event group, see --binlog-writeset-max-keys.</td>
+  </tr>
+  </table>
+
+  Old servers ignore the extra bytes. A writeset that cannot be read is
+  ignored, the event group is then scheduled as if it had none.
 */
 
 class Gtid_log_event: public Log_event
@@ -3609,6 +3641,20 @@ class Gtid_log_event: public Log_event
   /* FL_"COMMITTED or ROLLED-BACK"_XA is set for XA transaction. */
   static const uchar FL_COMPLETED_XA= 128;
 
+  /* Flags_extra. */
+  uchar flags_extra;
+  /*
+    FL_EXTRA_WRITESET is set when the event carries the hashes of the keys
+    of the rows changed by the event group, for --slave-parallel-mode=writeset.
+    It is the highest bit, so that it does not collide with the extra flags
+    that are allocated from bit 0 upwards.
+  */
+  static const uchar FL_EXTRA_WRITESET= 128;
+  uint32 writeset_count;
+  uint64 *writeset;
+  /* Set if writeset was allocated by the constructor and must be freed. */
+  bool writeset_allocated;
+
 #ifdef MYSQL_SERVER
   Gtid_log_event(THD *thd_arg, uint64 seq_no, uint32 domain_id, bool standalone,
                  uint16 flags, bool is_transactional, uint64 commit_id);
@@ -3623,12 +3669,24 @@ class Gtid_log_event: public Log_event
 #endif
   Gtid_log_event(const char *buf, uint event_len,
                  const Format_description_log_event *description_event);
-  ~Gtid_log_event() { }
+  ~Gtid_log_event()
+  {
+    if (writeset_allocated)
+      my_free(writeset);
+  }
   Log_event_type get_type_code() { return GTID_EVENT; }
   enum_logged_status logged_status() { return LOGGED_NO_DATA; }
   int get_data_size()
   {
-    return GTID_HEADER_LEN + ((flags2 & FL_GROUP_COMMIT_ID) ? 2 : 0);
+    return GTID_HEADER_LEN + ((flags2 & FL_GROUP_COMMIT_ID) ? 2 : 0) +
+      ((flags_extra & FL_EXTRA_WRITESET) ? 1 + 4 + 8 * writeset_count : 0);
+  }
+  /* Log the given writeset; the array must stay valid until write(). */
+  void set_writeset(uint64 *hashes, uint32 count)
+  {
+    flags_extra|= FL_EXTRA_WRITESET;
+    writeset= hashes;
+    writeset_count= count;
   }
   bool is_valid() const { return seq_no != 0; }
 #ifdef MYSQL_SERVER
@@ -5155,9 +5213,14 @@ class Rows_log_event : public Log_event
   KEY      *m_key_info; /* Pointer to KEY info for m_key_nr */
   uint      m_key_nr;   /* Key number */
   bool master_had_triggers;     /* set after tables opening */
+  bool m_use_hash_scan; /* Set by find_key() if find_row() should hash scan */
+  Rows_hash_scan *m_hash_scan; /* Before-images of the event, see find_row() */
 
   int find_key(); // Find a best key to use in find_row()
   int find_row(rpl_group_info *);
+  int hash_scan_build(rpl_group_info *);
+  int hash_scan_find_row(rpl_group_info *);
+  void hash_scan_end();
   int write_row(rpl_group_info *, const bool);
   int update_sequence();
 
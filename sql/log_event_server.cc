@@ -3200,7 +3200,8 @@ Gtid_log_event::Gtid_log_event(THD *thd_arg, uint64 seq_no_arg,
                                uint64 commit_id_arg)
   : Log_event(thd_arg, flags_arg, is_transactional),
     seq_no(seq_no_arg), commit_id(commit_id_arg), domain_id(domain_id_arg),
-    flags2((standalone ? FL_STANDALONE : 0) | (commit_id_arg ? FL_GROUP_COMMIT_ID : 0))
+    flags2((standalone ? FL_STANDALONE : 0) | (commit_id_arg ? FL_GROUP_COMMIT_ID : 0)),
+    flags_extra(0), writeset_count(0), writeset(0), writeset_allocated(false)
 {
   cache_type= Log_event::EVENT_NO_CACHE;
   bool is_tmp_table= thd_arg->lex->stmt_accessed_temp_table();
@@ -3303,9 +3304,32 @@ Gtid_log_event::write()
     bzero(buf+write_len, GTID_HEADER_LEN-write_len);
     write_len= GTID_HEADER_LEN;
   }
-  return write_header(write_len) ||
-         write_data(buf, write_len) ||
-         write_footer();
+
+  if (!flags_extra)
+    return write_header(write_len) ||
+           write_data(buf, write_len) ||
+           write_footer();
+
+  uchar extra_buf[1 + 4];
+  uchar hash_buf[8 * 64];
+  extra_buf[0]= flags_extra;
+  int4store(extra_buf + 1, writeset_count);
+  DBUG_EXECUTE_IF("binlog_writeset_truncated",
+                  int4store(extra_buf + 1, writeset_count + 1););
+  DBUG_EXECUTE_IF("binlog_writeset_unknown_flag", extra_buf[0]|= 1;);
+  if (write_header(write_len + sizeof(extra_buf) + 8 * (size_t) writeset_count) ||
+      write_data(buf, write_len) ||
+      write_data(extra_buf, sizeof(extra_buf)))
+    return true;
+  for (uint32 i= 0; i < writeset_count; )
+  {
+    size_t len= 0;
+    for (; i < writeset_count && len < sizeof(hash_buf); i++, len+= 8)
+      int8store(hash_buf + len, writeset[i]);
+    if (write_data(hash_buf, len))
+      return true;
+  }
+  return write_footer();
 }
 
 
@@ -5097,7 +5121,7 @@ Rows_log_event::Rows_log_event(THD *thd_arg, TABLE *tbl_arg, ulong tid,
 #ifdef HAVE_REPLICATION
     , m_curr_row(NULL), m_curr_row_end(NULL),
     m_key(NULL), m_key_info(NULL), m_key_nr(0),
-    master_had_triggers(0)
+    master_had_triggers(0), m_use_hash_scan(false), m_hash_scan(NULL)
 #endif
 {
   /*
@@ -7540,10 +7564,12 @@ static bool record_compare(TABLE *table)
   Find the best key to use when locating the row in @c find_row().
 
   A primary key is preferred if it exists; otherwise a unique index is
-  preferred. Else we pick the index with the smalles rec_per_key value.
+  preferred. Else we pick the index with the smalles rec_per_key value,
+  if INDEX_SCAN is in @@slave_rows_search_algorithms.
 
   If a suitable key is found, set @c m_key, @c m_key_nr and @c m_key_info
-  member fields appropriately.
+  member fields appropriately. If no key identifies the rows uniquely and
+  HASH_SCAN is in @@slave_rows_search_algorithms, set @c m_use_hash_scan.
 
   @returns Error code on failure, 0 on success.
 */
@@ -7552,10 +7578,12 @@ int Rows_log_event::find_key()
   uint i, best_key_nr, last_part;
   KEY *key, *UNINIT_VAR(best_key);
   ulong UNINIT_VAR(best_rec_per_key), tmp;
+  ulonglong algorithms= slave_rows_search_algorithms_options;
   DBUG_ENTER("Rows_log_event::find_key");
   DBUG_ASSERT(m_table);
 
   best_key_nr= MAX_KEY;
+  m_use_hash_scan= false;
 
   /*
     Keys are sorted so that any primary key is first, followed by unique keys,
@@ -7577,6 +7605,8 @@ int Rows_log_event::find_key()
       best_key= key;
       break;
     }
+    if (!(algorithms & (1ULL << SLAVE_ROWS_INDEX_SCAN)))
+      continue;
     /*
       We can only use a non-unique key if it allows range scans (ie. skip
       FULLTEXT indexes and such).
@@ -7596,6 +7626,10 @@ int Rows_log_event::find_key()
     }
   }
 
+  if (best_key_nr == MAX_KEY ||
+      (best_key->flags & (HA_NOSAME | HA_NULL_PART_KEY)) != HA_NOSAME)
+    m_use_hash_scan= MY_TEST(algorithms & (1ULL << SLAVE_ROWS_HASH_SCAN));
+
   if (best_key_nr == MAX_KEY)
   {
     m_key_info= NULL;
@@ -7670,6 +7704,367 @@ static int row_not_found_error(rpl_group_info *rgi)
          ? HA_ERR_KEY_NOT_FOUND : HA_ERR_RECORD_CHANGED;
 }
 
+/*
+  Hash scan lookup of the rows of an UPDATE or DELETE rows event.
+
+  Without a key that identifies the rows uniquely, find_row() has to scan
+  the table, or a range of a non-unique index, for every row of the event.
+  With HASH_SCAN in @@slave_rows_search_algorithms, the first find_row()
+  call for the event instead unpacks all before-images of the event into a
+  hash, and scans the table (or the index range of each key value) once,
+  remembering the position of the table row that matches each before-image.
+  The rows are then fetched with rnd_pos() one by one in event order, so
+  that they are changed in the same order as with a per-row lookup.
+*/
+
+class Rows_hash_scan
+{
+public:
+  struct Entry
+  {
+    const uchar *row;           /* Start of the before-image in the event */
+    uchar *record;              /* The unpacked before-image */
+    uchar *ref;                 /* Position of the matching table row */
+    Entry *next_in_event;
+    Entry *next_in_bucket;
+    ulong hash;
+    bool found;                 /* Set when ref has been filled in */
+  };
+
+  Rows_hash_scan()
+    : first(NULL), last(NULL), current(NULL), buckets(NULL), bucket_mask(0),
+      entries(0), matched(0)
+  {
+    init_alloc_root(PSI_INSTRUMENT_ME, &mem_root, 8192, 0, MYF(0));
+  }
+  ~Rows_hash_scan() { free_root(&mem_root, MYF(0)); }
+
+  bool add(TABLE *table, const uchar *row);
+  bool build(TABLE *table);
+  bool match(TABLE *table);
+  Entry *find(const uchar *row);
+  bool all_matched() const { return matched == entries; }
+
+  Entry *first, *last;
+
+private:
+  MEM_ROOT mem_root;
+  Entry *current;
+  Entry **buckets;
+  ulong bucket_mask;
+  uint entries, matched;
+};
+
+
+/*
+  Hash the columns of table->record[0] that record_compare() looks at, so
+  that records which record_compare() considers equal get the same hash.
+*/
+static ulong rpl_record_hash(TABLE *table)
+{
+  ulong nr1= 1, nr2= 4;
+
+  for (Field **ptr= table->field; *ptr; ptr++)
+  {
+    Field *field= *ptr;
+    if (table->versioned() && field->vers_sys_field())
+      continue;
+    if (field->is_null())
+      nr1^= (nr1 << 1) | 1;
+    else if (field->flags & BLOB_FLAG)
+    {
+      /* Field::hash() would hash the pointer to the blob data */
+      Field_blob *blob= static_cast<Field_blob*>(field);
+      my_charset_bin.hash_sort(blob->get_ptr(), blob->get_length(),
+                               &nr1, &nr2);
+    }
+    else
+      field->hash(&nr1, &nr2);
+  }
+  return nr1;
+}
+
+
+/* Add the before-image unpacked in table->record[0] */
+
+bool Rows_hash_scan::add(TABLE *table, const uchar *row)
+{
+  Entry *entry;
+
+  if (!(entry= (Entry*) alloc_root(&mem_root, sizeof(Entry))) ||
+      !(entry->record= (uchar*) memdup_root(&mem_root, table->record[0],
+                                            table->s->reclength)))
+    return true;
+  /*
+    The record only points to the BLOB values, which may be in a buffer
+    that is reused for the next row. Keep a copy of them.
+  */
+  for (uint i= 0; i < table->s->blob_fields; i++)
+  {
+    Field_blob *blob= (Field_blob*) table->field[table->s->blob_field[i]];
+    uint32 length= blob->get_length();
+    uchar *data;
+    if (!length)
+      continue;
+    if (!(data= (uchar*) memdup_root(&mem_root, blob->get_ptr(), length)))
+      return true;
+    blob->set_ptr_offset(entry->record - table->record[0], length, data);
+  }
+  entry->row= row;
+  entry->ref= NULL;
+  entry->next_in_event= NULL;
+  entry->next_in_bucket= NULL;
+  entry->hash= rpl_record_hash(table);
+  entry->found= false;
+  if (last)
+    last->next_in_event= entry;
+  else
+    first= entry;
+  last= entry;
+  entries++;
+  return false;
+}
+
+
+/* Create the hash buckets once all before-images have been added */
+
+bool Rows_hash_scan::build(TABLE *table)
+{
+  uint ref_length= table->file->ref_length;
+  uint n_buckets= my_round_up_to_next_power(MY_MAX(entries, 1));
+  uchar *refs;
+
+  if (!(buckets= (Entry**) alloc_root(&mem_root, n_buckets * sizeof(Entry*))) ||
+      !(refs= (uchar*) alloc_root(&mem_root, entries * ref_length + 1)))
+    return true;
+  bzero(buckets, n_buckets * sizeof(Entry*));
+  bucket_mask= n_buckets - 1;
+
+  for (Entry *entry= first; entry; entry= entry->next_in_event)
+  {
+    Entry **bucket= &buckets[entry->hash & bucket_mask];
+    entry->next_in_bucket= *bucket;
+    *bucket= entry;
+    entry->ref= refs;
+    refs+= ref_length;
+  }
+  return false;
+}
+
+
+/*
+  Look for a before-image that is equal to the row in table->record[0] and
+  has not been matched yet, and if there is one, remember the position of
+  the row for it.
+
+  @return true if a before-image matched the row
+*/
+
+bool Rows_hash_scan::match(TABLE *table)
+{
+  ulong hash= rpl_record_hash(table);
+
+  for (Entry *entry= buckets[hash & bucket_mask]; entry;
+       entry= entry->next_in_bucket)
+  {
+    if (entry->found || entry->hash != hash)
+      continue;
+    memcpy(table->record[1], entry->record, table->s->reclength);
+    if (!record_compare(table))
+    {
+      table->file->position(table->record[0]);
+      memcpy(entry->ref, table->file->ref, table->file->ref_length);
+      entry->found= true;
+      matched++;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/* Find the entry of the row starting at the given position of the event */
+
+Rows_hash_scan::Entry *Rows_hash_scan::find(const uchar *row)
+{
+  /* The rows are looked up in event order, so this is usually one step */
+  if (!current || current->row > row)
+    current= first;
+  while (current && current->row < row)
+    current= current->next_in_event;
+  return current && current->row == row ? current : NULL;
+}
+
+
+/**
+  Unpack all before-images of the event and locate the matching table
+  rows with a single table scan, or with one index range scan per key
+  value if @c find_key() picked a non-unique key.
+
+  @returns Error code on failure, 0 on success.
+*/
+
+int Rows_log_event::hash_scan_build(rpl_group_info *rgi)
+{
+  TABLE *table= m_table;
+  const uchar *saved_row= m_curr_row, *saved_row_end= m_curr_row_end;
+  int error= 0;
+  DBUG_ENTER("Rows_log_event::hash_scan_build");
+  DBUG_ASSERT(!m_hash_scan);
+
+  if (!(m_hash_scan= new Rows_hash_scan()))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  for (m_curr_row= m_rows_buf; m_curr_row < m_rows_end;
+       m_curr_row= m_curr_row_end)
+  {
+    const uchar *row= m_curr_row;
+    prepare_record(table, m_width, FALSE);
+    if (unlikely((error= unpack_current_row(rgi))))
+      goto end;
+    if (m_vers_from_plain)
+      table->vers_end_field()->set_max();
+    if (m_hash_scan->add(table, row))
+    {
+      error= HA_ERR_OUT_OF_MEM;
+      goto end;
+    }
+    if (get_general_type_code() == UPDATE_ROWS_EVENT)
+    {
+      /* Skip the after image */
+      m_curr_row= m_curr_row_end;
+      if (unlikely((error= unpack_current_row(rgi, &m_cols_ai))))
+        goto end;
+    }
+  }
+  if (m_hash_scan->build(table))
+  {
+    error= HA_ERR_OUT_OF_MEM;
+    goto end;
+  }
+
+  if (m_key_info)
+  {
+    DBUG_PRINT("info",("hash scan using key #%u [%s]",
+                       m_key_nr, m_key_info->name.str));
+    if (unlikely((error= table->file->ha_index_init(m_key_nr, FALSE))))
+    {
+      table->file->print_error(error, MYF(0));
+      goto end;
+    }
+    for (Rows_hash_scan::Entry *entry= m_hash_scan->first;
+         entry && !m_hash_scan->all_matched();
+         entry= entry->next_in_event)
+    {
+      /*
+        The scan of a key range matches all before-images with that key,
+        so a key is only scanned again if rows are missing on the slave.
+      */
+      if (entry->found)
+        continue;
+      memcpy(table->record[0], entry->record, table->s->reclength);
+      key_copy(m_key, table->record[0], m_key_info, 0);
+      error= table->file->ha_index_read_map(table->record[0], m_key,
+                                            HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+      while (!error)
+      {
+        m_hash_scan->match(table);
+        error= table->file->ha_index_next_same(table->record[0], m_key,
+                                               m_key_info->key_length);
+      }
+      if (error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
+      {
+        table->file->print_error(error, MYF(0));
+        table->file->ha_index_end();
+        goto end;
+      }
+    }
+    table->file->ha_index_end();
+  }
+  else
+  {
+    DBUG_PRINT("info",("hash scan using table scan (rnd_next)"));
+    if (unlikely((error= table->file->ha_rnd_init_with_error(1))))
+      goto end;
+    while (!m_hash_scan->all_matched() &&
+           !(error= table->file->ha_rnd_next(table->record[0])))
+      m_hash_scan->match(table);
+    table->file->ha_rnd_end();
+    if (error && error != HA_ERR_END_OF_FILE)
+    {
+      table->file->print_error(error, MYF(0));
+      goto end;
+    }
+  }
+  error= 0;
+  issue_long_find_row_warning(get_general_type_code(), m_table->alias.c_ptr(),
+                              m_key_info != NULL, rgi);
+
+end:
+  if (unlikely(error))
+    hash_scan_end();
+  m_curr_row= saved_row;
+  m_curr_row_end= saved_row_end;
+  DBUG_RETURN(error);
+}
+
+
+/**
+  Locate the current row using the positions found by
+  @c hash_scan_build(), which is called for the first row of the event.
+
+  @returns Error code on failure, 0 on success.
+*/
+
+int Rows_log_event::hash_scan_find_row(rpl_group_info *rgi)
+{
+  TABLE *table= m_table;
+  Rows_hash_scan::Entry *entry;
+  int error;
+  DBUG_ENTER("Rows_log_event::hash_scan_find_row");
+
+  if (!m_hash_scan && (error= hash_scan_build(rgi)))
+    DBUG_RETURN(error);
+
+  if (!(entry= m_hash_scan->find(m_curr_row)) || !entry->found)
+  {
+    DBUG_PRINT("info",("no record matching the given row found"));
+    error= row_not_found_error(rgi);
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(error);
+  }
+
+  /* hash_scan_build() has used record[1] */
+  memcpy(table->record[1], entry->record, table->s->reclength);
+
+  if (!table->file->inited &&
+      unlikely((error= table->file->ha_rnd_init_with_error(0))))
+    DBUG_RETURN(error);
+  error= table->file->ha_rnd_pos(table->record[0], entry->ref);
+  /*
+    The row can differ from the before-image only if the same table row was
+    matched by another before-image, in a re-scan of its key range because
+    rows are missing on the slave.
+  */
+  if (likely(!error) && record_compare(table))
+    error= HA_ERR_KEY_NOT_FOUND;
+  if (unlikely(error))
+  {
+    if (error == HA_ERR_KEY_NOT_FOUND || error == HA_ERR_RECORD_DELETED)
+      error= row_not_found_error(rgi);
+    table->file->print_error(error, MYF(0));
+    table->file->ha_index_or_rnd_end();
+  }
+  DBUG_RETURN(error);
+}
+
+
+void Rows_log_event::hash_scan_end()
+{
+  delete m_hash_scan;
+  m_hash_scan= NULL;
+}
+
 /**
   Locate the current row in event's table.
 
@@ -7793,6 +8188,12 @@ int Rows_log_event::find_row(rpl_group_info *rgi)
    */ 
   store_record(table,record[1]);    
 
+  if (m_use_hash_scan)
+  {
+    error= hash_scan_find_row(rgi);
+    goto end;
+  }
+
   if (m_key_info)
   {
     DBUG_PRINT("info",("locating record using key #%u [%s] (index_read)",
@@ -8044,6 +8445,7 @@ Delete_rows_log_event::do_after_row_operations(const Slave_reporting_capability
   my_free(m_key);
   m_key= NULL;
   m_key_info= NULL;
+  hash_scan_end();
 
   return error;
 }
@@ -8194,6 +8596,7 @@ Update_rows_log_event::do_after_row_operations(const Slave_reporting_capability
   my_free(m_key); // Free for multi_malloc
   m_key= NULL;
   m_key_info= NULL;
+  hash_scan_end();
 
   return error;
 }
@@ -32,10 +32,12 @@ static PSI_memory_key key_memory_MDL_context_acquire_locks;
 
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_fast_path;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_fast_path, "MDL_context::LOCK_fast_path", 0}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -157,28 +159,6 @@ void MDL_key::init_psi_keys()
 static bool mdl_initialized= 0;
 
 
-/**
-  A collection of all MDL locks. A singleton,
-  there is only one instance of the map in the server.
-*/
-
-class MDL_map
-{
-public:
-  void init();
-  void destroy();
-  MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
-  unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
-  void remove(LF_PINS *pins, MDL_lock *lock);
-  LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
-private:
-  LF_HASH m_locks; /**< All acquired locks in the server. */
-  /** Pre-allocated MDL_lock object for BACKUP namespace. */
-  MDL_lock *m_backup_lock;
-  friend int mdl_iterate(mdl_iterator_callback, void *);
-};
-
-
 /**
   A context of the recursive traversal through all contexts
   in all sessions in search for deadlock.
@@ -338,6 +318,24 @@ class MDL_lock
 public:
   typedef mdl_bitmap_t bitmap_t;
 
+  /**
+    Type of m_fast_path_state: FAST_PATH_COUNTERS counters of locks
+    acquired on the fast path, FAST_PATH_COUNTER_BITS bits each, followed
+    by the flags below.
+  */
+  typedef ulonglong fast_path_state_t;
+  static const uint FAST_PATH_COUNTERS= 3;
+  static const uint FAST_PATH_COUNTER_BITS= 20;
+  static const fast_path_state_t FAST_PATH_COUNTER_MASK=
+    (1ULL << FAST_PATH_COUNTER_BITS) - 1;
+  /** All the counters, i.e. all locks acquired on the fast path. */
+  static const fast_path_state_t FAST_PATH_LOCKS=
+    (1ULL << (FAST_PATH_COUNTER_BITS * FAST_PATH_COUNTERS)) - 1;
+  /** Obtrusive locks are granted or waited for: the fast path is closed. */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1ULL << 62;
+  /** The object is being removed from MDL_map and can't be used. */
+  static const fast_path_state_t IS_DESTROYED= 1ULL << 63;
+
   class Ticket_list
   {
   public:
@@ -381,6 +379,13 @@ class MDL_lock
     virtual bool needs_notification(const MDL_ticket *ticket) const = 0;
     virtual bool conflicting_locks(const MDL_ticket *ticket) const = 0;
     virtual bitmap_t hog_lock_types_bitmap() const = 0;
+    /**
+      Increments of m_fast_path_state for the "unobtrusive" lock types,
+      which can be acquired on the fast path, 0 for "obtrusive" ones.
+    */
+    virtual const fast_path_state_t *unobtrusive_lock_increment() const = 0;
+    /** Lock types counted by each of the fast path counters. */
+    virtual const bitmap_t *fast_path_granted_types() const = 0;
     virtual ~MDL_lock_strategy() {}
   };
 
@@ -417,9 +422,17 @@ class MDL_lock
     */
     virtual bitmap_t hog_lock_types_bitmap() const
     { return 0; }
+
+    /* Scoped locks are rare enough to always use the slow path. */
+    virtual const fast_path_state_t *unobtrusive_lock_increment() const
+    { return m_unobtrusive_lock_increment; }
+    virtual const bitmap_t *fast_path_granted_types() const
+    { return m_fast_path_granted_types; }
   private:
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+    static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+    static const bitmap_t m_fast_path_granted_types[FAST_PATH_COUNTERS];
   };
 
 
@@ -465,9 +478,16 @@ class MDL_lock
               MDL_BIT(MDL_EXCLUSIVE));
     }
 
+    virtual const fast_path_state_t *unobtrusive_lock_increment() const
+    { return m_unobtrusive_lock_increment; }
+    virtual const bitmap_t *fast_path_granted_types() const
+    { return m_fast_path_granted_types; }
+
   private:
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+    static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+    static const bitmap_t m_fast_path_granted_types[FAST_PATH_COUNTERS];
   };
 
 
@@ -502,9 +522,16 @@ class MDL_lock
     */
     virtual bitmap_t hog_lock_types_bitmap() const
     { return 0; }
+
+    virtual const fast_path_state_t *unobtrusive_lock_increment() const
+    { return m_unobtrusive_lock_increment; }
+    virtual const bitmap_t *fast_path_granted_types() const
+    { return m_fast_path_granted_types; }
   private:
     static const bitmap_t m_granted_incompatible[MDL_BACKUP_END];
     static const bitmap_t m_waiting_incompatible[MDL_BACKUP_END];
+    static const fast_path_state_t m_unobtrusive_lock_increment[MDL_BACKUP_END];
+    static const bitmap_t m_fast_path_granted_types[FAST_PATH_COUNTERS];
   };
 
 public:
@@ -545,9 +572,106 @@ class MDL_lock
   */
   mysql_prlock_t m_rwlock;
 
+  /**
+    Number of locks acquired on the fast path, and flags.
+
+    "Unobtrusive" lock types, the ones used by DML, are compatible with
+    each other. While there are no granted or waiting "obtrusive" locks,
+    they are granted by atomically incrementing a counter here, without
+    taking m_rwlock or adding tickets to the granted queue.
+
+    An obtrusive lock request sets HAS_OBTRUSIVE under m_rwlock before it
+    checks the counters, so that new unobtrusive requests take the slow
+    path and wait behind it. Fast path locks released while HAS_OBTRUSIVE
+    is set take m_rwlock and reschedule waiters.
+
+    A context moves its fast path locks to the granted queues, i.e.
+    "materializes" them, before it requests an obtrusive lock and before
+    it waits, so that can_grant_lock() and the deadlock detector see them.
+    Thus any fast path lock which conflicts with a request belongs to
+    another context, which is not waiting.
+  */
+  std::atomic<fast_path_state_t> m_fast_path_state;
+
+  /**
+    Number of obtrusive tickets in m_granted and m_waiting, or about to be
+    added there. Protected by m_rwlock.
+  */
+  uint m_obtrusive_locks_granted_waiting_count;
+
   bool is_empty() const
   {
-    return (m_granted.is_empty() && m_waiting.is_empty());
+    return (m_granted.is_empty() && m_waiting.is_empty() &&
+            !(m_fast_path_state & FAST_PATH_LOCKS));
+  }
+
+  fast_path_state_t get_unobtrusive_lock_increment(enum_mdl_type type) const
+  { return m_strategy->unobtrusive_lock_increment()[type]; }
+
+  static fast_path_state_t
+  get_unobtrusive_lock_increment(const MDL_request *request)
+  {
+    return get_strategy(&request->key)->
+      unobtrusive_lock_increment()[request->type];
+  }
+
+  /** Bitmap of types of locks which were granted on the fast path. */
+  bitmap_t fast_path_granted_bitmap() const
+  {
+    fast_path_state_t state= m_fast_path_state;
+    const bitmap_t *types= m_strategy->fast_path_granted_types();
+    bitmap_t result= 0;
+
+    for (uint i= 0; i < FAST_PATH_COUNTERS; i++)
+      if (state & (FAST_PATH_COUNTER_MASK << (i * FAST_PATH_COUNTER_BITS)))
+        result|= types[i];
+    return result;
+  }
+
+  /**
+    Try to acquire an unobtrusive lock on the fast path.
+
+    @retval TRUE   The lock is acquired.
+    @retval FALSE  The slow path must be used, or the object is destroyed.
+  */
+  bool fast_path_acquire(fast_path_state_t increment)
+  {
+    fast_path_state_t old_state= m_fast_path_state;
+    do
+    {
+      if (old_state & (HAS_OBTRUSIVE | IS_DESTROYED))
+        return false;
+    } while (!m_fast_path_state.compare_exchange_weak(old_state,
+                                                      old_state + increment));
+    return true;
+  }
+
+  void fast_path_release(LF_PINS *pins, fast_path_state_t increment);
+
+  /**
+    Account for a ticket of the given type which is about to be added to
+    m_granted or m_waiting. Obtrusive tickets close the fast path.
+
+    @pre m_rwlock is write-locked.
+  */
+  void obtrusive_lock_added(enum_mdl_type type)
+  {
+    if (!get_unobtrusive_lock_increment(type) &&
+        !m_obtrusive_locks_granted_waiting_count++)
+      m_fast_path_state.fetch_or(HAS_OBTRUSIVE);
+  }
+
+  /**
+    Account for a ticket of the given type which was removed from
+    m_granted or m_waiting, or was not added there after all.
+
+    @pre m_rwlock is write-locked.
+  */
+  void obtrusive_lock_removed(enum_mdl_type type)
+  {
+    if (!get_unobtrusive_lock_increment(type) &&
+        !--m_obtrusive_locks_granted_waiting_count)
+      m_fast_path_state.fetch_and(~HAS_OBTRUSIVE);
   }
 
   const bitmap_t *incompatible_granted_types_bitmap() const
@@ -611,12 +735,16 @@ class MDL_lock
 public:
 
   MDL_lock()
-    : m_hog_lock_count(0),
+    : m_fast_path_state(0),
+      m_obtrusive_locks_granted_waiting_count(0),
+      m_hog_lock_count(0),
       m_strategy(0)
   { mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock); }
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
+    m_fast_path_state(0),
+    m_obtrusive_locks_granted_waiting_count(0),
     m_hog_lock_count(0),
     m_strategy(&m_backup_lock_strategy)
   {
@@ -638,14 +766,25 @@ class MDL_lock
   {
     DBUG_ASSERT(key_arg->mdl_namespace() != MDL_key::BACKUP);
     new (&lock->key) MDL_key(key_arg);
-    if (key_arg->mdl_namespace() == MDL_key::SCHEMA)
-      lock->m_strategy= &m_scoped_lock_strategy;
-    else
-      lock->m_strategy= &m_object_lock_strategy;
+    DBUG_ASSERT(!lock->m_obtrusive_locks_granted_waiting_count);
+    lock->m_fast_path_state= 0;
+    lock->m_strategy= get_strategy(key_arg);
   }
 
   const MDL_lock_strategy *m_strategy;
 private:
+  static const MDL_lock_strategy *get_strategy(const MDL_key *key_arg)
+  {
+    switch (key_arg->mdl_namespace()) {
+    case MDL_key::BACKUP:
+      return &m_backup_lock_strategy;
+    case MDL_key::SCHEMA:
+      return &m_scoped_lock_strategy;
+    default:
+      return &m_object_lock_strategy;
+    }
+  }
+
   static const MDL_backup_lock m_backup_lock_strategy;
   static const MDL_scoped_lock m_scoped_lock_strategy;
   static const MDL_object_lock m_object_lock_strategy;
@@ -657,6 +796,31 @@ const MDL_lock::MDL_scoped_lock MDL_lock::m_scoped_lock_strategy;
 const MDL_lock::MDL_object_lock MDL_lock::m_object_lock_strategy;
 
 
+/**
+  A collection of all MDL locks. A singleton,
+  there is only one instance of the map in the server.
+*/
+
+class MDL_map
+{
+public:
+  void init();
+  void destroy();
+  MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
+  bool fast_path_acquire(LF_PINS *pins, const MDL_key *key,
+                         MDL_lock::fast_path_state_t increment,
+                         MDL_lock **lock_arg);
+  unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
+  void remove(LF_PINS *pins, MDL_lock *lock);
+  LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
+private:
+  LF_HASH m_locks; /**< All acquired locks in the server. */
+  /** Pre-allocated MDL_lock object for BACKUP namespace. */
+  MDL_lock *m_backup_lock;
+  friend int mdl_iterate(mdl_iterator_callback, void *);
+};
+
+
 static MDL_map mdl_locks;
 
 
@@ -718,9 +882,18 @@ struct mdl_iterate_arg
 {
   mdl_iterator_callback callback;
   void *argument;
+  MDL_lock *lock;
 };
 
 
+static my_bool mdl_iterate_fast_path_tickets(THD *thd, mdl_iterate_arg *arg)
+{
+  return MY_TEST(thd->mdl_context.iterate_fast_path_tickets(arg->lock,
+                                                             arg->callback,
+                                                             arg->argument));
+}
+
+
 static my_bool mdl_iterate_lock(MDL_lock *lock, mdl_iterate_arg *arg)
 {
   int res= FALSE;
@@ -737,6 +910,16 @@ static my_bool mdl_iterate_lock(MDL_lock *lock, mdl_iterate_arg *arg)
   while ((ticket= waiting_it++) && !(res= arg->callback(ticket, arg->argument, false)))
     /* no-op */;
   mysql_prlock_unlock(&lock->m_rwlock);
+
+  /*
+    Locks acquired on the fast path are known only to their contexts.
+    Look for them only if there are some, this is the rare case.
+  */
+  if (!res && (lock->m_fast_path_state & MDL_lock::FAST_PATH_LOCKS))
+  {
+    arg->lock= lock;
+    res= server_threads.iterate(mdl_iterate_fast_path_tickets, arg);
+  }
   return MY_TEST(res);
 }
 
@@ -744,7 +927,7 @@ static my_bool mdl_iterate_lock(MDL_lock *lock, mdl_iterate_arg *arg)
 int mdl_iterate(mdl_iterator_callback callback, void *arg)
 {
   DBUG_ENTER("mdl_iterate");
-  mdl_iterate_arg argument= { callback, arg };
+  mdl_iterate_arg argument= { callback, arg, NULL };
   LF_PINS *pins= mdl_locks.get_pins();
   int res= 1;
 
@@ -844,6 +1027,58 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
 }
 
 
+/**
+  Find MDL_lock object corresponding to the key, create it if it does
+  not exist, and try to acquire an unobtrusive lock on it on the fast
+  path.
+
+  @param[out] lock_arg  MDL_lock on which the lock was acquired, or NULL
+                        if the slow path must be used.
+
+  @retval FALSE  Success.
+  @retval TRUE   Failure (OOM).
+*/
+
+bool MDL_map::fast_path_acquire(LF_PINS *pins, const MDL_key *mdl_key,
+                                MDL_lock::fast_path_state_t increment,
+                                MDL_lock **lock_arg)
+{
+  MDL_lock *lock;
+
+  if (mdl_key->mdl_namespace() == MDL_key::BACKUP)
+  {
+    DBUG_ASSERT(mdl_key->length() == 3);
+    *lock_arg= m_backup_lock->fast_path_acquire(increment) ?
+               m_backup_lock : NULL;
+    return FALSE;
+  }
+
+retry:
+  while (!(lock= (MDL_lock*) lf_hash_search(&m_locks, pins, mdl_key->ptr(),
+                                            mdl_key->length())))
+    if (lf_hash_insert(&m_locks, pins, (uchar*) mdl_key) == -1)
+      return TRUE;
+
+  if (!lock->fast_path_acquire(increment))
+  {
+    /*
+      The pin keeps the object from being reused, so IS_DESTROYED
+      can't be reset under our feet.
+    */
+    bool destroyed= lock->m_fast_path_state & MDL_lock::IS_DESTROYED;
+    lf_hash_search_unpin(pins);
+    if (destroyed)
+      goto retry;
+    lock= NULL;
+  }
+  else
+    lf_hash_search_unpin(pins);
+
+  *lock_arg= lock;
+  return FALSE;
+}
+
+
 /**
  * Return thread id of the owner of the lock, if it is owned.
  */
@@ -887,6 +1122,8 @@ MDL_map::get_lock_owner(LF_PINS *pins, const MDL_key *mdl_key)
 
 void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
 {
+  MDL_lock::fast_path_state_t unused_state= 0;
+
   if (lock->key.mdl_namespace() == MDL_key::BACKUP)
   {
     /* Never destroy pre-allocated MDL_lock object in BACKUP namespace. */
@@ -894,6 +1131,18 @@ void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
     return;
   }
 
+  /*
+    The object is still in use if a lock was acquired on the fast path
+    after we have found it empty. Whoever releases the last of them will
+    try again.
+  */
+  if (!lock->m_fast_path_state.compare_exchange_strong(unused_state,
+                                                       MDL_lock::IS_DESTROYED))
+  {
+    mysql_prlock_unlock(&lock->m_rwlock);
+    return;
+  }
+
   lock->m_strategy= 0;
   mysql_prlock_unlock(&lock->m_rwlock);
   lf_hash_delete(&m_locks, pins, lock->key.ptr(), lock->key.length());
@@ -914,6 +1163,8 @@ MDL_context::MDL_context()
   m_pins(NULL)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  mysql_mutex_init(key_MDL_context_LOCK_fast_path, &m_LOCK_fast_path,
+                   MY_MUTEX_INIT_FAST);
 }
 
 
@@ -934,8 +1185,10 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_STATEMENT].is_empty());
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
+  DBUG_ASSERT(m_fast_path_tickets.is_empty());
 
   mysql_prlock_destroy(&m_LOCK_waiting_for);
+  mysql_mutex_destroy(&m_LOCK_fast_path);
   if (m_pins)
     lf_hash_put_pins(m_pins);
 }
@@ -1502,6 +1755,18 @@ MDL_lock::MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END]=
   MDL_BIT(MDL_EXCLUSIVE), 0, 0, 0, 0, 0, 0, 0, 0
 };
 
+const MDL_lock::fast_path_state_t
+MDL_lock::MDL_scoped_lock::m_unobtrusive_lock_increment[MDL_TYPE_END]=
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+const MDL_lock::bitmap_t
+MDL_lock::MDL_scoped_lock::m_fast_path_granted_types[FAST_PATH_COUNTERS]=
+{
+  0, 0, 0
+};
+
 
 /**
   Compatibility (or rather "incompatibility") matrices for per-object
@@ -1605,6 +1870,39 @@ MDL_lock::MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END]=
 };
 
 
+/**
+  Increments of MDL_lock::m_fast_path_state for per-object metadata locks.
+
+  S, SH, SR and SW locks are "unobtrusive": they are compatible with each
+  other and are the only ones used by DML, so they are acquired on the
+  fast path. SU, SRO, SNW, SNRW and X locks are "obtrusive" and always
+  use the slow path.
+
+  S and SH locks are counted together as they conflict with the same
+  types of requests once granted. SR and SW locks have counters of their
+  own.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_lock::MDL_object_lock::m_unobtrusive_lock_increment[MDL_TYPE_END]=
+{
+  0,
+  1ULL,
+  1ULL,
+  1ULL << FAST_PATH_COUNTER_BITS,
+  1ULL << (2 * FAST_PATH_COUNTER_BITS),
+  0, 0, 0, 0, 0
+};
+
+const MDL_lock::bitmap_t
+MDL_lock::MDL_object_lock::m_fast_path_granted_types[FAST_PATH_COUNTERS]=
+{
+  MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_SHARED_HIGH_PRIO),
+  MDL_BIT(MDL_SHARED_READ),
+  MDL_BIT(MDL_SHARED_WRITE)
+};
+
+
 /**
   Compatibility (or rather "incompatibility") matrices for backup metadata
   lock. Arrays of bitmaps which elements specify which granted/waiting locks
@@ -1716,6 +2014,45 @@ MDL_lock::MDL_backup_lock::m_waiting_incompatible[MDL_BACKUP_END]=
 };
 
 
+/**
+  Increments of MDL_lock::m_fast_path_state for the backup lock.
+
+  DML, TRANS_DML, ALTER_COPY and COMMIT locks, which are taken by every
+  data change, are acquired on the fast path. TRANS_DML and ALTER_COPY
+  conflict with the same types of requests once granted, so they share a
+  counter. SYS_DML and DDL locks are less frequent and use the slow path,
+  like all the locks taken by BACKUP STAGE and FTWRL.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_lock::MDL_backup_lock::m_unobtrusive_lock_increment[MDL_BACKUP_END]=
+{
+  /* MDL_BACKUP_START */
+  0, 0, 0, 0, 0,
+  /* MDL_BACKUP_FTWRL1 */
+  0, 0,
+  /* MDL_BACKUP_DML */
+  1ULL,
+  1ULL << FAST_PATH_COUNTER_BITS,
+  0,
+  /* MDL_BACKUP_DDL */
+  0,
+  /* MDL_BACKUP_BLOCK_DDL */
+  0,
+  1ULL << FAST_PATH_COUNTER_BITS,
+  /* MDL_BACKUP_COMMIT */
+  1ULL << (2 * FAST_PATH_COUNTER_BITS)
+};
+
+const MDL_lock::bitmap_t
+MDL_lock::MDL_backup_lock::m_fast_path_granted_types[FAST_PATH_COUNTERS]=
+{
+  MDL_BIT(MDL_BACKUP_DML),
+  MDL_BIT(MDL_BACKUP_TRANS_DML) | MDL_BIT(MDL_BACKUP_ALTER_COPY),
+  MDL_BIT(MDL_BACKUP_COMMIT)
+};
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1772,6 +2109,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   if (!ignore_lock_priority && (m_waiting.bitmap() & waiting_incompat_map))
     return false;
 
+  /*
+    The requestor has materialized its own fast path locks before
+    requesting an obtrusive lock (or waiting for one), so incompatible
+    fast path locks belong to other contexts.
+  */
+  if (fast_path_granted_bitmap() & granted_incompat_map)
+    return false;
+
   if (m_granted.bitmap() & granted_incompat_map)
   {
     Ticket_iterator it(m_granted);
@@ -1836,6 +2181,7 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
+  obtrusive_lock_removed(ticket->get_type());
   if (is_empty())
     mdl_locks.remove(pins, this);
   else
@@ -1860,6 +2206,41 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 }
 
 
+/**
+  Release a lock acquired on the fast path.
+
+  Takes m_rwlock only if there are obtrusive locks which may wait for
+  this one, or if it is the last lock and the object may be destroyed.
+*/
+
+void MDL_lock::fast_path_release(LF_PINS *pins, fast_path_state_t increment)
+{
+  fast_path_state_t old_state= m_fast_path_state;
+
+  for (;;)
+  {
+    if ((old_state & HAS_OBTRUSIVE) ||
+        ((old_state & FAST_PATH_LOCKS) == increment &&
+         key.mdl_namespace() != MDL_key::BACKUP))
+    {
+      mysql_prlock_wrlock(&m_rwlock);
+      m_fast_path_state.fetch_sub(increment);
+      if (is_empty())
+        mdl_locks.remove(pins, this);
+      else
+      {
+        reschedule_waiters();
+        mysql_prlock_unlock(&m_rwlock);
+      }
+      return;
+    }
+    if (m_fast_path_state.compare_exchange_weak(old_state,
+                                                old_state - increment))
+      return;
+  }
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -1988,6 +2369,96 @@ MDL_context::find_ticket(MDL_request *mdl_request,
 }
 
 
+/**
+  Check if this context may acquire locks on the fast path.
+
+  Contexts which need their conflicting locks to be notified (HANDLER,
+  INSERT DELAYED), and Galera, which aborts the transactions holding
+  conflicting locks, must have all their locks in the granted queues.
+*/
+
+inline bool MDL_context::fast_path_allowed() const
+{
+  return !m_needs_thr_lock_abort && !WSREP_ON;
+}
+
+
+/** Register a ticket which was acquired on the fast path. */
+
+void MDL_context::add_fast_path_ticket(MDL_ticket *ticket)
+{
+  ticket->m_is_fast_path= true;
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.push_front(ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/** Unregister a ticket which was acquired on the fast path. */
+
+void MDL_context::remove_fast_path_ticket(MDL_ticket *ticket)
+{
+  DBUG_ASSERT(ticket->m_is_fast_path);
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.remove(ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+  ticket->m_is_fast_path= false;
+}
+
+
+/**
+  Move all locks of this context which were acquired on the fast path to
+  the granted queues of their MDL_lock objects.
+
+  This is needed before the context requests an obtrusive lock or starts
+  waiting, so that other contexts and the deadlock detector see all its
+  locks.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  MDL_ticket *ticket;
+
+  /* Only the owner modifies the list, so it can read it without a lock. */
+  while ((ticket= m_fast_path_tickets.front()))
+  {
+    MDL_lock *lock= ticket->m_lock;
+
+    mysql_prlock_wrlock(&lock->m_rwlock);
+    remove_fast_path_ticket(ticket);
+    /* The ticket is added to the granted queue before we unlock. */
+    lock->m_fast_path_state.fetch_sub(
+      lock->get_unobtrusive_lock_increment(ticket->m_type));
+    lock->m_granted.add_ticket(ticket);
+    mysql_prlock_unlock(&lock->m_rwlock);
+  }
+}
+
+
+/**
+  Call the callback for all locks of this context on the MDL_lock object
+  which were acquired on the fast path.
+
+  Used by mdl_iterate() from other threads.
+*/
+
+int MDL_context::iterate_fast_path_tickets(const MDL_lock *lock,
+                                           int (*callback)(MDL_ticket *,
+                                                           void *, bool),
+                                           void *arg)
+{
+  int res= 0;
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  Fast_path_ticket_list::Iterator it(m_fast_path_tickets);
+  MDL_ticket *ticket;
+  while (!res && (ticket= it++))
+    if (ticket->m_lock == lock)
+      res= callback(ticket, arg, true);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+  return res;
+}
+
+
 /**
   Try to acquire one lock.
 
@@ -2031,6 +2502,7 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       is no need to release it.
     */
     DBUG_ASSERT(! ticket->m_lock->is_empty());
+    ticket->m_lock->obtrusive_lock_removed(ticket->get_type());
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -2063,6 +2535,7 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
   enum_mdl_duration found_duration;
+  MDL_lock::fast_path_state_t unobtrusive_lock_increment;
 
   /* Don't take chances in production. */
   DBUG_ASSERT(mdl_request->ticket == NULL);
@@ -2115,6 +2588,45 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
+  unobtrusive_lock_increment=
+    MDL_lock::get_unobtrusive_lock_increment(mdl_request);
+
+  if (unobtrusive_lock_increment && fast_path_allowed())
+  {
+    if (mdl_locks.fast_path_acquire(m_pins, key, unobtrusive_lock_increment,
+                                    &lock))
+    {
+      MDL_ticket::destroy(ticket);
+      return TRUE;
+    }
+
+    if (lock)
+    {
+      DBUG_ASSERT(ticket->m_psi == NULL);
+      ticket->m_psi= mysql_mdl_create(ticket,
+                                      &mdl_request->key,
+                                      mdl_request->type,
+                                      mdl_request->duration,
+                                      MDL_ticket::PENDING,
+                                      mdl_request->m_src_file,
+                                      mdl_request->m_src_line);
+      ticket->m_lock= lock;
+      add_fast_path_ticket(ticket);
+      m_tickets[mdl_request->duration].push_front(ticket);
+      mdl_request->ticket= ticket;
+      mysql_mdl_set_status(ticket->m_psi, MDL_ticket::GRANTED);
+      return FALSE;
+    }
+  }
+  else if (!unobtrusive_lock_increment)
+  {
+    /*
+      can_grant_lock() can tell our own locks from the conflicting ones
+      only if they are in the granted queue.
+    */
+    materialize_fast_path_locks();
+  }
+
   /* The below call implicitly locks MDL_lock::m_rwlock on success. */
   if (!(lock= mdl_locks.find_or_insert(m_pins, key)))
   {
@@ -2122,6 +2634,9 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
     return TRUE;
   }
 
+  /* Close the fast path before looking at the fast path locks. */
+  lock->obtrusive_lock_added(mdl_request->type);
+
   DBUG_ASSERT(ticket->m_psi == NULL);
   ticket->m_psi= mysql_mdl_create(ticket,
                                   &mdl_request->key,
@@ -2169,6 +2684,7 @@ bool
 MDL_context::clone_ticket(MDL_request *mdl_request)
 {
   MDL_ticket *ticket;
+  MDL_lock::fast_path_state_t unobtrusive_lock_increment;
 
 
   /*
@@ -2208,9 +2724,22 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
   ticket->m_lock= mdl_request->ticket->m_lock;
   mdl_request->ticket= ticket;
 
-  mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
-  ticket->m_lock->m_granted.add_ticket(ticket);
-  mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  /*
+    We already hold a lock on the object, so it can't be destroyed
+    and the fast path can be tried directly.
+  */
+  unobtrusive_lock_increment=
+    ticket->m_lock->get_unobtrusive_lock_increment(ticket->m_type);
+  if (unobtrusive_lock_increment && fast_path_allowed() &&
+      ticket->m_lock->fast_path_acquire(unobtrusive_lock_increment))
+    add_fast_path_ticket(ticket);
+  else
+  {
+    mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
+    ticket->m_lock->obtrusive_lock_added(ticket->m_type);
+    ticket->m_lock->m_granted.add_ticket(ticket);
+    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  }
 
   m_tickets[mdl_request->duration].push_front(ticket);
 
@@ -2317,6 +2846,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
 
   if (lock_wait_timeout == 0)
   {
+    lock->obtrusive_lock_removed(ticket->get_type());
     mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
     my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
@@ -2577,6 +3107,9 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
       mdl_ticket->get_key()->mdl_namespace() != MDL_key::BACKUP)
     DBUG_RETURN(FALSE);
 
+  /* The ticket to upgrade must be in the granted queue. */
+  materialize_fast_path_locks();
+
   MDL_REQUEST_INIT_BY_KEY(&mdl_xlock_request, &mdl_ticket->m_lock->key,
                           new_type, MDL_TRANSACTION);
 
@@ -2586,19 +3119,39 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   is_new_ticket= ! has_lock(mdl_svp, mdl_xlock_request.ticket);
 
   /* Merge the acquired and the original lock. @todo: move to a method. */
-  mysql_prlock_wrlock(&mdl_ticket->m_lock->m_rwlock);
-  if (is_new_ticket)
-    mdl_ticket->m_lock->m_granted.remove_ticket(mdl_xlock_request.ticket);
+  MDL_lock *lock= mdl_ticket->m_lock;
+  mysql_prlock_wrlock(&lock->m_rwlock);
   /*
     Set the new type of lock in the ticket. To update state of
     MDL_lock object correctly we need to temporarily exclude
     ticket from the granted queue and then include it back.
+    Account for the new type first, so that the fast path can't
+    be opened in between.
   */
-  mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
+  lock->m_granted.remove_ticket(mdl_ticket);
+  lock->obtrusive_lock_added(new_type);
+  lock->obtrusive_lock_removed(mdl_ticket->m_type);
   mdl_ticket->m_type= new_type;
-  mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  lock->m_granted.add_ticket(mdl_ticket);
+
+  if (is_new_ticket)
+  {
+    MDL_ticket *new_ticket= mdl_xlock_request.ticket;
+    if (new_ticket->m_is_fast_path)
+    {
+      /* The object is still locked by mdl_ticket, it can't go away. */
+      remove_fast_path_ticket(new_ticket);
+      lock->m_fast_path_state.fetch_sub(
+        lock->get_unobtrusive_lock_increment(new_ticket->m_type));
+    }
+    else
+    {
+      lock->m_granted.remove_ticket(new_ticket);
+      lock->obtrusive_lock_removed(new_ticket->m_type);
+    }
+  }
 
-  mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
+  mysql_prlock_unlock(&lock->m_rwlock);
 
   if (is_new_ticket)
   {
@@ -2874,7 +3427,14 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   DBUG_ASSERT(this == ticket->get_ctx());
 
-  lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    remove_fast_path_ticket(ticket);
+    lock->fast_path_release(m_pins,
+                            lock->get_unobtrusive_lock_increment(ticket->m_type));
+  }
+  else
+    lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2983,12 +3543,16 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
                (m_type == MDL_BACKUP_DDL ||
                 m_type == MDL_BACKUP_WAIT_FLUSH)));
 
+  DBUG_ASSERT(!m_is_fast_path);
+
   mysql_prlock_wrlock(&m_lock->m_rwlock);
   /*
     To update state of MDL_lock object correctly we need to temporarily
     exclude ticket from the granted queue and then include it back.
   */
   m_lock->m_granted.remove_ticket(this);
+  m_lock->obtrusive_lock_added(type);
+  m_lock->obtrusive_lock_removed(m_type);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
   m_lock->reschedule_waiters();
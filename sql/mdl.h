@@ -697,6 +697,8 @@ class MDL_ticket : public MDL_wait_for_subgraph
   /**
     Pointers for participating in the list of satisfied/pending requests
     for the lock. Externally accessible.
+    Tickets acquired on the fast path are not in any list of the lock,
+    and use these pointers for MDL_context::m_fast_path_tickets instead.
   */
   MDL_ticket *next_in_lock;
   MDL_ticket **prev_in_lock;
@@ -748,6 +750,7 @@ class MDL_ticket : public MDL_wait_for_subgraph
 #endif
      m_ctx(ctx_arg),
      m_lock(NULL),
+     m_is_fast_path(false),
      m_psi(NULL)
   {}
 
@@ -782,6 +785,13 @@ class MDL_ticket : public MDL_wait_for_subgraph
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock was acquired on the fast path, i.e. it is only
+    counted in MDL_lock::m_fast_path_state and is not in the granted
+    queue of the lock. Context private.
+  */
+  bool m_is_fast_path;
+
   PSI_metadata_lock *m_psi;
 
 private:
@@ -878,6 +888,12 @@ class MDL_context
 
   typedef Ticket_list::Iterator Ticket_iterator;
 
+  typedef I_P_List<MDL_ticket,
+                   I_P_List_adapter<MDL_ticket,
+                                    &MDL_ticket::next_in_lock,
+                                    &MDL_ticket::prev_in_lock> >
+          Fast_path_ticket_list;
+
   MDL_context();
   void destroy();
 
@@ -952,6 +968,12 @@ class MDL_context
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+    /*
+      MDL_lock::notify_conflicting_locks() only sees tickets in the
+      granted queue, so such a context must not keep fast path locks.
+    */
+    if (needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -1048,6 +1070,15 @@ class MDL_context
    */
   MDL_wait_for_subgraph *m_waiting_for;
   LF_PINS *m_pins;
+  /**
+    Tickets of this context which were acquired on the fast path.
+    Only needed to show them in INFORMATION_SCHEMA.METADATA_LOCK_INFO,
+    as other contexts can't see them in the queues of MDL_lock.
+    Modified only by the owner of the context, protected by
+    m_LOCK_fast_path.
+  */
+  Fast_path_ticket_list m_fast_path_tickets;
+  mysql_mutex_t m_LOCK_fast_path;
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
@@ -1055,6 +1086,10 @@ class MDL_context
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
+  inline bool fast_path_allowed() const;
+  void add_fast_path_ticket(MDL_ticket *ticket);
+  void remove_fast_path_ticket(MDL_ticket *ticket);
+  void materialize_fast_path_locks();
   bool fix_pins();
 
 public:
@@ -1065,10 +1100,18 @@ class MDL_context
   ulong get_thread_id() const { return thd_get_thread_id(get_thd()); }
 
   bool visit_subgraph(MDL_wait_for_graph_visitor *dvisitor);
+  int iterate_fast_path_tickets(const MDL_lock *lock,
+                                int (*callback)(MDL_ticket *, void *, bool),
+                                void *arg);
 
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /*
+      The deadlock detector follows edges only to the tickets in the
+      granted queues, so make our fast path locks visible to it first.
+    */
+    materialize_fast_path_locks();
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
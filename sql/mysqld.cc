@@ -112,6 +112,8 @@
 #include <errmsg.h>
 #include "sp_rcontext.h"
 #include "sp_cache.h"
+#include "filesort_utils.h"
+#include "sql_statistics.h"  // statistics_thread_pool_end
 #include "sql_reload.h"  // reload_acl_and_cache
 #include "sp_head.h"  // init_sp_psi_keys
 
@@ -397,6 +399,7 @@ my_bool opt_skip_slave_start = 0; ///< If set, slave is not autostarted
 my_bool opt_reckless_slave = 0;
 my_bool opt_enable_named_pipe= 0;
 my_bool opt_local_infile, opt_slave_compressed_protocol;
+ulong opt_slave_compression_algorithm= MY_COMPRESS_ZLIB;
 my_bool opt_safe_user_create = 0;
 my_bool opt_show_slave_auth_info;
 my_bool opt_log_slave_updates= 0;
@@ -468,6 +471,8 @@ ulong slave_exec_mode_options;
 ulong slave_run_triggers_for_rbr= 0;
 ulong slave_ddl_exec_mode_options= SLAVE_EXEC_MODE_IDEMPOTENT;
 ulonglong slave_type_conversions_options;
+ulonglong slave_rows_search_algorithms_options=
+  1ULL << SLAVE_ROWS_INDEX_SCAN;
 ulong thread_cache_size=0;
 ulonglong binlog_cache_size=0;
 ulonglong binlog_file_cache_size=0;
@@ -480,6 +485,7 @@ ulonglong query_cache_size=0;
 ulong query_cache_limit=0;
 ulong executed_events=0;
 Atomic_counter<query_id_t> global_query_id;
+Atomic_counter<uint64_t> join_plan_cache_version;
 ulong aborted_threads, aborted_connects, aborted_connects_preauth;
 ulong delayed_insert_timeout, delayed_insert_limit, delayed_queue_size;
 ulong delayed_insert_threads, delayed_insert_writes, delayed_rows_in_use;
@@ -622,6 +628,8 @@ ulong connection_errors_internal= 0;
 ulong connection_errors_max_connection= 0;
 /** Number of errors when reading the peer address. */
 ulong connection_errors_peer_addr= 0;
+/** Number of connections that use each protocol compression algorithm. */
+ulong compressed_connections[MY_COMPRESS_ALGORITHMS];
 
 /* classes for comparation parsing/processing */
 Eq_creator eq_creator;
@@ -861,7 +869,7 @@ PSI_file_key key_file_binlog,  key_file_binlog_cache, key_file_binlog_index,
 PSI_file_key key_file_query_log, key_file_slow_log;
 PSI_file_key key_file_relaylog, key_file_relaylog_index,
              key_file_relaylog_cache, key_file_relaylog_index_cache;
-PSI_file_key key_file_binlog_state;
+PSI_file_key key_file_binlog_state, key_file_binlog_gtid_index;
 
 #ifdef HAVE_PSI_INTERFACE
 #ifdef HAVE_MMAP
@@ -1204,6 +1212,7 @@ void init_net_server_extension(THD *thd)
   thd->m_net_server_extension.m_user_data= thd;
   thd->m_net_server_extension.m_before_header= net_before_header_psi;
   thd->m_net_server_extension.m_after_header= net_after_header_psi;
+  thd->m_net_server_extension.m_compress_stream= NULL;
   /* Activate this private extension for the mysqld server. */
   thd->net.extension= & thd->m_net_server_extension;
 }
@@ -1438,6 +1447,7 @@ int deny_severity = LOG_WARNING;
 #endif
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
+ulong query_cache_partitions= 1;
 Query_cache query_cache;
 #endif
 
@@ -2007,6 +2017,8 @@ static void clean_up(bool print_message)
   wt_end();
   multi_keycache_free();
   sp_cache_end();
+  filesort_thread_pool_end();
+  statistics_thread_pool_end();
   free_status_vars();
   end_thr_alarm(1);			/* Free allocated memory */
   end_thr_timer();
@@ -3740,6 +3752,7 @@ static int init_common_variables()
   connection_errors_internal= 0;
   connection_errors_max_connection= 0;
   connection_errors_peer_addr= 0;
+  bzero(compressed_connections, sizeof(compressed_connections));
   my_decimal_set_zero(&decimal_zero); // set decimal_zero constant;
 
   init_libstrings();
@@ -6809,6 +6822,9 @@ struct my_option my_long_options[]=
    "effort to avoid any conflicts. \"aggressive\" tries to maximise the "
    "parallelism, possibly at the cost of increased conflict rate. "
    "\"minimal\" only parallelizes the commit steps of transactions. "
+   "\"writeset\" is like \"conservative\", but also applies transactions "
+   "in parallel that change different rows according to the writesets "
+   "logged by the master (see --binlog-writeset-max-keys). "
    "\"none\" disables parallel apply completely.",
    &opt_slave_parallel_mode, &opt_slave_parallel_mode,
    &slave_parallel_mode_typelib, GET_ENUM | GET_ASK_ADDR, REQUIRED_ARG,
@@ -6955,6 +6971,39 @@ static int show_net_compression(THD *thd, SHOW_VAR *var, char *buff,
   return 0;
 }
 
+static int show_net_compression_algorithm(THD *thd, SHOW_VAR *var, char *buff,
+                                          enum enum_var_type scope)
+{
+  var->type= SHOW_CHAR;
+  var->value= const_cast<char*>(thd->net.compress ?
+                                my_compress_algorithm_names
+                                [thd->net.compress_algorithm] : "");
+  return 0;
+}
+
+/*
+  Compressed_connections_<algorithm>, for the algorithms that the server
+  was built with
+*/
+static int show_compressed_connections(THD *thd, SHOW_VAR *var, char *buff,
+                                       enum enum_var_type scope)
+{
+  SHOW_VAR *v= (SHOW_VAR *) buff;
+  var->type= SHOW_ARRAY;
+  var->value= buff;
+  for (uint i= 0; i < MY_COMPRESS_ALGORITHMS; i++)
+  {
+    if (!my_compress_stream_supported(i))
+      continue;
+    v->name= my_compress_algorithm_names[i];
+    v->value= (char*) &compressed_connections[i];
+    v->type= SHOW_LONG;
+    v++;
+  }
+  v->name= 0;
+  return 0;
+}
+
 static int show_starttime(THD *thd, SHOW_VAR *var, char *buff,
                           enum enum_var_type scope)
 {
@@ -7362,6 +7411,55 @@ static int show_default_keycache(THD *thd, SHOW_VAR *var, char *buff,
 }
 
 
+#ifdef HAVE_QUERY_CACHE
+/*
+  The query cache statistics are summed over the partitions, see
+  query_cache_partitions. The counters are reset by FLUSH STATUS in
+  refresh_status().
+*/
+
+static int show_query_cache_status(THD *thd, SHOW_VAR *var, char *buff,
+                                   enum enum_var_type scope)
+{
+  struct st_data {
+    Query_cache_status status;
+    SHOW_VAR var[9];
+  } *data;
+  SHOW_VAR *v;
+
+  data=(st_data *)buff;
+  v= data->var;
+
+  var->type= SHOW_ARRAY;
+  var->value= v;
+
+  query_cache.get_status(&data->status);
+
+#define set_one_qcache_var(X,Y)         \
+  v->name= X;                           \
+  v->type= SHOW_LONG_NOFLUSH;           \
+  v->value= (char*) &data->status.Y;    \
+  v++;
+
+  set_one_qcache_var("free_blocks",      free_memory_blocks);
+  set_one_qcache_var("free_memory",      free_memory);
+  set_one_qcache_var("hits",             hits);
+  set_one_qcache_var("inserts",          inserts);
+  set_one_qcache_var("lowmem_prunes",    lowmem_prunes);
+  set_one_qcache_var("not_cached",       refused);
+  set_one_qcache_var("queries_in_cache", queries_in_cache);
+  set_one_qcache_var("total_blocks",     total_blocks);
+
+  v->name= 0;
+
+  DBUG_ASSERT((char*)(v+1) <= buff + SHOW_VAR_FUNC_BUFF_SIZE);
+
+#undef set_one_qcache_var
+
+  return 0;
+}
+#endif /*HAVE_QUERY_CACHE*/
+
 static int show_memory_used(THD *thd, SHOW_VAR *var, char *buff,
                             struct system_status_var *status_var,
                             enum enum_var_type scope)
@@ -7446,7 +7544,9 @@ SHOW_VAR status_vars[]= {
   {"Column_compressions",      (char*) offsetof(STATUS_VAR, column_compressions), SHOW_LONG_STATUS},
   {"Column_decompressions",    (char*) offsetof(STATUS_VAR, column_decompressions), SHOW_LONG_STATUS},
   {"Com",                      (char*) com_status_vars, SHOW_ARRAY},
+  {"Compressed_connections",   (char*) &show_compressed_connections, SHOW_FUNC},
   {"Compression",              (char*) &show_net_compression, SHOW_SIMPLE_FUNC},
+  {"Compression_algorithm",    (char*) &show_net_compression_algorithm, SHOW_SIMPLE_FUNC},
   {"Connections",              (char*) &global_thread_id,         SHOW_LONG_NOFLUSH},
   {"Connection_errors_accept", (char*) &connection_errors_accept, SHOW_LONG},
   {"Connection_errors_internal", (char*) &connection_errors_internal, SHOW_LONG},
@@ -7532,6 +7632,9 @@ SHOW_VAR status_vars[]= {
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONG_STATUS},
   {"Opened_views",             (char*) offsetof(STATUS_VAR, opened_views), SHOW_LONG_STATUS},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_SIMPLE_FUNC},
+  {"Prepared_stmt_plan_cache_hits", (char*) offsetof(STATUS_VAR, ps_plan_cache_hits), SHOW_LONG_STATUS},
+  {"Prepared_stmt_plan_cache_invalidations", (char*) offsetof(STATUS_VAR, ps_plan_cache_invalidations), SHOW_LONG_STATUS},
+  {"Prepared_stmt_plan_cache_misses", (char*) offsetof(STATUS_VAR, ps_plan_cache_misses), SHOW_LONG_STATUS},
   {"Rows_sent",                (char*) offsetof(STATUS_VAR, rows_sent), SHOW_LONGLONG_STATUS},
   {"Rows_read",                (char*) offsetof(STATUS_VAR, rows_read), SHOW_LONGLONG_STATUS},
   {"Rows_tmp_read",            (char*) offsetof(STATUS_VAR, rows_tmp_read), SHOW_LONGLONG_STATUS},
@@ -7556,14 +7659,7 @@ SHOW_VAR status_vars[]= {
   {"Rpl_semi_sync_slave_send_ack", (char*) &rpl_semi_sync_slave_send_ack, SHOW_LONGLONG},
 #endif /* HAVE_REPLICATION */
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache",                   (char*) &show_query_cache_status, SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_SIMPLE_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONG_STATUS},
@@ -9144,6 +9240,9 @@ void refresh_status(THD *thd)
 
   /* Reset the counters of all key caches (default and named). */
   process_key_caches(reset_key_cache_counters, 0);
+#ifdef HAVE_QUERY_CACHE
+  query_cache.reset_status();
+#endif
   flush_status_time= time((time_t*) 0);
   mysql_mutex_unlock(&LOCK_status);
 
@@ -9193,7 +9292,8 @@ static PSI_file_info all_server_files[]=
   { &key_file_trg, "trigger_name", 0},
   { &key_file_trn, "trigger", 0},
   { &key_file_init, "init", 0},
-  { &key_file_binlog_state, "binlog_state", 0}
+  { &key_file_binlog_state, "binlog_state", 0},
+  { &key_file_binlog_gtid_index, "binlog_gtid_index", 0}
 };
 #endif /* HAVE_PSI_INTERFACE */
 
@@ -70,7 +70,8 @@ enum enum_slave_parallel_mode {
   SLAVE_PARALLEL_MINIMAL,
   SLAVE_PARALLEL_CONSERVATIVE,
   SLAVE_PARALLEL_OPTIMISTIC,
-  SLAVE_PARALLEL_AGGRESSIVE
+  SLAVE_PARALLEL_AGGRESSIVE,
+  SLAVE_PARALLEL_WRITESET
 };
 
 /* Function prototypes */
@@ -122,6 +123,7 @@ extern Atomic_counter<uint> connection_count;
 extern my_bool opt_safe_user_create;
 extern my_bool opt_safe_show_db, opt_local_infile, opt_myisam_use_mmap;
 extern my_bool opt_slave_compressed_protocol, use_temp_pool;
+extern ulong opt_slave_compression_algorithm;
 extern ulong slave_exec_mode_options, slave_ddl_exec_mode_options;
 extern ulong slave_retried_transactions;
 extern ulong transactions_multi_engine;
@@ -129,6 +131,7 @@ extern ulong rpl_transactions_multi_engine;
 extern ulong transactions_gtid_foreign_engine;
 extern ulong slave_run_triggers_for_rbr;
 extern ulonglong slave_type_conversions_options;
+extern ulonglong slave_rows_search_algorithms_options;
 extern my_bool read_only, opt_readonly;
 extern MYSQL_PLUGIN_IMPORT my_bool lower_case_file_system;
 extern my_bool opt_enable_named_pipe, opt_sync_frm, opt_allow_suspicious_udfs;
@@ -224,6 +227,7 @@ extern int32 slave_open_temp_tables;
 extern ulonglong query_cache_size;
 extern ulong query_cache_limit;
 extern ulong query_cache_min_res_unit;
+extern ulong query_cache_partitions;
 extern ulong slow_launch_threads, slow_launch_time;
 extern MYSQL_PLUGIN_IMPORT ulong max_connections;
 extern uint max_digest_length;
@@ -294,6 +298,7 @@ extern ulong connection_errors_tcpwrap;
 extern ulong connection_errors_internal;
 extern ulong connection_errors_max_connection;
 extern ulong connection_errors_peer_addr;
+extern ulong compressed_connections[MY_COMPRESS_ALGORITHMS];
 extern ulong log_warnings;
 extern my_bool encrypt_binlog;
 extern my_bool encrypt_tmp_disk_tables, encrypt_tmp_files;
@@ -402,7 +407,7 @@ extern PSI_file_key key_file_relaylog, key_file_relaylog_index,
                     key_file_relaylog_cache, key_file_relaylog_index_cache;
 extern PSI_socket_key key_socket_tcpip, key_socket_unix,
   key_socket_client_connection;
-extern PSI_file_key key_file_binlog_state;
+extern PSI_file_key key_file_binlog_state, key_file_binlog_gtid_index;
 
 #ifdef HAVE_PSI_INTERFACE
 void init_server_psi_keys();
@@ -893,6 +898,9 @@ enum enum_query_type
 /* query_id */
 extern Atomic_counter<query_id_t> global_query_id;
 
+/* Bumped when table statistics change, see Join_plan_cache */
+extern Atomic_counter<uint64_t> join_plan_cache_version;
+
 /* increment query_id and return it.  */
 inline __attribute__((warn_unused_result)) query_id_t next_query_id()
 {
@@ -955,6 +963,8 @@ extern my_bool opt_slave_sql_verify_checksum;
 extern my_bool opt_mysql56_temporal_format, strict_password_validation;
 extern my_bool opt_explicit_defaults_for_timestamp;
 extern ulong binlog_checksum_options;
+extern my_bool opt_binlog_gtid_index;
+extern uint opt_binlog_gtid_index_span_min;
 extern bool max_user_connections_checking;
 extern ulong opt_binlog_dbug_fsync_sleep;
 
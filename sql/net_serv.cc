@@ -122,12 +122,12 @@ extern void query_cache_insert(void *thd, const char *packet, size_t length,
 #endif // HAVE_QUERY_CACHE
 #define update_statistics(A) A
 extern my_bool thd_net_is_killed(THD *thd);
-/* Additional instrumentation hooks for the server */
-#include "mysql_com_server.h"
 #else
 #define update_statistics(A)
 #define thd_net_is_killed(A) 0
 #endif
+/* Additional instrumentation hooks and compression state for the server */
+#include "mysql_com_server.h"
 
 
 static my_bool net_write_buff(NET *, const uchar *, size_t len);
@@ -149,7 +149,8 @@ my_bool my_net_init(NET *net, Vio *vio, void *thd, uint my_flags)
   net->error=0; net->return_status=0;
   net->pkt_nr=net->compress_pkt_nr=0;
   net->last_error[0]=0;
-  net->compress=0; net->reading_or_writing=0;
+  net->compress=0; net->compress_algorithm= MY_COMPRESS_ZLIB;
+  net->reading_or_writing=0;
   net->where_b = net->remain_in_buf=0;
   net->net_skip_rest_factor= 0;
   net->last_errno=0;
@@ -195,10 +196,80 @@ void net_end(NET *net)
   DBUG_ENTER("net_end");
   my_free(net->buff);
   net->buff=0;
+#ifdef MYSQL_SERVER
+  if (NET_SERVER *ext= static_cast<NET_SERVER*>(net->extension))
+  {
+    my_compress_stream_end(ext->m_compress_stream);
+    ext->m_compress_stream= NULL;
+  }
+#endif
   DBUG_VOID_RETURN;
 }
 
 
+#ifdef HAVE_COMPRESS
+/** The compression stream of a connection, NULL for plain zlib. */
+static inline MY_COMPRESS_STREAM *net_compress_stream(NET *net)
+{
+#ifdef MYSQL_SERVER
+  if (NET_SERVER *ext= static_cast<NET_SERVER*>(net->extension))
+    return ext->m_compress_stream;
+#endif
+  return NULL;
+}
+#endif
+
+
+/**
+  Start using the compressed protocol, after the handshake.
+
+  Connections with a NET_SERVER extension get a compression stream, which
+  is what allows other algorithms than zlib and a compression level.
+  Others can only use zlib with the default level, like in my_compress().
+
+  @param net        the connection
+  @param algorithm  MY_COMPRESS_*, as negotiated with the peer
+  @param level      compression level, 0 for the default of the algorithm
+
+  @retval 0 ok
+  @retval 1 out of memory, or the algorithm is not supported
+*/
+
+my_bool my_net_set_compression(NET *net, uint algorithm, uint level)
+{
+  DBUG_ENTER("my_net_set_compression");
+  DBUG_PRINT("enter", ("algorithm: %u  level: %u", algorithm, level));
+#ifdef MYSQL_SERVER
+  if (NET_SERVER *ext= static_cast<NET_SERVER*>(net->extension))
+  {
+    DBUG_ASSERT(!ext->m_compress_stream);
+    if (!(ext->m_compress_stream=
+          my_compress_stream_init(algorithm, level,
+                                  MYF(net->thread_specific_malloc ?
+                                      MY_THREAD_SPECIFIC : 0))))
+      DBUG_RETURN(1);
+  }
+  else
+#endif
+  if (algorithm != MY_COMPRESS_ZLIB)
+    DBUG_RETURN(1);
+  net->compress= 1;
+  net->compress_algorithm= (uchar) algorithm;
+  DBUG_RETURN(0);
+}
+
+
+/** Change the compression level of a compressed connection. */
+
+void my_net_set_compression_level(NET *net, uint level)
+{
+#ifdef HAVE_COMPRESS
+  if (MY_COMPRESS_STREAM *stream= net_compress_stream(net))
+    my_compress_stream_set_level(stream, level);
+#endif
+}
+
+
 /** Realloc the packet buffer. */
 
 my_bool net_realloc(NET *net, size_t length)
@@ -639,8 +710,11 @@ net_real_write(NET *net,const uchar *packet, size_t len)
     size_t complen;
     uchar *b;
     uint header_length=NET_HEADER_SIZE+COMP_HEADER_SIZE;
+    MY_COMPRESS_STREAM *stream= net_compress_stream(net);
+    size_t buff_length= stream ? my_compress_stream_bound(stream, len) : len;
     if (!(b= (uchar*) my_malloc(key_memory_NET_compress_packet,
-                                len + NET_HEADER_SIZE + COMP_HEADER_SIZE + 1,
+                                buff_length + NET_HEADER_SIZE +
+                                COMP_HEADER_SIZE + 1,
                                 MYF(MY_WME | (net->thread_specific_malloc
                                               ? MY_THREAD_SPECIFIC : 0)))))
     {
@@ -650,11 +724,40 @@ net_real_write(NET *net,const uchar *packet, size_t len)
       net->reading_or_writing= 0;
       DBUG_RETURN(1);
     }
-    memcpy(b+header_length,packet,len);
 
-    /* Don't compress error packets (compress == 2) */
-    if (net->compress == 2 || my_compress(b+header_length, &len, &complen))
-      complen=0;
+    if (stream)
+    {
+      /*
+        Don't compress error packets (compress == 2) or short packets.
+        This must be decided here: a zstd stream has to send whatever
+        went through the compressor.
+      */
+      complen= 0;
+      if (net->compress != 2 && len >= MIN_COMPRESS_LENGTH)
+      {
+        complen= buff_length;
+        if (my_compress_stream(stream, b+header_length, &complen, packet, len))
+        {
+          my_free(b);
+          net->error= 2;
+          net->last_errno= ER_OUT_OF_RESOURCES;
+          net->reading_or_writing= 0;
+          DBUG_RETURN(1);
+        }
+      }
+      if (complen)
+        swap_variables(size_t, len, complen);
+      else
+        memcpy(b+header_length,packet,len);
+    }
+    else
+    {
+      memcpy(b+header_length,packet,len);
+
+      /* Don't compress error packets (compress == 2) */
+      if (net->compress == 2 || my_compress(b+header_length, &len, &complen))
+        complen=0;
+    }
     int3store(&b[NET_HEADER_SIZE],complen);
     int3store(b,len);
     b[3]=(uchar) (net->compress_pkt_nr++);
@@ -936,6 +1039,9 @@ my_real_read(NET *net, size_t *complen,
   if (header)
   {
     server_extension= static_cast<st_net_server*> (net->extension);
+    /* Connections to other servers have no callbacks */
+    if (server_extension != NULL && !server_extension->m_before_header)
+      server_extension= NULL;
     if (server_extension != NULL)
     {
       void *user_data= server_extension->m_user_data;
@@ -1355,8 +1461,11 @@ my_net_read_packet_reallen(NET *net, my_bool read_from_server, ulong* reallen)
 	return packet_error;
       }
       read_from_server= 0;
-      if (my_uncompress(net->buff + net->where_b, packet_len,
-			&complen))
+      MY_COMPRESS_STREAM *stream= net_compress_stream(net);
+      if (stream ?
+          my_uncompress_stream(stream, net->buff + net->where_b, packet_len,
+                               &complen) :
+          my_uncompress(net->buff + net->where_b, packet_len, &complen))
       {
 	net->error= 2;			/* caller will close socket */
         net->last_errno= ER_NET_UNCOMPRESS_ERROR;
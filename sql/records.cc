@@ -517,6 +517,72 @@ int rr_sequential(READ_RECORD *info)
 }
 
 
+/**
+  Make a table scan that init_read_record() set up with rr_sequential
+  read the rows in batches with handler::ha_rnd_next_batch().
+
+  @param info      READ_RECORD using rr_sequential
+  @param buf       buffer for max_rows rows of table->s->rec_buff_length
+                   bytes each
+  @param max_rows  maximum number of rows to read ahead
+
+  The first batch is small, so that a scan that is stopped early (for
+  example by LIMIT) does not read much ahead. Every following batch is
+  twice as large, up to max_rows.
+*/
+
+void init_read_record_batch(READ_RECORD *info, uchar *buf, uint max_rows)
+{
+  DBUG_ASSERT(info->read_record_func == rr_sequential);
+  DBUG_ASSERT(max_rows > 1);
+  info->batch_buf= info->batch_pos= info->batch_end= buf;
+  info->batch_max_rows= max_rows;
+  info->batch_rows= MY_MIN(max_rows, 8);
+  info->batch_error= 0;
+  info->reclength= info->table->s->rec_buff_length;
+  info->read_record_func= rr_sequential_batch;
+}
+
+
+int rr_sequential_batch(READ_RECORD *info)
+{
+  TABLE *table= info->table;
+
+  if (info->batch_pos == info->batch_end)
+  {
+    int error= info->batch_error;
+    if (!error)
+    {
+      uint n_rows;
+      error= table->file->ha_rnd_next_batch(info->batch_buf,
+                                            info->batch_rows, &n_rows);
+      if (error == HA_ERR_WRONG_COMMAND && !n_rows)
+      {
+        /* The engine cannot read this scan in batches */
+        info->read_record_func= rr_sequential;
+        return rr_sequential(info);
+      }
+      info->batch_error= error;
+      info->batch_pos= info->batch_buf;
+      info->batch_end= info->batch_buf + n_rows * info->reclength;
+      info->batch_rows= MY_MIN(info->batch_rows * 2, info->batch_max_rows);
+    }
+    if (info->batch_pos == info->batch_end)
+    {
+      table->file->update_rnd_batch_statistics(false);
+      table->status= STATUS_NOT_FOUND;
+      return rr_handle_error(info, error);
+    }
+  }
+
+  memcpy(table->record[0], info->batch_pos, table->s->reclength);
+  info->batch_pos+= info->reclength;
+  table->status= 0;
+  table->file->update_rnd_batch_statistics(true);
+  return 0;
+}
+
+
 static int rr_from_tempfile(READ_RECORD *info)
 {
   int tmp;
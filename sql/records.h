@@ -69,6 +69,16 @@ struct READ_RECORD
   uchar *rec_buf;                /* to read field values  after filesort */
   uchar	*cache,*cache_pos,*cache_end,*read_positions;
 
+  /*
+    Rows read ahead by rr_sequential_batch(): batch_pos..batch_end are
+    the rows not returned yet, and batch_error is the error that ended
+    the last batch. The buffer is owned by the caller of
+    init_read_record_batch().
+  */
+  uchar *batch_buf, *batch_pos, *batch_end;
+  uint batch_rows, batch_max_rows;
+  int batch_error;
+
   /*
     Structure storing information about sorting
   */
@@ -98,5 +108,7 @@ bool init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table,
                           bool print_error, uint idx, bool reverse);
 
 void rr_unlock_row(st_join_table *tab);
+void init_read_record_batch(READ_RECORD *info, uchar *buf, uint max_rows);
+int rr_sequential_batch(READ_RECORD *info);
 
 #endif /* SQL_RECORDS_H */
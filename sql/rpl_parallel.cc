@@ -2193,6 +2193,110 @@ rpl_parallel_entry::choose_thread(rpl_group_info *rgi, bool *did_enter_cond,
   return thr;
 }
 
+static inline uint32
+writeset_slot(uint64 hash, uint32 size)
+{
+  return (uint32) ((hash * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+
+/* Slots are zero when empty, so a zero hash is stored as 1. */
+static inline uint64
+writeset_key(uint64 hash)
+{
+  return hash ? hash : 1;
+}
+
+
+bool
+rpl_parallel_writeset::intersects(const uint64 *hashes, uint32 n) const
+{
+  if (!count)
+    return false;
+  for (uint32 i= 0; i < n; i++)
+  {
+    uint64 key= writeset_key(hashes[i]);
+    for (uint32 j= writeset_slot(key, size); slots[j]; j= (j + 1) & (size - 1))
+      if (slots[j] == key)
+        return true;
+  }
+  return false;
+}
+
+
+void
+rpl_parallel_writeset::add(const uint64 *hashes, uint32 n)
+{
+  if (!open)
+    return;
+  if (n > MAX_HASHES - count)
+  {
+    open= false;
+    return;
+  }
+  /* Keep the load factor at most 1/2. */
+  if ((count + n) * 2 > size)
+  {
+    uint32 new_size= MY_MAX(1024, my_round_up_to_next_power((count + n) * 2));
+    uint64 *new_slots;
+    if (!(new_slots= (uint64 *)my_malloc(PSI_INSTRUMENT_ME,
+                                         new_size * sizeof(uint64),
+                                         MYF(MY_ZEROFILL))))
+    {
+      open= false;
+      return;
+    }
+    for (uint32 i= 0; i < size; i++)
+    {
+      if (!slots[i])
+        continue;
+      uint32 j= writeset_slot(slots[i], new_size);
+      while (new_slots[j])
+        j= (j + 1) & (new_size - 1);
+      new_slots[j]= slots[i];
+    }
+    my_free(slots);
+    slots= new_slots;
+    size= new_size;
+  }
+  for (uint32 i= 0; i < n; i++)
+  {
+    uint64 key= writeset_key(hashes[i]);
+    uint32 j= writeset_slot(key, size);
+    while (slots[j] && slots[j] != key)
+      j= (j + 1) & (size - 1);
+    if (!slots[j])
+    {
+      slots[j]= key;
+      count++;
+    }
+  }
+}
+
+
+/* Empty the set for a new gco. */
+void
+rpl_parallel_writeset::clear()
+{
+  /* Do not keep clearing a big table after one big transaction. */
+  if (size > 4096 && count * 16 < size)
+    free();
+  else if (count)
+    bzero(slots, size * sizeof(uint64));
+  count= 0;
+  open= true;
+}
+
+
+void
+rpl_parallel_writeset::free()
+{
+  my_free(slots);
+  slots= NULL;
+  size= count= 0;
+}
+
+
 static void
 free_rpl_parallel_entry(void *element)
 {
@@ -2203,6 +2307,7 @@ free_rpl_parallel_entry(void *element)
     dealloc_gco(e->current_gco);
     e->current_gco= prev_gco;
   }
+  e->writeset.free();
   mysql_cond_destroy(&e->COND_parallel_entry);
   mysql_mutex_destroy(&e->LOCK_parallel_entry);
   my_free(e);
@@ -2803,6 +2908,26 @@ rpl_parallel::do_event(rpl_group_info *serial_rgi, Log_event *ev,
         */
         new_gco= false;
       }
+      else if (mode == SLAVE_PARALLEL_WRITESET)
+      {
+        /*
+          In writeset mode, the master logged the keys of the rows changed by
+          each transaction. A transaction that changes none of the rows
+          changed by the transactions in the current gco can run in parallel
+          with them, even if they did not group commit together on the master.
+          There is no speculation; only transactional event groups join, so
+          any lock wait between them (eg. on gaps of non-unique indexes) is
+          resolved with the usual deadlock kill and retry.
+        */
+        if (!(flags & group_commit_orderer::FORCE_SWITCH) &&
+            (gtid_flags & Gtid_log_event::FL_TRANSACTIONAL) &&
+            (gtid_flags & Gtid_log_event::FL_ALLOW_PARALLEL) &&
+            (gtid_ev->flags_extra & Gtid_log_event::FL_EXTRA_WRITESET) &&
+            e->writeset.open &&
+            !e->writeset.intersects(gtid_ev->writeset,
+                                    gtid_ev->writeset_count))
+          new_gco= false;
+      }
       else if ((mode >= SLAVE_PARALLEL_OPTIMISTIC) &&
                !(flags & group_commit_orderer::FORCE_SWITCH))
       {
@@ -2876,8 +3001,18 @@ rpl_parallel::do_event(rpl_group_info *serial_rgi, Log_event *ev,
       }
       gco->flags|= force_switch_flag;
       e->current_gco= gco;
+      if (mode == SLAVE_PARALLEL_WRITESET)
+        e->writeset.clear();
     }
     rgi->gco= gco;
+    if (mode == SLAVE_PARALLEL_WRITESET)
+    {
+      /* Later event groups can only join if they conflict with none in gco */
+      if (gtid_ev->flags_extra & Gtid_log_event::FL_EXTRA_WRITESET)
+        e->writeset.add(gtid_ev->writeset, gtid_ev->writeset_count);
+      else
+        e->writeset.open= false;
+    }
 
     qev->rgi= e->current_group_info= rgi;
     e->current_sub_id= rgi->gtid_sub_id;
@@ -250,6 +250,37 @@ struct rpl_parallel_thread_pool {
 };
 
 
+/*
+  The writeset hashes of the event groups queued in the current
+  group_commit_orderer, for --slave-parallel-mode=writeset. An event group
+  whose writeset has no hash in common with the set changes none of the rows
+  changed by the event groups already in the gco, so it can join the gco and
+  run in parallel with them.
+
+  Open addressing hash set of uint64, zero-initialised as part of the
+  rpl_parallel_entry (which is allocated with MY_ZEROFILL).
+*/
+struct rpl_parallel_writeset {
+  /* A gco with more hashes than this does not accept more event groups. */
+  static const uint32 MAX_HASHES= 65536;
+
+  uint64 *slots;
+  /* Number of slots, zero or a power of two. */
+  uint32 size;
+  uint32 count;
+  /*
+    False if some event group in the gco has no writeset, or if the set is
+    full. Then no more event groups can join the gco based on writesets.
+  */
+  bool open;
+
+  bool intersects(const uint64 *hashes, uint32 n) const;
+  void add(const uint64 *hashes, uint32 n);
+  void clear();
+  void free();
+};
+
+
 struct rpl_parallel_entry {
   mysql_mutex_t LOCK_parallel_entry;
   mysql_cond_t COND_parallel_entry;
@@ -343,6 +374,8 @@ struct rpl_parallel_entry {
   uint64 count_committing_event_groups;
   /* The group_commit_orderer object for the events currently being queued. */
   group_commit_orderer *current_gco;
+  /* The writesets of the event groups in current_gco. */
+  rpl_parallel_writeset writeset;
 
   rpl_parallel_thread * choose_thread(rpl_group_info *rgi, bool *did_enter_cond,
                                       PSI_stage_info *old_stage,
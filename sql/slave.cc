@@ -7269,7 +7269,13 @@ static int connect_to_master(THD* thd, MYSQL* mysql, Master_info* mi,
 #endif
   ulong client_flag= CLIENT_REMEMBER_OPTIONS;
   if (opt_slave_compressed_protocol)
+  {
     client_flag|= CLIENT_COMPRESS;                /* We will use compression */
+    mysql_options(mysql, MYSQL_OPT_COMPRESSION_ALGORITHM,
+                  my_compress_algorithm_names[opt_slave_compression_algorithm]);
+    mysql_options(mysql, MYSQL_OPT_COMPRESSION_LEVEL,
+                  &thd->variables.net_compression_level);
+  }
 
   mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT, (char *) &slave_net_timeout);
   mysql_options(mysql, MYSQL_OPT_READ_TIMEOUT, (char *) &slave_net_timeout);
@@ -12822,6 +12822,12 @@ static bool send_server_handshake_packet(MPVIO_EXT *mpvio,
     thd->client_capabilities|= CLIENT_TRANSACTIONS;
 
   thd->client_capabilities|= CAN_CLIENT_COMPRESS;
+#ifdef HAVE_COMPRESS
+  if (my_compress_stream_supported(MY_COMPRESS_ZSTD))
+    thd->client_capabilities|= MARIADB_CLIENT_ZSTD_COMPRESSION;
+  if (my_compress_stream_supported(MY_COMPRESS_LZ4))
+    thd->client_capabilities|= MARIADB_CLIENT_LZ4_COMPRESSION;
+#endif
 
   if (ssl_acceptor_fd)
   {
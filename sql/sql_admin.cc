@@ -899,13 +899,30 @@ static bool mysql_admin_table(THD* thd, TABLE_LIST* tables,
         protocol->store(table_name, system_charset_info); 
         protocol->store(operator_name, system_charset_info);
         protocol->store(STRING_WITH_LEN("status"), system_charset_info);
-	protocol->store(STRING_WITH_LEN("Engine-independent statistics collected"), 
-                        system_charset_info);
+        Table_statistics *stats= table->table->collected_stats;
+        if (stats->sample_fraction < 1)
+        {
+          char buf[128];
+          size_t length= my_snprintf(buf, sizeof(buf),
+                                     "Engine-independent statistics "
+                                     "collected from %.2f%% of the rows, "
+                                     "expected cardinality error %.2f%%",
+                                     stats->sample_fraction * 100,
+                                     stats->cardinality_error * 100);
+          protocol->store(buf, length, system_charset_info);
+        }
+        else
+          protocol->store(STRING_WITH_LEN("Engine-independent statistics collected"), 
+                          system_charset_info);
         if (protocol->write())
           goto err;
       }
     }
 
+    /* Join orders cached by prepared statements may depend on the old stats */
+    if (operator_func == &handler::ha_analyze)
+      join_plan_cache_version++;
+
     if (result_code == HA_ADMIN_NOT_IMPLEMENTED && need_repair_or_alter)
     {
       /*
@@ -599,6 +599,7 @@ void inline fix_local_query_cache_mode(THD *thd)
 bool Query_cache::try_lock(THD *thd, Cache_try_lock_mode mode)
 {
   bool interrupt= TRUE;
+  bool waited= FALSE;
   Query_cache_wait_state wait_state(thd, __func__, __FILE__, __LINE__);
   DBUG_ENTER("Query_cache::try_lock");
 
@@ -634,6 +635,11 @@ bool Query_cache::try_lock(THD *thd, Cache_try_lock_mode mode)
     else
     {
       DBUG_ASSERT(m_cache_lock_status == Query_cache::LOCKED);
+      if (mode != TRY && !waited)
+      {
+        waited= TRUE;
+        lock_waits++;
+      }
       /*
         To prevent send_result_to_client() and query_cache_insert() from
         blocking execution for too long a timeout is put on the lock.
@@ -691,6 +697,8 @@ void Query_cache::lock_and_suspend(void)
 
   mysql_mutex_lock(&structure_guard_mutex);
   m_requests_in_progress++;
+  if (m_cache_lock_status != Query_cache::UNLOCKED)
+    lock_waits++;
   while (m_cache_lock_status != Query_cache::UNLOCKED)
     mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
   m_cache_lock_status= Query_cache::LOCKED_NO_WAIT;
@@ -722,6 +730,8 @@ void Query_cache::lock(THD *thd)
   mysql_mutex_lock(&structure_guard_mutex);
   m_requests_in_progress++;
   fix_local_query_cache_mode(thd);
+  if (m_cache_lock_status != Query_cache::UNLOCKED)
+    lock_waits++;
   while (m_cache_lock_status != Query_cache::UNLOCKED)
     mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
   m_cache_lock_status= Query_cache::LOCKED;
@@ -852,7 +862,8 @@ Query_cache_query * Query_cache_block::query()
 {
 #ifndef DBUG_OFF
   if (type != QUERY)
-    query_cache.wreck(__LINE__, "incorrect block type");
+    query_cache.block_partition(this)->wreck(__LINE__,
+                                             "incorrect block type");
 #endif
   return (Query_cache_query *) data();
 }
@@ -861,7 +872,8 @@ Query_cache_table * Query_cache_block::table()
 {
 #ifndef DBUG_OFF
   if (type != TABLE)
-    query_cache.wreck(__LINE__, "incorrect block type");
+    query_cache.block_partition(this)->wreck(__LINE__,
+                                             "incorrect block type");
 #endif
   return (Query_cache_table *) data();
 }
@@ -871,7 +883,8 @@ Query_cache_result * Query_cache_block::result()
 #ifndef DBUG_OFF
   if (type != RESULT && type != RES_CONT && type != RES_BEG &&
       type != RES_INCOMPLETE)
-    query_cache.wreck(__LINE__, "incorrect block type");
+    query_cache.block_partition(this)->wreck(__LINE__,
+                                             "incorrect block type");
 #endif
   return (Query_cache_result *) data();
 }
@@ -1072,6 +1085,13 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (partitions)
+  {
+    query_cache_tls->partition->insert(thd, query_cache_tls, packet, length,
+                                       pkt_nr);
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_insert");
 
   /*
@@ -1110,8 +1130,8 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query %p", query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1135,6 +1155,12 @@ Query_cache::abort(THD *thd, Query_cache_tls *query_cache_tls)
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (partitions)
+  {
+    query_cache_tls->partition->abort(thd, query_cache_tls);
+    DBUG_VOID_RETURN;
+  }
+
   if (try_lock(thd, Query_cache::WAIT))
     DBUG_VOID_RETURN;
 
@@ -1171,12 +1197,18 @@ void Query_cache::end_of_result(THD *thd)
   if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (partitions)
+  {
+    query_cache_tls->partition->end_of_result(thd);
+    DBUG_VOID_RETURN;
+  }
+
   /* Ensure that only complete results are cached. */
   DBUG_ASSERT(thd->get_stmt_da()->is_eof());
 
   if (thd->killed)
   {
-    query_cache_abort(thd, &thd->query_cache_tls);
+    abort(thd, &thd->query_cache_tls);
     DBUG_VOID_RETURN;
   }
 
@@ -1224,9 +1256,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= MY_MAX(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= MY_MAX(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->set_results_ready(); // signal for plugin
@@ -1274,8 +1306,8 @@ Query_cache::Query_cache(size_t query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0),
-   m_cache_status(OK),
+   total_blocks(0), lowmem_prunes(0), misses(0), lock_waits(0),
+   m_cache_status(OK), partitions(NULL), n_partitions(1),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -1301,6 +1333,22 @@ size_t Query_cache::resize(size_t query_cache_size_arg)
 
   lock_and_suspend();
 
+  if (partitions)
+  {
+    /* Every partition gets an equal share of the memory */
+    new_query_cache_size= 0;
+    for (uint i= 0; i < n_partitions; i++)
+      new_query_cache_size+=
+        partitions[i].resize(query_cache_size_arg / n_partitions);
+    query_cache_size= new_query_cache_size;
+    if (new_query_cache_size && global_system_variables.query_cache_type != 0)
+      m_cache_status= OK;
+    else
+      m_cache_status= DISABLED;
+    unlock();
+    DBUG_RETURN(new_query_cache_size);
+  }
+
   /*
     Wait for all readers and writers to exit. When the list of all queries
     is iterated over with a block level lock, we are done.
@@ -1354,10 +1402,51 @@ size_t Query_cache::set_min_res_unit(size_t size)
   DBUG_ASSERT(size % 8 == 0);
   if (size < min_allocation_unit)
     size= ALIGN_SIZE(min_allocation_unit);
+  for (uint i= 0; partitions && i < n_partitions; i++)
+    partitions[i].set_min_res_unit(size);
   return (min_result_data_size= size);
 }
 
 
+/**
+  Find the partition of a query
+
+  @param query         text of the query, as used in the query cache key
+  @param query_length  length of the text
+
+  @return the partition that caches the query
+*/
+
+Query_cache *Query_cache::get_partition(const char *query,
+                                        size_t query_length)
+{
+  if (!partitions)
+    return this;
+  return partitions + my_hash_sort(&my_charset_bin, (const uchar*) query,
+                                   query_length) % n_partitions;
+}
+
+
+/**
+  Find the partition whose memory holds a block
+
+  @return the partition, or this object if the cache is not partitioned
+*/
+
+Query_cache *Query_cache::block_partition(const Query_cache_block *block)
+{
+  for (uint i= 0; partitions && i < n_partitions; i++)
+  {
+    Query_cache *part= partitions + i;
+    if ((const uchar*) block >= part->cache &&
+        (const uchar*) block < part->cache + part->additional_data_size +
+                               part->query_cache_size)
+      return part;
+  }
+  return this;
+}
+
+
 void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
 {
   TABLE_COUNTER_TYPE local_tables;
@@ -1404,6 +1493,13 @@ void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
   DBUG_ASSERT(thd->base_query.is_alloced() ||
               thd->base_query.ptr() == thd->query());
 
+  if (partitions)
+  {
+    get_partition(thd->base_query.ptr(), thd->base_query.length())->
+      store_query(thd, tables_used);
+    DBUG_VOID_RETURN;
+  }
+
   tables_type= 0;
   if ((local_tables= is_cacheable(thd, thd->lex, tables_used,
 				  &tables_type)))
@@ -1562,6 +1658,7 @@ def_week_frmt: %zu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.partition= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1704,15 +1801,6 @@ size_t build_normalized_name(char *buff, size_t bufflen,
 int
 Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
 {
-  ulonglong engine_data;
-  Query_cache_query *query;
-#ifndef EMBEDDED_LIBRARY
-  Query_cache_block *first_result_block;
-#endif
-  Query_cache_block *result_block;
-  Query_cache_block_table *block_table, *block_table_end;
-  size_t tot_length;
-  Query_cache_query_flags flags;
   const char *sql, *sql_end, *found_brace= 0;
   DBUG_ENTER("Query_cache::send_result_to_client");
 
@@ -1869,23 +1957,11 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
       goto err;
     }
   }
-  /*
-    Try to obtain an exclusive lock on the query cache. If the cache is
-    disabled or if a full cache flush is in progress, the attempt to
-    get the lock is aborted.
 
-    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  /*
+    The base query is the key of the partition, and it does not need the
+    lock, so it is prepared before locking.
   */
-  if (try_lock(thd, Query_cache::TIMEOUT))
-    goto err;
-
-  if (query_cache_size == 0)
-  {
-    thd->query_cache_is_applicable= 0;            // Query can't be cached
-    goto err_unlock;
-  }
-
-  Query_cache_block *query_block;
   if (thd->variables.query_cache_strip_comments)
   {
     if (found_brace)
@@ -1902,6 +1978,56 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
     thd->base_query.set(sql, query_length, system_charset_info);
   }
 
+  DBUG_RETURN(get_partition(sql, query_length)->
+              send_cached_result(thd, sql, query_length));
+
+err:
+  thd->query_cache_is_applicable= 0;            // Query can't be cached
+  DBUG_RETURN(0);				// Query was not cached
+}
+
+
+/**
+  Look up a query in this partition and send the result to the client.
+
+  @param thd           thread handle
+  @param sql           base query, with room for the rest of the key
+  @param query_length  length of the base query
+
+  @return see send_result_to_client()
+*/
+
+int
+Query_cache::send_cached_result(THD *thd, const char *sql, uint query_length)
+{
+  ulonglong engine_data;
+  Query_cache_query *query;
+#ifndef EMBEDDED_LIBRARY
+  Query_cache_block *first_result_block;
+#endif
+  Query_cache_block *result_block;
+  Query_cache_block_table *block_table, *block_table_end;
+  size_t tot_length;
+  Query_cache_query_flags flags;
+  DBUG_ENTER("Query_cache::send_cached_result");
+
+  /*
+    Try to obtain an exclusive lock on the query cache. If the cache is
+    disabled or if a full cache flush is in progress, the attempt to
+    get the lock is aborted.
+
+    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  */
+  if (try_lock(thd, Query_cache::TIMEOUT))
+    goto err;
+
+  if (query_cache_size == 0)
+  {
+    thd->query_cache_is_applicable= 0;            // Query can't be cached
+    goto err_unlock;
+  }
+
+  Query_cache_block *query_block;
   tot_length= (query_length + 1 + QUERY_CACHE_DB_LENGTH_SIZE +
                thd->db.length + QUERY_CACHE_FLAGS_SIZE);
 
@@ -2204,6 +2330,7 @@ def_week_frmt: %zu, in_trans: %d, autocommit: %d",
   DBUG_RETURN(1);				// Result sent to client
 
 err_unlock:
+  misses++;
   unlock();
   MYSQL_QUERY_CACHE_MISS(thd->query());
   /*
@@ -2351,6 +2478,13 @@ void Query_cache::invalidate(THD *thd, const char *db)
 
   DBUG_SLOW_ASSERT(ok_for_lower_case_names(db));
 
+  if (partitions)
+  {
+    for (uint i= 0; i < n_partitions; i++)
+      partitions[i].invalidate(thd, db);
+    DBUG_VOID_RETURN;
+  }
+
   bool restart= FALSE;
   /*
     Lock the query cache and queue all invalidation attempts to avoid
@@ -2440,6 +2574,13 @@ void Query_cache::flush()
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (partitions)
+  {
+    for (uint i= 0; i < n_partitions; i++)
+      partitions[i].flush();
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_flush1");
 
   lock_and_suspend();
@@ -2450,7 +2591,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2473,6 +2614,13 @@ void Query_cache::pack(THD *thd, size_t join_limit, uint iteration_limit)
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (partitions)
+  {
+    for (uint i= 0; i < n_partitions; i++)
+      partitions[i].pack(thd, join_limit, iteration_limit);
+    DBUG_VOID_RETURN;
+  }
+
   /*
     If the entire qc is being invalidated we can bail out early
     instead of waiting for the lock.
@@ -2506,6 +2654,15 @@ void Query_cache::destroy()
   }
   else
   {
+    if (partitions)
+    {
+      for (uint i= 0; i < n_partitions; i++)
+        partitions[i].destroy();
+      delete [] partitions;
+      partitions= NULL;
+      n_partitions= 1;
+    }
+
     /* Underlying code expects the lock. */
     lock_and_suspend();
     free_cache();
@@ -2522,6 +2679,9 @@ void Query_cache::destroy()
 
 void Query_cache::disable_query_cache(THD *thd)
 {
+  for (uint i= 0; partitions && i < n_partitions; i++)
+    partitions[i].disable_query_cache(thd);
+
   m_cache_status= DISABLE_REQUEST;
   /*
     If there is no requests in progress try to free buffer.
@@ -2533,6 +2693,46 @@ void Query_cache::disable_query_cache(THD *thd)
 }
 
 
+/**
+  Sum the statistics of all partitions
+
+  The counters are read without locking, like the status variables
+  always did.
+*/
+
+void Query_cache::get_status(Query_cache_status *status)
+{
+  bzero(status, sizeof(*status));
+  for (uint i= 0; i < n_partitions; i++)
+  {
+    Query_cache *part= partition(i);
+    status->free_memory_blocks+= (ulong) part->free_memory_blocks;
+    status->free_memory+=        (ulong) part->free_memory;
+    status->hits+=               (ulong) part->hits;
+    status->inserts+=            (ulong) part->inserts;
+    status->lowmem_prunes+=      (ulong) part->lowmem_prunes;
+    status->refused+=            (ulong) part->refused;
+    status->queries_in_cache+=   (ulong) part->queries_in_cache;
+    status->total_blocks+=       (ulong) part->total_blocks;
+  }
+}
+
+
+/**
+  Reset the statistics counters of all partitions (FLUSH STATUS)
+*/
+
+void Query_cache::reset_status()
+{
+  for (uint i= 0; i < n_partitions; i++)
+  {
+    Query_cache *part= partition(i);
+    part->hits= part->inserts= part->lowmem_prunes= part->refused= 0;
+    part->misses= part->lock_waits= 0;
+  }
+}
+
+
 /*****************************************************************************
   init/destroy
 *****************************************************************************/
@@ -2547,6 +2747,8 @@ void Query_cache::init()
   m_cache_lock_status= Query_cache::UNLOCKED;
   m_cache_status= Query_cache::OK;
   m_requests_in_progress= 0;
+  for (uint i= 0; i < QUERY_CACHE_TABLE_FILTER_SIZE; i++)
+    table_filter[i]= 0;
   initialized = 1;
   /*
     Using state_map from latin1 should be fine in all cases:
@@ -2570,6 +2772,19 @@ void Query_cache::init()
     (i.e. not inside a string literal or comment).
   */
   query_state_map= my_charset_latin1.state_map;
+
+  if (this == &query_cache && query_cache_partitions > 1 &&
+      (partitions= new Query_cache[query_cache_partitions]))
+  {
+    n_partitions= (uint) query_cache_partitions;
+    for (uint i= 0; i < n_partitions; i++)
+    {
+      partitions[i].query_cache_limit= query_cache_limit;
+      partitions[i].set_min_res_unit(min_result_data_size);
+      partitions[i].init();
+    }
+  }
+
   /*
     If we explicitly turn off query cache from the command line query
     cache will be disabled for the reminder of the server life
@@ -2833,6 +3048,8 @@ void Query_cache::free_cache()
   make_disabled();
   my_hash_free(&queries);
   my_hash_free(&tables);
+  for (uint i= 0; i < QUERY_CACHE_TABLE_FILTER_SIZE; i++)
+    table_filter[i]= 0;
   DBUG_VOID_RETURN;
 }
 
@@ -3273,6 +3490,22 @@ my_bool Query_cache::allocate_data_chain(Query_cache_block **result_block,
   Tables management
 *****************************************************************************/
 
+/*
+  Slot of a table key in Query_cache::table_filter. Keys which are equal
+  for the tables hash (see init_cache()) must get the same slot.
+*/
+
+static uint table_filter_slot(const uchar *key, size_t key_length)
+{
+#ifndef FN_NO_CASE_SENSE
+  CHARSET_INFO *cs= &my_charset_bin;
+#else
+  CHARSET_INFO *cs= lower_case_table_names ? &my_charset_bin :
+                                             files_charset_info;
+#endif
+  return my_hash_sort(cs, key, key_length) % QUERY_CACHE_TABLE_FILTER_SIZE;
+}
+
 /*
   Invalidate the first table in the table_list
 */
@@ -3300,6 +3533,18 @@ void Query_cache::invalidate_table(THD *thd, TABLE *table)
 
 void Query_cache::invalidate_table(THD *thd, uchar * key, size_t key_length)
 {
+  if (partitions)
+  {
+    /* Only the partitions that may have a query using the table */
+    uint slot= table_filter_slot(key, key_length);
+    for (uint i= 0; i < n_partitions; i++)
+    {
+      if (partitions[i].table_filter[slot])
+        partitions[i].invalidate_table(thd, key, key_length);
+    }
+    return;
+  }
+
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
 
   /*
@@ -3564,6 +3809,8 @@ Query_cache::insert_table(THD *thd, size_t key_len, const char *key,
       free_memory_block(table_block);
       DBUG_RETURN(0);
     }
+    if (hash)
+      table_filter[table_filter_slot((const uchar*) key, key_len)]++;
     char *db= header->db();
     header->table(db + db_length + 1);
     header->key_length((uint32)key_len);
@@ -3627,7 +3874,11 @@ void Query_cache::unlink_table(Query_cache_block_table *node)
                                &tables_blocks);
     Query_cache_table *header= table_block->table();
     if (header->is_hashed())
+    {
+      table_filter[table_filter_slot((const uchar*) header->data(),
+                                     header->key_length())]--;
       my_hash_delete(&tables,(uchar *) table_block);
+    }
     free_memory_block(table_block);
   }
   DBUG_VOID_RETURN;
@@ -4233,7 +4484,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4265,7 +4516,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -4852,6 +5103,14 @@ my_bool Query_cache::check_integrity(bool locked)
   uint i;
   DBUG_ENTER("check_integrity");
 
+  if (partitions)
+  {
+    /* The partitions have their own locks */
+    for (i= 0; i < n_partitions; i++)
+      result|= partitions[i].check_integrity(0);
+    DBUG_RETURN(result);
+  }
+
   if (!locked)
     lock_and_suspend();
 
@@ -18,6 +18,7 @@
 
 #include "hash.h"
 #include "my_base.h"                            /* ha_rows */
+#include "my_counter.h"                         /* Atomic_counter */
 
 class MY_LOCALE;
 struct TABLE_LIST;
@@ -66,6 +67,14 @@ typedef struct st_changed_table_list CHANGED_TABLE_LIST;
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* maximal number of partitions (see query_cache_partitions) */
+#define QUERY_CACHE_MAX_PARTITIONS		64
+/*
+  number of slots in the per-partition filter of cached tables
+  (see Query_cache::table_filter)
+*/
+#define QUERY_CACHE_TABLE_FILTER_SIZE		256
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -297,6 +306,14 @@ struct Query_cache_memory_bin_step
   }
 };
 
+/* Global status of the query cache, summed over all partitions */
+struct Query_cache_status
+{
+  ulong free_memory_blocks, free_memory, hits, inserts, lowmem_prunes,
+    refused, queries_in_cache, total_blocks;
+};
+
+
 class Query_cache
 {
 public:
@@ -305,6 +322,8 @@ class Query_cache
   /* statistics */
   size_t free_memory, queries_in_cache, hits, inserts, refused,
     free_memory_blocks, total_blocks, lowmem_prunes;
+  /* per-partition statistics, see QUERY_CACHE_PARTITION_INFO */
+  size_t misses, lock_waits;
 
 
 private:
@@ -337,6 +356,25 @@ class Query_cache
     till the end of a flush operation.
   */
   mysql_mutex_t structure_guard_mutex;
+
+  /*
+    With query_cache_partitions > 1 the global query_cache object only
+    routes the requests to an array of partitions, each of them being a
+    complete Query_cache with its own lock, memory and query list. A query
+    always goes to the partition chosen by the hash of its text, so
+    lookups and inserts of different queries rarely compete for a lock.
+    Partitions have partitions == NULL and n_partitions == 1.
+  */
+  Query_cache *partitions;
+  uint n_partitions;
+  /*
+    Number of hashed tables registered in this partition, by hash of the
+    table key. It is updated under the partition lock but read without it
+    when invalidating, to skip the partitions which can not have any query
+    using the table.
+  */
+  Atomic_counter<uint32> table_filter[QUERY_CACHE_TABLE_FILTER_SIZE];
+
   size_t additional_data_size;
   uchar *cache;					// cache memory
   Query_cache_block *first_block;		// physical location block list
@@ -446,6 +484,8 @@ class Query_cache
                                               uint8 *tables_type);
 
   static my_bool ask_handler_allowance(THD *thd, TABLE_LIST *tables_used);
+  int send_cached_result(THD *thd, const char *sql, uint query_length);
+  Query_cache *get_partition(const char *query, size_t query_length);
  public:
 
   Query_cache(size_t query_cache_limit = ULONG_MAX,
@@ -463,7 +503,12 @@ class Query_cache
   /* resize query cache (return real query size, 0 if disabled) */
   size_t resize(size_t query_cache_size);
   /* set limit on result size */
-  inline void result_size_limit(size_t limit){query_cache_limit=limit;}
+  inline void result_size_limit(size_t limit)
+  {
+    query_cache_limit=limit;
+    for (uint i= 0; partitions && i < n_partitions; i++)
+      partitions[i].query_cache_limit= limit;
+  }
   /* set minimal result data allocation unit size */
   size_t set_min_res_unit(size_t size);
 
@@ -542,6 +587,13 @@ class Query_cache
   void unlock(void);
 
   void disable_query_cache(THD *thd);
+
+  /* Partitions, for the statistics and the QUERY_CACHE_INFO plugin */
+  uint partition_count() const { return n_partitions; }
+  Query_cache *partition(uint i) { return partitions ? partitions + i : this; }
+  Query_cache *block_partition(const Query_cache_block *block);
+  void get_status(Query_cache_status *status);
+  void reset_status();
 };
 
 #ifdef HAVE_QUERY_CACHE
@@ -6644,6 +6644,7 @@ int THD::binlog_write_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  binlog_add_writeset(table, is_trans, record, NULL, NULL);
   return ev->add_row_data(row_data, len);
 }
 
@@ -6718,6 +6719,10 @@ int THD::binlog_update_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  binlog_add_writeset(table, is_trans, before_record, old_read_set, NULL);
+  binlog_add_writeset(table, is_trans, after_record, old_read_set,
+                      table->write_set);
+
   int error=  ev->add_row_data(before_row, before_size) ||
               ev->add_row_data(after_row, after_size);
 
@@ -6783,6 +6788,7 @@ int THD::binlog_delete_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  binlog_add_writeset(table, is_trans, record, old_read_set, NULL);
 
   int error= ev->add_row_data(row_data, len);
 
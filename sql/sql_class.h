@@ -110,6 +110,8 @@ enum enum_slave_run_triggers_for_rbr { SLAVE_RUN_TRIGGERS_FOR_RBR_NO,
                                        SLAVE_RUN_TRIGGERS_FOR_RBR_ENFORCE};
 enum enum_slave_type_conversions { SLAVE_TYPE_CONVERSIONS_ALL_LOSSY,
                                    SLAVE_TYPE_CONVERSIONS_ALL_NON_LOSSY};
+enum enum_slave_rows_search_algorithms { SLAVE_ROWS_INDEX_SCAN,
+                                         SLAVE_ROWS_HASH_SCAN };
 
 /*
   MARK_COLUMNS_READ:  A column is goind to be read.
@@ -475,6 +477,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -483,12 +486,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* The query cache partition that first_query_block belongs to */
+  Query_cache *partition;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), partition(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -659,6 +664,7 @@ typedef struct system_variables
   ulong column_compression_zlib_strategy;
   ulong lock_wait_timeout;
   ulong join_cache_level;
+  ulong join_cache_spill_partitions;
   ulong max_allowed_packet;
   ulong max_error_count;
   ulong max_length_for_sort_data;
@@ -679,12 +685,15 @@ typedef struct system_variables
   ulong optimizer_use_condition_selectivity;
   ulong use_stat_tables;
   double sample_percentage;
+  ulong analyze_sample_method;
+  ulong analyze_parallel_threads;
   ulong histogram_size;
   ulong histogram_type;
   ulong preload_buff_size;
   ulong profiling_history_size;
   ulong read_buff_size;
   ulong read_rnd_buff_size;
+  ulong sort_parallel_threads;
   ulong mrr_buff_size;
   ulong div_precincrement;
   /* Total size of all buffers used by the subselect_rowid_merge_engine. */
@@ -734,6 +743,7 @@ typedef struct system_variables
   my_bool old_passwords;
   my_bool big_tables;
   my_bool only_standard_compliant_cte;
+  my_bool prepared_stmt_plan_cache;
   my_bool query_cache_strip_comments;
   my_bool sql_log_slow;
   my_bool sql_log_bin;
@@ -804,6 +814,7 @@ typedef struct system_variables
   uint idle_write_transaction_timeout;
   uint column_compression_threshold;
   uint column_compression_zlib_level;
+  uint net_compression_level;
   uint in_subquery_conversion_threshold;
   ulonglong max_rowid_filter_size;
 
@@ -877,6 +888,9 @@ typedef struct system_status_var
   ulong opened_tables;
   ulong opened_shares;
   ulong opened_views;               /* +1 opening a view */
+  ulong ps_plan_cache_hits;         /* +1 reusing a cached join order */
+  ulong ps_plan_cache_misses;       /* +1 searching for a join order */
+  ulong ps_plan_cache_invalidations;/* +1 dropping a stale join order */
 
   ulong select_full_join_count_;
   ulong select_full_range_join_count_;
@@ -2584,6 +2598,9 @@ class THD: public THD_count, /* this must be first */
                         const uchar *buf);
   int binlog_update_row(TABLE* table, bool is_transactional,
                         const uchar *old_data, const uchar *new_data);
+  void binlog_add_writeset(TABLE *table, bool is_transactional,
+                           const uchar *record, const MY_BITMAP *read_cols,
+                           const MY_BITMAP *write_cols);
   static void binlog_prepare_row_images(TABLE* table);
 
   void set_server_id(uint32 sid) { variables.server_id = sid; }
@@ -6900,6 +6917,13 @@ inline void handler::increment_statistics(ulong SSV::*offset) const
   table->in_use->check_limit_rows_examined();
 }
 
+inline void handler::update_rnd_batch_statistics(bool found)
+{
+  if (found)
+    update_rows_read();
+  increment_statistics(&SSV::ha_read_rnd_next_count);
+}
+
 inline void handler::decrement_statistics(ulong SSV::*offset) const
 {
   status_var_decrement(table->in_use->status_var.*offset);
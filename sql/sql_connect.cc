@@ -1234,7 +1234,22 @@ void prepare_new_connection_state(THD* thd)
   Security_context *sctx= thd->security_ctx;
 
   if (thd->client_capabilities & CLIENT_COMPRESS)
-    thd->net.compress=1;				// Use compression
+  {
+    /* Use compression, with the algorithm that the client asked for */
+    uint algorithm= MY_COMPRESS_ZLIB;
+    if (thd->client_capabilities & MARIADB_CLIENT_ZSTD_COMPRESSION)
+      algorithm= MY_COMPRESS_ZSTD;
+    else if (thd->client_capabilities & MARIADB_CLIENT_LZ4_COMPRESSION)
+      algorithm= MY_COMPRESS_LZ4;
+    if (my_net_set_compression(&thd->net, algorithm,
+                               thd->variables.net_compression_level))
+    {
+      thd->set_killed(KILL_CONNECTION);
+      return;
+    }
+    statistic_increment(compressed_connections[thd->net.compress_algorithm],
+                        &LOCK_status);
+  }
 
   /*
     Much of this is duplicated in create_embedded_thd() for the
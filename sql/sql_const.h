@@ -98,6 +98,9 @@
 
 #define MAX_SORT_MEMORY 2048*1024
 #define MIN_SORT_MEMORY 1024
+#define MAX_SORT_THREADS 64
+#define MAX_ANALYZE_THREADS 64
+#define MAX_JOIN_CACHE_SPILL_PARTITIONS 1024
 
 /* Some portable defines */
 
@@ -34,6 +34,8 @@
 #include "opt_subselect.h"
 
 #define NO_MORE_RECORDS_IN_BUFFER  (uint)(-1)
+/* Maximum size of the buffer of a partition file of a BNLH join cache */
+#define SPILL_FILE_BUFFER_SIZE  (uint) (IO_SIZE*4)
 
 static void save_or_restore_used_tabs(JOIN_TAB *join_tab, bool save);
 
@@ -2916,8 +2918,6 @@ bool JOIN_CACHE_HASHED::put_record()
 {
   bool is_full;
   uchar *key;
-  uint key_len= key_length;
-  uchar *key_ref_ptr;
   uchar *link= 0;
   TABLE_REF *ref= &join_tab->ref;
   uchar *next_ref_ptr= pos;
@@ -2940,6 +2940,36 @@ bool JOIN_CACHE_HASHED::put_record()
     key= ref->key_buff;
   }
 
+  put_key_into_hash_table(key, next_ref_ptr);
+  return is_full;
+}
+
+
+/* 
+  Add a record from the join buffer to the hash table of the cache
+
+  SYNOPSIS
+    put_key_into_hash_table()
+      key            the key value built for the record
+      next_ref_ptr   the position of the reference to the next record in
+                     the key chain that precedes the record in the buffer
+
+  DESCRIPTION
+    The function searches for the key in the hash table. If it finds
+    the key it joins the record to the chain of records with this key.
+    Otherwise the key is placed into the hash table and a chain containing
+    only the record is attached to the key entry.
+
+  RETURN VALUE
+    none
+*/
+
+void JOIN_CACHE_HASHED::put_key_into_hash_table(uchar *key,
+                                                uchar *next_ref_ptr)
+{
+  uint key_len= key_length;
+  uchar *key_ref_ptr;
+
   /* Look for the key in the hash table */
   if (key_search(key, key_len, &key_ref_ptr))
   {
@@ -2988,7 +3018,6 @@ bool JOIN_CACHE_HASHED::put_record()
     /* Increment the counter of key_entries in the hash table */ 
     key_entries++;
   }  
-  return is_full;
 }
 
 
@@ -3139,8 +3168,7 @@ bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len,
     the calculated index of the hash entry for the given key  
 */
 
-inline
-uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
+static inline ulong key_bytes_hash(uchar *key, uint key_len)
 {
   ulong nr= 1;
   ulong nr2= 4;
@@ -3151,7 +3179,13 @@ uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
     nr^= (ulong) ((((uint) nr & 63)+nr2)*((uint) *pos))+ (nr << 8);
     nr2+= 3;
   }
-  return nr % hash_entries;
+  return nr;
+}
+
+inline
+uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
+{
+  return key_bytes_hash(key, key_len) % hash_entries;
 }
 
 
@@ -3186,6 +3220,31 @@ uint JOIN_CACHE_HASHED::get_hash_idx_complex(uchar *key, uint key_len)
 }
 
 
+/* 
+  Get the hash value of a key that does not depend on the hash table size
+
+  SYNOPSIS
+    get_key_hash_value()
+      key             pointer to the key value
+      key_len         key value length
+      
+  DESCRIPTION
+    The function calculates the hash value for the given key in the same
+    way as the hash function of the cache does, but without reducing it
+    modulo the number of hash entries. Equal keys get the same value.
+
+  RETURN VALUE
+    the calculated hash value for the given key  
+*/
+
+ulong JOIN_CACHE_HASHED::get_key_hash_value(uchar *key, uint key_len)
+{
+  if (hash_func == &JOIN_CACHE_HASHED::get_hash_idx_complex)
+    return key_hashnr(ref_key_info, ref_used_key_parts, key);
+  return key_bytes_hash(key, key_len);
+}
+
+
 /* 
   Compare two key entries in the hash table as sequence of bytes
 
@@ -3481,6 +3540,56 @@ void JOIN_TAB_SCAN::close()
 }
 
 
+/* 
+  Initiate the iteration over the rows of a partition file
+
+  SYNOPSIS
+    open()
+
+  DESCRIPTION
+    The function prepares the partition file of the rows of the joined
+    table that is set by set_file() for reading from its beginning.
+
+  RETURN VALUE   
+    0            the initiation is a success 
+    error code   otherwise     
+*/
+
+int JOIN_TAB_SCAN_SPILL::open()
+{
+  save_or_restore_used_tabs(join_tab, FALSE);
+  return reinit_io_cache(file, READ_CACHE, 0L, 0, 0);
+}
+
+
+/* 
+  Read the next row of the joined table from a partition file
+
+  SYNOPSIS
+    next()
+
+  DESCRIPTION
+    The function reads the next row from the partition file into the record
+    buffer of the joined table. The condition pushed to the joined table
+    has been checked for the row before it was written into the file.
+
+  RETURN VALUE   
+    0            the next row has been successfully read 
+    -1           there are no more rows in the file
+    1            an error occurred while reading the file
+*/
+
+int JOIN_TAB_SCAN_SPILL::next()
+{
+  TABLE *table= join_tab->table;
+  if (my_b_read(file, table->record[0], table->s->reclength))
+    return file->error ? 1 : -1;
+  table->status= 0;
+  table->null_row= 0;
+  return 0;
+}
+
+
 /*
   Prepare to iterate over the BNL join cache buffer to look for matches 
 
@@ -3812,12 +3921,545 @@ void JOIN_CACHE_BNLH::read_next_candidate_for_match(uchar *rec_ptr)
 
 int JOIN_CACHE_BNLH::init(bool for_explain)
 {
+  int rc;
   DBUG_ENTER("JOIN_CACHE_BNLH::init");
 
+  spill_partitions= 0;
+
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE_HASHED::init(for_explain));
+  if ((rc= JOIN_CACHE_HASHED::init(for_explain)) || for_explain)
+    DBUG_RETURN(rc);
+
+  /*
+    Prepare the partition files for the case when the records do not fit
+    into the join buffer. The number of partitions has been determined by
+    get_max_join_buffer_size(). Whether they are used is decided only when
+    the buffer becomes full for the first time, see put_record().
+  */
+  if (spill_partitions)
+  {
+    if (!(outer_files= (IO_CACHE*) join->thd->calloc(2*spill_partitions*
+                                                     sizeof(IO_CACHE))) ||
+        !(spill_scan= new JOIN_TAB_SCAN_SPILL(join, join_tab)))
+      DBUG_RETURN(1);
+    inner_files= outer_files+spill_partitions;
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Get the number of partitions for the records of a BNLH join cache
+
+  SYNOPSIS
+    get_spill_partitions()
+      tab         the table joined by the cache
+      linked      whether the cache is linked to a previous cache
+      with_blobs  whether the records of the cache contain blob fields
+
+  DESCRIPTION
+    The records of the join buffer and the rows of join_tab are written into
+    partition files as flat byte images, and the rows of join_tab are read
+    back from the files instead of the table. This is possible only if
+    - the cache is not linked to a previous cache and has no blob fields,
+    - the rows of join_tab have no blobs and their rowids are not needed,
+    - join_tab is not accessed by a dynamic range scan,
+    - join_tab, if it is an inner table of an outer join, is the only inner
+      table of a not nested outer join operation.
+    The buffers of the partition files take at most half of the space that
+    join_buffer_size allows for the cache, which may reduce the number of
+    partitions below join_cache_spill_partitions.
+
+    The function is called both by best_access_path(), before the join
+    caches are created, and when the cache is set up, so the nesting of
+    outer joins is checked on the TABLE_LIST objects rather than with
+    first_inner/first_upper, which are set only after the join order has
+    been chosen.
+
+  RETURN VALUE
+    the number of partitions, 0 if the records cannot be partitioned on disk
+*/
+
+uint JOIN_CACHE_BNLH::get_spill_partitions(JOIN_TAB *tab, bool linked,
+                                           bool with_blobs)
+{
+  uint partitions= (uint) tab->join->thd->variables.join_cache_spill_partitions;
+  if (!partitions || linked || with_blobs ||
+      tab->table->s->blob_fields ||
+      tab->keep_current_rowid ||
+      tab->use_quick == 2)
+    return 0;
+
+  TABLE_LIST *tbl= tab->table->pos_in_table_list;
+  if ((tbl->outer_join & (JOIN_TYPE_LEFT | JOIN_TYPE_RIGHT)) && tbl->embedding)
+    return 0;
+  for (TABLE_LIST *emb= tbl->embedding; emb; emb= emb->embedding)
+  {
+    if (emb->on_expr && emb->outer_join)
+      return 0;
+  }
+
+  size_t limit_sz= (size_t) tab->join->thd->variables.join_buff_size;
+  if (tab->join_buffer_size_limit)
+    set_if_smaller(limit_sz, tab->join_buffer_size_limit);
+  set_if_smaller(partitions, (uint) (limit_sz / (4 * IO_SIZE)));
+  return partitions;
+}
+
+
+/*
+  Get the maximum possible size of the buffer of a BNLH join cache
+
+  SYNOPSIS
+    get_max_join_buffer_size()
+      optimize_buff_size  FALSE <-> do not take more memory than needed for
+                          the records of the cache
+
+  DESCRIPTION
+    The function decides whether the records of the cache can be
+    partitioned on disk when they do not fit into the join buffer.
+    If so, the buffers of the partition files are taken out of the space
+    that is allowed for the join buffer by JOIN_CACHE.
+
+  RETURN VALUE
+    The maximum possible size of the join buffer of this cache
+*/
+
+size_t JOIN_CACHE_BNLH::get_max_join_buffer_size(bool optimize_buff_size)
+{
+  if (!max_buff_size)
+  {
+    size_t max_sz=
+      JOIN_CACHE_HASHED::get_max_join_buffer_size(optimize_buff_size);
+    size_t limit_sz= (size_t) join->thd->variables.join_buff_size;
+    if (join_tab->join_buffer_size_limit)
+      set_if_smaller(limit_sz, join_tab->join_buffer_size_limit);
+
+    spill_partitions= get_spill_partitions(join_tab, prev_cache != 0,
+                                           blobs != 0);
+    spill_file_buff_size= 0;
+    if (spill_partitions)
+    {
+      spill_file_buff_size= limit_sz / (4 * spill_partitions);
+      spill_file_buff_size-= spill_file_buff_size % IO_SIZE;
+      set_if_smaller(spill_file_buff_size, SPILL_FILE_BUFFER_SIZE);
+
+      size_t spill_sz= 2 * spill_partitions * spill_file_buff_size;
+      size_t min_sz= get_min_join_buffer_size();
+      if (max_sz + spill_sz > limit_sz)
+        max_sz= limit_sz > spill_sz + min_sz ? limit_sz - spill_sz : min_sz;
+      max_buff_size= max_sz;
+    }
+  }
+  return max_buff_size;
+}
+
+
+/*
+  Get the number of the partition a join key belongs to
+
+  SYNOPSIS
+    get_spill_partition()
+      key   the key value
+
+  DESCRIPTION
+    The partition is determined by the hash value of the key, so that all
+    records of the join buffer and all rows of join_tab that can match
+    each other are written into partition files with the same number.
+    The hash value is mixed before it is used, as its low bits are also
+    used to determine the hash table entry for the key.
+
+  RETURN VALUE
+    the number of the partition
+*/
+
+uint JOIN_CACHE_BNLH::get_spill_partition(uchar *key)
+{
+  ulonglong nr= get_key_hash_value(key, key_length);
+  return (uint) (((nr * 0x9E3779B97F4A7C15ULL) >> 32) % spill_partitions);
+}
+
+
+/*
+  Get the number of the partition for the current record of the join buffer
+
+  SYNOPSIS
+    get_curr_rec_spill_partition()
+
+  DESCRIPTION
+    The function builds the join key for the record that has been just read
+    from the join buffer and returns the number of its partition. Records
+    for which no key is built, because they have to be null complemented,
+    are all put into the first partition.
+
+  RETURN VALUE
+    the number of the partition
+*/
+
+uint JOIN_CACHE_BNLH::get_curr_rec_spill_partition()
+{
+  uchar *key;
+  TABLE_REF *ref= &join_tab->ref;
+  if (with_match_flag &&
+      get_match_flag_by_pos(curr_rec_pos) == MATCH_IMPOSSIBLE)
+    return 0;
+  if (use_emb_key)
+    key= get_curr_emb_key();
+  else
+  {
+    cp_buffer_from_ref(join->thd, join_tab->table, ref);
+    key= ref->key_buff;
+  }
+  return get_spill_partition(key);
+}
+
+
+/*
+  Open the partition files of the BNLH join cache
+
+  RETURN VALUE
+    FALSE   all files have been opened
+    TRUE    otherwise
+*/
+
+bool JOIN_CACHE_BNLH::open_spill_files()
+{
+  for (uint i= 0; i < 2*spill_partitions; i++)
+  {
+    if (open_cached_file(outer_files+i, mysql_tmpdir, TEMP_PREFIX,
+                         spill_file_buff_size, MYF(MY_WME)))
+    {
+      close_spill_files();
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+
+/* Close and delete the partition files of the BNLH join cache */
+
+void JOIN_CACHE_BNLH::close_spill_files()
+{
+  if (!outer_files)
+    return;
+  for (uint i= 0; i < 2*spill_partitions; i++)
+    close_cached_file(outer_files+i);
+}
+
+
+/*
+  Move the records from the join buffer into the partition files
+
+  SYNOPSIS
+    spill_buffer()
+
+  DESCRIPTION
+    The function reads all records from the join buffer and appends the
+    image of each of them to the partition file determined by its join key.
+    The image consists of the length of the record followed by the record
+    fields, so that the record can be copied back into the join buffer as
+    is. After this the join buffer is reset for writing.
+    The last record read from the buffer is the last one written into it,
+    so the record buffers are left as they were before the call.
+
+  RETURN VALUE
+    FALSE   the records have been written into the partition files
+    TRUE    otherwise
+*/
+
+bool JOIN_CACHE_BNLH::spill_buffer()
+{
+  reset(FALSE);
+  while (!get_record())
+  {
+    uchar *rec_ptr= curr_rec_pos-get_size_of_rec_length();
+    IO_CACHE *file= outer_files+get_curr_rec_spill_partition();
+    if (my_b_write(file, rec_ptr, (size_t) (pos-rec_ptr)))
+      return TRUE;
+  }
+  reset(TRUE);
+  return FALSE;
+}
+
+
+/*
+  Add a record into the buffer of a BNLH join cache
+
+  SYNOPSIS
+    put_record()
+
+  DESCRIPTION
+    This implementation of the virtual function put_record adds the record
+    into the join buffer as the implementation for the JOIN_CACHE_HASHED
+    class does. When the buffer becomes full and partition files are
+    allowed for the cache the records are not joined with join_tab at once.
+    Instead they are moved from the buffer into the partition files and
+    the buffer is reused for the next records. All partitioned records
+    are joined with join_tab by the join_records() call at the end of
+    the records (grace hash join), which reads join_tab only once rather
+    than once per refill of the join buffer.
+
+  RETURN VALUE
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer,
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::put_record()
+{
+  bool is_full= JOIN_CACHE_HASHED::put_record();
+  if (!is_full || !spill_partitions)
+    return is_full;
+
+  if (!spilled)
+  {
+    if (!get_spill_partitions(join_tab, prev_cache != 0, blobs != 0) ||
+        open_spill_files())
+      return is_full;
+    spilled= TRUE;
+    spill_failed= FALSE;
+  }
+  if (spill_buffer())
+  {
+    /* Let join_records() report the error */
+    spill_failed= TRUE;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Write all rows of join_tab into the partition files
+
+  SYNOPSIS
+    partition_join_tab()
+
+  DESCRIPTION
+    The function scans join_tab once and appends the image of each row
+    that satisfies the condition pushed to join_tab to the partition file
+    determined by the join key of the row. Rows of the partitions that
+    have no records from the join buffer are skipped, as they cannot
+    match anything.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::partition_join_tab()
+{
+  int error;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  TABLE *table= join_tab->table;
+  KEY *keyinfo= join_tab->get_keyinfo_by_key_no(join_tab->ref.key);
+  DBUG_ENTER("JOIN_CACHE_BNLH::partition_join_tab");
+
+  table->null_row= 0;
+  if ((rc= join_tab_execution_startup(join_tab)) < 0)
+    DBUG_RETURN(rc);
+
+  join_tab->build_range_rowid_filter_if_needed();
+
+  if (likely(!(error= join_tab_scan->open())))
+  {
+    while (!(error= join_tab_scan->next()))
+    {
+      if (unlikely(join->thd->check_killed()))
+      {
+        rc= NESTED_LOOP_KILLED;
+        break;
+      }
+      key_copy(key_buff, table->record[0], keyinfo, key_length, TRUE);
+      uint part= get_spill_partition(key_buff);
+      if (!my_b_tell(outer_files+part))
+        continue;
+      if (my_b_write(inner_files+part, table->record[0], table->s->reclength))
+      {
+        error= 1;
+        break;
+      }
+    }
+  }
+  if (error > 0)
+    rc= NESTED_LOOP_ERROR;
+  join_tab_scan->close();
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Load records from an outer partition file into the join buffer
+
+  SYNOPSIS
+    load_spilled_records()
+      file   the partition file of the records from the join buffer
+
+  DESCRIPTION
+    The function copies the records from the partition file into the
+    join buffer, starting from the current position in the file, until
+    either the file or the buffer is exhausted. Each record is put into
+    the hash table of the cache in the same way as put_record() does it.
+
+  RETURN VALUE
+    0    all records of the file have been loaded
+    1    the buffer is full, and there are more records in the file
+    -1   an error occurred while reading the file
+*/
+
+int JOIN_CACHE_BNLH::load_spilled_records(IO_CACHE *file)
+{
+  TABLE_REF *ref= &join_tab->ref;
+  uint len_size= get_size_of_rec_length();
+  for ( ; ; )
+  {
+    uchar *key;
+    uchar *next_ref_ptr= pos;
+    uchar *rec_ptr= pos+get_size_of_rec_offset();
+    if (!spill_rec_len_pending &&
+        my_b_read(file, spill_rec_len_buff, len_size))
+      return file->error ? -1 : 0;
+    spill_rec_len_pending= FALSE;
+
+    ulong len= get_rec_length(spill_rec_len_buff);
+    if (records &&
+        get_size_of_rec_offset()+len_size+len+extra_key_length() > rem_space())
+    {
+      spill_rec_len_pending= TRUE;
+      return 1;
+    }
+    memcpy(rec_ptr, spill_rec_len_buff, len_size);
+    rec_ptr+= len_size;
+    if (my_b_read(file, rec_ptr, len))
+      return -1;
+    records++;
+    curr_rec_pos= last_rec_pos= rec_ptr;
+    end_pos= pos= rec_ptr+len;
+
+    if (with_match_flag &&
+        get_match_flag_by_pos(curr_rec_pos) == MATCH_IMPOSSIBLE)
+      continue;
+    if (use_emb_key)
+      key= get_curr_emb_key();
+    else
+    {
+      get_record_by_pos(curr_rec_pos);
+      cp_buffer_from_ref(join->thd, join_tab->table, ref);
+      key= ref->key_buff;
+    }
+    put_key_into_hash_table(key, next_ref_ptr);
+  }
+}
+
+
+/*
+  Join the records from the partition files with join_tab
+
+  SYNOPSIS
+    join_spilled_records()
+
+  DESCRIPTION
+    The function is called at the end of the records when the records of
+    the cache have been partitioned on disk. It moves the records that are
+    still in the join buffer into the partition files, and partitions the
+    rows of join_tab in the same way. Then the records of each partition
+    are loaded into the join buffer and joined with the rows of join_tab
+    from the partition with the same number by the regular join_records()
+    procedure. If the records of a partition do not fit into the buffer,
+    the rows of join_tab from the partition are read once per refill.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_spilled_records()
+{
+  enum_nested_loop_state rc;
+  JOIN_TAB_SCAN *save_scan= join_tab_scan;
+  DBUG_ENTER("JOIN_CACHE_BNLH::join_spilled_records");
+
+  if (spill_failed || (records && spill_buffer()))
+  {
+    rc= NESTED_LOOP_ERROR;
+    goto finish;
+  }
+  if ((rc= partition_join_tab()) != NESTED_LOOP_OK)
+    goto finish;
+
+  join_tab_scan= spill_scan;
+  for (uint i= 0; i < spill_partitions; i++)
+  {
+    int res;
+    IO_CACHE *file= outer_files+i;
+    if (!my_b_tell(file))
+      continue;
+    if (reinit_io_cache(file, READ_CACHE, 0L, 0, 0))
+    {
+      rc= NESTED_LOOP_ERROR;
+      goto finish;
+    }
+    spill_scan->set_file(inner_files+i);
+    spill_rec_len_pending= FALSE;
+    do
+    {
+      if ((res= load_spilled_records(file)) < 0)
+      {
+        rc= NESTED_LOOP_ERROR;
+        goto finish;
+      }
+      rc= JOIN_CACHE::join_records(FALSE);
+      if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+        goto finish;
+    } while (res > 0);
+    close_cached_file(file);
+    close_cached_file(inner_files+i);
+  }
+
+finish:
+  join_tab_scan= save_scan;
+  close_spill_files();
+  spilled= FALSE;
+  spill_failed= FALSE;
+  reset(TRUE);
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Join records from the join buffer with records from the next join table    
+
+  SYNOPSIS
+    join_records()
+      skip_last    do not find matches for the last record from the buffer
+
+  DESCRIPTION
+    If the records of the cache have been partitioned on disk this
+    implementation of the virtual function joins the records from the
+    partition files, otherwise it joins the records from the join buffer
+    as the default implementation does.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state, except NESTED_LOOP_NO_MORE_ROWS.
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_records(bool skip_last)
+{
+  if (!spilled)
+    return JOIN_CACHE::join_records(skip_last);
+  DBUG_ASSERT(!skip_last);
+  return join_spilled_records();
+}
+
+
+/* Free the join buffer and the partition files of the BNLH join cache */
+
+void JOIN_CACHE_BNLH::free()
+{
+  close_spill_files();
+  spilled= FALSE;
+  JOIN_CACHE::free();
 }
 
 
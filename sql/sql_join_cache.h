@@ -659,7 +659,7 @@ class JOIN_CACHE :public Sql_alloc
   }
      
   /* Join records from the join buffer with records from the next join table */ 
-  enum_nested_loop_state join_records(bool skip_last);
+  virtual enum_nested_loop_state join_records(bool skip_last);
 
   /* Add a comment on the join algorithm employed by the join cache */
   virtual bool save_explain_data(EXPLAIN_BKA_TYPE *explain);
@@ -668,7 +668,7 @@ class JOIN_CACHE :public Sql_alloc
 
   virtual ~JOIN_CACHE() {}
   void reset_join(JOIN *j) { join= j; }
-  void free()
+  virtual void free()
   { 
     my_free(buff);
     buff= 0;
@@ -802,6 +802,12 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
   
 protected:
 
+  /* Get the hash value of a key independent of the size of the hash table */
+  ulong get_key_hash_value(uchar *key, uint key_len);
+
+  /* Add the record at next_ref_ptr to the chain of records for the key */
+  void put_key_into_hash_table(uchar *key, uchar *next_ref_ptr);
+
   /* 
     Index info on the TABLE_REF object used by the hash join
     to look for matching records
@@ -1086,6 +1092,34 @@ class JOIN_TAB_SCAN: public Sql_alloc
 
 };
 
+
+/*
+  The class JOIN_TAB_SCAN_SPILL is a companion class for the class
+  JOIN_CACHE_BNLH that is used when the records of the join buffer have
+  been partitioned on disk. It iterates over the rows of the joined table
+  that have been written into one partition file, instead of scanning
+  the table itself. The rows are read into the record buffer of the table.
+*/
+
+class JOIN_TAB_SCAN_SPILL: public JOIN_TAB_SCAN
+{
+  /* The partition file with the rows of the joined table */
+  IO_CACHE *file;
+
+public:
+
+  JOIN_TAB_SCAN_SPILL(JOIN *j, JOIN_TAB *tab) :JOIN_TAB_SCAN(j, tab)
+  {
+    file= 0;
+  }
+
+  void set_file(IO_CACHE *f) { file= f; }
+
+  int open();
+
+  int next();
+};
+
 /*
   The class JOIN_CACHE_BNL is used when the BNL join algorithm is
   employed to perform a join operation   
@@ -1147,6 +1181,51 @@ class JOIN_CACHE_BNL :public JOIN_CACHE
 class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 {
 
+private:
+
+  /*
+    The number of partitions the records are split into when they do not
+    fit into the join buffer, 0 if the records of the cache are never
+    written to disk.
+  */
+  uint spill_partitions;
+  /* The size of the buffer of each partition file */
+  size_t spill_file_buff_size;
+  /* TRUE if the records of the current join are partitioned on disk */
+  bool spilled;
+  /* TRUE if the records could not be written into the partition files */
+  bool spill_failed;
+  /*
+    TRUE if the length of the next record of the partition file being
+    loaded into the join buffer has been read into spill_rec_len_buff
+  */
+  bool spill_rec_len_pending;
+  uchar spill_rec_len_buff[4];
+  /*
+    The partition files of the records from the join buffer and of
+    the rows from join_tab, spill_partitions of each.
+  */
+  IO_CACHE *outer_files;
+  IO_CACHE *inner_files;
+  /* The iterator over the rows from join_tab in a partition file */
+  JOIN_TAB_SCAN_SPILL *spill_scan;
+
+  uint get_spill_partition(uchar *key);
+
+  uint get_curr_rec_spill_partition();
+
+  bool open_spill_files();
+
+  void close_spill_files();
+
+  bool spill_buffer();
+
+  enum_nested_loop_state partition_join_tab();
+
+  int load_spilled_records(IO_CACHE *file);
+
+  enum_nested_loop_state join_spilled_records();
+
 protected:
 
   /* 
@@ -1185,7 +1264,11 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab) : JOIN_CACHE_HASHED(j, tab) {}
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab)
+    : JOIN_CACHE_HASHED(j, tab),
+      spill_partitions(0), spill_file_buff_size(0), spilled(FALSE),
+      spill_failed(FALSE), spill_rec_len_pending(FALSE),
+      outer_files(0), inner_files(0), spill_scan(0) {}
 
   /* 
     This constructor creates a linked BNLH join cache. The cache is to be 
@@ -1194,7 +1277,10 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-    : JOIN_CACHE_HASHED(j, tab, prev) {}
+    : JOIN_CACHE_HASHED(j, tab, prev),
+      spill_partitions(0), spill_file_buff_size(0), spilled(FALSE),
+      spill_failed(FALSE), spill_rec_len_pending(FALSE),
+      outer_files(0), inner_files(0), spill_scan(0) {}
 
   /* Initialize the BNLH cache */       
   int init(bool for_explain);
@@ -1203,6 +1289,26 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 
   bool is_key_access() { return TRUE; }
 
+  size_t get_max_join_buffer_size(bool optimize_buff_size);
+
+  /*
+    Get the number of partitions the records of a BNLH cache joining tab
+    can be written into, 0 if they cannot be partitioned on disk
+  */
+  static uint get_spill_partitions(JOIN_TAB *tab, bool linked,
+                                   bool with_blobs);
+
+  /*
+    Add a record into the join buffer, partitioning the records on disk
+    when the buffer is full
+  */
+  bool put_record();
+
+  /* Join the records from the join buffer or from the partition files */
+  enum_nested_loop_state join_records(bool skip_last);
+
+  void free();
+
 };
 
 
@@ -2914,6 +2914,7 @@ void st_select_lex::init_query()
   item_list.empty();
   min_max_opt_list.empty();
   join= 0;
+  plan_cache= 0;
   having= prep_having= where= prep_where= 0;
   cond_pushed_into_where= cond_pushed_into_having= 0;
   attach_to_conds.empty();
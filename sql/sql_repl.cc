@@ -31,6 +31,7 @@
 #include "semisync_master.h"
 #include "semisync_slave.h"
 #include "mysys_err.h"
+#include "gtid_index.h"
 
 enum enum_gtid_until_state {
   GTID_UNTIL_NOT_DONE,
@@ -981,15 +982,19 @@ get_binlog_list(MEM_ROOT *memroot, bool reverse= true,
   Gtid_list_log_event where D is not present in the requested slave state at
   all. Since if D is not in requested slave state, it means that slave needs
   to start at the very first GTID in domain D.
+
+  The same check is used for the binlog states stored in the GTID index, to
+  decide if the slave can start from the corresponding offset in the file.
 */
 static bool
-contains_all_slave_gtid(slave_connection_state *st, Gtid_list_log_event *glev)
+contains_all_slave_gtid(slave_connection_state *st, const rpl_gtid *list,
+                        uint32 count)
 {
   uint32 i;
 
-  for (i= 0; i < glev->count; ++i)
+  for (i= 0; i < count; ++i)
   {
-    uint32 gl_domain_id= glev->list[i].domain_id;
+    uint32 gl_domain_id= list[i].domain_id;
     const rpl_gtid *gtid= st->find(gl_domain_id);
     if (!gtid)
     {
@@ -999,15 +1004,15 @@ contains_all_slave_gtid(slave_connection_state *st, Gtid_list_log_event *glev)
       */
       return false;
     }
-    if (gtid->server_id == glev->list[i].server_id &&
-        gtid->seq_no <= glev->list[i].seq_no)
+    if (gtid->server_id == list[i].server_id &&
+        gtid->seq_no <= list[i].seq_no)
     {
       /*
         The slave needs to start after gtid, but it is contained in an earlier
         binlog file. So we need to search back further, unless it was the very
         last gtid logged for the domain in earlier binlog files.
       */
-      if (gtid->seq_no < glev->list[i].seq_no)
+      if (gtid->seq_no < list[i].seq_no)
         return false;
 
       /*
@@ -1020,7 +1025,7 @@ contains_all_slave_gtid(slave_connection_state *st, Gtid_list_log_event *glev)
         beginning of this group, per the special case explained in comment at
         the start of this function. If not, then we need to search back further.
       */
-      if (i+1 < glev->count && gl_domain_id == glev->list[i+1].domain_id)
+      if (i+1 < count && gl_domain_id == list[i+1].domain_id)
         return false;
     }
   }
@@ -1246,6 +1251,139 @@ check_slave_start_position(binlog_send_info *info, const char **errormsg,
   return err;
 }
 
+/*
+  Update the slave connection state for starting at a point in the binlog
+  where the binlog state is (list, count) - the start of a binlog file (from
+  its Gtid_list_log_event) or a GTID index record.
+
+  As a special case, we allow to start from that point if the requested GTID
+  is the last event (in the corresponding domain) before it, but then we need
+  to remove that GTID from the slave state, rather than skipping events
+  waiting for it to turn up.
+
+  If slave is doing START SLAVE UNTIL, check for any UNTIL conditions that
+  are already reached before that point. Delete any such from the UNTIL hash,
+  to mark that such domains have already reached their UNTIL condition.
+*/
+static void
+gtid_adjust_start_state(slave_connection_state *state,
+                        slave_connection_state *until_gtid_state,
+                        const rpl_gtid *list, uint32 count)
+{
+  uint32 i;
+
+  for (i= 0; i < count; ++i)
+  {
+    const rpl_gtid *gtid= state->find(list[i].domain_id);
+    if (!gtid)
+    {
+      /*
+        Contains_all_slave_gtid() returns false if there is any domain in
+        the list which is not in the requested slave position.
+
+        We may delete a domain from the slave state inside this loop, but
+        we only do this when it is the very last GTID logged for that
+        domain before this point, and then we can not encounter it in any
+        further GTIDs in the list.
+      */
+      DBUG_ASSERT(0);
+    } else if (gtid->server_id == list[i].server_id &&
+               gtid->seq_no == list[i].seq_no)
+    {
+      /*
+        The slave requested to start from the very beginning of this
+        domain at this point. So delete the entry from the state, we do not
+        need to skip anything.
+      */
+      state->remove(gtid);
+    }
+
+    if (until_gtid_state &&
+        (gtid= until_gtid_state->find(list[i].domain_id)) &&
+        gtid->server_id == list[i].server_id &&
+        gtid->seq_no <= list[i].seq_no)
+    {
+      /*
+        We've already reached the stop position in UNTIL for this domain,
+        since it is before the start position.
+      */
+      until_gtid_state->remove(gtid);
+    }
+  }
+}
+
+
+/*
+  Use the GTID index of a binlog file to find the last indexed offset in the
+  file from which a slave with the given connection state can start.
+
+  Returns true if the index does not exist or has no usable record (then the
+  file must be read from the start). Otherwise returns false with the offset
+  in out_offset and the binlog state at that offset in out_list/out_count;
+  *out_list is reallocated as needed and must be freed by the caller.
+*/
+static bool
+gtid_index_find_start_pos(const char *binlog_name,
+                          slave_connection_state *state,
+                          my_off_t *out_offset, rpl_gtid **out_list,
+                          uint32 *out_count)
+{
+  Gtid_index_reader reader;
+  char end_pos_file[FN_REFLEN];
+  my_off_t max_offset;
+  MY_STAT stat;
+  uint32 list_size= 0;
+  bool found= false;
+
+  if (reader.open(binlog_name))
+    return true;
+
+  /*
+    The index record for an event group is written before the group itself,
+    so records in the active binlog may point beyond the part that is
+    visible to dump threads. Never use such records.
+  */
+  mysql_bin_log.lock_binlog_end_pos();
+  max_offset= mysql_bin_log.get_binlog_end_pos(end_pos_file);
+  mysql_bin_log.unlock_binlog_end_pos();
+  if (strcmp(my_basename(end_pos_file), my_basename(binlog_name)))
+  {
+    if (!mysql_file_stat(key_file_binlog, binlog_name, &stat, MYF(0)))
+      return true;
+    max_offset= (my_off_t)stat.st_size;
+  }
+
+  /*
+    Records are in increasing offset order with growing binlog state, so the
+    first record the slave cannot start from ends the search.
+  */
+  while (!reader.read_record())
+  {
+    if (reader.rec_offset <= BIN_LOG_HEADER_SIZE ||
+        reader.rec_offset > max_offset ||
+        !contains_all_slave_gtid(state, reader.gtid_list, reader.gtid_count))
+      break;
+    if (reader.gtid_count > list_size)
+    {
+      rpl_gtid *new_list= (rpl_gtid *)
+        my_realloc(PSI_INSTRUMENT_ME, *out_list,
+                   reader.gtid_count * sizeof(rpl_gtid),
+                   MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+      if (!new_list)
+        break;
+      *out_list= new_list;
+      list_size= reader.gtid_count;
+    }
+    memcpy(*out_list, reader.gtid_list, reader.gtid_count * sizeof(rpl_gtid));
+    *out_count= reader.gtid_count;
+    *out_offset= reader.rec_offset;
+    found= true;
+  }
+
+  return !found;
+}
+
+
 /*
   Find the name of the binlog file to start reading for a slave that connects
   using GTID state.
@@ -1272,17 +1410,29 @@ check_slave_start_position(binlog_send_info *info, const char **errormsg,
   corresponding entry in the slave state so we do not wrongly skip any events
   that might turn up if that domain becomes active again, vainly looking for
   the requested GTID that was already purged.
+
+  If the binlog file has a GTID index, it is used to find an offset further
+  into the file from where the slave can start (returned in out_start_pos),
+  so that the dump thread does not need to read and skip all event groups
+  from the start of the file. When starting from such an offset, the
+  Gtid_list_log_event at the start of the file is not read by the dump
+  thread, so the binlog state from the index is loaded into
+  until_binlog_state (if non-NULL) instead.
 */
 static const char *
 gtid_find_binlog_file(slave_connection_state *state, char *out_name,
-                      slave_connection_state *until_gtid_state)
+                      my_off_t *out_start_pos,
+                      slave_connection_state *until_gtid_state,
+                      rpl_binlog_state *until_binlog_state)
 {
   MEM_ROOT memroot;
   binlog_file_entry *list;
   Gtid_list_log_event *glev= NULL;
   const char *errormsg= NULL;
   char buf[FN_REFLEN];
+  rpl_gtid *index_list= NULL;
 
+  *out_start_pos= BIN_LOG_HEADER_SIZE;
   init_alloc_root(PSI_INSTRUMENT_ME, &memroot,
                   10*(FN_REFLEN+sizeof(binlog_file_entry)), 0,
                   MYF(MY_THREAD_SPECIFIC));
@@ -1326,63 +1476,36 @@ gtid_find_binlog_file(slave_connection_state *state, char *out_name,
     if (unlikely(errormsg))
       goto end;
 
-    if (!glev || contains_all_slave_gtid(state, glev))
+    if (!glev || contains_all_slave_gtid(state, glev->list, glev->count))
     {
       strmake(out_name, buf, FN_REFLEN);
 
       if (glev)
       {
-        uint32 i;
+        rpl_gtid *start_list= glev->list;
+        uint32 start_count= glev->count;
+        my_off_t index_pos= 0;
+        uint32 index_count= 0;
 
-        /*
-          As a special case, we allow to start from binlog file N if the
-          requested GTID is the last event (in the corresponding domain) in
-          binlog file (N-1), but then we need to remove that GTID from the slave
-          state, rather than skipping events waiting for it to turn up.
-
-          If slave is doing START SLAVE UNTIL, check for any UNTIL conditions
-          that are already included in a previous binlog file. Delete any such
-          from the UNTIL hash, to mark that such domains have already reached
-          their UNTIL condition.
-        */
-        for (i= 0; i < glev->count; ++i)
+        if (opt_binlog_gtid_index)
         {
-          const rpl_gtid *gtid= state->find(glev->list[i].domain_id);
-          if (!gtid)
+          if (!gtid_index_find_start_pos(buf, state, &index_pos,
+                                         &index_list, &index_count))
           {
-            /*
-              Contains_all_slave_gtid() returns false if there is any domain in
-              Gtid_list_event which is not in the requested slave position.
-
-              We may delete a domain from the slave state inside this loop, but
-              we only do this when it is the very last GTID logged for that
-              domain in earlier binlogs, and then we can not encounter it in any
-              further GTIDs in the Gtid_list.
-            */
-            DBUG_ASSERT(0);
-          } else if (gtid->server_id == glev->list[i].server_id &&
-                     gtid->seq_no == glev->list[i].seq_no)
-          {
-            /*
-              The slave requested to start from the very beginning of this
-              domain in this binlog file. So delete the entry from the state,
-              we do not need to skip anything.
-            */
-            state->remove(gtid);
-          }
-
-          if (until_gtid_state &&
-              (gtid= until_gtid_state->find(glev->list[i].domain_id)) &&
-              gtid->server_id == glev->list[i].server_id &&
-              gtid->seq_no <= glev->list[i].seq_no)
-          {
-            /*
-              We've already reached the stop position in UNTIL for this domain,
-              since it is before the start position.
-            */
-            until_gtid_state->remove(gtid);
+            *out_start_pos= index_pos;
+            start_list= index_list;
+            start_count= index_count;
+            mysql_bin_log.gtid_index_hits++;
           }
+          else
+            mysql_bin_log.gtid_index_misses++;
         }
+
+        gtid_adjust_start_state(state, until_gtid_state,
+                                start_list, start_count);
+        if (*out_start_pos > BIN_LOG_HEADER_SIZE && until_binlog_state &&
+            until_binlog_state->load(start_list, start_count))
+          errormsg= "Out of memory while looking for GTID position in binlog";
       }
 
       goto end;
@@ -1400,6 +1523,7 @@ gtid_find_binlog_file(slave_connection_state *state, char *out_name,
 end:
   if (glev)
     delete glev;
+  my_free(index_list);
 
   free_root(&memroot, MYF(0));
   return errormsg;
@@ -2168,15 +2292,15 @@ static int init_binlog_sender(binlog_send_info *info,
       return 1;
     }
     if ((info->errmsg= gtid_find_binlog_file(&info->gtid_state,
-                                             search_file_name,
-                                             info->until_gtid_state)))
+                                             search_file_name, pos,
+                                             info->until_gtid_state,
+                                             info->until_gtid_state ?
+                                             &info->until_binlog_state :
+                                             NULL)))
     {
       info->error= ER_MASTER_FATAL_ERROR_READING_BINLOG;
       return 1;
     }
-
-    /* start from beginning of binlog file */
-    *pos = 4;
   }
   else
   {
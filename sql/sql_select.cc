@@ -107,6 +107,14 @@ static ha_rows get_quick_record_count(THD *thd, SQL_SELECT *select,
 				      TABLE *table,
 				      const key_map *keys,ha_rows limit);
 static void optimize_straight_join(JOIN *join, table_map join_tables);
+static bool join_plan_cache_applicable(JOIN *join);
+static Join_plan_cache *join_plan_cache_probe(JOIN *join);
+static bool join_plan_cache_skip_range(const Join_plan_cache *cache,
+                                       JOIN_TAB *s);
+static bool join_plan_cache_lookup(JOIN *join, Join_plan_cache *cache,
+                                   table_map join_tables);
+static void join_plan_cache_store(JOIN *join);
+static void join_plan_cache_store_access(JOIN *join);
 static bool greedy_search(JOIN *join, table_map remaining_tables,
                           uint depth, uint prune_level,
                           uint use_cond_selectivity);
@@ -123,6 +131,7 @@ static int join_tab_cmp_straight(const void *dummy, const void* ptr1, const void
 static int join_tab_cmp_embedded_first(const void *emb, const void* ptr1, const void *ptr2);
 C_MODE_END
 static uint cache_record_length(JOIN *join,uint index);
+static bool cache_record_has_blobs(JOIN *join,uint index);
 static store_key *get_store_key(THD *thd,
 				KEYUSE *keyuse, table_map used_tables,
 				KEY_PART_INFO *key_part, uchar *key_buff,
@@ -2791,6 +2800,9 @@ int JOIN::optimize_stage2()
   if (make_join_readinfo(this, select_opts_for_readinfo, no_jbuf_after))
     DBUG_RETURN(1);
 
+  if (select_lex->plan_cache && join_plan_cache_applicable(this))
+    join_plan_cache_store_access(this);
+
   /* Perform FULLTEXT search before all regular searches */
   if (!(select_options & SELECT_DESCRIBE))
     if (init_ftfuncs(thd, select_lex, MY_TEST(order)))
@@ -4844,6 +4856,8 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
   List_iterator<TABLE_LIST> ti(tables_list);
   TABLE_LIST *tables;
   THD *thd= join->thd;
+  bool use_plan_cache;
+  Join_plan_cache *plan_cache;
   DBUG_ENTER("make_join_statistics");
 
   table_count=join->table_count;
@@ -5343,6 +5357,9 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
   join->join_tab= stat;
   join->make_notnull_conds_for_range_scans();
 
+  use_plan_cache= join_plan_cache_applicable(join);
+  plan_cache= use_plan_cache ? join_plan_cache_probe(join) : NULL;
+
   /* Calc how many (possible) matched records in each table */
 
   /*
@@ -5405,6 +5422,18 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
 
       s->table->cond_selectivity= 1.0;
 
+      if (plan_cache && join_plan_cache_skip_range(plan_cache, s))
+      {
+        if (thd->trace_started())
+        {
+          Json_writer_object table_records(thd);
+          table_records.add_table_name(s)
+                       .add("plan_cache", "range analysis skipped")
+                       .add("rows", s->found_records);
+        }
+        continue;
+      }
+
       /*
         Perform range analysis if there are keys it could use (1).
         Don't do range analysis for materialized subqueries (2).
@@ -5547,8 +5576,21 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
     /* Find an optimal join order of the non-constant tables. */
     if (join->const_tables != join->table_count)
     {
-      if (choose_plan(join, all_table_map & ~join->const_table_map))
-        goto error;
+      table_map join_tables= all_table_map & ~join->const_table_map;
+
+      if (plan_cache && join_plan_cache_lookup(join, plan_cache,
+                                               join_tables))
+        thd->status_var.ps_plan_cache_hits++;
+      else
+      {
+        if (choose_plan(join, join_tables))
+          goto error;
+        if (use_plan_cache)
+        {
+          thd->status_var.ps_plan_cache_misses++;
+          join_plan_cache_store(join);
+        }
+      }
 
 #ifdef HAVE_valgrind
       // JOIN::positions holds the current query plan. We've already
@@ -5563,6 +5605,19 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
 	     sizeof(POSITION)*join->const_tables);
       join->join_record_count= 1.0;
       join->best_read=1.0;
+
+      /*
+        All tables are constant, e.g. for lookups of primary keys. The
+        plan is settled by const table detection; the cache only records
+        that it is the same as before.
+      */
+      if (plan_cache && plan_cache->const_table_map == join->const_table_map)
+        thd->status_var.ps_plan_cache_hits++;
+      else if (use_plan_cache)
+      {
+        thd->status_var.ps_plan_cache_misses++;
+        join_plan_cache_store(join);
+      }
     }
   
     if (!(join->select_options & SELECT_DESCRIBE) &&
@@ -7814,7 +7869,36 @@ best_access_path(JOIN      *join,
     double refills= (1.0 + floor((double) cache_record_length(join,idx) *
                            record_count /
 			   (double) thd->variables.join_buff_size));
+    double scan_cost= tmp;
     tmp= COST_MULT(tmp, refills);
+    /*
+      The cache is linked to the cache of the previous table unless
+      join_cache_level=3 or the previous table is the first one.
+    */
+    bool linked= join->max_allowed_join_cache_level != 3 &&
+                 idx > join->const_tables + 1;
+    if (refills > 1.0 &&
+        JOIN_CACHE_BNLH::get_spill_partitions(s, linked,
+                                              cache_record_has_blobs(join,
+                                                                     idx)))
+    {
+      /*
+        Instead of being refilled the join buffer can be partitioned on
+        disk. Then the table is read only once, while the records of the
+        buffer and the rows of the table are written into partition files
+        and read back.
+      */
+      double spill_bytes= (double) cache_record_length(join,idx) *
+                          record_count +
+                          rnd_records * s->table->s->reclength;
+      double spill_cost= COST_ADD(scan_cost, 2.0 * spill_bytes / IO_SIZE);
+      if (spill_cost < tmp)
+      {
+        tmp= spill_cost;
+        trace_access_hash.add("spill_partitions",
+                              thd->variables.join_cache_spill_partitions);
+      }
+    }
     best_time= COST_ADD(tmp,
                         COST_MULT((record_count*join_sel) / TIME_FOR_COMPARE,
                                   rnd_records));
@@ -8259,6 +8343,303 @@ choose_plan(JOIN *join, table_map join_tables)
 }
 
 
+/*
+  Class of a row estimate, as compared by the plan cache: zero for no rows,
+  otherwise the position of the highest bit set in the estimate plus one.
+*/
+
+static inline uchar join_plan_estimate_class(double rows)
+{
+  ulonglong records= (ulonglong) rows;
+  return (uchar) (records ? my_bit_log2_uint64(records) + 1 : 0);
+}
+
+
+/*
+  Index used by the access method of a table, as stored in the plan cache.
+*/
+
+static uint join_plan_tab_key(const JOIN_TAB *tab)
+{
+  switch (tab->type) {
+  case JT_CONST:
+  case JT_EQ_REF:
+  case JT_REF:
+  case JT_REF_OR_NULL:
+    return tab->ref.key >= 0 ? (uint) tab->ref.key : MAX_KEY;
+  case JT_NEXT:
+    return tab->index;
+  default:
+    break;
+  }
+  if (tab->select && tab->select->quick)
+    return tab->select->quick->index;
+  return MAX_KEY;
+}
+
+
+/**
+  Check whether the plan of this join may be taken from and kept in
+  SELECT_LEX::plan_cache.
+
+  Only joins of a prepared statement executed with @@prepared_stmt_plan_cache
+  set qualify. Semi-join nests are left out as the order of their tables
+  is tied to the chosen semi-join strategy, and STRAIGHT_JOIN needs no
+  search anyway.
+*/
+
+static bool join_plan_cache_applicable(JOIN *join)
+{
+  THD *thd= join->thd;
+  return (thd->variables.prepared_stmt_plan_cache &&
+          thd->stmt_arena->type() == Query_arena::PREPARED_STATEMENT &&
+          !join->emb_sjm_nest &&
+          !join->select_lex->sj_nests.elements &&
+          !(join->select_options & SELECT_STRAIGHT_JOIN));
+}
+
+
+/**
+  Find the plan stored by a previous execution, once the const tables
+  are known.
+
+  The plan is usable if the statistics have not changed since it was
+  stored, and the same tables were found to be constant, with the same
+  access methods.
+
+  @return the cached plan, or NULL if there is none that fits
+*/
+
+static Join_plan_cache *join_plan_cache_probe(JOIN *join)
+{
+  Join_plan_cache *cache= join->select_lex->plan_cache;
+  DBUG_ENTER("join_plan_cache_probe");
+
+  if (!cache || !cache->valid)
+    DBUG_RETURN(NULL);
+
+  if (cache->version != join_plan_cache_version)
+  {
+    cache->valid= false;
+    join->thd->status_var.ps_plan_cache_invalidations++;
+    DBUG_RETURN(NULL);
+  }
+
+  if (cache->table_count != join->table_count ||
+      cache->const_table_map != join->const_table_map)
+    DBUG_RETURN(NULL);
+
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    uint tablenr= tab->table->tablenr;
+    if (tablenr >= cache->table_count)
+      DBUG_RETURN(NULL);
+    if (!(tab->table->map & join->const_table_map))
+      continue;
+    const Join_plan_cache::Tab_plan &tp= cache->tab[tablenr];
+    if (cache->access_known &&
+        (tp.type != tab->type || tp.key != join_plan_tab_key(tab)))
+      DBUG_RETURN(NULL);
+  }
+  DBUG_RETURN(cache);
+}
+
+
+/**
+  Check whether the range analysis of a table can be skipped, and if so
+  take its results from the cached plan.
+
+  The analysis is skipped if the finished plan of the previous execution
+  did not read the table with a range scan, the table was read by an
+  index lookup or had no index usable for a range, and its row estimate
+  from the table statistics is of the same class as then. Like the cached
+  join order, the cached estimates then stand for all parameter values.
+
+  @param cache  the plan returned by join_plan_cache_probe()
+  @param s      a non-constant table, after JOIN_TAB::scan_time()
+
+  @retval TRUE   s->found_records, s->read_time and the condition
+                 selectivity were taken from the cache
+  @retval FALSE  the range analysis must be done
+*/
+
+static bool join_plan_cache_skip_range(const Join_plan_cache *cache,
+                                       JOIN_TAB *s)
+{
+  if (!cache->access_known)
+    return FALSE;
+
+  const Join_plan_cache::Tab_plan &tp= cache->tab[s->table->tablenr];
+
+  if (tp.quick_type >= 0 ||
+      tp.stats_class != join_plan_estimate_class((double) s->records))
+    return FALSE;
+
+  switch (tp.type) {
+  case JT_EQ_REF:
+  case JT_REF:
+  case JT_REF_OR_NULL:
+    break;
+  default:
+    if (!s->const_keys.is_clear_all())
+      return FALSE;
+  }
+
+  s->found_records= tp.found_records;
+  s->read_time= tp.read_time;
+  s->table->cond_selectivity= tp.cond_selectivity;
+  return TRUE;
+}
+
+
+/**
+  Try to reuse the join order stored by a previous execution.
+
+  The order is reused if the range estimates of all non-constant tables
+  fall into the same classes as when it was stored. The access methods
+  are then recomputed for that order by optimize_straight_join(), which
+  skips the search over the possible orders done by choose_plan().
+
+  @param join         the join being optimized
+  @param cache        the plan returned by join_plan_cache_probe()
+  @param join_tables  set of the non-constant tables of the join
+
+  @retval TRUE   join->best_positions holds the plan for the cached order
+  @retval FALSE  the cached order does not fit, choose_plan() must be called
+*/
+
+static bool join_plan_cache_lookup(JOIN *join, Join_plan_cache *cache,
+                                   table_map join_tables)
+{
+  THD *thd= join->thd;
+  DBUG_ENTER("join_plan_cache_lookup");
+
+  /* The range analysis may have found more const tables */
+  if (cache->const_table_map != join->const_table_map)
+    DBUG_RETURN(FALSE);
+
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    if (!(tab->table->map & join->const_table_map) &&
+        cache->tab[tab->table->tablenr].records_class !=
+        join_plan_estimate_class(tab->found_records))
+      DBUG_RETURN(FALSE);
+  }
+
+  for (uint i= join->const_tables; i < join->table_count; i++)
+    join->best_ref[i]= join->join_tab + cache->order[i - join->const_tables];
+  DBUG_ASSERT(!join->best_ref[join->table_count]);
+
+  join->cur_embedding_map= 0;
+  reset_nj_counters(join, join->join_list);
+  join->cur_sj_inner_tables= 0;
+  {
+    Json_writer_object wrapper(thd);
+    wrapper.add("plan_cache", "hit");
+    Json_writer_array trace_plan(thd, "considered_execution_plans");
+    optimize_straight_join(join, join_tables);
+  }
+  if (thd->lex->is_single_level_stmt())
+    thd->status_var.last_query_cost= join->best_read;
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Store the join order chosen by choose_plan() and the row estimates of
+  the tables in SELECT_LEX::plan_cache.
+
+  The cache is allocated on the statement memory root the first time, so
+  that it survives the execution, and is overwritten afterwards. The
+  access methods are added by join_plan_cache_store_access() once they
+  are final.
+*/
+
+static void join_plan_cache_store(JOIN *join)
+{
+  THD *thd= join->thd;
+  SELECT_LEX *select= join->select_lex;
+  Join_plan_cache *cache= select->plan_cache;
+  DBUG_ENTER("join_plan_cache_store");
+
+  if (!cache)
+  {
+    MEM_ROOT *mem_root= thd->stmt_arena->mem_root;
+    uint *order;
+    Join_plan_cache::Tab_plan *tab;
+    if (!multi_alloc_root(mem_root,
+                          &cache, sizeof(Join_plan_cache),
+                          &order, sizeof(uint) * join->table_count,
+                          &tab, sizeof(*tab) * join->table_count,
+                          NullS))
+      DBUG_VOID_RETURN;
+    cache= new (cache) Join_plan_cache(join->table_count, order, tab);
+    select->plan_cache= cache;
+  }
+  else if (cache->table_count != join->table_count)
+    DBUG_VOID_RETURN;
+
+  for (uint i= 0; i < join->table_count; i++)
+    if (join->join_tab[i].table->tablenr >= cache->table_count)
+    {
+      cache->valid= false;
+      DBUG_VOID_RETURN;
+    }
+
+  for (uint i= join->const_tables; i < join->table_count; i++)
+    cache->order[i - join->const_tables]=
+      (uint) (join->best_positions[i].table - join->join_tab);
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *s= join->join_tab + i;
+    Join_plan_cache::Tab_plan &tp= cache->tab[s->table->tablenr];
+    tp.stats_class= join_plan_estimate_class((double) s->records);
+    tp.records_class= join_plan_estimate_class(s->found_records);
+    tp.found_records= s->found_records;
+    tp.read_time= s->read_time;
+    tp.cond_selectivity= s->table->cond_selectivity;
+  }
+  cache->const_table_map= join->const_table_map;
+  cache->version= join_plan_cache_version;
+  cache->access_known= false;
+  cache->valid= true;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Add the finished access methods of the tables to the plan stored by
+  join_plan_cache_store() during this execution.
+*/
+
+static void join_plan_cache_store_access(JOIN *join)
+{
+  Join_plan_cache *cache= join->select_lex->plan_cache;
+  DBUG_ENTER("join_plan_cache_store_access");
+
+  if (!cache || !cache->valid)
+    DBUG_VOID_RETURN;
+
+  for (JOIN_TAB *tab= first_linear_tab(join, WITH_BUSH_ROOTS,
+                                       WITH_CONST_TABLES);
+       tab;
+       tab= next_linear_tab(join, tab, WITH_BUSH_ROOTS))
+  {
+    if (!tab->table || tab->table->tablenr >= cache->table_count)
+      continue;
+    Join_plan_cache::Tab_plan &tp= cache->tab[tab->table->tablenr];
+    tp.type= (uchar) tab->type;
+    tp.key= join_plan_tab_key(tab);
+    tp.quick_type= tab->select && tab->select->quick
+      ? tab->select->quick->get_type() : -1;
+  }
+  cache->access_known= true;
+  DBUG_VOID_RETURN;
+}
+
+
 /*
   Compare two join tabs based on the subqueries they are from.
    - top-level join tabs go first
@@ -9825,6 +10206,27 @@ cache_record_length(JOIN *join,uint idx)
 }
 
 
+/*
+  Check whether a join buffer for the first idx tables of the join order
+  stores blob fields. cache_record_length() must have been called.
+*/
+
+static bool
+cache_record_has_blobs(JOIN *join,uint idx)
+{
+  JOIN_TAB **pos,**end;
+
+  for (pos=join->best_ref+join->const_tables,end=join->best_ref+idx ;
+       pos != end ;
+       pos++)
+  {
+    if ((*pos)->used_blobs)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
 /*
   Get the number of different row combinations for subset of partial join
 
@@ -18579,9 +18981,20 @@ bool Create_tmp_table::finalize(THD *thd,
   DBUG_ASSERT(m_alloced_field_count >= share->fields);
   DBUG_ASSERT(m_alloced_field_count >= share->blob_fields);
 
+  /*
+    HEAP stores blobs out of line, but cannot have a blob in a key. Blobs
+    among the fields of the distinct key need a unique constraint anyway.
+  */
+  bool blob_in_key= m_blobs_count[distinct] > 0;
+  for (ORDER *tmp= m_group; tmp && !blob_in_key; tmp= tmp->next)
+  {
+    Field *field= (*tmp->item)->get_tmp_table_field();
+    blob_in_key= field && (field->flags & BLOB_FLAG);
+  }
+
   /* If result table is small; use a heap */
   /* future: storage engine selection can be made dynamic? */
-  if (share->blob_fields || m_using_unique_constraint
+  if (blob_in_key || m_using_unique_constraint
       || (thd->variables.big_tables && !(m_select_options & SELECT_SMALL_RESULT))
       || (m_select_options & TMP_TABLE_FORCE_MYISAM)
       || thd->variables.tmp_memory_table_size == 0)
@@ -20616,8 +21029,10 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
   ha_rows found_records=join->found_records;
   COND *select_cond= join_tab->select_cond;
   bool select_cond_result= TRUE;
+  const bool select_cond_checked= join_tab->select_cond_checked;
 
   DBUG_ENTER("evaluate_join_record");
+  join_tab->select_cond_checked= false;
   DBUG_PRINT("enter",
              ("evaluate_join_record join: %p join_tab: %p"
               " cond: %p error: %d  alias %s",
@@ -20635,7 +21050,7 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
 
   join_tab->tracker->r_rows++;
 
-  if (select_cond)
+  if (select_cond && !select_cond_checked)
   {
     select_cond_result= MY_TEST(select_cond->val_int());
 
@@ -21484,9 +21899,97 @@ int join_init_read_record(JOIN_TAB *tab)
   if (init_read_record(&tab->read_record, tab->join->thd, tab->table,
                        tab->select, tab->filesort_result, 1,1, FALSE))
     return 1;
+  if (tab->read_record.read_record_func == rr_sequential)
+    tab->init_batch_read();
   return tab->read_record.read_record();
 }
 
+
+/**
+  Read the next row of a batched table scan, skipping the rows that do not
+  satisfy the condition attached to the table.
+
+  The rejected rows are accounted for exactly as evaluate_join_record()
+  would do, but without returning to sub_select() for each of them.
+  Rows that satisfy the condition are marked with
+  JOIN_TAB::select_cond_checked, so that evaluate_join_record() does not
+  evaluate the condition again.
+*/
+
+static int rr_sequential_batch_and_filter(READ_RECORD *info)
+{
+  JOIN_TAB *tab= info->table->reginfo.join_tab;
+  JOIN *join= tab->join;
+  THD *thd= join->thd;
+  int error;
+
+  while (!(error= rr_sequential_batch(info)))
+  {
+    if (tab->select_cond->val_int())
+    {
+      tab->select_cond_checked= true;
+      break;
+    }
+    if (unlikely(thd->is_error()))
+      return 1;
+    if (unlikely(thd->check_killed()))
+    {
+      thd->send_kill_message();
+      return 1;
+    }
+    tab->tracker->r_rows++;
+    join->join_examined_rows++;
+    thd->get_stmt_da()->inc_current_row_for_warning();
+    info->unlock_row(tab);
+  }
+  return error;
+}
+
+
+/**
+  Read the table scan of this JOIN_TAB in batches, if the storage engine
+  supports it and nothing needs the handler to be positioned on the row
+  that was returned last (locking reads, rowids, updates).
+
+  If this is the first table of the join and the condition attached to it
+  is cheap, has no side effects and only depends on the table itself,
+  the rows are also filtered while walking through the batch.
+*/
+
+void JOIN_TAB::init_batch_read()
+{
+  THD *thd= join->thd;
+
+  if (!(table->file->ha_table_flags() & HA_CAN_RND_BATCH) ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      table->reginfo.lock_type > TL_READ_NO_INSERT ||
+      keep_current_rowid || table->s->blob_fields || table->vfield)
+    return;
+
+  if (!batch_buff)
+  {
+    const uint reclength= table->s->rec_buff_length;
+    uint rows= (uint) MY_MIN(thd->variables.read_buff_size / reclength,
+                             1024);
+    if (rows < 2 ||
+        !(batch_buff= (uchar*) thd->alloc((size_t) rows * reclength)))
+      return;
+    /* Columns that the engine does not read must still be initialized */
+    for (uint i= 0; i < rows; i++)
+      memcpy(batch_buff + (size_t) i * reclength, table->s->default_values,
+             reclength);
+    batch_buff_rows= rows;
+  }
+
+  init_read_record_batch(&read_record, batch_buff, batch_buff_rows);
+
+  if (select_cond && this == join->join_tab + join->const_tables &&
+      table->reginfo.join_tab == this && !bush_root_tab && !first_inner &&
+      !(select_cond->used_tables() & ~table->map) &&
+      !select_cond->with_subquery() && !select_cond->is_expensive())
+    read_record.read_record_func= rr_sequential_batch_and_filter;
+}
+
 int
 join_read_record_no_init(JOIN_TAB *tab)
 {
@@ -23923,8 +24426,9 @@ JOIN_TAB::remove_duplicates()
     thd->reset_killed();
 
   table->file->info(HA_STATUS_VARIABLE);
-  if (table->s->db_type() == heap_hton ||
-      (!table->s->blob_fields &&
+  /* The hash index only uses sort_length() bytes of a blob */
+  if (!table->s->blob_fields &&
+      (table->s->db_type() == heap_hton ||
        ((ALIGN_SIZE(keylength) + HASH_OVERHEAD) * table->file->stats.records <
 	thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, table, field_count, first_field,
@@ -526,6 +526,17 @@ typedef struct st_join_table {
 
   void build_range_rowid_filter_if_needed();
 
+  /* Buffer for reading a table scan in batches, see init_batch_read() */
+  uchar *batch_buff;
+  uint batch_buff_rows;
+  /*
+    The current row was returned by rr_sequential_batch_and_filter(), which
+    has already found select_cond to be true for it
+  */
+  bool select_cond_checked;
+
+  void init_batch_read();
+
   void cleanup();
   inline bool is_using_loose_index_scan()
   {
@@ -2533,6 +2544,69 @@ class Pushdown_select: public Sql_alloc
 };
 
 
+/**
+  Query plan of a SELECT kept between executions of a prepared statement.
+
+  The cache holds the join order and the finished access method of every
+  table: the access type, the index and the kind of the range scan, if
+  any. It is looked up after const table detection, which has to run on
+  every execution as it reads the const rows for the parameter values.
+  When the same tables turn out to be constant:
+
+  - A table whose cached access did not use a range scan is not given to
+    the range optimizer again if its row estimate from the table
+    statistics has the same class as before. The estimates of the range
+    analysis of the previous execution are used instead.
+  - If the range estimates of all other tables are of the same class as
+    well, the search for a join order is skipped and only the access
+    methods are recomputed for the stored order.
+
+  Changing the definition of a table makes the statement be reprepared,
+  which gives it a new SELECT_LEX and so an empty cache. Statistics
+  changes are caught by comparing join_plan_cache_version.
+*/
+
+class Join_plan_cache
+{
+public:
+  /* Cached plan of one table, indexed by TABLE::tablenr */
+  struct Tab_plan
+  {
+    /* Class of the row estimate from the table statistics */
+    uchar stats_class;
+    /* Class of the row estimate after range analysis */
+    uchar records_class;
+    /* Access type of the finished plan (enum join_type) */
+    uchar type;
+    /* QUICK_SELECT_I::get_type() of the range scan, or -1 for none */
+    int quick_type;
+    /* Index used by the access method, or MAX_KEY */
+    uint key;
+    /* Results of the range analysis */
+    double found_records;
+    double read_time;
+    double cond_selectivity;
+  };
+
+  Join_plan_cache(uint table_count_arg, uint *order_arg, Tab_plan *tab_arg)
+    :version(0), const_table_map(0), table_count(table_count_arg),
+     order(order_arg), tab(tab_arg), valid(false), access_known(false)
+  {}
+
+  /* join_plan_cache_version when the plan was stored */
+  uint64_t version;
+  /* Tables found to be constant */
+  table_map const_table_map;
+  uint table_count;
+  /* Indexes in JOIN::join_tab of the non-constant tables, in join order */
+  uint *order;
+  Tab_plan *tab;
+  bool valid;
+  /* Whether Tab_plan::type, quick_type and key are set */
+  bool access_known;
+};
+
+
 bool test_if_order_compatible(SQL_I_List<ORDER> &a, SQL_I_List<ORDER> &b);
 int test_if_group_changed(List<Cached_item> &list);
 int create_sort_index(THD *thd, JOIN *join, JOIN_TAB *tab, Filesort *fsort);
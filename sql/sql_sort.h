@@ -533,6 +533,8 @@ class Sort_param {
   Addon_fields *addon_fields;     // Descriptors for companion fields.
   Sort_keys *sort_keys;
   bool using_pq;
+  uint sort_threads;            // Max threads for sorting a buffer
+  uint sort_threads_used;       // Max threads that sorted a buffer
 
   uchar *unique_buff;
   bool not_killable;
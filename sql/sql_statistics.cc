@@ -32,6 +32,10 @@
 #include "uniques.h"
 #include "sql_show.h"
 #include "sql_partition.h"
+#include <tpool.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 /*
   The system variable 'use_stat_tables' can take one of the
@@ -173,17 +177,17 @@ TABLE_FIELD_TYPE column_stat_fields[COLUMN_STAT_N_FIELDS] =
   },
   {
     { STRING_WITH_LEN("hist_size") },
-    { STRING_WITH_LEN("tinyint(3)") },
+    { STRING_WITH_LEN("smallint(5)") },
     { NULL, 0 }
   },
   {
     { STRING_WITH_LEN("hist_type") },
-    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB')") },
+    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','ENDPOINT_HB')") },
     { STRING_WITH_LEN("utf8") }
   },
   {
     { STRING_WITH_LEN("histogram") },
-    { STRING_WITH_LEN("varbinary(255)") },
+    { STRING_WITH_LEN("longblob") },
     { NULL, 0 }
   }
 };
@@ -1068,8 +1072,13 @@ class Column_stat: public Stat_table
           stat_field->store(table_field->collected_stats->get_avg_frequency());
           break; 
         case COLUMN_STAT_HIST_SIZE:
-          stat_field->store(table_field->collected_stats->histogram.get_size());
+        {
+          /* For ENDPOINT_HB hist_size is the number of buckets */
+          Histogram *hist= &table_field->collected_stats->histogram;
+          stat_field->store(hist->get_type() == ENDPOINT_HB ?
+                            hist->get_width() : hist->get_size());
           break;
+        }
         case COLUMN_STAT_HIST_TYPE:
           stat_field->store(table_field->collected_stats->histogram.get_type() +
                             1);
@@ -1158,9 +1167,16 @@ class Column_stat: public Stat_table
             table_field->read_stats->histogram.set_size(stat_field->val_int());
             break;            
           case COLUMN_STAT_HIST_TYPE:
+            Histogram *hist= &table_field->read_stats->histogram;
             Histogram_type hist_type= (Histogram_type) (stat_field->val_int() -
                                                         1);
-            table_field->read_stats->histogram.set_type(hist_type);
+            hist->set_type(hist_type);
+            /*
+              The size of an ENDPOINT_HB histogram is known only when it
+              has been read, hist_size is its number of buckets.
+            */
+            if (hist_type == ENDPOINT_HB)
+              hist->set_endpoint_buckets(hist->get_size());
             break;            
           }
         }
@@ -1199,6 +1215,32 @@ class Column_stat: public Stat_table
     }
   }
 
+
+  /**
+    @brief
+    Read an ENDPOINT_HB histogram from column_stats
+
+    @details
+    Like get_histogram_value(), but the histogram is decoded into memory
+    allocated in the statistical data of the table share. The record buffer
+    of 'table' is used to convert the stored values.
+  */
+
+  void get_endpoint_histogram_value()
+  {
+    if (find_stat())
+    {
+      String val;
+      Field *stat_field= stat_table->field[COLUMN_STAT_HISTOGRAM];
+      Field *field= table->field[table_field->field_index];
+      stat_field->val_str(&val);
+      if (!table_field->read_stats->histogram.load_endpoints(field,
+                                                 (const uchar *) val.ptr(),
+                                                 val.length()))
+        table_field->read_stats->set_not_null(COLUMN_STAT_HISTOGRAM);
+    }
+  }
+
 };
 
 
@@ -1581,6 +1623,294 @@ class Histogram_builder
 };
 
 
+/*
+  Endpoint_histogram_builder is a helper class that is used to build
+  ENDPOINT_HB histograms for columns.
+
+  The distinct values of the column are walked only once, in ascending
+  order, because Unique::walk() cannot be repeated. So the most common
+  values are not known yet while the buckets are being filled. The builder
+  keeps the values with the largest counts in a priority queue, together
+  with the bucket each of them has been counted in. When the walk is over,
+  the values that are clearly more frequent than the average one become
+  the most common values of the histogram and are taken out of their
+  buckets.
+*/
+
+class Endpoint_histogram_builder
+{
+  struct Mcv_candidate
+  {
+    ulonglong count;       /* number of rows with the value                */
+    ulonglong seq;         /* number of the value in the walk              */
+    uint bucket;           /* the bucket the value has been counted in     */
+    uchar *value;          /* the value, as a key of the Unique tree       */
+    uchar *prev_value;     /* the value that precedes it in the walk       */
+  };
+
+  Field *column;           /* table field for which the histogram is built */
+  uint col_length;         /* size of this field                           */
+  ha_rows records;         /* number of records the histogram is built for */
+  Field *min_value;        /* pointer to the minimal value for the field   */
+  Field *max_value;        /* pointer to the maximal value for the field   */
+  Histogram *histogram;    /* the histogram location                       */
+  uint hist_width;         /* the maximal number of buckets                */
+  uint curr_bucket;        /* number of the current bucket to be built     */
+  double next_bound;       /* value of count that closes the bucket        */
+  ulonglong count;         /* number of values retrieved                   */
+  ulonglong count_distinct;    /* number of distinct values retrieved      */
+  /* number of distinct values that occured only once  */
+  ulonglong count_distinct_single_occurence;
+
+  uchar *buffer;           /* memory for the arrays below                  */
+  ulonglong *bucket_rows;  /* number of rows in each bucket                */
+  ulonglong *bucket_ndv;   /* number of distinct values in each bucket     */
+  uchar *bucket_ends;      /* the last value of each bucket                */
+  ulonglong *bucket_last_seq;  /* number of the last value of each bucket  */
+  uchar *prev_value;       /* the last value retrieved                     */
+  Mcv_candidate *candidates;
+  QUEUE mcv_queue;         /* candidates, with the smallest count on top   */
+
+  static int cmp_candidate_count(void *, uchar *a, uchar *b)
+  {
+    ulonglong ca= ((Mcv_candidate *) a)->count;
+    ulonglong cb= ((Mcv_candidate *) b)->count;
+    return ca < cb ? -1 : ca > cb;
+  }
+
+  static int cmp_candidate_seq(const void *a, const void *b)
+  {
+    ulonglong sa= (*(Mcv_candidate **) a)->seq;
+    ulonglong sb= (*(Mcv_candidate **) b)->seq;
+    return sa < sb ? -1 : sa > sb;
+  }
+
+  void add_candidate(void *elem, element_count elem_cnt)
+  {
+    Mcv_candidate *cand;
+    if (mcv_queue.elements < mcv_queue.max_elements)
+    {
+      cand= candidates + mcv_queue.elements;
+      fill_candidate(cand, elem, elem_cnt);
+      queue_insert(&mcv_queue, (uchar *) cand);
+    }
+    else if ((cand= (Mcv_candidate *) queue_top(&mcv_queue))->count <
+             elem_cnt)
+    {
+      fill_candidate(cand, elem, elem_cnt);
+      queue_replace_top(&mcv_queue);
+    }
+  }
+
+  void fill_candidate(Mcv_candidate *cand, void *elem, element_count elem_cnt)
+  {
+    cand->count= elem_cnt;
+    cand->seq= count_distinct;
+    cand->bucket= curr_bucket;
+    memcpy(cand->value, elem, col_length);
+    memcpy(cand->prev_value, prev_value, col_length);
+  }
+
+  /* Find the chosen most common value with the given number in the walk */
+  static Mcv_candidate *find_mcv_by_seq(Mcv_candidate **mcvs, uint n_mcv,
+                                        ulonglong seq)
+  {
+    uint lo= 0, hi= n_mcv;
+    while (lo < hi)
+    {
+      uint mid= (lo + hi) / 2;
+      if (mcvs[mid]->seq == seq)
+        return mcvs[mid];
+      if (mcvs[mid]->seq < seq)
+        lo= mid + 1;
+      else
+        hi= mid;
+    }
+    return NULL;
+  }
+
+  /* Append the value that is in the record buffer of column */
+  bool append_value(String *to)
+  {
+    char buff[MAX_FIELD_WIDTH];
+    String val(buff, sizeof(buff), &my_charset_bin);
+    uchar len[2];
+    column->val_str(&val);
+    uint length= (uint) MY_MIN(val.length(), UINT_MAX16);
+    int2store(len, length);
+    return to->append((const char *) len, 2) ||
+           to->append(val.ptr(), length);
+  }
+
+public:
+  Endpoint_histogram_builder(Field *col, uint col_len, ha_rows rows)
+    : column(col), col_length(col_len), records(rows), curr_bucket(0),
+      count(0), count_distinct(0), count_distinct_single_occurence(0),
+      buffer(NULL)
+  {
+    Column_statistics *col_stats= col->collected_stats;
+    min_value= col_stats->min_value;
+    max_value= col_stats->max_value;
+    histogram= &col_stats->histogram;
+    hist_width= histogram->get_width();
+    next_bound= (double) records / hist_width;
+    bzero(&mcv_queue, sizeof(mcv_queue));
+
+    size_t entry_size= 3 * sizeof(ulonglong) + sizeof(Mcv_candidate) +
+                       3 * col_length;
+    if (!(buffer= (uchar *) my_malloc(PSI_INSTRUMENT_ME,
+                                      entry_size * hist_width + col_length,
+                                      MYF(MY_ZEROFILL))) ||
+        init_queue(&mcv_queue, hist_width, 0, 0, cmp_candidate_count,
+                   NULL, 0, 0))
+    {
+      my_free(buffer);
+      buffer= NULL;
+      return;
+    }
+    candidates= (Mcv_candidate *) buffer;
+    bucket_rows= (ulonglong *) (candidates + hist_width);
+    bucket_ndv= bucket_rows + hist_width;
+    bucket_last_seq= bucket_ndv + hist_width;
+    bucket_ends= (uchar *) (bucket_last_seq + hist_width);
+    uchar *values= bucket_ends + col_length * hist_width;
+    for (uint i= 0; i < hist_width; i++)
+    {
+      candidates[i].value= values + col_length * 2 * i;
+      candidates[i].prev_value= candidates[i].value + col_length;
+    }
+    prev_value= values + col_length * 2 * hist_width;
+  }
+
+  ~Endpoint_histogram_builder()
+  {
+    delete_queue(&mcv_queue);
+    my_free(buffer);
+  }
+
+  ulonglong get_count_distinct() const { return count_distinct; }
+  ulonglong get_count_single_occurence() const
+  {
+    return count_distinct_single_occurence;
+  }
+
+  int next(void *elem, element_count elem_cnt)
+  {
+    count_distinct++;
+    if (elem_cnt == 1)
+      count_distinct_single_occurence++;
+    count+= elem_cnt;
+    if (!buffer)
+      return 0;
+    memcpy(bucket_ends + curr_bucket * col_length, elem, col_length);
+    bucket_rows[curr_bucket]+= elem_cnt;
+    bucket_ndv[curr_bucket]++;
+    bucket_last_seq[curr_bucket]= count_distinct;
+    if (elem_cnt > 1)
+      add_candidate(elem, elem_cnt);
+    memcpy(prev_value, elem, col_length);
+    if (count >= next_bound && curr_bucket + 1 < hist_width)
+    {
+      curr_bucket++;
+      /*
+        Spread the remaining rows evenly over the remaining buckets, so
+        that a frequent value does not leave the following buckets empty.
+      */
+      next_bound= count + (double) (records - count) /
+                          (hist_width - curr_bucket);
+    }
+    return 0;
+  }
+
+  /*
+    Choose the most common values, and store the serialized histogram in
+    the memory of the table
+  */
+  void finish()
+  {
+    String data;
+    uchar buff[8];
+    uint n_mcv= 0, n_buckets= 0;
+    Mcv_candidate **mcvs= (Mcv_candidate **) mcv_queue.root + 1;
+
+    histogram->set_endpoint_histogram(NULL, 0, 0, 0);
+    if (!buffer || !count)
+      return;
+
+    /*
+      A value is kept apart from the buckets when it is more frequent
+      than the average value in a noticeable way.
+    */
+    double min_mcv_count= 1.25 * count / count_distinct;
+    for (uint i= 0; i < mcv_queue.elements; i++)
+    {
+      Mcv_candidate *cand= mcvs[i];
+      if (cand->count > min_mcv_count)
+      {
+        bucket_rows[cand->bucket]-= cand->count;
+        bucket_ndv[cand->bucket]--;
+        mcvs[n_mcv++]= cand;
+      }
+    }
+    my_qsort(mcvs, n_mcv, sizeof(Mcv_candidate *), cmp_candidate_seq);
+
+    bzero(buff, 8);
+    if (data.append((const char *) buff, 8))
+      return;
+    for (uint i= 0; i < n_mcv; i++)
+    {
+      double fraction= (double) mcvs[i]->count / records;
+      column->store_field_value(mcvs[i]->value, col_length);
+      float8store(buff, fraction);
+      if (data.append((const char *) buff, 8) || append_value(&data))
+        return;
+    }
+
+    ulonglong cum_rows= 0;
+    for (uint i= 0; i <= curr_bucket; i++)
+    {
+      if (!bucket_ndv[i])
+        continue;
+      cum_rows+= bucket_rows[i];
+      /*
+        The endpoint is the last value that stays in the bucket: skip
+        the most common values at the end of the bucket, which have been
+        taken out of it. bucket_ndv[i] != 0 guarantees that the bucket
+        still has a value of its own before them.
+      */
+      const uchar *end= bucket_ends + i * col_length;
+      Mcv_candidate *mcv;
+      for (ulonglong seq= bucket_last_seq[i];
+           (mcv= find_mcv_by_seq(mcvs, n_mcv, seq)); seq--)
+        end= mcv->prev_value;
+      column->store_field_value((uchar *) end, col_length);
+      double fraction= (double) cum_rows / records;
+      double pos= column->pos_in_interval(min_value, max_value);
+      float8store(buff, fraction);
+      if (data.append((const char *) buff, 8))
+        return;
+      float8store(buff, pos);
+      if (data.append((const char *) buff, 8))
+        return;
+      int4store(buff, (uint32) MY_MIN(bucket_ndv[i], UINT_MAX32));
+      if (data.append((const char *) buff, 4) || append_value(&data))
+        return;
+      n_buckets++;
+    }
+    int4store((uchar *) data.ptr(), n_mcv);
+    int4store((uchar *) data.ptr() + 4, n_buckets);
+
+    /* The columns of a table may be finished by several threads at once */
+    mysql_mutex_lock(&column->table->s->LOCK_share);
+    uchar *hist= (uchar *) memdup_root(&column->table->mem_root,
+                                       data.ptr(), data.length());
+    mysql_mutex_unlock(&column->table->s->LOCK_share);
+    if (hist)
+      histogram->set_endpoint_histogram(hist, data.length(), n_buckets, n_mcv);
+  }
+};
+
+
 C_MODE_START
 
 int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
@@ -1590,6 +1920,15 @@ int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
 }
 
 
+int endpoint_histogram_build_walk(void *elem, element_count elem_cnt,
+                                  void *arg)
+{
+  Endpoint_histogram_builder *hist_builder=
+    (Endpoint_histogram_builder *) arg;
+  return hist_builder->next(elem, elem_cnt);
+}
+
+
 
 static int count_distinct_single_occurence_walk(void *elem,
                                                 element_count count, void *arg)
@@ -1699,6 +2038,21 @@ class Count_distinct_field: public Sql_alloc
     distincts_single_occurence= hist_builder.get_count_single_occurence();
   }
 
+  /*
+    @brief
+    Calculate an ENDPOINT_HB histogram of the tree
+  */
+  void walk_tree_with_endpoint_histogram(ha_rows rows)
+  {
+    Endpoint_histogram_builder hist_builder(table_field, tree_key_length,
+                                            rows);
+    tree->walk(table_field->table, endpoint_histogram_build_walk,
+               (void *) &hist_builder);
+    hist_builder.finish();
+    distincts= hist_builder.get_count_distinct();
+    distincts_single_occurence= hist_builder.get_count_single_occurence();
+  }
+
   ulonglong get_count_distinct()
   {
     return distincts;
@@ -2128,17 +2482,24 @@ int alloc_statistics_for_table(THD* thd, TABLE *table)
   }
   uint hist_size= thd->variables.histogram_size;
   Histogram_type hist_type= (Histogram_type) (thd->variables.histogram_type);
+  /*
+    SINGLE_PREC_HB and DOUBLE_PREC_HB histograms are built in place, and
+    are limited to HIST_MAX_BYTES bytes. ENDPOINT_HB histograms are
+    allocated when they are built; the space is still reserved for them,
+    as they are not supported for BIT columns, which use DOUBLE_PREC_HB.
+  */
+  uint hist_bytes= MY_MIN(hist_size, HIST_MAX_BYTES);
   uchar *histogram= NULL;
-  if (hist_size > 0)
+  if (hist_bytes > 0)
   {
     if ((histogram= (uchar *) alloc_root(&table->mem_root,
-                                         hist_size * columns)))
-      bzero(histogram, hist_size * columns);
+                                         hist_bytes * columns)))
+      bzero(histogram, hist_bytes * columns);
 
   }
 
   if (!table_stats || !column_stats || !index_stats || !idx_avg_frequency ||
-      (hist_size && !histogram))
+      (hist_bytes && !histogram))
     DBUG_RETURN(1);
 
   table->collected_stats= table_stats;
@@ -2156,10 +2517,19 @@ int alloc_statistics_for_table(THD* thd, TABLE *table)
     (*field_ptr)->collected_stats->min_value= NULL;
     if (bitmap_is_set(table->read_set, (*field_ptr)->field_index))
     {
-      column_stats->histogram.set_size(hist_size);
-      column_stats->histogram.set_type(hist_type);
-      column_stats->histogram.set_values(histogram);
-      histogram+= hist_size;
+      if (hist_type == ENDPOINT_HB && (*field_ptr)->type() != MYSQL_TYPE_BIT)
+      {
+        column_stats->histogram.set_type(hist_type);
+        column_stats->histogram.set_endpoint_buckets(hist_size);
+      }
+      else
+      {
+        column_stats->histogram.set_size(hist_bytes);
+        column_stats->histogram.set_type(hist_type == ENDPOINT_HB ?
+                                         DOUBLE_PREC_HB : hist_type);
+        column_stats->histogram.set_values(histogram);
+      }
+      histogram+= hist_bytes;
     }
   }
 
@@ -2383,8 +2753,9 @@ int alloc_histograms_for_table_share(THD* thd, TABLE_SHARE *table_share,
     }
     memset(histograms, 0, total_hist_size);
     table_stats->histograms= histograms;
-    stats_cb->histograms_can_be_read= TRUE;
   }
+  /* ENDPOINT_HB histograms are allocated when they are read */
+  stats_cb->histograms_can_be_read= TRUE;
 
   if (!is_safe)
     mysql_mutex_unlock(&table_share->LOCK_share);
@@ -2496,14 +2867,16 @@ void Column_statistics_collected::finish(ha_rows rows, double sample_fraction)
   }
   if (count_distinct)
   {
-    uint hist_size= count_distinct->get_hist_size();
-
     /* Compute cardinality statistics and optionally histogram. */
-    if (hist_size == 0)
+    if (histogram.get_type() == ENDPOINT_HB && histogram.get_width())
+      count_distinct->walk_tree_with_endpoint_histogram(rows - nulls);
+    else if (count_distinct->get_hist_size() == 0)
       count_distinct->walk_tree();
     else
       count_distinct->walk_tree_with_histogram(rows - nulls);
 
+    uint hist_size= count_distinct->get_hist_size();
+
     ulonglong distincts= count_distinct->get_count_distinct();
     ulonglong distincts_single_occurence=
       count_distinct->get_count_distinct_single_occurence();
@@ -2662,6 +3035,415 @@ int collect_statistics_for_index(THD *thd, TABLE *table, uint index)
 }
 
 
+/*
+  Parallel aggregation of the statistics on the columns of a table.
+
+  The rows are fetched by the connection thread, as the handler belongs
+  to it, but the engine may read the table with up to the same number of
+  threads of its own (InnoDB reads ranges of the clustered index in
+  parallel, see ha_sample_init()). The sampled rows are copied into
+  batches, and the columns are
+  divided among workers that run in a thread pool shared by all
+  connections. The workers aggregate their columns over one batch while
+  the connection thread reads the next one.
+
+  The Unique objects that count the distinct values account their memory
+  to the current THD, so every worker has a THD of its own, and does
+  init(), add() and finish() or cleanup() for its columns. The workers
+  read the rows through clones of the column fields, and keep the minimal
+  and maximal values in record buffers of their own, as the null bits of
+  the columns share bytes. BLOB columns are aggregated by the connection
+  thread, as their values are not in the record buffer.
+*/
+
+/* Number of rows that are passed to the workers at a time */
+static const uint STAT_BATCH_ROWS= 256;
+
+static std::atomic<tpool::thread_pool*> stat_thread_pool;
+static std::mutex stat_thread_pool_mutex;
+
+static void stat_thread_init()
+{
+  my_thread_init();
+}
+
+static void stat_thread_end()
+{
+  my_thread_end();
+}
+
+static tpool::thread_pool *get_stat_thread_pool()
+{
+  tpool::thread_pool *pool= stat_thread_pool.load(std::memory_order_acquire);
+  if (!pool)
+  {
+    std::lock_guard<std::mutex> lk(stat_thread_pool_mutex);
+    if (!(pool= stat_thread_pool.load(std::memory_order_relaxed)))
+    {
+      pool= tpool::create_thread_pool_generic(1, MAX_ANALYZE_THREADS);
+      pool->set_thread_callbacks(stat_thread_init, stat_thread_end);
+      stat_thread_pool.store(pool, std::memory_order_release);
+    }
+  }
+  return pool;
+}
+
+
+void statistics_thread_pool_end()
+{
+  delete stat_thread_pool.exchange(nullptr);
+}
+
+
+class Parallel_stat_collector
+{
+public:
+  Parallel_stat_collector(THD *thd, TABLE *table)
+    : m_thd(thd), m_table(table), m_workers(NULL), m_n_workers(0),
+      m_batch(0), m_rows(0), m_error(false)
+  {
+    m_batches[0]= m_batches[1]= NULL;
+    m_pending[0]= m_pending[1]= m_pending[CONTROL]= 0;
+  }
+  ~Parallel_stat_collector();
+
+  /* Whether the column is aggregated by a worker */
+  static bool is_parallel(Field *field)
+  {
+    return !(field->flags & BLOB_FLAG) &&
+           bitmap_is_set(field->table->read_set, field->field_index);
+  }
+  static uint workers_for(TABLE *table, uint max_workers);
+
+  bool start(uint n_workers);
+  bool add_row();
+  bool end_rows();
+  void end(ha_rows rows, double sample_fraction, bool finish);
+
+private:
+  enum job { INIT_JOB, ADD_JOB, FINISH_JOB, CLEANUP_JOB };
+  /* Slot of the jobs that are not about a batch of rows */
+  static const uint CONTROL= 2;
+
+  struct Worker;
+
+  /*
+    Completion is signalled from release(), which is the last access of
+    the thread pool to the task.
+  */
+  struct Task : public tpool::task
+  {
+    Worker *worker;
+    uint slot;
+    job op;
+    const uchar *rows;
+    uint n_rows;
+    Task() : tpool::task(run_task, this) {}
+    static void run_task(void *arg)
+    {
+      Task *t= static_cast<Task*>(arg);
+      t->worker->owner->run(t);
+    }
+    void release() override
+    {
+      worker->owner->job_done(slot, worker->error);
+    }
+  };
+
+  struct Worker
+  {
+    Parallel_stat_collector *owner;
+    THD *thd;
+    Field **columns;    /* Clones of the columns, NULL-terminated */
+    uint n_columns;
+    uchar *record;      /* The record the clones point to */
+    bool error;
+    /* Runs the tasks of the worker one at a time */
+    tpool::task_group group;
+    Task tasks[CONTROL + 1];
+    Worker() : thd(NULL), n_columns(0), error(false), group(1) {}
+  };
+
+  void run(Task *task);
+  void submit(uint slot, job op, const uchar *rows, uint n_rows);
+  void job_done(uint slot, bool error);
+  bool wait(uint slot);
+  bool flush();
+
+  THD *m_thd;
+  TABLE *m_table;
+  Worker *m_workers;
+  uint m_n_workers;
+  uint m_rec_length;
+  /* Two batches: one is filled while the workers process the other */
+  uchar *m_batches[2];
+  uint m_batch;
+  uint m_rows;
+  /* Arguments of FINISH_JOB */
+  ha_rows m_total_rows;
+  double m_sample_fraction;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  uint m_pending[CONTROL + 1];
+  bool m_error;
+};
+
+
+/**
+  Number of workers to use for a table: one per column at most, and none
+  if only one would do all the work.
+*/
+uint Parallel_stat_collector::workers_for(TABLE *table, uint max_workers)
+{
+  uint columns= 0;
+  for (Field **field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    if (is_parallel(*field_ptr))
+      columns++;
+  }
+  uint workers= MY_MIN(max_workers, columns);
+  return workers > 1 ? workers : 0;
+}
+
+
+/**
+  Set up the workers, and have them start the aggregation of their columns
+
+  @return true on out of memory, or if a worker has failed
+*/
+bool Parallel_stat_collector::start(uint n_workers)
+{
+  TABLE *table= m_table;
+  MEM_ROOT *mem_root= &table->mem_root;
+  uint rec_buff_length= table->s->rec_buff_length;
+  uint columns= 0;
+  Field **field_ptr;
+  DBUG_ENTER("Parallel_stat_collector::start");
+
+  m_rec_length= rec_buff_length;
+  if (!(m_batches[0]= (uchar *) my_malloc(PSI_INSTRUMENT_ME,
+                                          2 * STAT_BATCH_ROWS *
+                                          rec_buff_length, MYF(MY_WME))) ||
+      !(m_workers= new Worker[n_workers]))
+    DBUG_RETURN(true);
+  m_batches[1]= m_batches[0] + STAT_BATCH_ROWS * rec_buff_length;
+  m_n_workers= n_workers;
+
+  for (field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    if (is_parallel(*field_ptr))
+      columns++;
+  }
+  for (uint n= 0; n < n_workers; n++)
+  {
+    Worker *w= &m_workers[n];
+    w->owner= this;
+    /* One record for the clones of the columns, and two for min and max */
+    if (!(w->thd= new THD(next_thread_id())) ||
+        !(w->columns= (Field **) alloc_root(mem_root,
+                                            ((columns + n_workers - 1) /
+                                             n_workers + 1) *
+                                            sizeof(Field *))) ||
+        !(w->record= (uchar *) alloc_root(mem_root, 3 * rec_buff_length)))
+      DBUG_RETURN(true);
+    memcpy(w->record, table->record[0], rec_buff_length);
+    if (table->collected_stats->min_max_record_buffers)
+      memcpy(w->record + rec_buff_length,
+             table->collected_stats->min_max_record_buffers,
+             2 * rec_buff_length);
+  }
+
+  /* Deal the columns out to the workers */
+  uint column= 0;
+  for (field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    Field *table_field= *field_ptr;
+    if (!is_parallel(table_field))
+      continue;
+    Worker *w= &m_workers[column++ % n_workers];
+    Column_statistics *stats= table_field->collected_stats;
+    Field *fld;
+    if (!(fld= table_field->clone(mem_root, NULL,
+                                  w->record - table->record[0])))
+      DBUG_RETURN(true);
+    w->columns[w->n_columns++]= fld;
+    for (uint i= 1; i <= 2; i++)
+    {
+      Field **min_max= i == 1 ? &stats->min_value : &stats->max_value;
+      if (*min_max &&
+          !(*min_max= table_field->clone(mem_root, table,
+                                         w->record + i * rec_buff_length -
+                                         table->record[0])))
+        DBUG_RETURN(true);
+    }
+  }
+  for (uint n= 0; n < n_workers; n++)
+    m_workers[n].columns[m_workers[n].n_columns]= NULL;
+
+  submit(CONTROL, INIT_JOB, NULL, 0);
+  if (wait(CONTROL))
+  {
+    /* Free what the workers have set up for their columns */
+    submit(CONTROL, CLEANUP_JOB, NULL, 0);
+    wait(CONTROL);
+    DBUG_RETURN(true);
+  }
+  DBUG_RETURN(false);
+}
+
+
+Parallel_stat_collector::~Parallel_stat_collector()
+{
+  for (uint slot= 0; slot <= CONTROL; slot++)
+    wait(slot);
+  for (uint n= 0; n < m_n_workers; n++)
+    delete m_workers[n].thd;
+  delete [] m_workers;
+  my_free(m_batches[0]);
+}
+
+
+/** Do a job of a worker, in a thread of the pool */
+void Parallel_stat_collector::run(Task *task)
+{
+  Worker *w= task->worker;
+  THD *save_thd= current_thd;
+  Field **field_ptr;
+
+  set_current_thd(w->thd);
+  switch (task->op) {
+  case INIT_JOB:
+    for (field_ptr= w->columns; *field_ptr; field_ptr++)
+      (*field_ptr)->collected_stats->init(m_thd, *field_ptr);
+    break;
+  case ADD_JOB:
+    for (uint i= 0; i < task->n_rows && !w->error; i++)
+    {
+      my_ptrdiff_t diff= task->rows + i * m_rec_length - w->record;
+      for (field_ptr= w->columns; *field_ptr; field_ptr++)
+      {
+        Field *field= *field_ptr;
+        field->move_field_offset(diff);
+        bool error= field->collected_stats->add();
+        field->move_field_offset(-diff);
+        if (error)
+        {
+          w->error= true;
+          break;
+        }
+      }
+    }
+    break;
+  case FINISH_JOB:
+    for (field_ptr= w->columns; *field_ptr; field_ptr++)
+      (*field_ptr)->collected_stats->finish(m_total_rows, m_sample_fraction);
+    break;
+  case CLEANUP_JOB:
+    for (field_ptr= w->columns; *field_ptr; field_ptr++)
+      (*field_ptr)->collected_stats->cleanup();
+    break;
+  }
+  set_current_thd(save_thd);
+}
+
+
+/** Give a job to every worker */
+void Parallel_stat_collector::submit(uint slot, job op, const uchar *rows,
+                                     uint n_rows)
+{
+  tpool::thread_pool *pool= get_stat_thread_pool();
+  DBUG_ASSERT(!m_pending[slot]);
+  m_pending[slot]= m_n_workers;
+  for (uint n= 0; n < m_n_workers; n++)
+  {
+    Task *t= &m_workers[n].tasks[slot];
+    t->worker= &m_workers[n];
+    t->slot= slot;
+    t->op= op;
+    t->rows= rows;
+    t->n_rows= n_rows;
+    t->m_group= &m_workers[n].group;
+    pool->submit_task(t);
+  }
+}
+
+
+void Parallel_stat_collector::job_done(uint slot, bool error)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_error|= error;
+  if (!--m_pending[slot])
+    m_cond.notify_all();
+}
+
+
+/**
+  Wait until the workers are done with the jobs of a slot
+
+  @return true if a worker has failed
+*/
+bool Parallel_stat_collector::wait(uint slot)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (m_pending[slot])
+    m_cond.wait(lk);
+  return m_error;
+}
+
+
+/** Pass the current batch to the workers, and switch to the other one */
+bool Parallel_stat_collector::flush()
+{
+  if (m_rows)
+    submit(m_batch, ADD_JOB, m_batches[m_batch], m_rows);
+  m_batch^= 1;
+  m_rows= 0;
+  return wait(m_batch);
+}
+
+
+/**
+  Pass the row in record[0] to the workers
+
+  @return true if a worker has failed
+*/
+bool Parallel_stat_collector::add_row()
+{
+  memcpy(m_batches[m_batch] + m_rows * m_rec_length, m_table->record[0],
+         m_table->s->reclength);
+  if (++m_rows < STAT_BATCH_ROWS)
+    return false;
+  return flush();
+}
+
+
+/**
+  Pass the last rows to the workers, and wait until they are aggregated
+
+  @return true if a worker has failed
+*/
+bool Parallel_stat_collector::end_rows()
+{
+  bool error= flush();
+  return wait(m_batch ^ 1) || error;
+}
+
+
+/**
+  Have the workers finish the aggregation of their columns, or clean up
+  if the collection has failed
+*/
+void Parallel_stat_collector::end(ha_rows rows, double sample_fraction,
+                                  bool finish)
+{
+  m_total_rows= rows;
+  m_sample_fraction= sample_fraction;
+  submit(CONTROL, finish ? FINISH_JOB : CLEANUP_JOB, NULL, 0);
+  wait(CONTROL);
+}
+
+
 /**
   @brief 
   Collect statistical data for a table
@@ -2690,9 +3472,11 @@ int collect_statistics_for_index(THD *thd, TABLE *table, uint index)
   @note
   The function first collects statistical data for statistical characteristics
   to be saved in the statistical tables table_stat and column_stats. To do this
-  it performs a full table scan of 'table'. At this scan the function collects
+  it performs a table scan of 'table', which returns a sample of the rows
+  unless analyze_sample_percentage is 100. At this scan the function collects
   statistics on each column of the table and count the total number of the
-  scanned rows. To calculate the value of 'avg_frequency' for a column the
+  scanned rows. With analyze_parallel_threads > 1 the columns are aggregated
+  by several threads, see Parallel_stat_collector. To calculate the value of 'avg_frequency' for a column the
   function constructs an object of the helper class Count_distinct_field
   (or its derivation). Currently this class cannot count the number of
   distinct values for blob columns. So the value of 'avg_frequency' for
@@ -2723,6 +3507,8 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   handler *file=table->file;
   double sample_fraction= thd->variables.sample_percentage / 100;
   const ha_rows MIN_THRESHOLD_FOR_SAMPLING= 50000;
+  Parallel_stat_collector collector(thd, table);
+  uint workers;
 
   DBUG_ENTER("collect_statistics_for_table");
 
@@ -2742,48 +3528,76 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
                    log(200 * file->records())) / file->records(), 1);
     }
   }
+  table->collected_stats->sample_fraction= sample_fraction;
+  table->collected_stats->cardinality_error= 0;
+
+  workers= Parallel_stat_collector::workers_for(table,
+             (uint) thd->variables.analyze_parallel_threads);
+  if (workers && collector.start(workers))
+    DBUG_RETURN(1);
 
   for (field_ptr= table->field; *field_ptr; field_ptr++)
   {
     table_field= *field_ptr;   
-    if (!bitmap_is_set(table->read_set, table_field->field_index))
+    if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+        (workers && Parallel_stat_collector::is_parallel(table_field)))
       continue; 
     table_field->collected_stats->init(thd, table_field);
   }
 
   restore_record(table, s->default_values);
 
-  /* Perform a full table scan to collect statistics on 'table's columns */
-  if (!(rc= file->ha_rnd_init(TRUE)))
+  /* Perform a (sampled) table scan to collect statistics on 'table's columns */
+  if (!(rc= file->ha_sample_init(sample_fraction,
+                                 (ha_sample_mode)
+                                 thd->variables.analyze_sample_method,
+                                 (uint)
+                                 thd->variables.analyze_parallel_threads)))
   {
     DEBUG_SYNC(table->in_use, "statistics_collection_start");
 
-    while ((rc= file->ha_rnd_next(table->record[0])) != HA_ERR_END_OF_FILE)
+    while (!(rc= file->ha_sample_next(table->record[0])))
     {
-      if (thd->killed)
-        break;
-
-      if (rc)
-        break;
-
-      if (thd_rnd(thd) <= sample_fraction)
+      for (field_ptr= table->field; *field_ptr; field_ptr++)
       {
-        for (field_ptr= table->field; *field_ptr; field_ptr++)
-        {
-          table_field= *field_ptr;
-          if (!bitmap_is_set(table->read_set, table_field->field_index))
-            continue;
-          if ((rc= table_field->collected_stats->add()))
-            break;
-        }
-        if (rc)
+        table_field= *field_ptr;
+        if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+            (workers && Parallel_stat_collector::is_parallel(table_field)))
+          continue;
+        if ((rc= table_field->collected_stats->add()))
           break;
-        rows++;
       }
+      if (rc || (workers && (rc= collector.add_row())))
+        break;
+      rows++;
     }
-    file->ha_rnd_end();
+    if (sample_fraction < 1)
+    {
+      /*
+        The relative standard error of the number of rows estimated from
+        the sample. A block sample has fewer independent units.
+      */
+      double units= (double) file->records() / file->sample_unit_rows();
+      table->collected_stats->cardinality_error=
+        sqrt((1 - sample_fraction) / (sample_fraction * MY_MAX(units, 1.0)));
+    }
+    file->ha_sample_end();
   }
   rc= (rc == HA_ERR_END_OF_FILE && !thd->killed) ? 0 : 1;
+  if (workers && collector.end_rows())
+    rc= 1;
+
+  /*
+    The workers finish their columns before the other ones are finished,
+    in the same way as below.
+  */
+  bitmap_clear_all(table->write_set);
+  if (workers)
+  {
+    bitmap_copy(table->write_set, table->read_set);
+    collector.end(rows, sample_fraction, !rc);
+    bitmap_clear_all(table->write_set);
+  }
 
   /* 
     Calculate values for all statistical characteristics on columns and
@@ -2797,11 +3611,11 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
       static_cast<ha_rows>(rows / sample_fraction);
   }
 
-  bitmap_clear_all(table->write_set);
   for (field_ptr= table->field; *field_ptr; field_ptr++)
   {
     table_field= *field_ptr;
-    if (!bitmap_is_set(table->read_set, table_field->field_index))
+    if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+        (workers && Parallel_stat_collector::is_parallel(table_field)))
       continue;
     bitmap_set_bit(table->write_set, table_field->field_index); 
     if (!rc)
@@ -3226,18 +4040,29 @@ int read_histograms_for_table(THD *thd, TABLE *table, TABLE_LIST *stat_tables)
     uchar *histogram= table_share->stats_cb.table_stats->histograms;
     TABLE *stat_table= stat_tables[COLUMN_STAT].table;
     Column_stat column_stat(stat_table, table);
+    enum_check_fields old_check_level= thd->count_cuted_fields;
+
+    /* Don't write warnings for internal field conversions */
+    thd->count_cuted_fields= CHECK_FIELD_IGNORE;
     for (field_ptr= table_share->field; *field_ptr; field_ptr++)
     {
       Field *table_field= *field_ptr;
-      uint hist_size= table_field->read_stats->histogram.get_size();
+      Histogram *hist= &table_field->read_stats->histogram;
+      uint hist_size= hist->get_size();
       if (hist_size)
       {
         column_stat.set_key_fields(table_field);
-        table_field->read_stats->histogram.set_values(histogram);
+        hist->set_values(histogram);
         column_stat.get_histogram_value();
         histogram+= hist_size;
       }
+      else if (hist->get_type() == ENDPOINT_HB && hist->get_width())
+      {
+        column_stat.set_key_fields(table_field);
+        column_stat.get_endpoint_histogram_value();
+      }
     }
+    thd->count_cuted_fields= old_check_level;
   }
  
   DBUG_RETURN(0);
@@ -3912,11 +4737,19 @@ double get_column_range_cardinality(Field *field,
         {
           store_key_image_to_rec(field, (uchar *) min_endp->key,
                                  field->key_length());
-          double pos= field->pos_in_interval(col_stats->min_value,
-                                             col_stats->max_value);
-          res= col_non_nulls * 
-	       hist->point_selectivity(pos,
-                                       avg_frequency / col_non_nulls);
+          if (hist->get_type() == ENDPOINT_HB)
+            res= col_non_nulls *
+                 hist->endpoint_point_selectivity(field,
+                                                  avg_frequency /
+                                                  col_non_nulls);
+          else
+          {
+            double pos= field->pos_in_interval(col_stats->min_value,
+                                               col_stats->max_value);
+            res= col_non_nulls * 
+                 hist->point_selectivity(pos,
+                                         avg_frequency / col_non_nulls);
+          }
         }
       }
       else if (avg_frequency == 0.0)
@@ -3931,6 +4764,15 @@ double get_column_range_cardinality(Field *field,
     if (col_stats->min_max_values_are_provided())
     {
       double sel, min_mp_pos, max_mp_pos;
+      Histogram *hist= &col_stats->histogram;
+      /*
+        An ENDPOINT_HB histogram compares the values themselves, so the
+        fractions of the values below the ends of the range are taken
+        while each end is in the record buffer.
+      */
+      bool use_endpoints= hist->is_available() &&
+                          hist->get_type() == ENDPOINT_HB;
+      double min_frac= 0.0, max_frac= 1.0;
 
       if (min_endp && !(field->null_ptr && min_endp->key[0]))
       {
@@ -3938,6 +4780,9 @@ double get_column_range_cardinality(Field *field,
                                field->key_length());
         min_mp_pos= field->pos_in_interval(col_stats->min_value,
                                            col_stats->max_value);
+        if (use_endpoints)
+          min_frac= hist->endpoint_fraction_below(field, min_mp_pos,
+                                                  range_flag & NEAR_MIN);
       }
       else
         min_mp_pos= 0.0;
@@ -3947,12 +4792,16 @@ double get_column_range_cardinality(Field *field,
                                field->key_length());
         max_mp_pos= field->pos_in_interval(col_stats->min_value,
                                            col_stats->max_value);
+        if (use_endpoints)
+          max_frac= hist->endpoint_fraction_below(field, max_mp_pos,
+                                                  !(range_flag & NEAR_MAX));
       }
       else
         max_mp_pos= 1.0;
 
-      Histogram *hist= &col_stats->histogram;
-      if (!hist->is_available())
+      if (use_endpoints)
+        sel= MY_MAX(max_frac - min_frac, 0.0);
+      else if (!hist->is_available())
         sel= (max_mp_pos - min_mp_pos);
       else
         sel= hist->range_selectivity(min_mp_pos, max_mp_pos);
@@ -4083,6 +4932,259 @@ double Histogram::point_selectivity(double pos, double avg_sel)
   return sel;
 }
 
+/*
+  Decode a serialized ENDPOINT_HB histogram
+
+  @param field   A field of an opened instance of the table. Its record
+                 buffer is used to convert the stored values into the
+                 record format.
+  @param data    The value of column_stats.histogram
+  @param length  Length of data
+
+  @details
+  The histogram is allocated in the statistical data of the table share.
+
+  @retval
+    false  The histogram has been read
+  @retval
+    true   The histogram is malformed, or out of memory
+*/
+
+bool Histogram::load_endpoints(Field *field, const uchar *data, size_t length)
+{
+  const uchar *end= data + length;
+  TABLE_SHARE *share= field->table->s;
+  String images;
+  Histogram_endpoint *eps= NULL;
+  size_t *offsets;
+  uchar *mem;
+  uint mcvs, buckets, n;
+  bool res= true;
+
+  if (length < 8)
+    return true;
+  mcvs= uint4korr(data);
+  buckets= uint4korr(data + 4);
+  data+= 8;
+  /* Every value takes at least 10 bytes */
+  if (mcvs > length / 10 || buckets > length / 10 ||
+      !(n= mcvs + buckets))
+    return true;
+
+  if (!(eps= (Histogram_endpoint *)
+        my_malloc(PSI_INSTRUMENT_ME,
+                  n * (sizeof(Histogram_endpoint) + sizeof(size_t)),
+                  MYF(0))))
+    return true;
+  offsets= (size_t *) (eps + n);
+
+  my_bitmap_map *old_map= dbug_tmp_use_all_columns(field->table,
+                                                   field->table->write_set);
+  for (uint i= 0; i < n; i++)
+  {
+    Histogram_endpoint *ep= eps + i;
+    uint header= i < mcvs ? 10 : 22;
+    uint len;
+    if ((size_t) (end - data) < header)
+      goto err;
+    float8get(ep->fraction, data);
+    if (i < mcvs)
+    {
+      ep->pos= 0.0;
+      ep->ndv= 1;
+      len= uint2korr(data + 8);
+    }
+    else
+    {
+      float8get(ep->pos, data + 8);
+      ep->ndv= MY_MAX(uint4korr(data + 16), 1);
+      len= uint2korr(data + 20);
+    }
+    data+= header;
+    if ((size_t) (end - data) < len)
+      goto err;
+    field->store((const char *) data, len, &my_charset_bin);
+    data+= len;
+
+    /* Only the used part of a VARCHAR value is kept */
+    uint image_length= field->data_length();
+    if (field->real_type() == MYSQL_TYPE_VARCHAR)
+      image_length+= ((Field_varstring *) field)->length_bytes;
+    offsets[i]= images.length();
+    if (images.append((const char *) field->ptr, image_length))
+      goto err;
+  }
+  if (data != end)
+    goto err;
+
+  mysql_mutex_lock(&share->LOCK_share);
+  mem= (uchar *) alloc_root(&share->stats_cb.mem_root,
+                            n * sizeof(Histogram_endpoint) + images.length());
+  mysql_mutex_unlock(&share->LOCK_share);
+  if (!mem)
+    goto err;
+
+  memcpy(mem + n * sizeof(Histogram_endpoint), images.ptr(), images.length());
+  for (uint i= 0; i < n; i++)
+    eps[i].value= mem + n * sizeof(Histogram_endpoint) + offsets[i];
+  memcpy(mem, eps, n * sizeof(Histogram_endpoint));
+  endpoints= (Histogram_endpoint *) mem;
+  n_mcv= mcvs;
+  n_buckets= buckets;
+  size= (uint) length;
+  res= false;
+
+err:
+  dbug_tmp_restore_column_map(field->table->write_set, old_map);
+  my_free(eps);
+  return res;
+}
+
+
+/*
+  Look for the value in the record buffer of 'field' among the most common
+  values of an ENDPOINT_HB histogram
+
+  @param idx  Set to the index of the value if it is found, otherwise to
+              the number of the most common values that are smaller
+
+  @retval
+    true   The value is a most common value
+*/
+
+bool Histogram::find_mcv(Field *field, uint *idx)
+{
+  uint lo= 0, hi= n_mcv;
+  while (lo < hi)
+  {
+    uint mid= (lo + hi) / 2;
+    int cmp= field->cmp(field->ptr, endpoints[mid].value);
+    if (!cmp)
+    {
+      *idx= mid;
+      return true;
+    }
+    if (cmp < 0)
+      hi= mid;
+    else
+      lo= mid + 1;
+  }
+  *idx= lo;
+  return false;
+}
+
+
+/*
+  Find the first bucket of an ENDPOINT_HB histogram whose endpoint is not
+  smaller than the value in the record buffer of 'field'. Returns
+  n_buckets if the value is above the last endpoint.
+*/
+
+uint Histogram::find_endpoint_bucket(Field *field)
+{
+  Histogram_endpoint *buckets= endpoints + n_mcv;
+  uint lo= 0, hi= n_buckets;
+  while (lo < hi)
+  {
+    uint mid= (lo + hi) / 2;
+    if (field->cmp(field->ptr, buckets[mid].value) <= 0)
+      hi= mid;
+    else
+      lo= mid + 1;
+  }
+  return lo;
+}
+
+
+/*
+  Estimate selectivity of "col=const" using an ENDPOINT_HB histogram
+
+  @param field    The field with "const" in its record buffer
+  @param avg_sel  Average selectivity of condition "col=const" in this
+                  table, used for values above the largest one that the
+                  histogram has seen.
+
+  @details
+  A most common value has its own frequency. Any other value is assumed to
+  have the average frequency of the distinct values of its bucket.
+*/
+
+double Histogram::endpoint_point_selectivity(Field *field, double avg_sel)
+{
+  uint idx;
+  if (find_mcv(field, &idx))
+    return endpoints[idx].fraction;
+
+  Histogram_endpoint *buckets= endpoints + n_mcv;
+  uint b= find_endpoint_bucket(field);
+  if (b == n_buckets)
+    return avg_sel;
+  double bucket_sel= buckets[b].fraction - (b ? buckets[b - 1].fraction : 0.0);
+  return bucket_sel / buckets[b].ndv;
+}
+
+
+/*
+  Estimate the fraction of non-NULL values that are less than the value in
+  the record buffer of 'field', or less than or equal to it if 'inclusive'
+
+  @param pos  Position of the value between column's min_value and
+              max_value
+
+  @details
+  The most common values and the buckets below the value are counted
+  exactly. Within the bucket that contains the value, values are assumed
+  to be uniformly distributed between the endpoints of the bucket.
+*/
+
+double Histogram::endpoint_fraction_below(Field *field, double pos,
+                                          bool inclusive)
+{
+  uint idx;
+  double sel= 0.0;
+  bool is_mcv= find_mcv(field, &idx);
+
+  for (uint i= 0; i < idx; i++)
+    sel+= endpoints[i].fraction;
+  if (is_mcv && inclusive)
+    sel+= endpoints[idx].fraction;
+  if (!n_buckets)
+    return sel;
+
+  Histogram_endpoint *buckets= endpoints + n_mcv;
+  uint b= find_endpoint_bucket(field);
+  if (b == n_buckets)
+    return sel + buckets[n_buckets - 1].fraction;
+
+  double start_sel= b ? buckets[b - 1].fraction : 0.0;
+  double start_pos= b ? buckets[b - 1].pos : 0.0;
+  double bucket_sel= buckets[b].fraction - start_sel;
+  double value_sel= bucket_sel / buckets[b].ndv;
+  double in_bucket;
+
+  if (!field->cmp(field->ptr, buckets[b].value))
+  {
+    /* The value is the endpoint, the last value kept in the bucket */
+    in_bucket= bucket_sel - value_sel;
+  }
+  else if (buckets[b].pos > start_pos)
+  {
+    in_bucket= bucket_sel * (pos - start_pos) / (buckets[b].pos - start_pos);
+    set_if_bigger(in_bucket, 0.0);
+    set_if_smaller(in_bucket, bucket_sel);
+  }
+  else
+    in_bucket= bucket_sel / 2;
+
+  if (!is_mcv && inclusive)
+  {
+    in_bucket+= value_sel;
+    set_if_smaller(in_bucket, bucket_sel);
+  }
+  return start_sel + in_bucket + sel;
+}
+
+
 /*
   Check whether the table is one of the persistent statistical tables.
 */
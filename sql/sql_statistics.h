@@ -42,9 +42,18 @@ typedef
 enum enum_histogram_type
 {
   SINGLE_PREC_HB,
-  DOUBLE_PREC_HB
+  DOUBLE_PREC_HB,
+  ENDPOINT_HB
 } Histogram_type;
 
+/*
+  The largest histogram_size accepted for SINGLE_PREC_HB and DOUBLE_PREC_HB,
+  whose size is counted in bytes. For ENDPOINT_HB histogram_size is the
+  number of buckets.
+*/
+#define HIST_MAX_BYTES 255
+
+
 enum enum_stat_tables
 {
   TABLE_STAT,
@@ -118,6 +127,7 @@ bool check_eits_preferred(THD *thd)
 int read_statistics_for_tables_if_needed(THD *thd, TABLE_LIST *tables);
 int read_statistics_for_tables(THD *thd, TABLE_LIST *tables);
 int collect_statistics_for_table(THD *thd, TABLE *table);
+void statistics_thread_pool_end();
 void delete_stat_values_for_table_share(TABLE_SHARE *table_share);
 int alloc_statistics_for_table(THD *thd, TABLE *table);
 int update_statistics_for_table(THD *thd, TABLE *table);
@@ -140,13 +150,61 @@ double get_column_range_cardinality(Field *field,
 bool is_stat_table(const LEX_CSTRING *db, LEX_CSTRING *table);
 bool is_eits_usable(Field* field);
 
+/*
+  A value stored in an ENDPOINT_HB histogram: either one of the most common
+  values of the column, or the upper endpoint of a bucket.
+*/
+
+struct Histogram_endpoint
+{
+  uchar *value;    /* The value, in the record format of the column */
+  /*
+    For a most common value, the fraction of non-NULL rows that have it.
+    For a bucket, the fraction of non-NULL rows that are in this bucket or
+    in the buckets before it, not counting the most common values.
+  */
+  double fraction;
+  double pos;      /* Position of value between min_value and max_value */
+  ulong ndv;       /* Number of distinct values in the bucket */
+};
+
+
+/*
+  SINGLE_PREC_HB and DOUBLE_PREC_HB histograms are arrays of bucket
+  endpoints, each stored as its position between the minimal and the maximal
+  value of the column, with 8 or 16 bits of precision.
+
+  An ENDPOINT_HB histogram stores the values themselves. It consists of a
+  list of the most common values with their frequencies, and of an
+  equi-height histogram over the remaining values where every bucket has
+  its upper endpoint, its cumulative frequency and its number of distinct
+  values. In column_stats it is stored as
+
+    4 bytes number of most common values M
+    4 bytes number of buckets B
+    M times: 8 bytes frequency, 2 bytes length L, L bytes value
+    B times: 8 bytes cumulative frequency, 8 bytes position,
+             4 bytes number of distinct values, 2 bytes length L,
+             L bytes value
+
+  where values are the strings of Field::val_str(). After reading, the
+  histogram is kept as an array of Histogram_endpoint, with the values
+  converted to the record format, so that they can be compared with
+  Field::cmp().
+*/
+
 class Histogram
 {
 
 private:
   Histogram_type type;
-  uint8 size; /* Size of values array, in bytes */
+  uint size; /* Size of values array, in bytes */
   uchar *values;
+  /* ENDPOINT_HB: number of buckets and of most common values */
+  uint n_buckets;
+  uint n_mcv;
+  /* ENDPOINT_HB: n_mcv most common values followed by n_buckets buckets */
+  Histogram_endpoint *endpoints;
 
   uint prec_factor()
   {
@@ -155,6 +213,8 @@ class Histogram
       return ((uint) (1 << 8) - 1);
     case DOUBLE_PREC_HB:
       return ((uint) (1 << 16) - 1);
+    case ENDPOINT_HB:
+      break;
     }
     return 1;
   }
@@ -167,6 +227,8 @@ class Histogram
       return size;
     case DOUBLE_PREC_HB:
       return size / 2;
+    case ENDPOINT_HB:
+      return n_buckets;
     }
     return 0;
   }
@@ -180,6 +242,8 @@ class Histogram
       return (uint) (((uint8 *) values)[i]);
     case DOUBLE_PREC_HB:
       return (uint) uint2korr(values + i * 2);
+    case ENDPOINT_HB:
+      break;
     }
     return 0;
   }
@@ -231,13 +295,40 @@ class Histogram
 
   uchar *get_values() { return (uchar *) values; }
 
-  void set_size (ulonglong sz) { size= (uint8) sz; }
+  void set_size (ulonglong sz) { size= (uint) sz; }
 
   void set_type (Histogram_type t) { type= t; }
 
   void set_values (uchar *vals) { values= (uchar *) vals; }
 
-  bool is_available() { return get_size() > 0 && get_values(); }
+  /*
+    Set the number of buckets of an ENDPOINT_HB histogram that is to be
+    built or read. The serialized histogram is not available yet.
+  */
+  void set_endpoint_buckets(uint buckets)
+  {
+    n_buckets= buckets;
+    n_mcv= 0;
+    size= 0;
+    values= NULL;
+    endpoints= NULL;
+  }
+
+  void set_endpoint_histogram(uchar *data, uint data_size, uint buckets,
+                              uint mcvs)
+  {
+    values= data;
+    size= data_size;
+    n_buckets= buckets;
+    n_mcv= mcvs;
+  }
+
+  bool is_available()
+  {
+    if (type == ENDPOINT_HB)
+      return endpoints != NULL;
+    return get_size() > 0 && get_values();
+  }
 
   void set_value(uint i, double val)
   {
@@ -248,6 +339,9 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, val * prec_factor());
       return;
+    case ENDPOINT_HB:
+      DBUG_ASSERT(0);
+      return;
     }
   }
 
@@ -260,6 +354,9 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, uint2korr(values + i * 2 - 2));
       return;
+    case ENDPOINT_HB:
+      DBUG_ASSERT(0);
+      return;
     }
   }
 
@@ -277,6 +374,28 @@ class Histogram
     Estimate selectivity of "col=const" using a histogram
   */
   double point_selectivity(double pos, double avg_sel);
+
+  /*
+    Decode a serialized ENDPOINT_HB histogram read from column_stats
+  */
+  bool load_endpoints(Field *field, const uchar *data, size_t length);
+
+  /*
+    Estimate selectivity of "col=const" using an ENDPOINT_HB histogram,
+    for the value that is in the record buffer of 'field'
+  */
+  double endpoint_point_selectivity(Field *field, double avg_sel);
+
+  /*
+    Estimate the fraction of non-NULL values that are less than (or, if
+    'inclusive', less than or equal to) the value that is in the record
+    buffer of 'field', using an ENDPOINT_HB histogram
+  */
+  double endpoint_fraction_below(Field *field, double pos, bool inclusive);
+
+private:
+  uint find_endpoint_bucket(Field *field);
+  bool find_mcv(Field *field, uint *idx);
 };
 
 
@@ -296,6 +415,8 @@ class Table_statistics
   Index_statistics *index_stats;    /* Array of statistical data for indexes */
   ulong *idx_avg_frequency;   /* Array of records per key for index prefixes */
   ulong total_hist_size;            /* Total size of all histograms */
+  double sample_fraction;           /* Fraction of the rows that were read */
+  double cardinality_error;         /* Relative error of cardinality      */
   uchar *histograms;                /* Sequence of histograms       */                    
 };
 
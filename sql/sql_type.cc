@@ -17,6 +17,7 @@
 #include "mariadb.h"
 #include "sql_type.h"
 #include "sql_type_geom.h"
+#include "sql_type_json.h"
 #include "sql_const.h"
 #include "sql_class.h"
 #include "sql_time.h"
@@ -95,6 +96,8 @@ class Type_collection_std: public Type_collection
 public:
   const Type_handler *handler_by_name(const LEX_CSTRING &name) const override
   {
+    if (type_handler_jsonb.name().eq(name))
+      return &type_handler_jsonb;
     return NULL;
   }
   const Type_handler *aggregate_for_result(const Type_handler *a,
@@ -204,9 +207,12 @@ Type_handler::handler_by_name(THD *thd, const LEX_CSTRING &name)
     return ph;
   }
 
+  const Type_handler *ha;
+  if ((ha= type_collection_std.handler_by_name(name)))
+    return ha;
+
 #ifdef HAVE_SPATIAL
-  const Type_handler *ha= type_collection_geometry.handler_by_name(name);
-  if (ha)
+  if ((ha= type_collection_geometry.handler_by_name(name)))
     return ha;
 #endif
   return NULL;
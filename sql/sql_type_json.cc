@@ -18,9 +18,11 @@
 
 #include "sql_type_json.h"
 #include "sql_class.h"
+#include "json_binary.h"
 
 
 Type_handler_json_longtext  type_handler_json_longtext;
+Named_type_handler<Type_handler_jsonb> type_handler_jsonb("jsonb");
 
 
 /**
@@ -55,3 +57,246 @@ bool Type_handler_json_longtext::
     return true;
   return Type_handler::Column_definition_validate_check_constraint(thd, c);
 }
+
+
+/***************************************************************************/
+
+bool Type_handler_jsonb::
+       Column_definition_prepare_stage1(THD *thd,
+                                        MEM_ROOT *mem_root,
+                                        Column_definition *def,
+                                        handler *file,
+                                        ulonglong table_flags) const
+{
+  /*
+    The text of a JSONB column is always utf8mb4,
+    whatever CONVERT TO CHARACTER SET or the table default say.
+  */
+  def->charset= &my_charset_utf8mb4_bin;
+  return Type_handler_long_blob::Column_definition_prepare_stage1(thd,
+                                                                  mem_root,
+                                                                  def, file,
+                                                                  table_flags);
+}
+
+
+Field *Type_handler_jsonb::make_table_field(MEM_ROOT *root,
+                                            const LEX_CSTRING *name,
+                                            const Record_addr &addr,
+                                            const Type_all_attributes &attr,
+                                            TABLE_SHARE *share) const
+{
+  return new (root)
+         Field_jsonb(addr.ptr(), addr.null_ptr(), addr.null_bit(),
+                     Field::NONE, name, share, 4);
+}
+
+
+Field *Type_handler_jsonb::
+  make_table_field_from_def(TABLE_SHARE *share, MEM_ROOT *mem_root,
+                            const LEX_CSTRING *name,
+                            const Record_addr &rec, const Bit_addr &bit,
+                            const Column_definition_attributes *attr,
+                            uint32 flags) const
+{
+  return new (mem_root)
+    Field_jsonb(rec.ptr(), rec.null_ptr(), rec.null_bit(),
+                attr->unireg_check, name, share,
+                attr->pack_flag_to_pack_length());
+}
+
+
+static bool jsonb_key_error(const Key_part_spec *part, const handler *file)
+{
+  my_error(ER_WRONG_KEY_COLUMN, MYF(0), file->table_type(),
+           part->field_name.str);
+  return true;
+}
+
+
+bool Type_handler_jsonb::Key_part_spec_init_primary(Key_part_spec *part,
+                                                    const Column_definition
+                                                      &def,
+                                                    const handler *file) const
+{
+  return jsonb_key_error(part, file);
+}
+
+
+bool Type_handler_jsonb::Key_part_spec_init_unique(Key_part_spec *part,
+                                                   const Column_definition
+                                                     &def,
+                                                   const handler *file,
+                                                   bool *hash_field_needed)
+                                                   const
+{
+  return jsonb_key_error(part, file);
+}
+
+
+bool Type_handler_jsonb::Key_part_spec_init_multiple(Key_part_spec *part,
+                                                     const Column_definition
+                                                       &def,
+                                                     const handler *file) const
+{
+  return jsonb_key_error(part, file);
+}
+
+
+bool Type_handler_jsonb::Key_part_spec_init_foreign(Key_part_spec *part,
+                                                    const Column_definition
+                                                      &def,
+                                                    const handler *file) const
+{
+  return jsonb_key_error(part, file);
+}
+
+
+/***************************************************************************/
+
+bool Field_jsonb::val_json_binary(Json_binary_value *to) const
+{
+  return to->init(get_ptr(), get_length());
+}
+
+
+/*
+  Store JSON null for a text that is not valid JSON, or set the field
+  to SQL NULL if it is nullable.
+*/
+int Field_jsonb::store_invalid(const char *from, size_t length,
+                               CHARSET_INFO *cs)
+{
+  static const uchar json_null[]= { JSON_BINARY_VERSION, JSON_VALUE_NULL };
+  THD *thd= get_thd();
+  if (thd->count_cuted_fields > CHECK_FIELD_EXPRESSION)
+    thd->push_warning_truncated_value_for_field(Sql_condition::WARN_LEVEL_WARN,
+                                                type_handler_jsonb.name().ptr(),
+                                                ErrConvString(from, length,
+                                                              cs).ptr(),
+                                                table->s, field_name.str);
+  set_ptr((uint32) sizeof(json_null), (uchar *) json_null);
+  if (maybe_null())
+    set_null();
+  return 1;
+}
+
+
+int Field_jsonb::store(const char *from, size_t length, CHARSET_INFO *cs)
+{
+  DBUG_ASSERT(marked_for_write_or_computed());
+  StringBuffer<STRING_BUFFER_USUAL_SIZE> text;
+  const char *js= from;
+  size_t js_length= length;
+  uint32 dummy_offset;
+  uint errors;
+  char *tmp;
+
+  /*
+    The text is parsed as utf8mb4. Copy it aside also when it points
+    into 'value', which is about to be overwritten.
+  */
+  if (String::needs_conversion(length, cs, &my_charset_utf8mb4_bin,
+                               &dummy_offset) ||
+      (from >= value.ptr() && from <= value.end()))
+  {
+    if (text.copy(from, length, cs, &my_charset_utf8mb4_bin, &errors))
+      goto oom_error;
+    js= text.ptr();
+    js_length= text.length();
+  }
+
+  value.length(0);
+  if (json_binary_from_text(&value, js, js_length))
+    return store_invalid(js, js_length,
+                         js == from ? cs : &my_charset_utf8mb4_bin);
+
+  tmp= const_cast<char*>(value.ptr());
+  if (table && table->blob_storage)    // GROUP_CONCAT with ORDER BY | DISTINCT
+  {
+    if (!(tmp= table->blob_storage->store(value.ptr(), value.length())))
+      goto oom_error;
+  }
+  Field_blob::store_length(value.length());
+  bmove(ptr + packlength, (uchar*) &tmp, sizeof(char*));
+  return 0;
+
+oom_error:
+  /* Fatal OOM error */
+  bzero(ptr, Field_blob::pack_length());
+  return -1;
+}
+
+
+void Field_jsonb::val_text(const uchar *ptr_arg, String *to) const
+{
+  Json_binary_value doc;
+  const uchar *blob;
+  uint32 length= get_length(ptr_arg);
+  memcpy(&blob, ptr_arg + packlength, sizeof(char*));
+  to->set_charset(&my_charset_utf8mb4_bin);
+  to->length(0);
+  if (length && (doc.init(blob, length) || doc.to_text(to)))
+    to->length(0);                       // Broken document
+}
+
+
+String *Field_jsonb::val_str(String *val_buffer, String *val_ptr)
+{
+  DBUG_ASSERT(marked_for_read());
+  val_text(ptr, val_buffer);
+  return val_buffer;
+}
+
+
+int Field_jsonb::cmp_max(const uchar *a_ptr, const uchar *b_ptr,
+                         uint max_length) const
+{
+  StringBuffer<STRING_BUFFER_USUAL_SIZE> a, b;
+  val_text(a_ptr, &a);
+  val_text(b_ptr, &b);
+  return field_charset()->strnncollsp(a.ptr(), MY_MIN(a.length(), max_length),
+                                      b.ptr(), MY_MIN(b.length(), max_length));
+}
+
+
+double Field_jsonb::val_real(void)
+{
+  DBUG_ASSERT(marked_for_read());
+  THD *thd= get_thd();
+  StringBuffer<STRING_BUFFER_USUAL_SIZE> buf;
+  val_str(&buf, &buf);
+  return Converter_strntod_with_warn(thd, Warn_filter(thd), field_charset(),
+                                     buf.ptr(), buf.length()).result();
+}
+
+
+longlong Field_jsonb::val_int(void)
+{
+  DBUG_ASSERT(marked_for_read());
+  THD *thd= get_thd();
+  StringBuffer<STRING_BUFFER_USUAL_SIZE> buf;
+  val_str(&buf, &buf);
+  return Converter_strntoll_with_warn(thd, Warn_filter(thd), field_charset(),
+                                      buf.ptr(), buf.length()).result();
+}
+
+
+my_decimal *Field_jsonb::val_decimal(my_decimal *decimal_value)
+{
+  DBUG_ASSERT(marked_for_read());
+  THD *thd= get_thd();
+  StringBuffer<STRING_BUFFER_USUAL_SIZE> buf;
+  val_str(&buf, &buf);
+  Converter_str2my_decimal_with_warn(thd, Warn_filter(thd),
+                                     E_DEC_FATAL_ERROR, field_charset(),
+                                     buf.ptr(), buf.length(), decimal_value);
+  return decimal_value;
+}
+
+
+void Field_jsonb::sql_type(String &res) const
+{
+  const Name tmp= type_handler_jsonb.name();
+  res.set(tmp.ptr(), tmp.length(), &my_charset_latin1);
+}
@@ -35,4 +35,143 @@ class Type_handler_json_longtext: public Type_handler_long_blob
 extern MYSQL_PLUGIN_IMPORT
   Type_handler_json_longtext type_handler_json_longtext;
 
+
+/*
+  JSONB stores documents in the binary format of json_binary.h.
+  The text is parsed once on store, and converted back on read.
+*/
+class Type_handler_jsonb: public Type_handler_long_blob
+{
+public:
+  virtual ~Type_handler_jsonb() {}
+  const Type_handler *type_handler_for_tmp_table(const Item *item)
+                                                 const override
+  {
+    return this;
+  }
+  const Type_handler *type_handler_for_union(const Item *item) const override
+  {
+    return this;
+  }
+  Item *create_typecast_item(THD *thd, Item *item,
+                             const Type_cast_attributes &attr) const override
+  {
+    return NULL;
+  }
+  bool Column_definition_data_type_info_image(Binary_string *to,
+                                              const Column_definition &def)
+                                              const override
+  {
+    return to->append(name().lex_cstring());
+  }
+  bool Column_definition_prepare_stage1(THD *thd,
+                                        MEM_ROOT *mem_root,
+                                        Column_definition *c,
+                                        handler *file,
+                                        ulonglong table_flags) const override;
+  Field *make_table_field(MEM_ROOT *root,
+                          const LEX_CSTRING *name,
+                          const Record_addr &addr,
+                          const Type_all_attributes &attr,
+                          TABLE_SHARE *share) const override;
+  Field *make_table_field_from_def(TABLE_SHARE *share,
+                                   MEM_ROOT *mem_root,
+                                   const LEX_CSTRING *name,
+                                   const Record_addr &addr,
+                                   const Bit_addr &bit,
+                                   const Column_definition_attributes *attr,
+                                   uint32 flags) const override;
+  /*
+    Indexes are not supported: the key image is the binary document,
+    whose byte order does not match the comparison of the JSON text.
+  */
+  bool Key_part_spec_init_primary(Key_part_spec *part,
+                                  const Column_definition &def,
+                                  const handler *file) const override;
+  bool Key_part_spec_init_unique(Key_part_spec *part,
+                                 const Column_definition &def,
+                                 const handler *file,
+                                 bool *has_key_needed) const override;
+  bool Key_part_spec_init_multiple(Key_part_spec *part,
+                                   const Column_definition &def,
+                                   const handler *file) const override;
+  bool Key_part_spec_init_foreign(Key_part_spec *part,
+                                  const Column_definition &def,
+                                  const handler *file) const override;
+  bool Key_part_spec_init_ft(Key_part_spec *part,
+                             const Column_definition &def) const override
+  {
+    return true; // Error
+  }
+};
+
+extern MYSQL_PLUGIN_IMPORT
+  Named_type_handler<Type_handler_jsonb> type_handler_jsonb;
+
+
+#include "field.h"
+
+class Json_binary_value;
+
+class Field_jsonb: public Field_blob
+{
+  int store_invalid(const char *from, size_t length, CHARSET_INFO *cs);
+  /* The JSON text of the document in the record at 'ptr_arg' */
+  void val_text(const uchar *ptr_arg, String *to) const;
+public:
+  Field_jsonb(uchar *ptr_arg, uchar *null_ptr_arg, uchar null_bit_arg,
+              enum utype unireg_check_arg, const LEX_CSTRING *field_name_arg,
+              TABLE_SHARE *share, uint blob_pack_length)
+    :Field_blob(ptr_arg, null_ptr_arg, null_bit_arg, unireg_check_arg,
+                field_name_arg, share, blob_pack_length,
+                &my_charset_utf8mb4_bin)
+  {}
+  const Type_handler *type_handler() const override
+  {
+    return &type_handler_jsonb;
+  }
+  bool is_json_binary() const override { return true; }
+  /* The stored document. Returns true if it is empty or broken */
+  bool val_json_binary(Json_binary_value *to) const;
+  int store(const char *to, size_t length, CHARSET_INFO *charset) override;
+  using Field_str::store;
+  double val_real() override;
+  longlong val_int() override;
+  String *val_str(String *, String *) override;
+  my_decimal *val_decimal(my_decimal *) override;
+  /*
+    Values compare as their JSON text, like the items reading them do.
+    sort_string() and pack_sort_string() already go through val_str().
+  */
+  int cmp_max(const uchar *, const uchar *, uint max_length) const override;
+  /*
+    The key image is that of the binary document, which does not match
+    the comparison of the JSON text.
+  */
+  bool can_optimize_keypart_ref(const Item_bool_func *cond,
+                                const Item *item) const override
+  {
+    return false;
+  }
+  bool can_optimize_group_min_max(const Item_bool_func *cond,
+                                  const Item *const_item) const override
+  {
+    return false;
+  }
+  bool can_optimize_range(const Item_bool_func *cond,
+                          const Item *item,
+                          bool is_eq_func) const override
+  {
+    return false;
+  }
+  bool can_be_converted_by_engine(const Column_definition &new_type)
+                                  const override
+  {
+    return false; // Override the Field_blob behavior
+  }
+  bool has_charset() const override { return false; }
+  void sql_type(String &str) const override;
+  uint size_of() const override { return sizeof(*this); }
+};
+
 #endif // SQL_TYPE_JSON_INCLUDED
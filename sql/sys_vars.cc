@@ -442,6 +442,27 @@ static Sys_var_double Sys_analyze_sample_percentage(
        CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 100),
        DEFAULT(100));
 
+static const char *analyze_sample_method_names[]=
+  {"BERNOULLI", "SYSTEM", 0};
+static Sys_var_enum Sys_analyze_sample_method(
+       "analyze_sample_method",
+       "How ANALYZE TABLE samples the rows when it does not read all of "
+       "them. BERNOULLI picks every row independently. SYSTEM picks blocks "
+       "of consecutive rows, which lets the storage engine skip reading "
+       "the other blocks, but gives less accurate statistics for columns "
+       "whose values are clustered",
+       SESSION_VAR(analyze_sample_method), CMD_LINE(REQUIRED_ARG),
+       analyze_sample_method_names, DEFAULT(HA_SAMPLE_BERNOULLI));
+
+static Sys_var_ulong Sys_analyze_parallel_threads(
+       "analyze_parallel_threads",
+       "Maximum number of threads that ANALYZE TABLE uses to compute the "
+       "engine-independent statistics of the columns of a table, and that "
+       "the storage engine may use to read the table (InnoDB does). 1 means "
+       "that the connection thread aggregates all the columns",
+       SESSION_VAR(analyze_parallel_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, MAX_ANALYZE_THREADS), DEFAULT(1), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_auto_increment_increment(
        "auto_increment_increment",
        "Auto-increment columns are incremented by this",
@@ -2315,7 +2336,8 @@ Sys_var_slave_parallel_mode::global_value_ptr(THD *thd,
 
 /* The order here must match enum_slave_parallel_mode in mysqld.h. */
 static const char *slave_parallel_mode_names[] = {
-  "none", "minimal", "conservative", "optimistic", "aggressive", NULL
+  "none", "minimal", "conservative", "optimistic", "aggressive", "writeset",
+  NULL
 };
 export TYPELIB slave_parallel_mode_typelib = {
   array_elements(slave_parallel_mode_names)-1,
@@ -2335,6 +2357,9 @@ Sys_slave_parallel_mode(
        "effort to avoid any conflicts. \"aggressive\" tries to maximise the "
        "parallelism, possibly at the cost of increased conflict rate. "
        "\"minimal\" only parallelizes the commit steps of transactions. "
+       "\"writeset\" is like \"conservative\", but also applies transactions "
+       "in parallel that change different rows according to the writesets "
+       "logged by the master (see --binlog-writeset-max-keys). "
        "\"none\" disables parallel apply completely.",
        GLOBAL_VAR(opt_slave_parallel_mode), NO_CMD_LINE,
        slave_parallel_mode_names, DEFAULT(SLAVE_PARALLEL_OPTIMISTIC));
@@ -2450,6 +2475,14 @@ static Sys_var_uint Sys_max_prepared_stmt_count(
        VALID_RANGE(0, UINT_MAX32), DEFAULT(16382), BLOCK_SIZE(1),
        &PLock_prepared_stmt_count);
 
+static Sys_var_mybool Sys_prepared_stmt_plan_cache(
+       "prepared_stmt_plan_cache",
+       "Let prepared statements reuse the join order found by a previous "
+       "execution when the range estimates of the tables fall into the "
+       "same classes, instead of searching for a new one",
+       SESSION_VAR(prepared_stmt_plan_cache), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 static Sys_var_ulong Sys_max_recursive_iterations(
        "max_recursive_iterations",
        "Maximum number of iterations when executing recursive queries",
@@ -2589,6 +2622,23 @@ static Sys_var_ulong Sys_net_retry_count(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_net_retry_count));
 
+static bool fix_net_compression_level(sys_var *self, THD *thd,
+                                      enum_var_type type)
+{
+  if (type != OPT_GLOBAL)
+    my_net_set_compression_level(&thd->net,
+                                 thd->variables.net_compression_level);
+  return false;
+}
+static Sys_var_uint Sys_net_compression_level(
+       "net_compression_level",
+       "Compression level for packets sent on a connection that uses the "
+       "compressed protocol. 0 is the default of the compression algorithm. "
+       "zlib uses levels up to 9 and zstd up to 22; lz4 ignores the level",
+       SESSION_VAR(net_compression_level), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 22), DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+       NOT_IN_BINLOG, ON_CHECK(0), ON_UPDATE(fix_net_compression_level));
+
 static Sys_var_mybool Sys_old_mode(
        "old", "Use compatible behavior from previous MariaDB version. See also --old-mode",
        SESSION_VAR(old_mode), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
@@ -3094,6 +3144,15 @@ static Sys_var_ulong Sys_query_cache_min_res_unit(
        BLOCK_SIZE(8), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_qcache_min_res_unit));
 
+static Sys_var_ulong Sys_query_cache_partitions(
+       "query_cache_partitions",
+       "Number of partitions of the query cache. Each partition has its "
+       "own lock and an equal share of query_cache_size, and caches the "
+       "queries whose text hashes to it",
+       READ_ONLY GLOBAL_VAR(query_cache_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, QUERY_CACHE_MAX_PARTITIONS), DEFAULT(1),
+       BLOCK_SIZE(1));
+
 static const char *query_cache_type_names[]= { "OFF", "ON", "DEMAND", 0 };
 
 static bool check_query_cache_type(sys_var *self, THD *thd, set_var *var)
@@ -3237,6 +3296,17 @@ Sys_slave_compressed_protocol(
        GLOBAL_VAR(opt_slave_compressed_protocol), CMD_LINE(OPT_ARG),
        DEFAULT(FALSE));
 
+static Sys_var_on_access_global<Sys_var_enum,
+                        PRIV_SET_SYSTEM_GLOBAL_VAR_SLAVE_COMPRESSION_ALGORITHM>
+Sys_slave_compression_algorithm(
+       "slave_compression_algorithm",
+       "Compression algorithm for the master/slave protocol when "
+       "slave_compressed_protocol is set. Legal values are zlib (default), "
+       "zstd and lz4. zlib is used if the master or this server was built "
+       "without support for the chosen algorithm",
+       GLOBAL_VAR(opt_slave_compression_algorithm), CMD_LINE(REQUIRED_ARG),
+       my_compress_algorithm_names, DEFAULT(MY_COMPRESS_ZLIB));
+
 #ifdef HAVE_REPLICATION
 static const char *slave_exec_mode_names[]= {"STRICT", "IDEMPOTENT", 0};
 static Sys_var_on_access_global<Sys_var_enum,
@@ -3295,6 +3365,23 @@ Slave_type_conversions(
        slave_type_conversions_name,
        DEFAULT(0));
 
+static const char *slave_rows_search_algorithms_names[]=
+  {"INDEX_SCAN", "HASH_SCAN", 0};
+static Sys_var_on_access_global<Sys_var_set,
+                     PRIV_SET_SYSTEM_GLOBAL_VAR_SLAVE_ROWS_SEARCH_ALGORITHMS>
+Slave_rows_search_algorithms(
+       "slave_rows_search_algorithms",
+       "Set of algorithms that the slave may use to find the rows of a "
+       "row-based UPDATE or DELETE when the table has no primary key and "
+       "no unique key on NOT NULL columns. INDEX_SCAN looks up each row "
+       "using the best non-unique index. HASH_SCAN puts all rows of the "
+       "event in a hash and finds them with a single scan of the table, or "
+       "of the matching index ranges if INDEX_SCAN is also set. If the "
+       "variable is empty, each row is looked up with a full table scan",
+       GLOBAL_VAR(slave_rows_search_algorithms_options),
+       CMD_LINE(REQUIRED_ARG), slave_rows_search_algorithms_names,
+       DEFAULT(1ULL << SLAVE_ROWS_INDEX_SCAN));
+
 static Sys_var_on_access_global<Sys_var_mybool,
                            PRIV_SET_SYSTEM_GLOBAL_VAR_SLAVE_SQL_VERIFY_CHECKSUM>
 Sys_slave_sql_verify_checksum(
@@ -3550,6 +3637,14 @@ static Sys_var_ulonglong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, SIZE_T_MAX), DEFAULT(MAX_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_sort_parallel_threads(
+       "sort_parallel_threads",
+       "Maximum number of threads that filesort uses to sort the contents "
+       "of its sort buffer. 1 means that the sort is done by the connection "
+       "thread only",
+       SESSION_VAR(sort_parallel_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, MAX_SORT_THREADS), DEFAULT(1), BLOCK_SIZE(1));
+
 export sql_mode_t expand_sql_mode(sql_mode_t sql_mode)
 {
   if (sql_mode & MODE_ANSI)
@@ -3985,6 +4080,16 @@ Sys_threadpool_dedicated_listener(
   GLOBAL_VAR(threadpool_dedicated_listener), CMD_LINE(OPT_ARG), DEFAULT(FALSE),
   NO_MUTEX_GUARD, NOT_IN_BINLOG
 );
+
+static Sys_var_on_access_global<Sys_var_mybool,
+                                PRIV_SET_SYSTEM_GLOBAL_VAR_THREAD_POOL>
+Sys_threadpool_work_stealing(
+  "thread_pool_work_stealing",
+  "If set to 1, idle worker threads take queued connections from "
+  "other thread groups that are busy",
+  GLOBAL_VAR(threadpool_work_stealing), CMD_LINE(OPT_ARG), DEFAULT(TRUE),
+  NO_MUTEX_GUARD, NOT_IN_BINLOG
+);
 #endif /* HAVE_POOL_OF_THREADS */
 
 /**
@@ -6315,6 +6420,16 @@ static Sys_var_ulong Sys_join_cache_level(
        SESSION_VAR(join_cache_level), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 8), DEFAULT(2), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_join_cache_spill_partitions(
+       "join_cache_spill_partitions",
+       "Number of partitions the records of a hashed join buffer are written "
+       "to on disk when they do not fit into the buffer, so that the joined "
+       "table is read only once instead of once per refill of the buffer. "
+       "0 disables writing join buffers to disk",
+       SESSION_VAR(join_cache_spill_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, MAX_JOIN_CACHE_SPILL_PARTITIONS), DEFAULT(0),
+       BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_mrr_buffer_size(
        "mrr_buffer_size",
        "Size of buffer to use when using MRR with range access",
@@ -6379,10 +6494,11 @@ static Sys_var_enum Sys_optimizer_use_stat_tables(
 
 static Sys_var_ulong Sys_histogram_size(
        "histogram_size",
-       "Number of bytes used for a histogram. "
+       "Number of bytes used for a histogram, at most 255, or the number "
+       "of buckets of an ENDPOINT_HB histogram. "
        "If set to 0, no histograms are created by ANALYZE.",
        SESSION_VAR(histogram_size), CMD_LINE(REQUIRED_ARG),
-       VALID_RANGE(0, 255), DEFAULT(254), BLOCK_SIZE(1));
+       VALID_RANGE(0, 8192), DEFAULT(254), BLOCK_SIZE(1));
 
 extern const char *histogram_types[];
 static Sys_var_enum Sys_histogram_type(
@@ -6390,7 +6506,9 @@ static Sys_var_enum Sys_histogram_type(
        "Specifies type of the histograms created by ANALYZE. "
        "Possible values are: "
        "SINGLE_PREC_HB - single precision height-balanced, "
-       "DOUBLE_PREC_HB - double precision height-balanced.",
+       "DOUBLE_PREC_HB - double precision height-balanced, "
+       "ENDPOINT_HB - height-balanced with the endpoint values and "
+       "a list of the most common values.",
        SESSION_VAR(histogram_type), CMD_LINE(REQUIRED_ARG),
        histogram_types, DEFAULT(1));
 
@@ -169,6 +169,8 @@ static ST_FIELD_INFO stats_fields_info[] =
   Column("POLLS_BY_WORKER",               SLonglong(19), NOT_NULL),
   Column("DEQUEUES_BY_LISTENER",          SLonglong(19), NOT_NULL),
   Column("DEQUEUES_BY_WORKER",            SLonglong(19), NOT_NULL),
+  Column("STEALS",                        SLonglong(19), NOT_NULL),
+  Column("STOLEN",                        SLonglong(19), NOT_NULL),
   CEnd()
 };
 
@@ -198,6 +200,8 @@ static int stats_fill_table(THD* thd, TABLE_LIST* tables, COND*)
     table->field[8]->store(counters->polls_by_worker, true);
     table->field[9]->store(counters->dequeues_by_listener, true);
     table->field[10]->store(counters->dequeues_by_worker, true);
+    table->field[11]->store(counters->steals, true);
+    table->field[12]->store(counters->stolen, true);
     mysql_mutex_unlock(&group->mutex);
     if (schema_table_store_record(thd, table))
       return 1;
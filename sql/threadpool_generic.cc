@@ -122,6 +122,7 @@ static int  wake_or_create_thread(thread_group_t *thread_group, bool due_to_stal
 static int  create_worker(thread_group_t *thread_group, bool due_to_stall);
 static void *worker_main(void *param);
 static void check_stall(thread_group_t *thread_group);
+static void wake_stealer(thread_group_t *thread_group);
 static void set_next_timeout_check(ulonglong abstime);
 static void print_pool_blocked_message(bool);
 
@@ -465,6 +466,116 @@ static void queue_put(thread_group_t *thread_group, native_event *ev, int cnt)
   }
 }
 
+
+#ifndef HAVE_IOCP
+/*
+  Take a connection from the work queue of another group.
+
+  Used by a worker that found nothing to do in its own group, before it goes
+  to sleep, or after wake_stealer() woke it. Only groups with an active
+  worker are considered. Such a group does not wake its idle workers for
+  queued connections (see listener()), so the connections would wait until
+  the active worker is done, or until the timer detects a stall. Groups are
+  visited starting with the next one, so a busy group is mostly helped by
+  the same neighbour.
+
+  The caller holds its own group mutex, and two groups may try to steal from
+  each other, so the other group's mutex is only tried.
+
+  The stolen connection is moved to the current group. Its socket is removed
+  from the poll descriptor of the old group, and start_io() moves the
+  connection back to its home group after the request has been handled.
+*/
+
+static TP_connection_generic *queue_steal(thread_group_t *thread_group)
+{
+  DBUG_ENTER("queue_steal");
+  uint n= group_count;
+  uint self= (uint) (thread_group - all_groups);
+
+  for (uint i= 1; i < n; i++)
+  {
+    thread_group_t *victim= &all_groups[(self + i) % n];
+    if (victim == thread_group)
+      continue;
+
+    /* Unprotected check, repeated below under the mutex */
+    if (is_queue_empty(victim) || !victim->active_thread_count)
+      continue;
+    if (mysql_mutex_trylock(&victim->mutex))
+      continue;
+
+    TP_connection_generic *c= NULL;
+    if (!victim->shutdown && victim->active_thread_count)
+      c= queue_get(victim);
+    if (c)
+    {
+      if (c->bound_to_poll_descriptor)
+      {
+        io_poll_disassociate_fd(victim->pollfd, c->fd);
+        c->bound_to_poll_descriptor= false;
+      }
+      victim->connection_count--;
+      TP_INCREMENT_GROUP_COUNTER(victim, stolen);
+    }
+    mysql_mutex_unlock(&victim->mutex);
+
+    if (c)
+    {
+      c->thread_group= thread_group;
+      thread_group->connection_count++;
+      TP_INCREMENT_GROUP_COUNTER(thread_group, steals);
+      DBUG_RETURN(c);
+    }
+  }
+  DBUG_RETURN(NULL);
+}
+#endif
+
+
+/*
+  Wake an idle worker of another group, to steal the work that is queued
+  in this group behind its active worker (see queue_steal()).
+
+  Without this, only workers that are about to go to sleep would look for
+  work in other groups, and idle groups would never help.
+
+  The caller holds the mutex of its group, so the other group's mutex is
+  only tried, as in queue_steal(). Groups that have queued work of their
+  own are skipped.
+*/
+
+static void wake_stealer(thread_group_t *thread_group)
+{
+#ifndef HAVE_IOCP
+  DBUG_ENTER("wake_stealer");
+  if (!threadpool_work_stealing || !thread_group->active_thread_count ||
+      is_queue_empty(thread_group))
+    DBUG_VOID_RETURN;
+
+  uint n= group_count;
+  uint self= (uint) (thread_group - all_groups);
+
+  for (uint i= 1; i < n; i++)
+  {
+    thread_group_t *group= &all_groups[(self + i) % n];
+
+    /* Unprotected check, repeated below under the mutex */
+    if (group->waiting_threads.is_empty() || !is_queue_empty(group))
+      continue;
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+
+    bool woken= !group->shutdown && is_queue_empty(group) &&
+                !wake_thread(group, false);
+    mysql_mutex_unlock(&group->mutex);
+    if (woken)
+      break;
+  }
+  DBUG_VOID_RETURN;
+#endif
+}
+
 /* 
   Handle wait timeout : 
   Find connections that have been idle for too long and kill them.
@@ -631,6 +742,11 @@ void check_stall(thread_group_t *thread_group)
     TP_INCREMENT_GROUP_COUNTER(thread_group,stalls);
     wake_or_create_thread(thread_group,true);
   }
+  else
+  {
+    /* Work is being dequeued, but may still wait behind the active worker */
+    wake_stealer(thread_group);
+  }
   
   /* Reset queue event count */
   thread_group->queue_event_count= 0;
@@ -780,6 +896,8 @@ static TP_connection_generic * listener(worker_thread_t *current_thread,
         }
       }
     }
+    else
+      wake_stealer(thread_group);
     mysql_mutex_unlock(&thread_group->mutex);
   }
 
@@ -1075,6 +1193,8 @@ static void queue_put(thread_group_t *thread_group, TP_connection_generic *conne
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
+  else
+    wake_stealer(thread_group);
 
   DBUG_VOID_RETURN;
 }
@@ -1176,6 +1296,16 @@ TP_connection_generic *get_event(worker_thread_t *current_thread,
       }
     }
 
+#ifndef HAVE_IOCP
+    /* Help another group that has queued work and no idle workers. */
+    if (!oversubscribed && threadpool_work_stealing)
+    {
+      connection= queue_steal(thread_group);
+      if (connection)
+        break;
+    }
+#endif
+
 
     /* And now, finally sleep */ 
     current_thread->woken = false; /* wake() sets this to true */
@@ -1403,7 +1533,8 @@ void TP_connection_generic::set_io_timeout(int timeout_sec)
 /**
   Handle a (rare) special case,where connection needs to 
   migrate to a different group because group_count has changed
-  after thread_pool_size setting. 
+  after thread_pool_size setting, or because the connection was
+  stolen by a worker of another group (see queue_steal()).
 */
 
 static int change_group(TP_connection_generic *c, 
@@ -1448,6 +1579,8 @@ int TP_connection_generic::start_io()
 
     So we recalculate in which group the connection should be, based
     on thread_id and current group count, and migrate if necessary.
+    This also returns a connection that was stolen by another group's
+    worker to its home group.
   */ 
   thread_group_t *group = 
     &all_groups[thd->thread_id%group_count];
@@ -120,6 +120,8 @@ struct thread_group_counters_t
   ulonglong dequeues_by_listener;
   ulonglong polls_by_listener;
   ulonglong polls_by_worker;
+  ulonglong steals;
+  ulonglong stolen;
 };
 
 struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) thread_group_t
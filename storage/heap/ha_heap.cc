@@ -348,6 +348,30 @@ int ha_heap::rnd_next(uchar *buf)
   return error;
 }
 
+int ha_heap::rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+{
+  const uint rec_buff_length= table_share->rec_buff_length;
+  ulong deleted= 0;
+  int error= 0;
+
+  while (*n_rows < max_rows)
+  {
+    if (!(error= heap_scan(file, buf)))
+    {
+      buf+= rec_buff_length;
+      (*n_rows)++;
+    }
+    else if (error == HA_ERR_RECORD_DELETED)
+      deleted++;
+    else
+      break;
+    error= 0;
+  }
+  status_var_add(table->in_use->status_var.ha_read_rnd_deleted_count,
+                 deleted);
+  return error;
+}
+
 int ha_heap::rnd_pos(uchar * buf, uchar *pos)
 {
   int error;
@@ -611,6 +635,7 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_BLOBDEF *blobdef;
   TABLE_SHARE *share= table_arg->s;
   bool found_real_auto_increment= 0;
 
@@ -621,10 +646,12 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
 
   if (!(keydef= (HP_KEYDEF*) my_malloc(hp_key_memory_HP_KEYDEF,
                                        keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+                                       share->blob_fields * sizeof(HP_BLOBDEF),
 				       MYF(MY_WME | MY_THREAD_SPECIFIC))))
     return my_errno;
   seg= reinterpret_cast<HA_KEYSEG*>(keydef + keys);
+  blobdef= reinterpret_cast<HP_BLOBDEF*>(seg + parts);
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -652,6 +679,7 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
     for (; key_part != key_part_end; key_part++, seg++)
     {
       Field *field= key_part->field;
+      DBUG_ASSERT(!(field->flags & BLOB_FLAG));
 
       if (pos->algorithm == HA_KEY_ALG_BTREE)
 	seg->type= field->key_type();
@@ -709,6 +737,19 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
     }
   }
   mem_per_row+= MY_ALIGN(MY_MAX(share->reclength, sizeof(char*)) + 1, sizeof(char*));
+
+  /*
+    Blobs are stored out of line, see hp_blob.c. MEMORY tables created by
+    the user still refuse blobs (HA_NO_BLOBS), so only internal temporary
+    tables get here with blob fields, and never with a key over a blob.
+  */
+  for (uint i= 0; i < share->blob_fields; i++)
+  {
+    Field_blob *field= (Field_blob*) table_arg->field[share->blob_field[i]];
+    DBUG_ASSERT(field->flags & BLOB_FLAG);
+    blobdef[i].offset= field->offset(table_arg->record[0]);
+    blobdef[i].packlength= field->pack_length_no_ptr();
+  }
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
@@ -717,6 +758,14 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->auto_key= auto_key;
   hp_create_info->auto_key_type= auto_key_type;
   hp_create_info->max_table_size=current_thd->variables.max_heap_table_size;
+  /*
+    The number of rows of an internal temporary table is limited by
+    tmp_memory_table_size through max_rows, which does not account for
+    the blob data.
+  */
+  if (internal_table && share->blob_fields)
+    set_if_smaller(hp_create_info->max_table_size,
+                   current_thd->variables.tmp_memory_table_size);
   hp_create_info->with_auto_increment= found_real_auto_increment;
   hp_create_info->internal_table= internal_table;
 
@@ -729,6 +778,8 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->keys= share->keys;
   hp_create_info->reclength= share->reclength;
   hp_create_info->keydef= keydef;
+  hp_create_info->blobs= share->blob_fields;
+  hp_create_info->blobdef= blobdef;
   return 0;
 }
 
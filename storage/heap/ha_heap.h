@@ -51,7 +51,8 @@ class ha_heap: public handler
             HA_BINLOG_ROW_CAPABLE | HA_BINLOG_STMT_CAPABLE |
             HA_CAN_SQL_HANDLER | HA_CAN_ONLINE_BACKUPS |
             HA_REC_NOT_IN_SEQ | HA_CAN_INSERT_DELAYED | HA_NO_TRANSACTIONS |
-            HA_HAS_RECORDS | HA_STATS_RECORDS_IS_EXACT | HA_CAN_HASH_KEYS);
+            HA_HAS_RECORDS | HA_STATS_RECORDS_IS_EXACT | HA_CAN_HASH_KEYS |
+            HA_CAN_RND_BATCH);
   }
   ulong index_flags(uint inx, uint part, bool all_parts) const
   {
@@ -90,6 +91,7 @@ class ha_heap: public handler
   int index_last(uchar * buf);
   int rnd_init(bool scan);
   int rnd_next(uchar *buf);
+  int rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows);
   int rnd_pos(uchar * buf, uchar *pos);
   void position(const uchar *record);
   int can_continue_handler_scan();
@@ -52,6 +52,16 @@ typedef struct st_hp_hash_info
   ulong hash_of_key;
 } HASH_INFO;
 
+/*
+  Header of an out-of-line blob, followed by the blob data. All chunks of
+  a table are linked together, so that they can be freed by hp_clear().
+*/
+typedef struct st_hp_blob_chunk
+{
+  struct st_hp_blob_chunk *next, *prev;
+  size_t length;			/* Allocated size, including header */
+} HP_BLOB_CHUNK;
+
 typedef struct {
   HA_KEYSEG *keyseg;
   uint key_length;
@@ -98,6 +108,15 @@ extern my_bool hp_if_null_in_key(HP_KEYDEF *keyinfo, const uchar *record);
 extern int hp_close(HP_INFO *info);
 extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
+extern uchar *hp_copy_blob(HP_SHARE *share, const uchar *data, size_t length);
+extern void hp_free_blob(HP_SHARE *share, uchar *data);
+extern size_t hp_blob_length(const HP_BLOBDEF *blobdef, const uchar *record);
+extern uchar *hp_blob_ptr(const HP_BLOBDEF *blobdef, const uchar *record);
+extern void hp_set_blob_ptr(const HP_BLOBDEF *blobdef, uchar *record,
+                            const uchar *data);
+extern int hp_write_blobs(HP_SHARE *share, uchar *pos);
+extern void hp_free_blobs(HP_SHARE *share, uchar *pos);
+extern void hp_free_all_blobs(HP_SHARE *share);
 extern uint hp_rb_pack_key(HP_KEYDEF *keydef, uchar *key, const uchar *old,
                            key_part_map keypart_map);
 
@@ -107,6 +126,7 @@ extern PSI_memory_key hp_key_memory_HP_SHARE;
 extern PSI_memory_key hp_key_memory_HP_INFO;
 extern PSI_memory_key hp_key_memory_HP_PTRS;
 extern PSI_memory_key hp_key_memory_HP_KEYDEF;
+extern PSI_memory_key hp_key_memory_HP_BLOB;
 
 #ifdef HAVE_PSI_INTERFACE
 void init_heap_psi_keys();
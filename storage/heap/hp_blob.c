@@ -0,0 +1,185 @@
+/* Copyright (c) 2020, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+/*
+  Out-of-line storage of BLOB columns.
+
+  A heap record has the same format as table->record[0], so a BLOB column
+  is stored as its length followed by a pointer to the data. When a record
+  is written, the data of each blob is copied to a chunk owned by the table
+  and the pointer in the stored record is changed to point to the chunk.
+  Reading a record therefore returns pointers into the table, which stay
+  valid until the row is updated or deleted, like for other engines.
+
+  The chunks are counted in data_length, so they are limited by
+  max_table_size together with the fixed-size part of the rows.
+*/
+
+#include "heapdef.h"
+
+size_t hp_blob_length(const HP_BLOBDEF *blobdef, const uchar *record)
+{
+  const uchar *pos= record + blobdef->offset;
+  switch (blobdef->packlength) {
+  case 1:
+    return (size_t) *pos;
+  case 2:
+    return (size_t) uint2korr(pos);
+  case 3:
+    return (size_t) uint3korr(pos);
+  case 4:
+    return (size_t) uint4korr(pos);
+  }
+  DBUG_ASSERT(0);
+  return 0;
+}
+
+
+uchar *hp_blob_ptr(const HP_BLOBDEF *blobdef, const uchar *record)
+{
+  uchar *data;
+  memcpy(&data, record + blobdef->offset + blobdef->packlength, sizeof(data));
+  return data;
+}
+
+
+void hp_set_blob_ptr(const HP_BLOBDEF *blobdef, uchar *record,
+                     const uchar *data)
+{
+  memcpy(record + blobdef->offset + blobdef->packlength, &data, sizeof(data));
+}
+
+
+/*
+  Copy blob data to a new chunk of the table
+
+  RETURN
+    pointer to the copy, or NULL with my_errno set if the table is full
+    or out of memory
+*/
+
+uchar *hp_copy_blob(HP_SHARE *share, const uchar *data, size_t length)
+{
+  HP_BLOB_CHUNK *chunk;
+  size_t alloc_length= sizeof(HP_BLOB_CHUNK) + length;
+
+  if (share->data_length + share->index_length + alloc_length >
+      share->max_table_size)
+  {
+    my_errno= HA_ERR_RECORD_FILE_FULL;
+    return NULL;
+  }
+  if (!(chunk= (HP_BLOB_CHUNK*) my_malloc(hp_key_memory_HP_BLOB, alloc_length,
+                                          MYF(share->internal ?
+                                              MY_THREAD_SPECIFIC : 0))))
+  {
+    my_errno= ENOMEM;
+    return NULL;
+  }
+  chunk->length= alloc_length;
+  chunk->prev= NULL;
+  if ((chunk->next= share->blob_chunks))
+    chunk->next->prev= chunk;
+  share->blob_chunks= chunk;
+  share->data_length+= alloc_length;
+
+  memcpy(chunk + 1, data, length);
+  return (uchar*) (chunk + 1);
+}
+
+
+void hp_free_blob(HP_SHARE *share, uchar *data)
+{
+  HP_BLOB_CHUNK *chunk= ((HP_BLOB_CHUNK*) data) - 1;
+
+  if (chunk->next)
+    chunk->next->prev= chunk->prev;
+  if (chunk->prev)
+    chunk->prev->next= chunk->next;
+  else
+    share->blob_chunks= chunk->next;
+  share->data_length-= chunk->length;
+  my_free(chunk);
+}
+
+
+/*
+  Replace the blob pointers of a record that is being written with
+  pointers to copies owned by the table. Empty blobs get a NULL pointer.
+
+  RETURN
+    0  ok
+    #  error; no chunks are left allocated for the record
+*/
+
+int hp_write_blobs(HP_SHARE *share, uchar *pos)
+{
+  HP_BLOBDEF *blobdef, *end;
+
+  for (blobdef= share->blobdef, end= blobdef + share->blobs;
+       blobdef < end; blobdef++)
+  {
+    size_t length= hp_blob_length(blobdef, pos);
+    uchar *data= NULL;
+
+    if (length && !(data= hp_copy_blob(share, hp_blob_ptr(blobdef, pos),
+                                       length)))
+    {
+      /* Undo the copies made so far */
+      while (blobdef-- > share->blobdef)
+      {
+        if ((data= hp_blob_ptr(blobdef, pos)))
+          hp_free_blob(share, data);
+      }
+      return my_errno;
+    }
+    hp_set_blob_ptr(blobdef, pos, data);
+  }
+  return 0;
+}
+
+
+/* Free the blob chunks of a stored record */
+
+void hp_free_blobs(HP_SHARE *share, uchar *pos)
+{
+  HP_BLOBDEF *blobdef, *end;
+
+  for (blobdef= share->blobdef, end= blobdef + share->blobs;
+       blobdef < end; blobdef++)
+  {
+    uchar *data= hp_blob_ptr(blobdef, pos);
+    if (data)
+    {
+      hp_free_blob(share, data);
+      hp_set_blob_ptr(blobdef, pos, NULL);
+    }
+  }
+}
+
+
+/* Free all blob chunks of the table, see hp_clear() */
+
+void hp_free_all_blobs(HP_SHARE *share)
+{
+  HP_BLOB_CHUNK *chunk, *next;
+
+  for (chunk= share->blob_chunks; chunk; chunk= next)
+  {
+    next= chunk->next;
+    my_free(chunk);
+  }
+  share->blob_chunks= NULL;
+}
@@ -18,6 +18,75 @@
 
 #include "heapdef.h"
 
+/*
+  Copy the blobs of the new version of the current record to chunks of
+  the table, and remember them in info->blob_buff. A blob that still
+  points to the chunk of the stored record (the column was not changed)
+  shares that chunk.
+*/
+
+static int hp_copy_new_blobs(HP_INFO *info, const uchar *pos,
+                             const uchar *heap_new)
+{
+  HP_SHARE *share= info->s;
+  uint i;
+
+  for (i= 0; i < share->blobs; i++)
+  {
+    HP_BLOBDEF *blobdef= share->blobdef + i;
+    size_t length= hp_blob_length(blobdef, heap_new);
+    uchar *data= hp_blob_ptr(blobdef, heap_new);
+
+    if (!length)
+      data= NULL;
+    else if (data != hp_blob_ptr(blobdef, pos) ||
+             length > hp_blob_length(blobdef, pos))
+    {
+      if (!(data= hp_copy_blob(share, data, length)))
+      {
+        int error= my_errno;
+        while (i--)
+        {
+          if (info->blob_buff[i] &&
+              info->blob_buff[i] != hp_blob_ptr(share->blobdef + i, pos))
+            hp_free_blob(share, info->blob_buff[i]);
+        }
+        return my_errno= error;
+      }
+    }
+    info->blob_buff[i]= data;
+  }
+  return 0;
+}
+
+
+/*
+  Free either the blob chunks of the old version of the record
+  (commit == TRUE) or the copies made by hp_copy_new_blobs()
+*/
+
+static void hp_release_blobs(HP_INFO *info, uchar *pos, my_bool commit)
+{
+  HP_SHARE *share= info->s;
+  uint i;
+
+  for (i= 0; i < share->blobs; i++)
+  {
+    uchar *old_data= hp_blob_ptr(share->blobdef + i, pos);
+    uchar *new_data= info->blob_buff[i];
+    if (old_data == new_data)
+      continue;
+    if (commit)
+    {
+      if (old_data)
+        hp_free_blob(share, old_data);
+    }
+    else if (new_data)
+      hp_free_blob(share, new_data);
+  }
+}
+
+
 int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 {
   HP_KEYDEF *keydef, *end, *p_lastinx;
@@ -31,6 +100,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  if (share->blobs && hp_copy_new_blobs(info, pos, heap_new))
+    DBUG_RETURN(my_errno);
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -47,7 +118,16 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  if (share->blobs)
+  {
+    uint i;
+    hp_release_blobs(info, pos, TRUE);
+    memcpy(pos,heap_new,(size_t) share->reclength);
+    for (i= 0; i < share->blobs; i++)
+      hp_set_blob_ptr(share->blobdef + i, pos, info->blob_buff[i]);
+  }
+  else
+    memcpy(pos,heap_new,(size_t) share->reclength);
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -68,6 +148,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       /* we don't need to delete non-inserted key from rb-tree */
       if ((*keydef->write_key)(info, keydef, old, pos))
       {
+        if (share->blobs)
+          hp_release_blobs(info, pos, FALSE);
         if (++(share->records) == share->blength)
 	  share->blength+= share->blength;
         DBUG_RETURN(my_errno);
@@ -85,6 +167,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       keydef--;
     }
   }
+  if (share->blobs)
+    hp_release_blobs(info, pos, FALSE);
   if (++(share->records) == share->blength)
     share->blength+= share->blength;
   DBUG_RETURN(my_errno);
@@ -46,6 +46,10 @@ int heap_write(HP_INFO *info, const uchar *record)
     DBUG_RETURN(my_errno);
   share->changed=1;
 
+  memcpy(pos,record,(size_t) share->reclength);
+  if (share->blobs && hp_write_blobs(share, pos))
+    goto err_free_pos;
+
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
        keydef++)
   {
@@ -53,7 +57,6 @@ int heap_write(HP_INFO *info, const uchar *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
   pos[share->visible]= 1;                     /* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
@@ -86,7 +89,10 @@ int heap_write(HP_INFO *info, const uchar *record)
       break;
     keydef--;
   } 
+  if (share->blobs)
+    hp_free_blobs(share, pos);
 
+err_free_pos:
   share->deleted++;
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
@@ -42,6 +42,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "ha0ha.h"
 #include "srv0mon.h"
 #include "sync0sync.h"
+#include "ut0counter.h"
 
 /** Is search system enabled.
 Search system is protected by array of latches. */
@@ -77,6 +78,53 @@ UNIV_INTERN byte		btr_sea_pad2[CACHE_LINE_SIZE];
 /** The adaptive hash index */
 btr_search_sys_t*	btr_search_sys;
 
+/** Number of btr_search_guess_on_hash() calls that are looking up the
+adaptive hash index without holding the search latch. The hash tables
+and their heaps are only emptied or freed after btr_search_enabled has
+been cleared and this has dropped to zero. Each lookup increments and
+decrements the same slot, so that no slot is ever negative. */
+static ib_counter_t<ulint>	btr_search_optimistic;
+
+/** Exit a lookup started by btr_search_optimistic_enter().
+@param[in]	slot	the slot passed to btr_search_optimistic_enter() */
+static void btr_search_optimistic_exit(size_t slot)
+{
+	/* Make the reads of the lookup happen before the hash tables
+	can be freed by btr_search_disable(). */
+	std::atomic_thread_fence(std::memory_order_release);
+	btr_search_optimistic.add(slot, ulint(-1));
+}
+
+/** Start a lookup of the adaptive hash index without the search latch.
+@param[in]	slot	slot of btr_search_optimistic to use
+@return whether the adaptive hash index may be accessed, until
+btr_search_optimistic_exit() */
+static bool btr_search_optimistic_enter(size_t slot)
+{
+	btr_search_optimistic.add(slot, 1);
+	/* Pairs with the fence in btr_search_optimistic_wait(): either
+	we see btr_search_enabled cleared, or btr_search_disable()
+	sees our increment and waits for us. */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (btr_search_enabled) {
+		return(true);
+	}
+	btr_search_optimistic_exit(slot);
+	return(false);
+}
+
+/** Wait for the lookups without the search latch to finish.
+btr_search_enabled must have been cleared, so that no new ones start. */
+static void btr_search_optimistic_wait()
+{
+	ut_ad(!btr_search_enabled);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	while (btr_search_optimistic) {
+		os_thread_yield();
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+}
+
 /** If the number of records on the page divided by this parameter
 would have been successfully accessed using a hash index, the index
 is then built on the page, assuming the global limit has been reached */
@@ -280,7 +328,11 @@ void btr_search_sys_resize(ulint hash_size)
 		return;
 	}
 
-	/* Step-2: Recreate hash tables with new size. */
+	/* Step-2: Recreate hash tables with new size. Lookups without
+	the latch do not access the tables while btr_search_enabled is
+	cleared, and btr_search_disable() waited for the ones that
+	started before. */
+	ut_ad(!btr_search_optimistic);
 	for (ulint i = 0; i < btr_ahi_parts; ++i) {
 
 		mem_heap_free(btr_search_sys->hash_tables[i]->heap);
@@ -396,10 +448,19 @@ void btr_search_disable(bool need_mutex)
 	/* Set all block->index = NULL. */
 	buf_pool.clear_hash_index();
 
-	/* Clear the adaptive hash index. */
+	/* Clear the adaptive hash index. The lookups without the latch
+	that are in progress fail their validation and retry with the
+	latch, which will find the adaptive hash index disabled. Their
+	nodes are only freed after they have finished. */
 	for (ulint i = 0; i < btr_ahi_parts; ++i) {
-		hash_table_clear(btr_search_sys->hash_tables[i]);
-		mem_heap_empty(btr_search_sys->hash_tables[i]->heap);
+		ha_clear_adaptive_start(btr_search_sys->hash_tables[i]);
+	}
+
+	DEBUG_SYNC_C("btr_search_disable_wait");
+	btr_search_optimistic_wait();
+
+	for (ulint i = 0; i < btr_ahi_parts; ++i) {
+		ha_clear_adaptive_end(btr_search_sys->hash_tables[i]);
 	}
 
 	btr_search_x_unlock_all();
@@ -838,6 +899,30 @@ btr_search_failure(btr_search_t* info, btr_cur_t* cursor)
 #endif /* UNIV_SEARCH_PERF_STAT */
 
 	info->last_hash_succ = FALSE;
+	info->hash_fails++;
+}
+
+/** Check whether most of the recent hash searches on an index failed.
+Each failed hash search is followed by a search in the B-tree, and
+possibly by an update of the hash index, so that it is cheaper not to
+use the hash index on the index for a while.
+@param[in,out]	info	search info of the index
+@return whether the hash index was switched off for the index */
+static bool btr_search_check_hurt(btr_search_t* info)
+{
+	bool	hurt = info->hash_fails > BTR_SEARCH_HURT_WINDOW / 2;
+
+	info->hash_tries = 0;
+	info->hash_fails = 0;
+
+	if (hurt) {
+		info->n_hash_potential = 0;
+		info->last_hash_succ = FALSE;
+		info->hash_off = BTR_SEARCH_HURT_BACKOFF;
+		MONITOR_INC(MONITOR_ADAPTIVE_HASH_INDEX_OFF);
+	}
+
+	return(hurt);
 }
 
 /** Clear the adaptive hash index on all pages in the buffer pool. */
@@ -906,11 +991,6 @@ inline buf_block_t* buf_pool_t::block_from_ahi(const byte *ptr) const
   /* buf_pool_t::chunk_t::init() invokes buf_block_init() so that
   block[n].frame == block->frame + n * srv_page_size.  Check it. */
   ut_ad(block->frame == page_align(ptr));
-  /* Read the state of the block without holding a mutex.
-  A state transition from BUF_BLOCK_FILE_PAGE to
-  BUF_BLOCK_REMOVE_HASH is possible during this execution. */
-  ut_d(const buf_page_state state = buf_block_get_state(block));
-  ut_ad(state == BUF_BLOCK_FILE_PAGE || state == BUF_BLOCK_REMOVE_HASH);
   return block;
 }
 
@@ -981,6 +1061,12 @@ btr_search_guess_on_hash(
 		return(FALSE);
 	}
 
+	if (++info->hash_tries >= BTR_SEARCH_HURT_WINDOW
+	    && btr_search_check_hurt(info)) {
+
+		return(FALSE);
+	}
+
 	index_id = index->id;
 
 #ifdef UNIV_SEARCH_PERF_STAT
@@ -992,24 +1078,48 @@ btr_search_guess_on_hash(
 	cursor->flag = BTR_CUR_HASH;
 
 	rw_lock_t* use_latch = ahi_latch ? NULL : btr_get_search_latch(index);
+	hash_table_t* table;
+	buf_block_t* block;
+	uint32_t version;
+	const size_t slot = get_rnd_value();
+
+	/* Unless the caller holds the latch, look up the hash table
+	without acquiring it. The result is validated after the block
+	has been buffer-fixed. If the hash chain was modified meanwhile,
+	the lookup is repeated while holding the latch. */
+	bool optimistic = use_latch && btr_search_optimistic_enter(slot);
+
+	if (optimistic) {
+		table = btr_get_search_table(index);
+		if (!ha_search_optimistic(table, fold, &rec, &version)) {
+			btr_search_optimistic_exit(slot);
+			optimistic = false;
+		}
+	}
 
-	if (use_latch) {
-		rw_lock_s_lock(use_latch);
+	if (!optimistic) {
+retry_latched:
+		if (use_latch) {
+			rw_lock_s_lock(use_latch);
 
-		if (!btr_search_enabled) {
-			goto fail;
+			if (!btr_search_enabled) {
+				goto fail;
+			}
+		} else {
+			ut_ad(btr_search_enabled);
+			ut_ad(rw_lock_own(ahi_latch, RW_LOCK_S));
 		}
-	} else {
-		ut_ad(btr_search_enabled);
-		ut_ad(rw_lock_own(ahi_latch, RW_LOCK_S));
-	}
 
-	rec = (rec_t*) ha_search_and_get_data(
-		btr_get_search_table(index), fold);
+		table = btr_get_search_table(index);
+		rec = ha_search_and_get_data(table, fold);
+	}
 
 	if (rec == NULL) {
-		if (use_latch) {
+		if (optimistic) {
+			btr_search_optimistic_exit(slot);
+		}
 fail:
+		if (use_latch && !optimistic) {
 			rw_lock_s_unlock(use_latch);
 		}
 
@@ -1018,12 +1128,26 @@ btr_search_guess_on_hash(
 		return(FALSE);
 	}
 
-	buf_block_t* block = buf_pool.block_from_ahi(rec);
+	block = buf_pool.block_from_ahi(rec);
 
 	if (use_latch) {
 		mutex_enter(&block->mutex);
 
-		if (buf_block_get_state(block) == BUF_BLOCK_REMOVE_HASH) {
+		if (optimistic) {
+			/* Without the latch, the block may have been
+			evicted or even reused after the lookup. */
+			if (buf_block_get_state(block)
+			    != BUF_BLOCK_FILE_PAGE) {
+				mutex_exit(&block->mutex);
+				btr_search_optimistic_exit(slot);
+retry:
+				MONITOR_ATOMIC_INC(
+					MONITOR_ADAPTIVE_HASH_SEARCH_RETRY);
+				optimistic = false;
+				goto retry_latched;
+			}
+		} else if (buf_block_get_state(block)
+			   == BUF_BLOCK_REMOVE_HASH) {
 			/* Another thread is just freeing the block
 			from the LRU list of the buffer pool: do not
 			try to access this page. */
@@ -1032,12 +1156,27 @@ btr_search_guess_on_hash(
 		}
 
 		ut_ad(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
-		DBUG_ASSERT(block->page.status != buf_page_t::FREED);
 
 		buf_page_set_accessed(&block->page);
 		buf_block_buf_fix_inc(block, __FILE__, __LINE__);
 		mutex_exit(&block->mutex);
 
+		if (optimistic) {
+			DEBUG_SYNC_C("btr_search_guess_optimistic");
+			bool valid = ha_search_validate(table, fold, version);
+			btr_search_optimistic_exit(slot);
+
+			if (!valid) {
+				buf_block_buf_fix_dec(block);
+				goto retry;
+			}
+		}
+
+		/* The buffer-fix prevents the block from being evicted
+		or freed, and the hash index entries of a block are always
+		dropped before that. */
+		DBUG_ASSERT(block->page.status != buf_page_t::FREED);
+
 		buf_page_make_young_if_needed(&block->page);
 		mtr_memo_type_t	fix_type;
 		if (latch_mode == BTR_SEARCH_LEAF) {
@@ -1059,7 +1198,9 @@ btr_search_guess_on_hash(
 
 		buf_pool.stat.n_page_gets++;
 
-		rw_lock_s_unlock(use_latch);
+		if (!optimistic) {
+			rw_lock_s_unlock(use_latch);
+		}
 
 		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
 	}
@@ -462,7 +462,7 @@ byte *buf_buddy_alloc_low(ulint i, bool *lru)
 	}
 
 	/* Try allocating from the buf_pool.free list. */
-	block = buf_LRU_get_free_only();
+	block = buf_LRU_get_free_only(buf_pool.local_node());
 
 	if (block) {
 		goto alloc_big;
@@ -470,7 +470,7 @@ byte *buf_buddy_alloc_low(ulint i, bool *lru)
 
 	/* Try replacing an uncompressed page in the buffer pool. */
 	mutex_exit(&buf_pool.mutex);
-	block = buf_LRU_get_free_block();
+	block = buf_LRU_get_free_block(buf_pool.local_node());
 	mutex_enter(&buf_pool.mutex);
 	if (lru) {
 		*lru = true;
@@ -712,7 +712,7 @@ buf_buddy_realloc(void* buf, ulint size)
 
 	if (block == NULL) {
 		/* Try allocating from the buf_pool.free list. */
-		block = buf_LRU_get_free_only();
+		block = buf_LRU_get_free_only(buf_pool.local_node());
 
 		if (block == NULL) {
 			return(false); /* free_list was not enough */
@@ -179,7 +179,11 @@ in the database, using tables whose size is a power of 2.
 There are several lists of control blocks.
 
 The free list (buf_pool.free) contains blocks which are currently not
-used.
+used. With innodb_numa_node_local, each buffer pool chunk is bound to
+one NUMA node and there is one free list per node. A block for a page
+is preferably taken from the free list of the node that the page
+identifier hashes to (buf_pool_t::page_node()), so that a page is
+placed on the same node whenever it is read in.
 
 The common LRU list contains all the blocks holding a file page
 except those for which the bufferfix count is non-zero.
@@ -515,7 +519,7 @@ buf_pool_get_oldest_modification()
 buf_block_t*
 buf_block_alloc()
 {
-	buf_block_t* block = buf_LRU_get_free_block();
+	buf_block_t* block = buf_LRU_get_free_block(buf_pool.local_node());
 	buf_block_set_state(block, BUF_BLOCK_MEMORY);
 	return(block);
 }
@@ -1360,8 +1364,26 @@ inline bool buf_pool_t::chunk_t::create(size_t bytes)
   if (UNIV_UNLIKELY(!mem))
     return false;
 
+  /* With innodb_numa_node_local, the chunks are assigned to the
+  NUMA nodes round-robin. */
+  const ulint node= ulint(this - buf_pool.chunks) % buf_pool.n_numa_nodes;
+
 #ifdef HAVE_LIBNUMA
-  if (srv_numa_interleave)
+  if (buf_pool.n_numa_nodes > 1)
+  {
+    struct bitmask *numa_node_mask= numa_allocate_nodemask();
+    numa_bitmask_setbit(numa_node_mask, buf_pool.numa_node_id[node]);
+    if (mbind(mem, mem_size(), MPOL_PREFERRED,
+              numa_node_mask->maskp, numa_node_mask->size, MPOL_MF_MOVE))
+    {
+      ib::warn() << "Failed to set NUMA memory policy of"
+              " buffer pool page frames to MPOL_PREFERRED for node "
+              << buf_pool.numa_node_id[node]
+              << " (error: " << strerror(errno) << ").";
+    }
+    numa_bitmask_free(numa_node_mask);
+  }
+  else if (srv_numa_interleave)
   {
     struct bitmask *numa_mems_allowed= numa_get_mems_allowed();
     if (mbind(mem, mem_size(), MPOL_INTERLEAVE,
@@ -1414,7 +1436,8 @@ inline bool buf_pool_t::chunk_t::create(size_t bytes)
     buf_block_init(block, frame);
     UNIV_MEM_INVALID(block->frame, srv_page_size);
     /* Add the block to the free list */
-    UT_LIST_ADD_LAST(buf_pool.free, &block->page);
+    block->numa_node= uint32_t(node);
+    UT_LIST_ADD_LAST(buf_pool.free[node], &block->page);
 
     ut_d(block->page.in_free_list = TRUE);
     block++;
@@ -1513,8 +1536,37 @@ bool buf_pool_t::create()
   n_chunks= srv_buf_pool_size / srv_buf_pool_chunk_unit;
   const size_t chunk_size= srv_buf_pool_chunk_unit;
 
+  n_numa_nodes= 1;
+#ifdef HAVE_LIBNUMA
+  if (!srv_numa_node_local);
+  else if (numa_available() == -1)
+    ib::warn() << "innodb_numa_node_local=ON is ignored,"
+      " because NUMA is not available";
+  else
+  {
+    struct bitmask *numa_mems_allowed= numa_get_mems_allowed();
+    n_numa_nodes= 0;
+    for (int n= 0; n <= numa_max_node() &&
+         n_numa_nodes < BUF_POOL_MAX_NUMA_NODES; n++)
+      if (numa_bitmask_isbitset(numa_mems_allowed, n))
+        numa_node_id[n_numa_nodes++]= n;
+    numa_bitmask_free(numa_mems_allowed);
+
+    DBUG_EXECUTE_IF("ib_buf_pool_2_numa_nodes",
+                    if (n_numa_nodes == 1)
+                      numa_node_id[n_numa_nodes++]= numa_node_id[0];);
+
+    if (n_numa_nodes > 1)
+      ib::info() << "Binding buffer pool chunks to " << n_numa_nodes
+        << " NUMA nodes";
+    else
+      n_numa_nodes= 1;
+  }
+#endif /* HAVE_LIBNUMA */
+
   chunks= static_cast<chunk_t*>(ut_zalloc_nokey(n_chunks * sizeof *chunks));
-  UT_LIST_INIT(free, &buf_page_t::list);
+  for (ulint i= 0; i < n_numa_nodes; i++)
+    UT_LIST_INIT(free[i], &buf_page_t::list);
   curr_size= 0;
   auto chunk= chunks;
 
@@ -1592,8 +1644,11 @@ bool buf_pool_t::create()
 
   try_LRU_scan= true;
 
-  ut_d(flush_hp.m_mutex= &flush_list_mutex;);
-  ut_d(lru_hp.m_mutex= &mutex);
+  for (ulint i= 0; i < MAX_PAGE_CLEANERS; i++)
+  {
+    ut_d(flush_hp[i].m_mutex= &flush_list_mutex);
+    ut_d(lru_hp[i].m_mutex= &mutex);
+  }
   ut_d(lru_scan_itr.m_mutex= &mutex);
   ut_d(single_scan_itr.m_mutex= &mutex);
 
@@ -1612,6 +1667,27 @@ bool buf_pool_t::create()
   return false;
 }
 
+/** Determine the free list from which a block that does not belong to
+any page is preferably allocated.
+@return index of a buf_pool.free list */
+ulint buf_pool_t::local_node() const
+{
+  if (n_numa_nodes == 1)
+    return 0;
+#ifdef HAVE_LIBNUMA
+  const int cpu= sched_getcpu();
+  if (cpu >= 0)
+  {
+    const int node= numa_node_of_cpu(cpu);
+    for (ulint i= 0; i < n_numa_nodes; i++)
+      if (numa_node_id[i] == node)
+        return i;
+  }
+#endif /* HAVE_LIBNUMA */
+  static Atomic_counter<ulint> next_node;
+  return next_node++ % n_numa_nodes;
+}
+
 /** Clean up after successful create() */
 void buf_pool_t::close()
 {
@@ -1685,7 +1761,7 @@ inline bool buf_pool_t::realloc(buf_block_t *block)
 	ut_ad(mutex_own(&mutex));
 	ut_ad(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
 
-	new_block = buf_LRU_get_free_only();
+	new_block = buf_LRU_get_free_only(page_node(block->page.id));
 
 	if (new_block == NULL) {
 		return(false); /* free list was not enough */
@@ -1863,29 +1939,33 @@ inline bool buf_pool_t::withdraw_blocks()
 		ulint	count1 = 0;
 
 		mutex_enter(&mutex);
-		block = reinterpret_cast<buf_block_t*>(
-			UT_LIST_GET_FIRST(free));
-		while (block != NULL
-		       && UT_LIST_GET_LEN(withdraw) < withdraw_target) {
-			ut_ad(block->page.in_free_list);
-			ut_ad(!block->page.in_flush_list);
-			ut_ad(!block->page.in_LRU_list);
-			ut_a(!buf_page_in_file(&block->page));
-
-			buf_block_t*	next_block;
-			next_block = reinterpret_cast<buf_block_t*>(
-				UT_LIST_GET_NEXT(
-					list, &block->page));
-
-			if (buf_pool.will_be_withdrawn(block->page)) {
-				/* This should be withdrawn */
-				UT_LIST_REMOVE(free, &block->page);
-				UT_LIST_ADD_LAST(withdraw, &block->page);
-				ut_d(block->in_withdraw_list = TRUE);
-				count1++;
-			}
+		for (ulint i = 0; i < n_numa_nodes; i++) {
+			block = reinterpret_cast<buf_block_t*>(
+				UT_LIST_GET_FIRST(free[i]));
+			while (block != NULL
+			       && UT_LIST_GET_LEN(withdraw)
+			       < withdraw_target) {
+				ut_ad(block->page.in_free_list);
+				ut_ad(!block->page.in_flush_list);
+				ut_ad(!block->page.in_LRU_list);
+				ut_a(!buf_page_in_file(&block->page));
+
+				buf_block_t*	next_block;
+				next_block = reinterpret_cast<buf_block_t*>(
+					UT_LIST_GET_NEXT(
+						list, &block->page));
+
+				if (buf_pool.will_be_withdrawn(block->page)) {
+					/* This should be withdrawn */
+					UT_LIST_REMOVE(free[i], &block->page);
+					UT_LIST_ADD_LAST(withdraw,
+							 &block->page);
+					ut_d(block->in_withdraw_list = TRUE);
+					count1++;
+				}
 
-			block = next_block;
+				block = next_block;
+			}
 		}
 		mutex_exit(&mutex);
 
@@ -3585,7 +3665,7 @@ buf_page_get_gen(
 		or relocated while we are attempting to allocate an
 		uncompressed page. */
 
-		block = buf_LRU_get_free_block();
+		block = buf_LRU_get_free_block(buf_pool.page_node(page_id));
 
 		mutex_enter(&buf_pool.mutex);
 
@@ -4028,7 +4108,7 @@ buf_page_optimistic_get(
 
 /** Given a tablespace id and page number tries to get that page. If the
 page is not in the buffer pool it is not loaded and NULL is returned.
-Suitable for using when holding the lock_sys_t::mutex.
+Suitable for using when holding the lock_sys_t::latch.
 @param[in]	page_id	page id
 @param[in]	file	file name
 @param[in]	line	line where called
@@ -4247,7 +4327,7 @@ buf_page_init_for_read(
 	if (zip_size && !unzip && !recv_recovery_is_on()) {
 		block = NULL;
 	} else {
-		block = buf_LRU_get_free_block();
+		block = buf_LRU_get_free_block(buf_pool.page_node(page_id));
 		ut_ad(block);
 	}
 
@@ -4447,7 +4527,7 @@ buf_page_create(
 	ut_ad(mtr->is_active());
 	ut_ad(page_id.space() != 0 || !zip_size);
 
-	free_block = buf_LRU_get_free_block();
+	free_block = buf_LRU_get_free_block(buf_pool.page_node(page_id));
 
 	mutex_enter(&buf_pool.mutex);
 
@@ -5370,10 +5450,10 @@ void buf_pool_t::validate()
 	ut_ad(UT_LIST_GET_LEN(buf_pool.LRU) == n_lru);
 
 	if (buf_pool.curr_size == buf_pool.old_size
-	    && UT_LIST_GET_LEN(buf_pool.free) != n_free) {
+	    && buf_pool.free_len() != n_free) {
 
 		ib::fatal() << "Free list len "
-			<< UT_LIST_GET_LEN(buf_pool.free)
+			<< buf_pool.free_len()
 			<< ", free blocks " << n_free << ". Aborting...";
 	}
 
@@ -5415,7 +5495,7 @@ void buf_pool_t::print()
 	ib::info()
 		<< "[buffer pool: size=" << curr_size
 		<< ", database pages=" << UT_LIST_GET_LEN(LRU)
-		<< ", free pages=" << UT_LIST_GET_LEN(free)
+		<< ", free pages=" << free_len()
 		<< ", modified database pages="
 		<< UT_LIST_GET_LEN(flush_list)
 		<< ", n pending decompressions=" << n_pend_unzip
@@ -5596,7 +5676,7 @@ void buf_stats_get_pool_info(buf_pool_info_t *pool_info)
 
 	pool_info->old_lru_len = buf_pool.LRU_old_len;
 
-	pool_info->free_list_len = UT_LIST_GET_LEN(buf_pool.free);
+	pool_info->free_list_len = buf_pool.free_len();
 
 	pool_info->flush_list_len = UT_LIST_GET_LEN(buf_pool.flush_list);
 
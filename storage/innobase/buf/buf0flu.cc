@@ -55,6 +55,10 @@ Created 11/11/1995 Heikki Tuuri
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+
+#ifdef HAVE_LIBNUMA
+# include <numa.h>
+#endif /* HAVE_LIBNUMA */
 static const int buf_flush_page_cleaner_priority = -20;
 #endif /* UNIV_LINUX */
 #ifdef HAVE_LZO
@@ -99,9 +103,10 @@ mysql_pfs_key_t page_cleaner_thread_key;
 os_event_t	buf_flush_event;
 
 static void pc_flush_slot_func(void *);
-static tpool::task_group page_cleaner_task_group(1);
-static tpool::waitable_task pc_flush_slot_task(
-	pc_flush_slot_func, 0, &page_cleaner_task_group);
+/** Task that processes page cleaner slots; it is submitted
+innodb_page_cleaners-1 times for each request, and the coordinator
+processes slots as well. */
+static tpool::waitable_task pc_flush_slot_task(pc_flush_slot_func, 0);
 
 /** State for page cleaner array slot */
 enum page_cleaner_state_t {
@@ -123,10 +128,24 @@ struct page_cleaner_slot_t {
 					set to PAGE_CLEANER_STATE_FLUSHING,
 					n_flushed_lru and n_flushed_list can be
 					updated only by the worker thread */
-	/* This value is set during state==PAGE_CLEANER_STATE_NONE */
+	/* These values are set during state==PAGE_CLEANER_STATE_NONE */
 	ulint			n_pages_requested;
 					/*!< number of requested pages
 					for the slot */
+	ulint			n_lru_requested;
+					/*!< number of blocks to make
+					available from the LRU segment */
+	ulint			lru_scan;
+					/*!< length of the LRU segment,
+					ULINT_UNDEFINED for the last slot */
+	ulint			list_scan;
+					/*!< length of the flush_list
+					segment, ULINT_UNDEFINED for the
+					last slot */
+	ulint			node;	/*!< buf_pool.free list that the
+					LRU segment of the slot refills,
+					or ULINT_UNDEFINED if the slot is
+					not bound to a NUMA node */
 	/* These values are updated during state==PAGE_CLEANER_STATE_FLUSHING,
 	and commited with state==PAGE_CLEANER_STATE_FINISHED.
 	The consistency is protected by the 'state' */
@@ -136,9 +155,6 @@ struct page_cleaner_slot_t {
 	ulint			n_flushed_list;
 					/*!< number of flushed pages
 					by flush_list flushing */
-	bool			succeeded_list;
-					/*!< true if flush_list flushing
-					succeeded. */
 	ulint			flush_lru_time;
 					/*!< elapsed time for LRU flushing */
 	ulint			flush_list_time;
@@ -149,6 +165,10 @@ struct page_cleaner_slot_t {
 	ulint			flush_list_pass;
 					/*!< count to attempt flush_list
 					flushing */
+	ulint			n_flushed_pass;
+					/*!< number of pages flushed since
+					page_cleaner_flush_pages_recommendation()
+					last aggregated the statistics */
 };
 
 /** Page cleaner structure */
@@ -163,6 +183,15 @@ struct page_cleaner_t {
 						to flush */
 	lsn_t			lsn_limit;	/*!< upper limit of LSN to be
 						flushed */
+	ulint			n_pages_requested;
+						/*!< number of pages requested
+						to flush from the flush_list,
+						for all slots together */
+	bool			flush_lru;	/*!< true if the LRU batch
+						of the request was started */
+	bool			flush_list;	/*!< true if the flush_list
+						batch of the request was
+						started */
 #if 1 /* FIXME: use bool for these, or remove some of these */
 	ulint			n_slots_requested;
 						/*!< number of slots
@@ -181,7 +210,32 @@ struct page_cleaner_t {
 						requests for all slots */
 	ulint			flush_pass;	/*!< count to finish to flush
 						requests for all slots */
-	page_cleaner_slot_t	slot;
+	ulint			flush_lru_time;
+						/*!< elapsed time for LRU
+						flushing of the requests;
+						the slots flush concurrently,
+						so this is the time of the
+						slowest slot of each request */
+	ulint			flush_list_time;
+						/*!< elapsed time for
+						flush_list flushing of the
+						requests, counted in the
+						same way */
+	ulint			request_lru_time;
+						/*!< longest LRU flushing time
+						of a slot of the current
+						request */
+	ulint			request_list_time;
+						/*!< longest flush_list
+						flushing time of a slot of
+						the current request */
+	ulint			n_slots;	/*!< number of slots used by
+						the current request */
+	page_cleaner_slot_t	slots[MAX_PAGE_CLEANERS];
+						/*!< one slot for each worker;
+						each slot flushes a disjoint
+						segment of the end of the LRU
+						list and of the flush_list */
 	bool			is_running;	/*!< false if attempt
 						to shutdown */
 };
@@ -209,6 +263,16 @@ static inline void incr_flush_list_size_in_bytes(const buf_block_t* block)
 	ut_ad(buf_pool.stat.flush_list_bytes <= buf_pool.curr_pool_size);
 }
 
+/** Adjust the flush_list hazard pointers of all page cleaner slots
+before a block is removed from the flush_list.
+@param[in]	bpage	block that is being removed */
+static inline void buf_flush_adjust_hp(const buf_page_t* bpage)
+{
+	for (ulint i = 0; i < MAX_PAGE_CLEANERS; i++) {
+		buf_pool.flush_hp[i].adjust(bpage);
+	}
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /** Validate the flush list. */
 static void buf_flush_validate_low();
@@ -498,9 +562,9 @@ void buf_flush_remove(buf_page_t* bpage)
 
 	mutex_enter(&buf_pool.flush_list_mutex);
 
-	/* Important that we adjust the hazard pointer before removing
+	/* Important that we adjust the hazard pointers before removing
 	the bpage from flush list. */
-	buf_pool.flush_hp.adjust(bpage);
+	buf_flush_adjust_hp(bpage);
 
 	switch (buf_page_get_state(bpage)) {
 	case BUF_BLOCK_POOL_WATCH:
@@ -586,9 +650,9 @@ buf_flush_relocate_on_flush_list(
 		prev_b = buf_flush_insert_in_flush_rbt(dpage);
 	}
 
-	/* Important that we adjust the hazard pointer before removing
+	/* Important that we adjust the hazard pointers before removing
 	the bpage from the flush list. */
-	buf_pool.flush_hp.adjust(bpage);
+	buf_flush_adjust_hp(bpage);
 
 	/* Must be done after we have removed it from the flush_rbt
 	because we assert on in_flush_list in comparison function. */
@@ -1624,7 +1688,7 @@ static ulint buf_free_from_unzip_LRU_list_batch(ulint max)
 {
 	ulint		scanned = 0;
 	ulint		count = 0;
-	ulint		free_len = UT_LIST_GET_LEN(buf_pool.free);
+	ulint		free_len = buf_pool.free_len();
 	ulint		lru_len = UT_LIST_GET_LEN(buf_pool.unzip_LRU);
 
 	ut_ad(mutex_own(&buf_pool.mutex));
@@ -1648,7 +1712,7 @@ static ulint buf_free_from_unzip_LRU_list_batch(ulint max)
 			block = UT_LIST_GET_PREV(unzip_LRU, block);
 		}
 
-		free_len = UT_LIST_GET_LEN(buf_pool.free);
+		free_len = buf_pool.free_len();
 		lru_len = UT_LIST_GET_LEN(buf_pool.unzip_LRU);
 	}
 
@@ -1670,14 +1734,31 @@ The calling thread is not allowed to own any latches on pages!
 
 @param[in]	max	desired number of blocks to make available
 			in the free list (best effort; not guaranteed)
-@param[out]	n	counts of flushed and evicted pages */
-static void buf_flush_LRU_list_batch(ulint max, flush_counters_t* n)
+@param[out]	n	counts of flushed and evicted pages
+@param[in]	slot	page cleaner slot; slot 0 scans from the end of
+			the LRU list, the others from buf_pool.lru_hp[slot]
+@param[in]	max_scan	maximum number of blocks to scan,
+			or ULINT_UNDEFINED
+@param[in]	node	buf_pool.free list to refill, or ULINT_UNDEFINED;
+			the blocks of the other free lists are skipped */
+static void buf_flush_LRU_list_batch(ulint max, flush_counters_t* n,
+				     ulint slot, ulint max_scan, ulint node)
 {
 	buf_page_t*	bpage;
 	ulint		scanned = 0;
-	ulint		free_len = UT_LIST_GET_LEN(buf_pool.free);
 	ulint		lru_len = UT_LIST_GET_LEN(buf_pool.LRU);
 	ulint		withdraw_depth = 0;
+	ulint		free_target = srv_LRU_scan_depth;
+
+	ut_ad(node == ULINT_UNDEFINED || node < buf_pool.n_numa_nodes);
+
+	auto get_free_len = [node]() {
+		return node == ULINT_UNDEFINED
+			? buf_pool.free_len()
+			: ulint(UT_LIST_GET_LEN(buf_pool.free[node]));
+	};
+
+	ulint		free_len = get_free_len();
 
 	n->flushed = 0;
 	n->evicted = 0;
@@ -1689,21 +1770,40 @@ static void buf_flush_LRU_list_batch(ulint max, flush_counters_t* n)
 			- UT_LIST_GET_LEN(buf_pool.withdraw);
 	}
 
-	for (bpage = UT_LIST_GET_LAST(buf_pool.LRU);
+	free_target += withdraw_depth;
+
+	if (node != ULINT_UNDEFINED) {
+		/* The slots of each node refill their own free list. */
+		free_target /= buf_pool.n_numa_nodes;
+	}
+
+	LRUHp&	hp = buf_pool.lru_hp[slot];
+
+	for (bpage = slot ? hp.get() : UT_LIST_GET_LAST(buf_pool.LRU);
 	     bpage != NULL && n->flushed + n->evicted < max
-	     && free_len < srv_LRU_scan_depth + withdraw_depth
+	     && scanned < max_scan
+	     && free_len < free_target
 	     && lru_len > BUF_LRU_MIN_LEN;
 	     ++scanned,
-	     bpage = buf_pool.lru_hp.get()) {
+	     bpage = hp.get()) {
 
 		buf_page_t* prev = UT_LIST_GET_PREV(LRU, bpage);
-		buf_pool.lru_hp.set(prev);
+		hp.set(prev);
 
 		BPageMutex*	block_mutex = buf_page_get_mutex(bpage);
 
 		mutex_enter(block_mutex);
 
-		if (buf_flush_ready_for_replace(bpage)) {
+		if (node != ULINT_UNDEFINED
+		    && buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE
+		    && reinterpret_cast<buf_block_t*>(bpage)->numa_node
+		    != node) {
+			/* The block would be freed to the free list of
+			another NUMA node. Leave it to the slots of that
+			node. Compressed-only pages have no frame and may
+			be evicted by any slot. */
+			mutex_exit(block_mutex);
+		} else if (buf_flush_ready_for_replace(bpage)) {
 			/* block is ready for eviction i.e., it is
 			clean and is not IO-fixed or buffer fixed. */
 			mutex_exit(block_mutex);
@@ -1720,18 +1820,18 @@ static void buf_flush_LRU_list_batch(ulint max, flush_counters_t* n)
 		} else {
 			/* Can't evict or dispatch this block. Go to
 			previous. */
-			ut_ad(buf_pool.lru_hp.is_hp(prev));
+			ut_ad(hp.is_hp(prev));
 			mutex_exit(block_mutex);
 		}
 
 		ut_ad(!mutex_own(block_mutex));
 		ut_ad(mutex_own(&buf_pool.mutex));
 
-		free_len = UT_LIST_GET_LEN(buf_pool.free);
+		free_len = get_free_len();
 		lru_len = UT_LIST_GET_LEN(buf_pool.LRU);
 	}
 
-	buf_pool.lru_hp.set(NULL);
+	hp.set(NULL);
 
 	/* We keep track of all flushes happening as part of LRU
 	flush. When estimating the desired rate at which flush_list
@@ -1761,14 +1861,21 @@ static void buf_flush_LRU_list_batch(ulint max, flush_counters_t* n)
 Whether LRU or unzip_LRU is used depends on the state of the system.
 @param[in]	max	desired number of blocks to make available
 			in the free list (best effort; not guaranteed)
-@param[out]	n	counts of flushed and evicted pages */
-static void buf_do_LRU_batch(ulint max, flush_counters_t* n)
+@param[out]	n	counts of flushed and evicted pages
+@param[in]	slot	page cleaner slot, see buf_flush_LRU_list_batch();
+			only slot 0 evicts from the unzip_LRU list
+@param[in]	max_scan	maximum number of blocks to scan,
+			or ULINT_UNDEFINED
+@param[in]	node	buf_pool.free list to refill, or ULINT_UNDEFINED */
+static void buf_do_LRU_batch(ulint max, flush_counters_t* n,
+			     ulint slot, ulint max_scan, ulint node)
 {
-	n->unzip_LRU_evicted = buf_LRU_evict_from_unzip_LRU()
+	n->unzip_LRU_evicted = !slot && buf_LRU_evict_from_unzip_LRU()
 		? buf_free_from_unzip_LRU_list_batch(max) : 0;
 
 	if (max > n->unzip_LRU_evicted) {
-		buf_flush_LRU_list_batch(max - n->unzip_LRU_evicted, n);
+		buf_flush_LRU_list_batch(max - n->unzip_LRU_evicted, n,
+					 slot, max_scan, node);
 	} else {
 		n->evicted = 0;
 		n->flushed = 0;
@@ -1785,10 +1892,15 @@ The calling thread is not allowed to own any latches on pages!
 not guaranteed that the actual number is that big, though)
 @param[in]	lsn_limit	all blocks whose oldest_modification is smaller
 than this should be flushed (if their number does not exceed min_n)
+@param[in]	slot		page cleaner slot; slot 0 scans from the end
+of the flush_list, the others from buf_pool.flush_hp[slot]
+@param[in]	max_scan	maximum number of blocks to scan,
+or ULINT_UNDEFINED
 @return number of blocks for which the write request was queued;
 ULINT_UNDEFINED if there was a flush of the same type already
 running */
-static ulint buf_do_flush_list_batch(ulint min_n, lsn_t lsn_limit)
+static ulint buf_do_flush_list_batch(ulint min_n, lsn_t lsn_limit,
+				     ulint slot, ulint max_scan)
 {
 	ulint		count = 0;
 	ulint		scanned = 0;
@@ -1799,16 +1911,19 @@ static ulint buf_do_flush_list_batch(ulint min_n, lsn_t lsn_limit)
 	block to be flushed. */
 	mutex_enter(&buf_pool.flush_list_mutex);
 	ulint len = UT_LIST_GET_LEN(buf_pool.flush_list);
+	FlushHp& hp = buf_pool.flush_hp[slot];
 
 	/* In order not to degenerate this scan to O(n*n) we attempt
 	to preserve pointer of previous block in the flush list. To do
 	so we declare it a hazard pointer. Any thread working on the
 	flush list must check the hazard pointer and if it is removing
 	the same block then it must reset it. */
-	for (buf_page_t* bpage = UT_LIST_GET_LAST(buf_pool.flush_list);
+	for (buf_page_t* bpage = slot
+		     ? hp.get() : UT_LIST_GET_LAST(buf_pool.flush_list);
 	     count < min_n && bpage != NULL && len > 0
+	     && scanned < max_scan
 	     && bpage->oldest_modification < lsn_limit;
-	     bpage = buf_pool.flush_hp.get(),
+	     bpage = hp.get(),
 	     ++scanned) {
 
 		buf_page_t*	prev;
@@ -1817,7 +1932,7 @@ static ulint buf_do_flush_list_batch(ulint min_n, lsn_t lsn_limit)
 		ut_ad(bpage->in_flush_list);
 
 		prev = UT_LIST_GET_PREV(list, bpage);
-		buf_pool.flush_hp.set(prev);
+		hp.set(prev);
 		mutex_exit(&buf_pool.flush_list_mutex);
 
 #ifdef UNIV_DEBUG
@@ -1828,12 +1943,12 @@ static ulint buf_do_flush_list_batch(ulint min_n, lsn_t lsn_limit)
 
 		mutex_enter(&buf_pool.flush_list_mutex);
 
-		ut_ad(flushed || buf_pool.flush_hp.is_hp(prev));
+		ut_ad(flushed || hp.is_hp(prev));
 
 		--len;
 	}
 
-	buf_pool.flush_hp.set(NULL);
+	hp.set(NULL);
 	mutex_exit(&buf_pool.flush_list_mutex);
 
 	if (scanned) {
@@ -1868,16 +1983,25 @@ BUF_FLUSH_LIST, then the caller must not own any latches on pages
 @param[in]	min_n		wished minimum mumber of blocks flushed (it is
 not guaranteed that the actual number is that big, though)
 @param[in]	lsn_limit	in the case of BUF_FLUSH_LIST all blocks whose
-@param[out]	n		counts of flushed and evicted pages
 oldest_modification is smaller than this should be flushed (if their number
-does not exceed min_n), otherwise ignored */
+does not exceed min_n), otherwise ignored
+@param[out]	n		counts of flushed and evicted pages
+@param[in]	slot		page cleaner slot whose segment of the list
+is flushed, or 0 to start from the end of the list
+@param[in]	max_scan	maximum number of blocks to scan,
+or ULINT_UNDEFINED
+@param[in]	node		in the case of BUF_FLUSH_LRU, the
+buf_pool.free list to refill, or ULINT_UNDEFINED for all of them */
 static
 void
 buf_flush_batch(
 	buf_flush_t		flush_type,
 	ulint			min_n,
 	lsn_t			lsn_limit,
-	flush_counters_t*	n)
+	flush_counters_t*	n,
+	ulint			slot = 0,
+	ulint			max_scan = ULINT_UNDEFINED,
+	ulint			node = ULINT_UNDEFINED)
 {
 	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 	ut_ad(flush_type == BUF_FLUSH_LRU
@@ -1889,10 +2013,11 @@ buf_flush_batch(
 	the flush functions. */
 	switch (flush_type) {
 	case BUF_FLUSH_LRU:
-		buf_do_LRU_batch(min_n, n);
+		buf_do_LRU_batch(min_n, n, slot, max_scan, node);
 		break;
 	case BUF_FLUSH_LIST:
-		n->flushed = buf_do_flush_list_batch(min_n, lsn_limit);
+		n->flushed = buf_do_flush_list_batch(min_n, lsn_limit,
+						     slot, max_scan);
 		n->evicted = 0;
 		break;
 	default:
@@ -2171,23 +2296,19 @@ bool buf_flush_single_page_from_LRU()
 	return(freed);
 }
 
-/**
-Clear up the tail of the LRU list.
-Put replaceable pages at the tail of LRU to the free list.
-Flush dirty pages at the tail of LRU to the disk.
-The depth to which we scan each buffer pool is controlled by dynamic
-config parameter innodb_LRU_scan_depth.
-@return total pages flushed */
-static ulint buf_flush_LRU_list()
+/** Determine how deep the page cleaner scans the end of the LRU list.
+The depth is controlled by the dynamic configuration parameter
+innodb_LRU_scan_depth, or by the number of blocks still to be withdrawn
+when the buffer pool is being shrunk.
+@return number of blocks to scan */
+static ulint buf_flush_LRU_scan_depth()
 {
 	ulint	scan_depth, withdraw_depth;
-	flush_counters_t	n;
 
-	memset(&n, 0, sizeof(flush_counters_t));
+	ut_ad(mutex_own(&buf_pool.mutex));
 
 	/* srv_LRU_scan_depth can be arbitrarily large value.
 	We cap it with current LRU size. */
-	mutex_enter(&buf_pool.mutex);
 	scan_depth = UT_LIST_GET_LEN(buf_pool.LRU);
 	if (buf_pool.curr_size < buf_pool.old_size
 	    && buf_pool.withdraw_target > 0) {
@@ -2196,20 +2317,14 @@ static ulint buf_flush_LRU_list()
 	} else {
 		withdraw_depth = 0;
 	}
-	mutex_exit(&buf_pool.mutex);
 	if (withdraw_depth > srv_LRU_scan_depth) {
 		scan_depth = ut_min(withdraw_depth, scan_depth);
 	} else {
 		scan_depth = ut_min(static_cast<ulint>(srv_LRU_scan_depth),
 				    scan_depth);
 	}
-	/* Currently one of page_cleaners is the only thread
-	that can trigger an LRU flush at the same time.
-	So, it is not possible that a batch triggered during
-	last iteration is still running, */
-	buf_flush_do_batch(BUF_FLUSH_LRU, scan_depth, 0, &n);
 
-	return(n.flushed);
+	return(scan_depth);
 }
 
 /** Wait for any possible LRU flushes to complete. */
@@ -2243,7 +2358,7 @@ af_get_pct_for_dirty()
 	looking at it) */
 	double	dirty_pct = 100 * static_cast<double>(dirty)
 		/ static_cast<double>(1 + UT_LIST_GET_LEN(buf_pool.LRU)
-				      + UT_LIST_GET_LEN(buf_pool.free));
+				      + buf_pool.free_len());
 
 	ut_a(srv_max_dirty_pages_pct_lwm
 	     <= srv_max_buf_pool_modified_pct);
@@ -2311,7 +2426,8 @@ af_get_pct_for_lsn(
 /*********************************************************************//**
 This function is called approximately once every second by the
 page_cleaner thread. Based on various factors it decides if there is a
-need to do flushing.
+need to do flushing. The I/O capacity is scaled by the number of page
+cleaner slots that flushed pages during the last averaging interval.
 @return number of pages recommended to be flushed
 @param last_pages_in	the number of pages flushed by the last flush_list
 			flushing. */
@@ -2324,6 +2440,7 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 	static	ulint		avg_page_rate = 0;
 	static	ulint		n_iterations = 0;
 	static	time_t		prev_time;
+	static	ulint		n_active = 1;
 	lsn_t			oldest_lsn;
 	lsn_t			cur_lsn;
 	lsn_t			age;
@@ -2381,16 +2498,46 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 		page_cleaner.flush_time = 0;
 		page_cleaner.flush_pass = 0;
 
-		ulint	lru_tm = page_cleaner.slot.flush_lru_time;
-		ulint	list_tm = page_cleaner.slot.flush_list_time;
-		ulint	lru_pass = page_cleaner.slot.flush_lru_pass;
-		ulint	list_pass = page_cleaner.slot.flush_list_pass;
-		page_cleaner.slot.flush_lru_time  = 0;
-		page_cleaner.slot.flush_lru_pass  = 0;
-		page_cleaner.slot.flush_list_time = 0;
-		page_cleaner.slot.flush_list_pass = 0;
+		/* The time of the slots is summed for the average time
+		of a slot. The time of a request, during which the slots
+		flush concurrently, is the time of its slowest slot. */
+		ulint	lru_wall_tm = page_cleaner.flush_lru_time;
+		ulint	list_wall_tm = page_cleaner.flush_list_time;
+		ulint	lru_tm = 0;
+		ulint	list_tm = 0;
+		ulint	lru_pass = 0;
+		ulint	list_pass = 0;
+
+		page_cleaner.flush_lru_time = 0;
+		page_cleaner.flush_list_time = 0;
+
+		/* The slots that flushed any pages are active. The
+		configured slots that found no work in their segments
+		do not add to the flushing capacity. */
+		n_active = 0;
+
+		for (ulint i = 0; i < MAX_PAGE_CLEANERS; i++) {
+			page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+
+			lru_tm += slot.flush_lru_time;
+			list_tm += slot.flush_list_time;
+			lru_pass += slot.flush_lru_pass;
+			list_pass += slot.flush_list_pass;
+			if (slot.n_flushed_pass && i < srv_n_page_cleaners) {
+				n_active++;
+			}
+			slot.flush_lru_time  = 0;
+			slot.flush_lru_pass  = 0;
+			slot.flush_list_time = 0;
+			slot.flush_list_pass = 0;
+			slot.n_flushed_pass = 0;
+		}
 		mutex_exit(&page_cleaner.mutex);
 
+		if (n_active < 1) {
+			n_active = 1;
+		}
+
 		/* minimum values are 1, to avoid dividing by zero. */
 		if (lru_tm < 1) {
 			lru_tm = 1;
@@ -2398,6 +2545,12 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 		if (list_tm < 1) {
 			list_tm = 1;
 		}
+		if (lru_wall_tm < 1) {
+			lru_wall_tm = 1;
+		}
+		if (list_wall_tm < 1) {
+			list_wall_tm = 1;
+		}
 		if (flush_tm < 1) {
 			flush_tm = 1;
 		}
@@ -2418,15 +2571,15 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 			    lru_tm  / lru_pass);
 
 		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD,
-			    list_tm / flush_pass);
+			    list_wall_tm / flush_pass);
 		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
-			    lru_tm / flush_pass);
+			    lru_wall_tm / flush_pass);
 		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_EST,
-			    flush_tm * list_tm / flush_pass
-			    / (list_tm + lru_tm));
+			    flush_tm * list_wall_tm / flush_pass
+			    / (list_wall_tm + lru_wall_tm));
 		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_EST,
-			    flush_tm * lru_tm / flush_pass
-			    / (list_tm + lru_tm));
+			    flush_tm * lru_wall_tm / flush_pass
+			    / (list_wall_tm + lru_wall_tm));
 		MONITOR_SET(MONITOR_FLUSH_AVG_TIME, flush_tm / flush_pass);
 
 		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_PASS, list_pass);
@@ -2469,8 +2622,8 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 	mutex_exit(&buf_pool.flush_list_mutex);
 
 	mutex_enter(&page_cleaner.mutex);
-	ut_ad(page_cleaner.slot.state == PAGE_CLEANER_STATE_NONE);
-	page_cleaner.slot.n_pages_requested
+	ut_ad(page_cleaner.n_slots_requested == 0);
+	page_cleaner.n_pages_requested
 		= pages_for_lsn / buf_flush_lsn_scan_factor + 1;
 	mutex_exit(&page_cleaner.mutex);
 
@@ -2479,16 +2632,25 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 		pages_for_lsn = 1;
 	}
 
+	/* innodb_io_capacity and innodb_io_capacity_max are the budget
+	of one page cleaner slot. pc_request() divides the pages between
+	the slots, which flush concurrently, so the aggregate capacity is
+	that of the slots that were active during the last interval.
+	avg_page_rate already is the aggregate rate of all slots. */
+	const ulint	io_capacity = srv_io_capacity * n_active;
+	const ulint	max_io_capacity = srv_max_io_capacity
+		* n_active;
+
 	/* Cap the maximum IO capacity that we are going to use by
-	max_io_capacity. Limit the value to avoid too quick increase */
+	max_io_capacity. Limit the value to avoid too quick increase. */
 	pages_for_lsn = std::min<ulint>(
-		pages_for_lsn, srv_max_io_capacity * 2);
+		pages_for_lsn, max_io_capacity * 2);
 
-	n_pages = (ulint(double(srv_io_capacity) * double(pct_total) / 100.0)
+	n_pages = (ulint(double(io_capacity) * double(pct_total) / 100.0)
 		   + avg_page_rate + pages_for_lsn) / 3;
 
-	if (n_pages > srv_max_io_capacity) {
-		n_pages = srv_max_io_capacity;
+	if (n_pages > max_io_capacity) {
+		n_pages = max_io_capacity;
 	}
 
 	mutex_enter(&page_cleaner.mutex);
@@ -2499,10 +2661,10 @@ page_cleaner_flush_pages_recommendation(ulint last_pages_in)
 	/* if REDO has enough of free space,
 	don't care about age distribution of pages */
 	if (pct_for_lsn > 30) {
-		page_cleaner.slot.n_pages_requested *= n_pages
+		page_cleaner.n_pages_requested *= n_pages
 			/ pages_for_lsn + 1;
 	} else {
-		page_cleaner.slot.n_pages_requested = n_pages;
+		page_cleaner.n_pages_requested = n_pages;
 	}
 	mutex_exit(&page_cleaner.mutex);
 
@@ -2555,6 +2717,149 @@ pc_sleep_if_needed(
 	return(OS_SYNC_TIME_EXCEEDED);
 }
 
+/** Divide the end of the LRU list between the page cleaner slots
+that are bound to NUMA nodes. Slot i refills the free list of node
+i % n_numa_nodes. The slots of a node divide the whole end of the list
+between them, like pc_divide_LRU() does, and skip the blocks of the
+other nodes.
+@param[in]	n_slots	number of slots, at least buf_pool.n_numa_nodes */
+static void pc_divide_LRU_by_node(ulint n_slots)
+{
+	ut_ad(mutex_own(&buf_pool.mutex));
+
+	const ulint	n_nodes = buf_pool.n_numa_nodes;
+	const ulint	scan_depth = buf_flush_LRU_scan_depth();
+
+	ut_ad(n_slots >= n_nodes);
+
+	for (ulint i = 0; i < n_slots; i++) {
+		page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+		const ulint	node = i % n_nodes;
+		/* the position of the slot among those of the node */
+		const ulint	pos = i / n_nodes;
+		const ulint	n_node_slots = (n_slots - node - 1)
+			/ n_nodes + 1;
+		const ulint	seg = scan_depth / n_node_slots;
+		const ulint	n_free = scan_depth / n_nodes;
+		buf_page_t*	bpage = UT_LIST_GET_LAST(buf_pool.LRU);
+
+		for (ulint j = pos * seg; j-- && bpage; ) {
+			bpage = UT_LIST_GET_PREV(LRU, bpage);
+		}
+
+		if (i) {
+			buf_pool.lru_hp[i].set(bpage);
+		}
+
+		slot.node = node;
+
+		if (pos + 1 < n_node_slots) {
+			slot.n_lru_requested = n_free / n_node_slots;
+			slot.lru_scan = seg;
+		} else {
+			slot.n_lru_requested = n_free
+				- n_free / n_node_slots * pos;
+			slot.lru_scan = ULINT_UNDEFINED;
+		}
+	}
+}
+
+/** Divide the end of the LRU list between the page cleaner slots.
+Each slot but the last one scans a segment of the same length, starting
+at buf_pool.lru_hp[slot]; the last slot may scan further towards the
+start of the list. With innodb_numa_node_local, if there is a slot for
+every NUMA node, see pc_divide_LRU_by_node().
+@param[in]	n_slots	number of slots */
+static void pc_divide_LRU(ulint n_slots)
+{
+	mutex_enter(&buf_pool.mutex);
+
+	if (buf_pool.n_numa_nodes > 1 && n_slots >= buf_pool.n_numa_nodes) {
+		pc_divide_LRU_by_node(n_slots);
+		mutex_exit(&buf_pool.mutex);
+		return;
+	}
+
+	const ulint	scan_depth = buf_flush_LRU_scan_depth();
+	const ulint	seg = scan_depth / n_slots;
+	buf_page_t*	bpage = UT_LIST_GET_LAST(buf_pool.LRU);
+
+	for (ulint i = 0; i < n_slots; i++) {
+		page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+
+		slot.node = ULINT_UNDEFINED;
+
+		if (i) {
+			for (ulint j = seg; j-- && bpage; ) {
+				bpage = UT_LIST_GET_PREV(LRU, bpage);
+			}
+			buf_pool.lru_hp[i].set(bpage);
+		}
+
+		if (i + 1 < n_slots) {
+			slot.n_lru_requested = seg;
+			slot.lru_scan = seg;
+		} else {
+			slot.n_lru_requested = scan_depth - seg * i;
+			slot.lru_scan = ULINT_UNDEFINED;
+		}
+	}
+
+	mutex_exit(&buf_pool.mutex);
+}
+
+/** Divide the end of the flush_list between the page cleaner slots,
+like pc_divide_LRU().
+@param[in]	n_slots		number of slots
+@param[in]	min_n		wished minimum number of blocks flushed
+@param[in]	lsn_limit	all blocks whose oldest_modification is
+smaller than this should be flushed (if their number does not exceed
+min_n) */
+static void pc_divide_flush_list(ulint n_slots, ulint min_n, lsn_t lsn_limit)
+{
+	mutex_enter(&buf_pool.flush_list_mutex);
+
+	ulint	len = min_n;
+	buf_page_t*	bpage = UT_LIST_GET_LAST(buf_pool.flush_list);
+
+	if (min_n != ULINT_MAX) {
+	} else if (lsn_limit == LSN_MAX) {
+		len = UT_LIST_GET_LEN(buf_pool.flush_list);
+	} else {
+		/* Only divide the blocks that are to be flushed. */
+		len = 0;
+		for (const buf_page_t* b = bpage;
+		     b != NULL && b->oldest_modification < lsn_limit;
+		     b = UT_LIST_GET_PREV(list, b)) {
+			len++;
+		}
+	}
+
+	const ulint	seg = len / n_slots;
+
+	for (ulint i = 0; i < n_slots; i++) {
+		page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+
+		if (i) {
+			for (ulint j = seg; j-- && bpage; ) {
+				bpage = UT_LIST_GET_PREV(list, bpage);
+			}
+			buf_pool.flush_hp[i].set(bpage);
+		}
+
+		if (i + 1 < n_slots) {
+			slot.n_pages_requested = seg;
+			slot.list_scan = seg;
+		} else {
+			slot.n_pages_requested = min_n == ULINT_MAX
+				? ULINT_MAX : min_n - seg * i;
+			slot.list_scan = ULINT_UNDEFINED;
+		}
+	}
+
+	mutex_exit(&buf_pool.flush_list_mutex);
+}
+
 /**
 Requests for all slots to flush.
 @param min_n	wished minimum mumber of blocks flushed
@@ -2565,6 +2870,8 @@ Requests for all slots to flush.
 */
 static void pc_request(ulint min_n, lsn_t lsn_limit)
 {
+	const ulint	n_slots = srv_n_page_cleaners;
+
 	mutex_enter(&page_cleaner.mutex);
 
 	ut_ad(page_cleaner.n_slots_requested == 0);
@@ -2573,23 +2880,52 @@ static void pc_request(ulint min_n, lsn_t lsn_limit)
 
 	page_cleaner.requested = (min_n > 0);
 	page_cleaner.lsn_limit = lsn_limit;
-
-	ut_ad(page_cleaner.slot.state == PAGE_CLEANER_STATE_NONE);
+	page_cleaner.n_slots = n_slots;
 
 	if (min_n == 0 || min_n == ULINT_MAX) {
-		page_cleaner.slot.n_pages_requested = min_n;
+		page_cleaner.n_pages_requested = min_n;
 	}
 
-	/* page_cleaner.slot.n_pages_requested was already set by
+	/* Otherwise page_cleaner.n_pages_requested was already set by
 	page_cleaner_flush_pages_recommendation() */
+	min_n = page_cleaner.n_pages_requested;
+
+	mutex_exit(&page_cleaner.mutex);
 
-	page_cleaner.slot.state = PAGE_CLEANER_STATE_REQUESTED;
+	/* The batches are started and ended on behalf of all slots,
+	so that no other thread can start a batch of the same type
+	while the slots are flushing. */
+	page_cleaner.flush_lru = page_cleaner.is_running
+		&& buf_flush_start(BUF_FLUSH_LRU);
+	page_cleaner.flush_list = page_cleaner.is_running
+		&& page_cleaner.requested
+		&& buf_flush_start(BUF_FLUSH_LIST);
 
-	page_cleaner.n_slots_requested = 1;
+	if (page_cleaner.flush_lru) {
+		pc_divide_LRU(n_slots);
+	}
+
+	if (page_cleaner.flush_list) {
+		pc_divide_flush_list(n_slots, min_n, lsn_limit);
+	}
+
+	mutex_enter(&page_cleaner.mutex);
+
+	for (ulint i = 0; i < n_slots; i++) {
+		ut_ad(page_cleaner.slots[i].state == PAGE_CLEANER_STATE_NONE);
+		page_cleaner.slots[i].state = PAGE_CLEANER_STATE_REQUESTED;
+	}
+
+	page_cleaner.n_slots_requested = n_slots;
 	page_cleaner.n_slots_flushing = 0;
 	page_cleaner.n_slots_finished = 0;
 
 	mutex_exit(&page_cleaner.mutex);
+
+	/* The coordinator processes slots as well. */
+	for (ulint i = 1; i < n_slots; i++) {
+		srv_thread_pool->submit_task(&pc_flush_slot_task);
+	}
 }
 
 /**
@@ -2605,63 +2941,84 @@ static ulint pc_flush_slot()
 	mutex_enter(&page_cleaner.mutex);
 
 	if (page_cleaner.n_slots_requested) {
-		ut_ad(page_cleaner.slot.state == PAGE_CLEANER_STATE_REQUESTED);
-		page_cleaner.n_slots_requested--;
-		page_cleaner.n_slots_flushing++;
-		page_cleaner.slot.state = PAGE_CLEANER_STATE_FLUSHING;
+		ulint	i = 0;
 
-		if (UNIV_UNLIKELY(!page_cleaner.is_running)) {
-			page_cleaner.slot.n_flushed_lru = 0;
-			page_cleaner.slot.n_flushed_list = 0;
-			goto finish_mutex;
+		while (page_cleaner.slots[i].state
+		       != PAGE_CLEANER_STATE_REQUESTED) {
+			i++;
+			ut_ad(i < page_cleaner.n_slots);
 		}
 
+		page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+
+		page_cleaner.n_slots_requested--;
+		page_cleaner.n_slots_flushing++;
+		slot.state = PAGE_CLEANER_STATE_FLUSHING;
+		slot.n_flushed_lru = 0;
+		slot.n_flushed_list = 0;
+
 		mutex_exit(&page_cleaner.mutex);
 
-		lru_tm = ut_time_ms();
+		/* Flush pages from the LRU segment of the slot */
+		if (page_cleaner.flush_lru) {
+			flush_counters_t n;
+			memset(&n, 0, sizeof(flush_counters_t));
+			lru_tm = ut_time_ms();
+
+#ifdef HAVE_LIBNUMA
+			/* Evict the blocks of the node on its own CPUs. */
+			const bool bind = slot.node != ULINT_UNDEFINED
+				&& !numa_run_on_node(
+					buf_pool.numa_node_id[slot.node]);
+#endif /* HAVE_LIBNUMA */
 
-		/* Flush pages from end of LRU if required */
-		page_cleaner.slot.n_flushed_lru = buf_flush_LRU_list();
+			buf_flush_batch(BUF_FLUSH_LRU, slot.n_lru_requested,
+					0, &n, i, slot.lru_scan, slot.node);
+
+#ifdef HAVE_LIBNUMA
+			if (bind) {
+				numa_run_on_node(-1);
+			}
+#endif /* HAVE_LIBNUMA */
 
-		lru_tm = ut_time_ms() - lru_tm;
-		lru_pass++;
+			slot.n_flushed_lru = n.flushed;
 
-		if (UNIV_UNLIKELY(!page_cleaner.is_running)) {
-			page_cleaner.slot.n_flushed_list = 0;
-			goto finish;
+			lru_tm = ut_time_ms() - lru_tm;
+			lru_pass++;
 		}
 
-		/* Flush pages from flush_list if required */
-		if (page_cleaner.requested) {
+		/* Flush pages from the flush_list segment of the slot */
+		if (page_cleaner.flush_list && page_cleaner.is_running) {
 			flush_counters_t n;
 			memset(&n, 0, sizeof(flush_counters_t));
 			list_tm = ut_time_ms();
 
-			page_cleaner.slot.succeeded_list = buf_flush_do_batch(
-				BUF_FLUSH_LIST,
-				page_cleaner.slot.n_pages_requested,
-				page_cleaner.lsn_limit,
-				&n);
+			buf_flush_batch(BUF_FLUSH_LIST,
+					slot.n_pages_requested,
+					page_cleaner.lsn_limit,
+					&n, i, slot.list_scan);
 
-			page_cleaner.slot.n_flushed_list = n.flushed;
+			slot.n_flushed_list = n.flushed;
 
 			list_tm = ut_time_ms() - list_tm;
 			list_pass++;
-		} else {
-			page_cleaner.slot.n_flushed_list = 0;
-			page_cleaner.slot.succeeded_list = true;
 		}
-finish:
+
 		mutex_enter(&page_cleaner.mutex);
-finish_mutex:
 		page_cleaner.n_slots_flushing--;
 		page_cleaner.n_slots_finished++;
-		page_cleaner.slot.state = PAGE_CLEANER_STATE_FINISHED;
-
-		page_cleaner.slot.flush_lru_time += lru_tm;
-		page_cleaner.slot.flush_list_time += list_tm;
-		page_cleaner.slot.flush_lru_pass += lru_pass;
-		page_cleaner.slot.flush_list_pass += list_pass;
+		slot.state = PAGE_CLEANER_STATE_FINISHED;
+
+		slot.flush_lru_time += lru_tm;
+		slot.flush_list_time += list_tm;
+		slot.flush_lru_pass += lru_pass;
+		slot.flush_list_pass += list_pass;
+		slot.n_flushed_pass += slot.n_flushed_lru
+			+ slot.n_flushed_list;
+		page_cleaner.request_lru_time = std::max(
+			page_cleaner.request_lru_time, lru_tm);
+		page_cleaner.request_list_time = std::max(
+			page_cleaner.request_list_time, list_tm);
 
 		if (page_cleaner.n_slots_requested == 0
 		    && page_cleaner.n_slots_flushing == 0) {
@@ -2699,14 +3056,26 @@ pc_wait_finished(
 
 	ut_ad(page_cleaner.n_slots_requested == 0);
 	ut_ad(page_cleaner.n_slots_flushing == 0);
-	ut_ad(page_cleaner.n_slots_finished == 1);
+	ut_ad(page_cleaner.n_slots_finished == page_cleaner.n_slots);
 
-	ut_ad(page_cleaner.slot.state == PAGE_CLEANER_STATE_FINISHED);
-	page_cleaner.slot.state = PAGE_CLEANER_STATE_NONE;
-	*n_flushed_lru = page_cleaner.slot.n_flushed_lru;
-	*n_flushed_list = page_cleaner.slot.n_flushed_list;
-	all_succeeded = page_cleaner.slot.succeeded_list;
-	page_cleaner.slot.n_pages_requested = 0;
+	for (ulint i = 0; i < page_cleaner.n_slots; i++) {
+		page_cleaner_slot_t&	slot = page_cleaner.slots[i];
+
+		ut_ad(slot.state == PAGE_CLEANER_STATE_FINISHED);
+		slot.state = PAGE_CLEANER_STATE_NONE;
+		*n_flushed_lru += slot.n_flushed_lru;
+		*n_flushed_list += slot.n_flushed_list;
+		slot.n_pages_requested = 0;
+	}
+
+	/* The flush_list batch fails if another thread was running one. */
+	all_succeeded = !page_cleaner.requested || page_cleaner.flush_list;
+	page_cleaner.n_pages_requested = 0;
+
+	page_cleaner.flush_lru_time += page_cleaner.request_lru_time;
+	page_cleaner.flush_list_time += page_cleaner.request_list_time;
+	page_cleaner.request_lru_time = 0;
+	page_cleaner.request_list_time = 0;
 
 	page_cleaner.n_slots_finished = 0;
 
@@ -2714,6 +3083,14 @@ pc_wait_finished(
 
 	mutex_exit(&page_cleaner.mutex);
 
+	if (page_cleaner.flush_lru) {
+		buf_flush_end(BUF_FLUSH_LRU);
+	}
+
+	if (page_cleaner.flush_list) {
+		buf_flush_end(BUF_FLUSH_LIST);
+	}
+
 	return(all_succeeded);
 }
 
@@ -3094,6 +3471,8 @@ static os_thread_ret_t DECLARE_THREAD(buf_flush_page_cleaner)(void*)
 
 thread_exit:
 	page_cleaner.is_running = false;
+	/* Wait for the workers that may still be looking for a slot. */
+	pc_flush_slot_task.wait();
 	mutex_destroy(&page_cleaner.mutex);
 
 	os_event_destroy(page_cleaner.is_finished);
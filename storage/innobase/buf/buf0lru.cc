@@ -804,21 +804,22 @@ bool buf_LRU_scan_and_free_block(bool scan_all)
 bool buf_LRU_buf_pool_running_out()
 {
 	return !recv_recovery_is_on()
-		&& UT_LIST_GET_LEN(buf_pool.free)
+		&& buf_pool.free_len()
 		+ UT_LIST_GET_LEN(buf_pool.LRU)
 		< ut_min(buf_pool.curr_size, buf_pool.old_size) / 4;
 }
 
-/** @return a buffer block from the buf_pool.free list
+/** @return a buffer block from one buf_pool.free list
+@param[in,out]	free	free list
 @retval	NULL	if the free list is empty */
-buf_block_t* buf_LRU_get_free_only()
+static buf_block_t*
+buf_LRU_get_free_only_low(UT_LIST_BASE_NODE_T(buf_page_t)& free)
 {
 	buf_block_t*	block;
 
 	ut_ad(mutex_own(&buf_pool.mutex));
 
-	block = reinterpret_cast<buf_block_t*>(
-		UT_LIST_GET_FIRST(buf_pool.free));
+	block = reinterpret_cast<buf_block_t*>(UT_LIST_GET_FIRST(free));
 
 	while (block != NULL) {
 
@@ -827,7 +828,7 @@ buf_block_t* buf_LRU_get_free_only()
 		ut_ad(!block->page.in_flush_list);
 		ut_ad(!block->page.in_LRU_list);
 		ut_a(!buf_page_in_file(&block->page));
-		UT_LIST_REMOVE(buf_pool.free, &block->page);
+		UT_LIST_REMOVE(free, &block->page);
 
 		if (buf_pool.curr_size >= buf_pool.old_size
 		    || UT_LIST_GET_LEN(buf_pool.withdraw)
@@ -853,12 +854,39 @@ buf_block_t* buf_LRU_get_free_only()
 		ut_d(block->in_withdraw_list = TRUE);
 
 		block = reinterpret_cast<buf_block_t*>(
-			UT_LIST_GET_FIRST(buf_pool.free));
+			UT_LIST_GET_FIRST(free));
 	}
 
 	return(block);
 }
 
+/** @return a buffer block from the buf_pool.free lists
+@param[in]	node	the free list to try first, see buf_pool_t::page_node()
+@retval	NULL	if the free lists are empty */
+buf_block_t* buf_LRU_get_free_only(ulint node)
+{
+	ut_ad(node < buf_pool.n_numa_nodes);
+
+	/* Prefer the requested NUMA node, but fall back to the
+	other nodes rather than evict a page. */
+	for (ulint i = 0; i < buf_pool.n_numa_nodes; i++) {
+		if (buf_block_t* block = buf_LRU_get_free_only_low(
+			    buf_pool.free[(node + i)
+					  % buf_pool.n_numa_nodes])) {
+#ifdef UNIV_DEBUG
+			if (i) {
+				buf_pool.stat.n_numa_remote++;
+			} else {
+				buf_pool.stat.n_numa_local++;
+			}
+#endif /* UNIV_DEBUG */
+			return(block);
+		}
+	}
+
+	return(NULL);
+}
+
 /******************************************************************//**
 Checks how much of buf_pool is occupied by non-data objects like
 AHI, lock heaps etc. Depending on the size of non-data objects this
@@ -870,7 +898,7 @@ static void buf_LRU_check_size_of_non_data_objects()
 
 	if (!recv_recovery_is_on()
 	    && buf_pool.curr_size == buf_pool.old_size
-	    && UT_LIST_GET_LEN(buf_pool.free)
+	    && buf_pool.free_len()
 	    + UT_LIST_GET_LEN(buf_pool.LRU) < buf_pool.curr_size / 20) {
 
 		ib::fatal() << "Over 95 percent of the buffer pool is"
@@ -885,7 +913,7 @@ static void buf_LRU_check_size_of_non_data_objects()
 			<< "M could be bigger.";
 	} else if (!recv_recovery_is_on()
 		   && buf_pool.curr_size == buf_pool.old_size
-		   && (UT_LIST_GET_LEN(buf_pool.free)
+		   && (buf_pool.free_len()
 		       + UT_LIST_GET_LEN(buf_pool.LRU))
 		   < buf_pool.curr_size / 3) {
 
@@ -947,8 +975,9 @@ we put it to free list to be used.
     * scan LRU list even if buf_pool.try_LRU_scan is not set
 * iteration > 1:
   * same as iteration 1 but sleep 10ms
+@param[in]	node	the free list to try first, see buf_pool_t::page_node()
 @return the free control block, in state BUF_BLOCK_READY_FOR_USE */
-buf_block_t* buf_LRU_get_free_block()
+buf_block_t* buf_LRU_get_free_block(ulint node)
 {
 	buf_block_t*	block		= NULL;
 	bool		freed		= false;
@@ -967,7 +996,7 @@ buf_block_t* buf_LRU_get_free_block()
 			goto not_found;});
 
 	/* If there is a block in the free list, take it */
-	block = buf_LRU_get_free_only();
+	block = buf_LRU_get_free_only(node);
 
 	if (block != NULL) {
 		mutex_exit(&buf_pool.mutex);
@@ -1181,7 +1210,9 @@ static void buf_unzip_LRU_remove_block_if_needed(buf_page_t* bpage)
 @param[in]	bpage	buffer page descriptor */
 void buf_LRU_adjust_hp(const buf_page_t* bpage)
 {
-	buf_pool.lru_hp.adjust(bpage);
+	for (ulint i = 0; i < MAX_PAGE_CLEANERS; i++) {
+		buf_pool.lru_hp[i].adjust(bpage);
+	}
 	buf_pool.lru_scan_itr.adjust(bpage);
 	buf_pool.single_scan_itr.adjust(bpage);
 }
@@ -1696,7 +1727,8 @@ buf_LRU_block_free_non_file_page(
 			&block->page);
 		ut_d(block->in_withdraw_list = TRUE);
 	} else {
-		UT_LIST_ADD_FIRST(buf_pool.free, &block->page);
+		UT_LIST_ADD_FIRST(buf_pool.free[block->numa_node],
+				  &block->page);
 		ut_d(block->page.in_free_list = TRUE);
 	}
 
@@ -2142,11 +2174,15 @@ void buf_LRU_validate()
 
 	CheckInFreeList::validate();
 
-	for (buf_page_t* bpage = UT_LIST_GET_FIRST(buf_pool.free);
-	     bpage != NULL;
-	     bpage = UT_LIST_GET_NEXT(list, bpage)) {
+	for (ulint i = 0; i < buf_pool.n_numa_nodes; i++) {
+		for (buf_page_t* bpage = UT_LIST_GET_FIRST(buf_pool.free[i]);
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_NEXT(list, bpage)) {
 
-		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_NOT_USED);
+			ut_a(buf_page_get_state(bpage) == BUF_BLOCK_NOT_USED);
+			ut_a(reinterpret_cast<buf_block_t*>(bpage)->numa_node
+			     == i);
+		}
 	}
 
 	CheckUnzipLRUAndLRUList::validate();
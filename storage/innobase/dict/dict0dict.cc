@@ -1179,6 +1179,7 @@ inline void dict_sys_t::add(dict_table_t* table)
 	ulint fold = ut_fold_string(table->name.m_name);
 
 	mutex_create(LATCH_ID_AUTOINC, &table->autoinc_mutex);
+	mutex_create(LATCH_ID_LOCK_SYS_TABLE, &table->lock_mutex);
 
 	/* Look for a table with the same name: error if such exists */
 	{
@@ -1919,6 +1920,7 @@ void dict_sys_t::remove(dict_table_t* table, bool lru, bool keep)
 	}
 
 	mutex_free(&table->autoinc_mutex);
+	mutex_free(&table->lock_mutex);
 
 	if (!keep) {
 		dict_mem_table_free(table);
@@ -387,7 +387,10 @@ static bool dict_stats_process_entry_from_recalc_pool()
 		ret = false;
 	} else {
 
-		dict_stats_update(table, DICT_STATS_RECALC_PERSISTENT);
+		if (dict_stats_update(table, DICT_STATS_RECALC_PERSISTENT)
+		    == DB_SUCCESS) {
+			innobase_stats_changed();
+		}
 		ret = true;
 	}
 
@@ -67,6 +67,14 @@ ib_create(
 			type);
 		ut_a(table->heap);
 
+#ifdef BTR_CUR_HASH_ADAPT
+		if (type == MEM_HEAP_FOR_BTR_SEARCH) {
+			table->versions = static_cast<ha_version_t*>(
+				ut_zalloc_nokey(HA_N_VERSIONS
+						* sizeof(ha_version_t)));
+		}
+#endif /* BTR_CUR_HASH_ADAPT */
+
 		return(table);
 	}
 
@@ -193,6 +201,59 @@ ha_clear(
 }
 
 #ifdef BTR_CUR_HASH_ADAPT
+/** Marks a modification of up to two hash chains of an adaptive hash
+index table for the lookups of ha_search_optimistic(). The modification
+must be protected by the x-latch of the table. */
+class ha_chain_write
+{
+public:
+	ha_chain_write(hash_table_t* table, ulint fold)
+		: m_first(&ha_get_version(table, fold)), m_second(NULL)
+	{
+		begin(m_first);
+	}
+
+	ha_chain_write(hash_table_t* table, ulint fold, ulint fold2)
+		: m_first(&ha_get_version(table, fold)),
+		  m_second(&ha_get_version(table, fold2))
+	{
+		if (m_second == m_first) {
+			m_second = NULL;
+		}
+		begin(m_first);
+		begin(m_second);
+	}
+
+	~ha_chain_write()
+	{
+		end(m_second);
+		end(m_first);
+	}
+
+private:
+	static void begin(std::atomic<uint32_t>* v)
+	{
+		if (v) {
+			ut_ad(!(*v & 1));
+			v->store(v->load(std::memory_order_relaxed) + 1,
+				 std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+	}
+
+	static void end(std::atomic<uint32_t>* v)
+	{
+		if (v) {
+			ut_ad(*v & 1);
+			v->store(v->load(std::memory_order_relaxed) + 1,
+				 std::memory_order_release);
+		}
+	}
+
+	std::atomic<uint32_t>*	m_first;
+	std::atomic<uint32_t>*	m_second;
+};
+
 # if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 /** Maximum number of records in a page */
 static const ulint MAX_N_POINTERS
@@ -236,6 +297,8 @@ ha_insert_for_fold_func(
 
 	cell = hash_get_nth_cell(table, hash);
 
+	ha_chain_write	write(table, fold);
+
 	prev_node = static_cast<ha_node_t*>(cell->node);
 
 	while (prev_node != NULL) {
@@ -323,6 +386,41 @@ ha_btr_search_latch_x_locked(const hash_table_t* table)
 }
 #endif /* UNIV_DEBUG */
 
+/** Start emptying an adaptive hash index table. All hash chains are
+marked as being modified, so that the lookups of ha_search_optimistic()
+that are in progress will fail their validation, and the chains are
+emptied. The nodes remain allocated until ha_clear_adaptive_end().
+@param[in,out]	table	hash table */
+void ha_clear_adaptive_start(hash_table_t* table)
+{
+	ut_ad(table->versions);
+	ut_d(ha_btr_search_latch_x_locked(table));
+
+	for (ulint i = 0; i < HA_N_VERSIONS; i++) {
+		ut_ad(!(table->versions[i].n & 1));
+		table->versions[i].n.fetch_add(1, std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+
+	hash_table_clear(table);
+}
+
+/** Finish emptying an adaptive hash index table by freeing its nodes.
+No ha_search_optimistic() may be in progress on the table.
+@param[in,out]	table	hash table */
+void ha_clear_adaptive_end(hash_table_t* table)
+{
+	ut_ad(table->versions);
+	ut_d(ha_btr_search_latch_x_locked(table));
+
+	mem_heap_empty(table->heap);
+
+	for (ulint i = 0; i < HA_N_VERSIONS; i++) {
+		ut_ad(table->versions[i].n & 1);
+		table->versions[i].n.fetch_add(1, std::memory_order_release);
+	}
+}
+
 /***********************************************************//**
 Deletes a hash node. */
 void
@@ -342,6 +440,13 @@ ha_delete_hash_node(
 	}
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 
+	/* The top node of the heap may be moved in place of del_node,
+	which modifies its hash chain as well. */
+	const ha_node_t* top_node = static_cast<const ha_node_t*>(
+		mem_heap_get_top(hash_get_heap(table, del_node->fold),
+				 sizeof(ha_node_t)));
+	ha_chain_write	write(table, del_node->fold, top_node->fold);
+
 	HASH_DELETE_AND_COMPACT(ha_node_t, next, table, del_node);
 }
 
@@ -378,6 +483,7 @@ ha_search_and_update_if_found_func(
 	node = ha_search_with_data(table, fold, data);
 
 	if (node) {
+		ha_chain_write	write(table, fold);
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 		if (table->adaptive) {
 			ut_a(node->block->n_pointers-- < MAX_N_POINTERS);
@@ -368,6 +368,24 @@ TYPELIB innodb_flush_method_typelib = {
 	NULL
 };
 
+#ifdef __linux__
+/** Possible values of innodb_linux_aio */
+static const char* innodb_linux_aio_names[] = {
+	"auto",		/* SRV_LINUX_AIO_AUTO */
+	"io_uring",	/* SRV_LINUX_AIO_IO_URING */
+	"aio",		/* SRV_LINUX_AIO_LIBAIO */
+	NullS
+};
+
+/** Enumeration of innodb_linux_aio */
+static TYPELIB innodb_linux_aio_typelib = {
+	array_elements(innodb_linux_aio_names) - 1,
+	"innodb_linux_aio_typelib",
+	innodb_linux_aio_names,
+	NULL
+};
+#endif
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in case of normal DML ops it is not
 sensible to call srv_active_wake_master_thread after each
@@ -544,7 +562,9 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_KEY(trx_pool_mutex),
 	PSI_KEY(trx_pool_manager_mutex),
 	PSI_KEY(srv_sys_mutex),
-	PSI_KEY(lock_mutex),
+	PSI_KEY(lock_sys_shard_mutex),
+	PSI_KEY(lock_sys_table_mutex),
+	PSI_KEY(lock_sys_deadlock_mutex),
 	PSI_KEY(lock_wait_mutex),
 	PSI_KEY(trx_mutex),
 	PSI_KEY(srv_threads_mutex),
@@ -578,6 +598,7 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	PSI_RWLOCK_KEY(fts_cache_init_rw_lock),
 	PSI_RWLOCK_KEY(trx_i_s_cache_lock),
 	PSI_RWLOCK_KEY(trx_purge_latch),
+	PSI_RWLOCK_KEY(lock_sys_latch),
 	PSI_RWLOCK_KEY(index_tree_rw_lock),
 	PSI_RWLOCK_KEY(index_online_log),
 	PSI_RWLOCK_KEY(dict_table_stats),
@@ -899,6 +920,10 @@ static SHOW_VAR innodb_status_variables[]= {
 #ifdef UNIV_DEBUG
   {"buffer_pool_pages_latched",
    &export_vars.innodb_buffer_pool_pages_latched, SHOW_SIZE_T},
+  {"buffer_pool_numa_local",
+   &export_vars.innodb_buffer_pool_numa_local, SHOW_SIZE_T},
+  {"buffer_pool_numa_remote",
+   &export_vars.innodb_buffer_pool_numa_remote, SHOW_SIZE_T},
 #endif /* UNIV_DEBUG */
   {"buffer_pool_pages_made_not_young",
    &export_vars.innodb_buffer_pool_pages_made_not_young, SHOW_SIZE_T},
@@ -2708,10 +2733,12 @@ ha_innobase::ha_innobase(
                           | HA_CAN_TABLES_WITHOUT_ROLLBACK
                           | HA_CAN_ONLINE_BACKUPS
 			  | HA_CONCURRENT_OPTIMIZE
+			  | HA_CAN_RND_BATCH
 			  |  (srv_force_primary_key ? HA_REQUIRE_PRIMARY_KEY : 0)
 		  ),
 	m_start_of_scan(),
-        m_mysql_has_locked()
+        m_mysql_has_locked(),
+	m_sample()
 {}
 
 /*********************************************************************//**
@@ -3048,6 +3075,13 @@ innobase_invalidate_query_cache(
 #endif
 }
 
+/** Note that the persistent statistics of a table were recalculated,
+so that the query plans that prepared statements cached are dropped. */
+void innobase_stats_changed()
+{
+	join_plan_cache_version++;
+}
+
 /** Quote a standard SQL identifier like index or column name.
 @param[in]	file	output stream
 @param[in]	trx	InnoDB transaction, or NULL
@@ -3422,10 +3456,6 @@ static const char* innodb_undo_logs_msg
 = "The parameter innodb_undo_logs is deprecated and has no effect.";
 /** Deprecated parameter with no effect */
 static ulong innodb_buffer_pool_instances;
-/** Deprecated parameter with no effect */
-static ulong innodb_page_cleaners;
-static const char* innodb_page_cleaners_msg
-= "The parameter innodb_page_cleaners is deprecated and has no effect.";
 
 ulong srv_n_log_files;
 static const char* srv_n_log_files_msg
@@ -3510,10 +3540,6 @@ static int innodb_init_params()
 				  " is deprecated and has no effect.");
 	}
 
-	if (UNIV_UNLIKELY(deprecated::innodb_page_cleaners)) {
-		sql_print_warning(deprecated::innodb_page_cleaners_msg);
-	}
-
 	if (UNIV_UNLIKELY(deprecated::srv_n_log_files != 1)) {
 		sql_print_warning(deprecated::srv_n_log_files_msg);
 		deprecated::srv_n_log_files = 1;
@@ -3521,8 +3547,6 @@ static int innodb_init_params()
 
 	deprecated::innodb_buffer_pool_instances = 1;
 
-	deprecated::innodb_page_cleaners = 1;
-
 	if (UNIV_UNLIKELY(deprecated::innodb_undo_logs != TRX_SYS_N_RSEGS)) {
 		sql_print_warning(deprecated::innodb_undo_logs_msg);
 		deprecated::innodb_undo_logs = TRX_SYS_N_RSEGS;
@@ -3873,6 +3897,14 @@ static int innodb_init_params()
 		srv_use_doublewrite_buf = FALSE;
 	}
 
+#ifdef HAVE_LIBNUMA
+	if (srv_numa_node_local && srv_numa_interleave) {
+		ib::warn() << "innodb_numa_node_local=ON overrides"
+			" innodb_numa_interleave=ON";
+		srv_numa_interleave = FALSE;
+	}
+#endif /* HAVE_LIBNUMA */
+
 #ifdef LINUX_NATIVE_AIO
 	if (srv_use_native_aio) {
 		ib::info() << "Using Linux native AIO";
@@ -6217,6 +6249,11 @@ ha_innobase::close()
 {
 	DBUG_ENTER("ha_innobase::close");
 
+	if (m_sample) {
+		row_sample_end(m_sample);
+		m_sample = NULL;
+	}
+
 	row_prebuilt_free(m_prebuilt, FALSE);
 
 	if (m_upd_buf != NULL) {
@@ -9452,6 +9489,11 @@ int
 ha_innobase::rnd_end(void)
 /*======================*/
 {
+	if (m_sample) {
+		row_sample_end(m_sample);
+		m_sample = NULL;
+	}
+
 	return(index_end());
 }
 
@@ -9485,6 +9527,152 @@ ha_innobase::rnd_next(
 	DBUG_RETURN(error);
 }
 
+/** Read the next rows of a table scan. Apart from the first few rows,
+they are copied directly from the row_search_mvcc() prefetch cache.
+@param[out]	buf		rows, table->s->rec_buff_length bytes apart
+@param[in]	max_rows	maximum number of rows to read
+@param[out]	n_rows		number of rows that were read
+@return 0, or the error that ended the batch
+@retval HA_ERR_WRONG_COMMAND if the scan must be read row by row */
+int
+ha_innobase::rnd_next_batch(uchar* buf, uint max_rows, uint* n_rows)
+{
+	DBUG_ENTER("rnd_next_batch");
+
+	/* A locking read must be able to release the lock on the row that
+	was returned last (unlock_row()), and the pushed down conditions
+	are evaluated on table->record[0]. */
+	if (m_prebuilt->select_lock_type != LOCK_NONE
+	    || m_prebuilt->idx_cond || m_prebuilt->pk_filter) {
+		DBUG_RETURN(HA_ERR_WRONG_COMMAND);
+	}
+
+	const uint	rec_buff_length = table->s->rec_buff_length;
+	int		error = 0;
+
+	while (*n_rows < max_rows) {
+		if (!m_start_of_scan && m_prebuilt->n_fetch_cached) {
+			const ulint n = row_sel_dequeue_cached_rows_for_mysql(
+				buf, rec_buff_length, max_rows - *n_rows,
+				m_prebuilt);
+
+			if (n) {
+				const trx_t* trx = m_prebuilt->trx;
+				if (m_prebuilt->table->is_system_db) {
+					srv_stats.n_system_rows_read.add(
+						thd_get_thread_id(
+							trx->mysql_thd), n);
+				} else {
+					srv_stats.n_rows_read.add(
+						thd_get_thread_id(
+							trx->mysql_thd), n);
+				}
+
+				table->status = 0;
+				*n_rows += uint(n);
+				buf += n * rec_buff_length;
+				continue;
+			}
+		}
+
+		/* Fetch the next row, and let row_search_mvcc()
+		refill the prefetch cache. */
+		error = rnd_next(buf);
+		if (error) {
+			break;
+		}
+
+		++*n_rows;
+		buf += rec_buff_length;
+	}
+
+	DBUG_RETURN(error);
+}
+
+/** Read the next row of a sampled table scan. With HA_SAMPLE_SYSTEM
+whole leaf pages of the clustered index are taken or skipped, and with
+several sample_readers the ranges of the leaf level are read in parallel,
+see row_sample_start(). Locking reads, and full scans by one reader, use
+the default implementation.
+@param[out]	buf	row in the MySQL format
+@return 0, HA_ERR_END_OF_FILE, or error number */
+int
+ha_innobase::sample_next(uchar* buf)
+{
+	DBUG_ENTER("ha_innobase::sample_next");
+
+	if (m_start_of_scan && !m_sample
+	    && (sample_readers > 1
+		|| (sample_mode == HA_SAMPLE_SYSTEM && sample_fraction < 1))
+	    && m_prebuilt->select_lock_type == LOCK_NONE
+	    && m_prebuilt->index->is_primary()
+	    && m_prebuilt->index_usable
+	    && m_prebuilt->table->is_readable()
+	    && !m_prebuilt->table->no_rollback()) {
+		trx_t*	trx = m_prebuilt->trx;
+
+		ut_a(trx == thd_to_trx(m_user_thd));
+
+		/* Do the start-of-statement preparations of
+		row_search_mvcc(). */
+		if (m_prebuilt->sql_stat_start) {
+			build_template(false);
+			m_prebuilt->sql_stat_start = FALSE;
+			trx_start_if_not_started(trx, false);
+			trx->read_view.open(trx);
+		}
+
+		m_sample = row_sample_start(
+			m_prebuilt, sample_fraction,
+			sample_mode == HA_SAMPLE_SYSTEM, sample_readers);
+		m_start_of_scan = false;
+
+		/* A leaf page is the unit of the sample. */
+		if (sample_mode == HA_SAMPLE_SYSTEM
+		    && m_prebuilt->index->stat_n_leaf_pages) {
+			sample_block_rows = std::max<ha_rows>(
+				stats.records
+				/ m_prebuilt->index->stat_n_leaf_pages, 1);
+		}
+	}
+
+	if (!m_sample) {
+		DBUG_RETURN(handler::sample_next(buf));
+	}
+
+	if (thd_kill_level(m_user_thd)) {
+		DBUG_RETURN(HA_ERR_ABORTED_BY_USER);
+	}
+
+	dberr_t	err = row_sample_next(m_sample, buf);
+
+	switch (err) {
+	case DB_SUCCESS:
+		if (m_prebuilt->table->is_system_db) {
+			srv_stats.n_system_rows_read.add(
+				thd_get_thread_id(m_user_thd), 1);
+		} else {
+			srv_stats.n_rows_read.add(
+				thd_get_thread_id(m_user_thd), 1);
+		}
+		update_rows_read();
+		if (table->vfield && buf == table->record[0]) {
+			table->update_virtual_fields(
+				this, VCOL_UPDATE_FOR_READ);
+		}
+		table->status = 0;
+		DBUG_RETURN(0);
+	case DB_END_OF_INDEX:
+		table->status = STATUS_NOT_FOUND;
+		DBUG_RETURN(HA_ERR_END_OF_FILE);
+	default:
+		table->status = STATUS_NOT_FOUND;
+		DBUG_RETURN(convert_error_code_to_mysql(
+				    err, m_prebuilt->table->flags,
+				    m_user_thd));
+	}
+}
+
 /**********************************************************************//**
 Fetches a row from the table based on a row reference.
 @return 0, HA_ERR_KEY_NOT_FOUND, or error code */
@@ -18864,16 +19052,6 @@ innodb_log_optimize_ddl_warn(THD* thd, st_mysql_sys_var*, void*, const void*)
 			    deprecated::innodb_log_optimize_ddl_msg);
 }
 
-/** Issue a deprecation warning for SET GLOBAL innodb_page_cleaners.
-@param[in,out]	thd	client connection */
-static void
-innodb_page_cleaners_warn(THD* thd, st_mysql_sys_var*, void*, const void*)
-{
-	push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
-			    HA_ERR_UNSUPPORTED,
-			    deprecated::innodb_page_cleaners_msg);
-}
-
 /** Issue a deprecation warning for SET GLOBAL innodb_undo_logs.
 @param[in,out]	thd	client connection */
 static void
@@ -19283,9 +19461,12 @@ static MYSQL_SYSVAR_STR(log_group_home_dir, srv_log_group_home_dir,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Path to InnoDB log files.", NULL, NULL, NULL);
 
-static MYSQL_SYSVAR_ULONG(page_cleaners, deprecated::innodb_page_cleaners,
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
   PLUGIN_VAR_RQCMDARG,
-  innodb_deprecated_ignored, NULL, innodb_page_cleaners_warn, 0, 0, 64, 0);
+  "Number of page cleaner workers that flush disjoint segments of"
+  " the LRU list and the flush list in parallel. innodb_io_capacity and"
+  " innodb_io_capacity_max apply to each worker that has pages to flush.",
+  NULL, NULL, 1, 1, MAX_PAGE_CLEANERS, 0);
 
 static MYSQL_SYSVAR_DOUBLE(max_dirty_pages_pct, srv_max_buf_pool_modified_pct,
   PLUGIN_VAR_RQCMDARG,
@@ -19709,6 +19890,12 @@ static MYSQL_SYSVAR_ULONG(force_recovery, srv_force_recovery,
   "Helps to save your data in case the disk image of the database becomes corrupt. Value 5 can return bogus data, and 6 can permanently corrupt data.",
   NULL, NULL, 0, 0, 6, 0);
 
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_recovery_apply_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Maximum number of concurrent tasks applying redo log to pages"
+  " during crash recovery.",
+  NULL, NULL, 4, 1, 256, 0);
+
 static MYSQL_SYSVAR_ULONG(page_size, srv_page_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Page size to use for all InnoDB tablespaces.",
@@ -19860,11 +20047,27 @@ static MYSQL_SYSVAR_BOOL(use_native_aio, srv_use_native_aio,
   "Use native AIO if supported on this platform.",
   NULL, NULL, TRUE);
 
+#ifdef __linux__
+static MYSQL_SYSVAR_ENUM(linux_aio, srv_linux_aio,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Specifies which Linux AIO implementation to use when"
+  " innodb_use_native_aio=ON: auto (io_uring if available, else aio),"
+  " io_uring (refuse to start if it is not available), or aio (libaio)",
+  NULL, NULL, SRV_LINUX_AIO_AUTO, &innodb_linux_aio_typelib);
+#endif
+
 #ifdef HAVE_LIBNUMA
 static MYSQL_SYSVAR_BOOL(numa_interleave, srv_numa_interleave,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Use NUMA interleave memory policy to allocate InnoDB buffer pool.",
   NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_BOOL(numa_node_local, srv_numa_node_local,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Bind each InnoDB buffer pool chunk to one NUMA node, and keep a free"
+  " list per node. A page is read into a block of the node that its"
+  " page number hashes to. Overrides innodb_numa_interleave.",
+  NULL, NULL, FALSE);
 #endif /* HAVE_LIBNUMA */
 
 static MYSQL_SYSVAR_ENUM(change_buffering, innodb_change_buffering,
@@ -19951,6 +20154,12 @@ static MYSQL_SYSVAR_ULONG(read_ahead_threshold, srv_read_ahead_threshold,
   " trigger a readahead.",
   NULL, NULL, 56, 0, 64, 0);
 
+static MYSQL_SYSVAR_ULONG(fetch_cache_size, srv_fetch_cache_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum memory in bytes for the rows that an index scan prefetches"
+  " at a time",
+  NULL, NULL, 128 << 10, 0, 64 << 20, 0);
+
 static MYSQL_SYSVAR_STR(monitor_enable, innobase_enable_monitor_counter,
   PLUGIN_VAR_RQCMDARG,
   "Turn on a monitor counter",
@@ -20255,6 +20464,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(flush_log_at_trx_commit),
   MYSQL_SYSVAR(flush_method),
   MYSQL_SYSVAR(force_recovery),
+  MYSQL_SYSVAR(fetch_cache_size),
+  MYSQL_SYSVAR(recovery_apply_threads),
   MYSQL_SYSVAR(fill_factor),
   MYSQL_SYSVAR(ft_cache_size),
   MYSQL_SYSVAR(ft_total_cache_size),
@@ -20323,8 +20534,12 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(autoinc_lock_mode),
   MYSQL_SYSVAR(version),
   MYSQL_SYSVAR(use_native_aio),
+#ifdef __linux__
+  MYSQL_SYSVAR(linux_aio),
+#endif
 #ifdef HAVE_LIBNUMA
   MYSQL_SYSVAR(numa_interleave),
+  MYSQL_SYSVAR(numa_node_local),
 #endif /* HAVE_LIBNUMA */
   MYSQL_SYSVAR(change_buffering),
   MYSQL_SYSVAR(change_buffer_max_size),
@@ -31,6 +31,8 @@ extern const char innobase_index_reserve_name[];
 
 /** Prebuilt structures in an InnoDB table handle used within MySQL */
 struct row_prebuilt_t;
+/** Sampled scan of a clustered index */
+struct row_sample_t;
 
 /** InnoDB transaction */
 struct trx_t;
@@ -158,6 +160,10 @@ class ha_innobase final: public handler
 
 	int rnd_next(uchar *buf) override;
 
+	int rnd_next_batch(uchar* buf, uint max_rows, uint* n_rows) override;
+
+	int sample_next(uchar* buf) override;
+
 	int rnd_pos(uchar * buf, uchar *pos) override;
 
 	int ft_init() override;
@@ -518,6 +524,9 @@ class ha_innobase final: public handler
 
         /** If mysql has locked with external_lock() */
         bool                    m_mysql_has_locked;
+
+	/** the sampled scan that sample_next() reads, or NULL */
+	row_sample_t*		m_sample;
 };
 
 
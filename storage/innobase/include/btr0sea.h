@@ -236,6 +236,15 @@ struct btr_search_t{
 				which would have succeeded, or did succeed,
 				using the hash index;
 				the range is 0 .. BTR_SEARCH_BUILD_LIMIT + 5 */
+	ulint	hash_tries;	/*!< number of hash searches since
+				the hash index was last checked for
+				being useful on this index */
+	ulint	hash_fails;	/*!< number of failed hash searches
+				among hash_tries */
+	ulint	hash_off;	/*!< if nonzero, the number of B-tree
+				searches for which the hash index will not
+				be used or built on this index, because
+				most hash searches failed */
 	/* @} */
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
@@ -279,7 +288,10 @@ struct btr_search_sys_t{
 					to rec_t pointers on index pages */
 };
 
-/** Latches protecting access to adaptive hash index. */
+/** Latches protecting access to adaptive hash index. The hash tables
+are only modified while holding the latch in exclusive mode.
+btr_search_guess_on_hash() normally reads them without any latch, see
+ha_search_optimistic(). */
 extern rw_lock_t**		btr_search_latches;
 
 /** The adaptive hash index */
@@ -305,6 +317,14 @@ pattern */
 the hash index */
 #define BTR_SEARCH_ON_HASH_LIMIT	3
 
+/** Number of hash searches on an index after which the hash index is
+checked for being useful on the index */
+#define BTR_SEARCH_HURT_WINDOW		1000
+
+/** If more than half of the hash searches on an index failed, the hash
+index is not used or built on the index for this many B-tree searches */
+#define BTR_SEARCH_HURT_BACKOFF		100000
+
 /** We do this many searches before trying to keep the search latch
 over calls from MySQL. If we notice someone waiting for the latch, we
 again set this much timeout. This is to reduce contention. */
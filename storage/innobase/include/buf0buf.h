@@ -74,6 +74,16 @@ struct fil_addr_t;
 #define MAX_PAGE_HASH_LOCKS	1024	/*!< The maximum number of
 					page_hash locks */
 
+/** Maximum number of page cleaner workers (innodb_page_cleaners) */
+#define MAX_PAGE_CLEANERS		64
+
+#ifdef HAVE_LIBNUMA
+/** Maximum number of NUMA nodes with innodb_numa_node_local */
+# define BUF_POOL_MAX_NUMA_NODES	64
+#else
+# define BUF_POOL_MAX_NUMA_NODES	1
+#endif /* HAVE_LIBNUMA */
+
 # ifdef UNIV_DEBUG
 extern my_bool	buf_disable_resize_buffer_pool_debug; /*!< if TRUE, resizing
 					buffer pool is not allowed. */
@@ -263,7 +273,7 @@ buf_page_optimistic_get(
 
 /** Given a tablespace id and page number tries to get that page. If the
 page is not in the buffer pool it is not loaded and NULL is returned.
-Suitable for using when holding the lock_sys_t::mutex.
+Suitable for using when holding the lock_sys_t::latch.
 @param[in]	page_id	page id
 @param[in]	file	file name
 @param[in]	line	line where called
@@ -278,7 +288,7 @@ buf_page_try_get_func(
 
 /** Tries to get a page.
 If the page is not in the buffer pool it is not loaded. Suitable for using
-when holding the lock_sys_t::mutex.
+when holding the lock_sys_t::latch.
 @param[in]	page_id	page identifier
 @param[in]	mtr	mini-transaction
 @return the page if in buffer pool, NULL if not */
@@ -1326,6 +1336,9 @@ struct buf_block_t{
 					used in debugging */
 	ibool		in_withdraw_list;
 #endif /* UNIV_DEBUG */
+	uint32_t	numa_node;	/*!< index of the buf_pool.free list
+					that the block belongs to; constant
+					after buf_pool_t::chunk_t::create() */
 	uint32_t	lock_hash_val;	/*!< hashed value of the page address
 					in the record lock hash table;
 					protected by buf_block_t::lock
@@ -1634,6 +1647,13 @@ struct buf_pool_stat_t{
 				buf_page_peek_if_too_old() */
 	ulint	LRU_bytes;	/*!< LRU size in bytes */
 	ulint	flush_list_bytes;/*!< flush_list size in bytes */
+#ifdef UNIV_DEBUG
+	ulint	n_numa_local;	/*!< number of blocks that were taken
+				from the requested buf_pool.free list */
+	ulint	n_numa_remote;	/*!< number of blocks that were taken
+				from the free list of another NUMA node,
+				because the requested one was empty */
+#endif /* UNIV_DEBUG */
 };
 
 /** Statistics of buddy blocks of a given size. */
@@ -1771,6 +1791,31 @@ class buf_pool_t
     return size;
   }
 
+  /** @return the total length of the free lists */
+  ulint free_len() const
+  {
+    ulint len= 0;
+    for (ulint i= 0; i < n_numa_nodes; i++)
+      len+= UT_LIST_GET_LEN(free[i]);
+    return len;
+  }
+
+  /** Determine the free list from which a block for a page is preferably
+  allocated. With innodb_numa_node_local, pages are spread over the NUMA
+  nodes by their identifier, so that a page always lands on the same node.
+  @param id   page identifier
+  @return index of a buf_pool.free list */
+  ulint page_node(const page_id_t id) const
+  {
+    return n_numa_nodes > 1 ? id.fold() % n_numa_nodes : 0;
+  }
+
+  /** Determine the free list from which a block that does not belong to
+  any page (buf_block_alloc(), buf_buddy_alloc()) is preferably allocated.
+  @return index of the buf_pool.free list of the NUMA node of the current
+  CPU, or the next free list in round-robin order if that is unknown */
+  ulint local_node() const;
+
   /** Determine whether a frame is intended to be withdrawn during resize().
   @param ptr    pointer within a buf_block_t::frame
   @return whether the frame will be withdrawn */
@@ -1933,9 +1978,12 @@ class buf_pool_t
 					also protects writes to
 					bpage::oldest_modification and
 					flush_list_hp */
-	FlushHp			flush_hp;/*!< "hazard pointer"
-					used during scan of flush_list
-					while doing flush list batch.
+	FlushHp			flush_hp[MAX_PAGE_CLEANERS];
+					/*!< "hazard pointers" used
+					during scan of flush_list while
+					doing flush list batch, one for
+					each page cleaner slot; flush_hp[0]
+					is also used by other batches.
 					Protected by flush_list_mutex */
 	UT_LIST_BASE_NODE_T(buf_page_t) flush_list;
 					/*!< base node of the modified block
@@ -1990,9 +2038,17 @@ class buf_pool_t
 	/** @name LRU replacement algorithm fields */
 	/* @{ */
 
-	UT_LIST_BASE_NODE_T(buf_page_t) free;
-					/*!< base node of the free
-					block list */
+	UT_LIST_BASE_NODE_T(buf_page_t) free[BUF_POOL_MAX_NUMA_NODES];
+					/*!< base nodes of the free
+					block lists; there is one per
+					NUMA node with innodb_numa_node_local,
+					otherwise only free[0] is used */
+	ulint		n_numa_nodes;	/*!< number of free lists in use */
+#ifdef HAVE_LIBNUMA
+	int		numa_node_id[BUF_POOL_MAX_NUMA_NODES];
+					/*!< NUMA node numbers of the
+					free lists */
+#endif /* HAVE_LIBNUMA */
 
 	UT_LIST_BASE_NODE_T(buf_page_t) withdraw;
 					/*!< base node of the withdraw
@@ -2003,9 +2059,10 @@ class buf_pool_t
 	ulint		withdraw_target;/*!< target length of withdraw
 					block list, when withdrawing */
 
-	/** "hazard pointer" used during scan of LRU while doing
-	LRU list batch.  Protected by buf_pool_t::mutex. */
-	LRUHp		lru_hp;
+	/** "hazard pointers" used during scan of LRU while doing
+	LRU list batch, one for each page cleaner slot; lru_hp[0] is also
+	used by other batches.  Protected by buf_pool_t::mutex. */
+	LRUHp		lru_hp[MAX_PAGE_CLEANERS];
 
 	/** Iterator used to scan the LRU list when searching for
 	replacable victim. Protected by buf_pool_t::mutex. */
@@ -2279,7 +2336,9 @@ struct	CheckInFreeList {
 
 	static void validate()
 	{
-		ut_list_validate(buf_pool.free, CheckInFreeList());
+		for (ulint i = 0; i < buf_pool.n_numa_nodes; i++) {
+			ut_list_validate(buf_pool.free[i], CheckInFreeList());
+		}
 	}
 };
 
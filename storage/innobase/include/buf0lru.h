@@ -96,9 +96,10 @@ buf_LRU_free_page(
 @return true if found and freed */
 bool buf_LRU_scan_and_free_block(bool scan_all);
 
-/** @return a buffer block from the buf_pool.free list
-@retval	NULL	if the free list is empty */
-buf_block_t* buf_LRU_get_free_only();
+/** @return a buffer block from the buf_pool.free lists
+@param[in]	node	the free list to try first, see buf_pool_t::page_node()
+@retval	NULL	if the free lists are empty */
+buf_block_t* buf_LRU_get_free_only(ulint node);
 
 /** Get a free block from the buf_pool. The block is taken off the
 free list. If free list is empty, blocks are moved from the end of the
@@ -122,8 +123,9 @@ we put it to free list to be used.
     * scan LRU list even if buf_pool.try_LRU_scan is not set
 * iteration > 1:
   * same as iteration 1 but sleep 10ms
+@param[in]	node	the free list to try first, see buf_pool_t::page_node()
 @return the free control block, in state BUF_BLOCK_READY_FOR_USE */
-buf_block_t* buf_LRU_get_free_block()
+buf_block_t* buf_LRU_get_free_block(ulint node)
 	MY_ATTRIBUTE((malloc,warn_unused_result));
 
 /** @return whether the unzip_LRU list should be used for evicting a victim
@@ -2211,7 +2211,7 @@ struct dict_table_t {
 	kept in trx_t. In order to quickly determine whether a transaction has
 	locked the AUTOINC lock we keep a pointer to the transaction here in
 	the 'autoinc_trx' member. This is to avoid acquiring the
-	lock_sys_t::mutex and scanning the vector in trx_t.
+	lock_sys_t::latch and scanning the vector in trx_t.
 	When an AUTOINC lock has to wait, the corresponding lock instance is
 	created on the trx lock heap rather than use the pre-allocated instance
 	in autoinc_lock below. */
@@ -2231,14 +2231,14 @@ struct dict_table_t {
 
 	/** This counter is used to track the number of granted and pending
 	autoinc locks on this table. This value is set after acquiring the
-	lock_sys_t::mutex but we peek the contents to determine whether other
-	transactions have acquired the AUTOINC lock or not. Of course only one
-	transaction can be granted the lock but there can be multiple
-	waiters. */
+	lock_sys_t::latch (in shared mode, together with lock_mutex) but we
+	peek the contents to determine whether other transactions have
+	acquired the AUTOINC lock or not. Of course only one transaction can
+	be granted the lock but there can be multiple waiters. */
 	ulong					n_waiting_or_granted_auto_inc_locks;
 
 	/** The transaction that currently holds the the AUTOINC lock on this
-	table. Protected by lock_sys.mutex. */
+	table. Protected by lock_sys.latch, like locks. */
 	const trx_t*				autoinc_trx;
 
 	/* @} */
@@ -2253,8 +2253,9 @@ struct dict_table_t {
 
 	/** Count of the number of record locks on this table. We use this to
 	determine whether we can evict the table from the dictionary cache.
-	It is protected by lock_sys.mutex. */
-	ulint					n_rec_locks;
+	Record locks may be created while holding only a partition of
+	lock_sys.latch, so this is updated atomically. */
+	Atomic_counter<ulint>			n_rec_locks;
 
 private:
 	/** Count of how many handles are opened to this table. Dropping of the
@@ -2263,9 +2264,15 @@ struct dict_table_t {
 	Atomic_counter<uint32_t>		n_ref_count;
 
 public:
-	/** List of locks on the table. Protected by lock_sys.mutex. */
+	/** List of locks on the table. Protected by lock_sys.latch in
+	exclusive mode, or in shared mode together with lock_mutex. Locks
+	are only removed while holding the exclusive latch. */
 	table_lock_list_t			locks;
 
+	/** Mutex protecting locks while lock_sys.latch is held in
+	shared mode */
+	ib_mutex_t				lock_mutex;
+
 	/** Timestamp of the last modification of this table. */
 	time_t					update_time;
 
@@ -32,6 +32,8 @@ Created 8/18/1994 Heikki Tuuri
 #include "buf0types.h"
 #include "rem0types.h"
 
+#include <atomic>
+
 #ifdef BTR_CUR_HASH_ADAPT
 /*************************************************************//**
 Looks for an element in a hash table.
@@ -43,6 +45,53 @@ ha_search_and_get_data(
 /*===================*/
 	hash_table_t*	table,	/*!< in: hash table */
 	ulint		fold);	/*!< in: folded value of the searched data */
+
+/** Number of version counters of an adaptive hash index table */
+#define HA_N_VERSIONS	64
+
+/** A version counter of an adaptive hash index table. Counter i covers
+the hash chains of the cells whose number modulo HA_N_VERSIONS is i.
+It is incremented before and after any of those chains is modified,
+so that it is odd while a modification is in progress. This allows
+lookups without the search latch, see ha_search_optimistic(). */
+struct ha_version_t
+{
+	std::atomic<uint32_t>	n;
+	byte			pad[CPU_LEVEL1_DCACHE_LINESIZE
+				    - sizeof(std::atomic<uint32_t>)];
+};
+
+/** Look for an element in an adaptive hash index table without holding
+the search latch. The result may only be trusted after it has been
+validated with ha_search_validate().
+@param[in]	table	hash table
+@param[in]	fold	folded value of the searched data
+@param[out]	data	the data of the first node having the fold value,
+			or NULL if not found
+@param[out]	version	version of the hash chain, for
+			ha_search_validate()
+@return whether the lookup was consistent; false if the hash chain
+was being modified, and the lookup must be repeated under the latch */
+UNIV_INLINE
+bool
+ha_search_optimistic(
+	hash_table_t*	table,
+	ulint		fold,
+	const rec_t**	data,
+	uint32_t*	version);
+
+/** Check that the hash chain searched by ha_search_optimistic()
+has not been modified since.
+@param[in]	table	hash table
+@param[in]	fold	folded value of the searched data
+@param[in]	version	version returned by ha_search_optimistic()
+@return whether the result of the lookup is still valid */
+UNIV_INLINE
+bool
+ha_search_validate(
+	hash_table_t*	table,
+	ulint		fold,
+	uint32_t	version);
 /*********************************************************//**
 Looks for an element when we know the pointer to the data and updates
 the pointer to data if found.
@@ -117,6 +166,18 @@ ha_clear(
 	hash_table_t*	table);	/*!< in, own: hash table */
 
 #ifdef BTR_CUR_HASH_ADAPT
+/** Start emptying an adaptive hash index table. All hash chains are
+marked as being modified, so that the lookups of ha_search_optimistic()
+that are in progress will fail their validation, and the chains are
+emptied. The nodes remain allocated until ha_clear_adaptive_end().
+@param[in,out]	table	hash table */
+void ha_clear_adaptive_start(hash_table_t* table);
+
+/** Finish emptying an adaptive hash index table by freeing its nodes.
+No ha_search_optimistic() may be in progress on the table.
+@param[in,out]	table	hash table */
+void ha_clear_adaptive_end(hash_table_t* table);
+
 /*************************************************************//**
 Inserts an entry into a hash table. If an entry with the same fold number
 is found, its node is updated to point to the new data, and no new node
@@ -76,6 +76,10 @@ innobase_invalidate_query_cache(
 					NOTE that in Windows this is
 					always in LOWER CASE! */
 
+/** Note that the persistent statistics of a table were recalculated,
+so that the query plans that prepared statements cached are dropped. */
+void innobase_stats_changed();
+
 /** Quote a standard SQL identifier like tablespace, index or column name.
 @param[in]	file	output stream
 @param[in]	trx	InnoDB transaction, or NULL
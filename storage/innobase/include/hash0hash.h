@@ -32,6 +32,9 @@ Created 5/20/1997 Heikki Tuuri
 
 struct hash_table_t;
 struct hash_cell_t;
+#ifdef BTR_CUR_HASH_ADAPT
+struct ha_version_t;
+#endif /* BTR_CUR_HASH_ADAPT */
 
 typedef void*	hash_node_t;
 
@@ -514,6 +517,12 @@ struct hash_table_t {
 					heaps; there are then n_mutexes
 					many of these heaps */
 	mem_heap_t*		heap;
+#ifdef BTR_CUR_HASH_ADAPT
+	ha_version_t*		versions;/*!< NULL, or version counters
+					for lookups in the adaptive hash
+					index that do not acquire the
+					search latch */
+#endif /* BTR_CUR_HASH_ADAPT */
 #ifdef UNIV_DEBUG
 	ulint			magic_n;
 # define HASH_TABLE_MAGIC_N	76561114
@@ -35,6 +35,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "lock0types.h"
 #include "hash0hash.h"
 #include "srv0srv.h"
+#include "sync0rw.h"
 #include "ut0vec.h"
 #include "gis0rtree.h"
 #include "lock0prdt.h"
@@ -579,7 +580,7 @@ lock_print_info_all_transactions(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys.mutex. */
+The caller must be holding lock_sys.latch. */
 ulint
 lock_number_of_rows_locked(
 /*=======================*/
@@ -588,7 +589,7 @@ lock_number_of_rows_locked(
 
 /*********************************************************************//**
 Return the number of table locks for a transaction.
-The caller must be holding lock_sys.mutex. */
+The caller must be holding lock_sys.latch. */
 ulint
 lock_number_of_tables_locked(
 /*=========================*/
@@ -669,6 +670,14 @@ lock_wait_suspend_thread(
 /*=====================*/
 	que_thr_t*	thr);	/*!< in: query thread associated with the
 				user OS thread */
+
+/** Check if a lock wait that was just enqueued results in a deadlock,
+and if so, resolve it by cancelling the wait of a victim transaction.
+This is invoked by the thread that is about to suspend itself for the
+lock wait, without holding lock_sys.latch.
+@param[in,out]	trx	transaction that is waiting for a lock */
+void
+lock_wait_check_deadlock(trx_t* trx);
 /*********************************************************************//**
 Unlocks AUTO_INC type locks that were possibly reserved by a trx. This
 function should be called at the the end of an SQL statement, by the
@@ -755,9 +764,43 @@ class lock_sys_t
   bool m_initialised;
 
 public:
+	/** Number of latch partitions of the record lock hash tables */
+	static const ulint	N_SHARDS = 256;
+
+	/** Latch protecting the locks. Operations that are local to one
+	page (acquiring a record lock that does not have to wait, checking
+	for conflicting locks on insert) hold it in shared mode together
+	with the partition mutex of the page, see page_lock(). Acquiring
+	a table lock that does not have to wait holds it in shared mode
+	together with dict_table_t::lock_mutex. Deadlock detection holds
+	it in shared mode together with deadlock_mutex. Everything else
+	(enqueueing lock waits, granting or cancelling waiting locks,
+	releasing the locks of a transaction, lock queue reorganization
+	on page split/merge) holds it in exclusive mode, which excludes
+	all partitions. Because waits only come and go in exclusive mode,
+	the waits-for graph does not change while the latch is held in
+	shared mode. */
 	MY_ALIGNED(CACHE_LINE_SIZE)
-	LockMutex	mutex;			/*!< Mutex protecting the
-						locks */
+	rw_lock_t	latch;
+
+	/** A latch partition of rec_hash, prdt_hash and prdt_page_hash.
+	All three hash tables have the same number of cells, and a page
+	belongs to partition (cell % N_SHARDS) in each of them, so that
+	pages sharing a hash chain always share the partition. */
+	struct shard_t
+	{
+		MY_ALIGNED(CACHE_LINE_SIZE)
+		LockMutex	mutex;
+	};
+	shard_t		shards[N_SHARDS];
+
+	/** Mutex serializing deadlock detection, which holds latch in
+	shared mode. Protects DeadlockChecker state, trx_lock_t::deadlock_mark
+	and trx_lock_t::victim_wait_lock, and the reporting of the latest
+	deadlock. Acquired before the partition mutexes. */
+	MY_ALIGNED(CACHE_LINE_SIZE)
+	LockMutex	deadlock_mutex;
+
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
 	hash_table_t*	prdt_hash;		/*!< hash table of the predicate
@@ -818,6 +861,44 @@ class lock_sys_t
 
   /** Closes the lock system at database shutdown. */
   void close();
+
+
+  /** @return the partition mutex of a lock hash table cell */
+  LockMutex& shard_mutex(ulint cell)
+  {
+    return shards[cell % N_SHARDS].mutex;
+  }
+
+  /**
+    Acquire latch in shared mode and the partition of a page, for
+    accessing the record lock queue of the page.
+
+    @param[in] block  buffer block of the page
+  */
+  inline void page_lock(const buf_block_t *block);
+
+  /**
+    Release the latches acquired by page_lock().
+
+    @param[in] block  buffer block of the page
+  */
+  inline void page_unlock(const buf_block_t *block);
+
+#ifdef UNIV_DEBUG
+  /**
+    @return whether the record lock queue of a page may be accessed by the
+    current thread: the latch is held in exclusive mode, or in shared mode
+    together with the partition mutex of the page
+  */
+  bool page_locked(ulint space, ulint page_no);
+
+  /**
+    @return whether the lock queue of a table may be accessed by the
+    current thread: the latch is held in exclusive mode, or in shared mode
+    together with dict_table_t::lock_mutex
+  */
+  bool table_locked(const dict_table_t *table);
+#endif /* UNIV_DEBUG */
 };
 
 /*********************************************************************//**
@@ -880,7 +961,8 @@ lock_rec_create_low(
 	trx_t*		trx,
 	bool		holds_trx_mutex);
 /** Enqueue a waiting request for a lock which cannot be granted immediately.
-Check for deadlocks.
+Deadlocks will be checked for by lock_wait_check_deadlock() before the
+thread is suspended.
 @param[in]	type_mode	the requested lock mode (LOCK_S or LOCK_X)
 				possibly ORed with LOCK_GAP or
 				LOCK_REC_NOT_GAP, ORed with
@@ -894,9 +976,8 @@ Check for deadlocks.
 @param[in,out]	thr		query thread
 @param[in]	prdt		minimum bounding box (spatial index)
 @retval	DB_LOCK_WAIT		if the waiting lock was enqueued
-@retval	DB_DEADLOCK		if this transaction was chosen as the victim
-@retval	DB_SUCCESS_LOCKED_REC	if the other transaction was chosen as a victim
-				(or it happened to commit) */
+@retval	DB_LOCK_WAIT_TIMEOUT	if innodb_lock_wait_timeout=0
+@retval	DB_SUCCESS_LOCKED_REC	if the conflicting lock was cancelled */
 dberr_t
 lock_rec_enqueue_waiting(
 #ifdef WITH_WSREP
@@ -933,23 +1014,29 @@ lock_rec_free_all_from_discard_page(
 /** The lock system */
 extern lock_sys_t lock_sys;
 
-/** Test if lock_sys.mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() 		\
-	(lock_sys.mutex.trylock(__FILE__, __LINE__))
+/** Test if lock_sys.latch can be acquired in exclusive mode without
+waiting.
+@return nonzero if it could not be acquired */
+#define lock_mutex_enter_nowait()			\
+	(!rw_lock_x_lock_nowait(&lock_sys.latch))
 
-/** Test if lock_sys.mutex is owned. */
-#define lock_mutex_own() (lock_sys.mutex.is_owned())
+/** Test if lock_sys.latch is owned in exclusive mode. */
+#define lock_mutex_own() rw_lock_own(&lock_sys.latch, RW_LOCK_X)
 
-/** Acquire the lock_sys.mutex. */
+/** Acquire lock_sys.latch in exclusive mode. */
 #define lock_mutex_enter() do {			\
-	mutex_enter(&lock_sys.mutex);		\
+	rw_lock_x_lock(&lock_sys.latch);	\
 } while (0)
 
-/** Release the lock_sys.mutex. */
+/** Release lock_sys.latch from exclusive mode. */
 #define lock_mutex_exit() do {			\
-	lock_sys.mutex.exit();			\
+	rw_lock_x_unlock(&lock_sys.latch);	\
 } while (0)
 
+/** Test if the record lock queue of a page may be accessed. */
+#define lock_rec_page_own(space, page_no)	\
+	lock_sys.page_locked(space, page_no)
+
 /** Test if lock_sys.wait_mutex is owned. */
 #define lock_wait_mutex_own() (lock_sys.wait_mutex.is_owned())
 
@@ -52,6 +52,9 @@ row_mysql_prebuilt_free_blob_heap(
 /*==============================*/
 	row_prebuilt_t*	prebuilt);	/*!< in: prebuilt struct of a
 					ha_innobase:: table handle */
+/** Free the fetch cache of a table handle.
+@param[in,out]	prebuilt	prebuilt struct of a ha_innobase:: handle */
+void row_mysql_prebuilt_free_fetch_cache(row_prebuilt_t* prebuilt);
 /*******************************************************************//**
 Stores a >= 5.0.3 format true VARCHAR length to dest, in the MySQL row
 format.
@@ -562,7 +565,13 @@ struct mysql_row_templ_t {
 	ulint	is_virtual;		/*!< if a column is a virtual column */
 };
 
+/* Initial number of rows in fetch_cache. The depth is doubled every
+time the cache is filled up, until MYSQL_FETCH_CACHE_MAX_SIZE rows or
+innodb_fetch_cache_size bytes are reached, and it is reset to this
+value whenever the cursor is positioned anew. */
 #define MYSQL_FETCH_CACHE_SIZE		8
+/* Upper bound for the fetch_cache depth */
+#define MYSQL_FETCH_CACHE_MAX_SIZE	1024
 /* After fetching this many rows, we start caching them in fetch_cache */
 #define MYSQL_FETCH_CACHE_THRESHOLD	4
 
@@ -737,7 +746,7 @@ struct row_prebuilt_t {
 	ulint		n_rows_fetched;	/*!< number of rows fetched after
 					positioning the current cursor */
 	ulint		fetch_direction;/*!< ROW_SEL_NEXT or ROW_SEL_PREV */
-	byte*		fetch_cache[MYSQL_FETCH_CACHE_SIZE];
+	byte**		fetch_cache;
 					/*!< a cache for fetched rows if we
 					fetch many rows from the same cursor:
 					it saves CPU time to fetch them in a
@@ -747,6 +756,12 @@ struct row_prebuilt_t {
 					allocated mem buf start, because
 					there is a 4 byte magic number at the
 					start and at the end */
+	ulint		fetch_cache_size;/*!< number of row buffers
+					allocated in fetch_cache */
+	ulint		fetch_cache_depth;/*!< number of rows to prefetch
+					into fetch_cache at a time; grows
+					during long scans, see
+					MYSQL_FETCH_CACHE_SIZE */
 	bool		keep_other_fields_on_keyread; /*!< when using fetch
 					cache with HA_EXTRA_KEYREAD, don't
 					overwrite other fields in mysql row
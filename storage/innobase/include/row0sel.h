@@ -194,6 +194,20 @@ row_search_mvcc(
 	ulint		direction)
 	MY_ATTRIBUTE((warn_unused_result));
 
+/** Pop rows from the prefetch cache of a forward scan that was
+started with row_search_mvcc().
+@param[out]	buf		buffer for the rows in MySQL format
+@param[in]	rec_len		distance between the rows in buf
+@param[in]	max_rows	maximum number of rows to pop
+@param[in,out]	prebuilt	prebuilt struct for the table handle
+@return number of rows that were copied to buf */
+ulint
+row_sel_dequeue_cached_rows_for_mysql(
+	byte*		buf,
+	ulint		rec_len,
+	ulint		max_rows,
+	row_prebuilt_t*	prebuilt);
+
 /********************************************************************//**
 Count rows in a R-Tree leaf level.
 @return DB_SUCCESS if successful */
@@ -218,6 +232,41 @@ ib_uint64_t
 row_search_max_autoinc(dict_index_t* index)
 	MY_ATTRIBUTE((nonnull, warn_unused_result));
 
+/** A sampled scan of a clustered index, see row_sample_start() */
+struct row_sample_t;
+
+/** Start a sampled scan of the clustered index, for collecting statistics.
+The leaf level is divided into ranges at the node pointers of the root page,
+and the ranges are read by up to n_readers tasks of srv_thread_pool. Only
+the records of the leaf pages (or of the rows) that are taken into the
+sample are converted to the MySQL format.
+@param[in,out]	prebuilt	table handle with a non-locking read view
+				and a template for the clustered index
+@param[in]	fraction	probability of taking a page or a row
+@param[in]	pages		whether to take whole leaf pages
+@param[in]	n_readers	maximum number of concurrent readers
+@return the scan, to be freed by row_sample_end() */
+row_sample_t*
+row_sample_start(
+	row_prebuilt_t*	prebuilt,
+	double		fraction,
+	bool		pages,
+	ulint		n_readers);
+
+/** Fetch the next row of a sampled scan. The rows of different ranges
+are returned in no particular order.
+@param[in,out]	sample	sampled scan
+@param[out]	buf	row in the MySQL format; any BLOB data is valid
+			until the next call
+@return DB_SUCCESS, DB_END_OF_INDEX, or error code */
+dberr_t
+row_sample_next(row_sample_t* sample, byte* buf);
+
+/** Stop a sampled scan and free it.
+@param[in,out]	sample	sampled scan */
+void
+row_sample_end(row_sample_t* sample);
+
 /** A structure for caching column values for prefetched rows */
 struct sel_buf_t{
 	byte*		data;	/*!< data, or NULL; if not NULL, this field
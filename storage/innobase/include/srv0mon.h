@@ -311,6 +311,9 @@ enum monitor_id_t {
 	MONITOR_N_UPD_EXIST_EXTERN,
 	MONITOR_PURGE_INVOKED,
 	MONITOR_PURGE_N_PAGE_HANDLED,
+	MONITOR_PURGE_N_REC_READ,
+	MONITOR_PURGE_N_READERS,
+	MONITOR_PURGE_WORKER_MAX_RECS,
 	MONITOR_DML_PURGE_DELAY,
 	MONITOR_PURGE_STOP_COUNT,
 	MONITOR_PURGE_RESUME_COUNT,
@@ -372,6 +375,8 @@ enum monitor_id_t {
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVED,
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVE_NOT_FOUND,
 	MONITOR_ADAPTIVE_HASH_ROW_UPDATED,
+	MONITOR_ADAPTIVE_HASH_SEARCH_RETRY,
+	MONITOR_ADAPTIVE_HASH_INDEX_OFF,
 #endif /* BTR_CUR_HASH_ADAPT */
 
 	/* Tablespace related counters */
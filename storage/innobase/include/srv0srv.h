@@ -261,7 +261,19 @@ OS (provided we compiled Innobase with it in), otherwise we will
 use simulated aio.
 Currently we support native aio on windows and linux */
 extern my_bool	srv_use_native_aio;
+#ifdef __linux__
+/** Alternatives for innodb_linux_aio */
+enum srv_linux_aio_t {
+	SRV_LINUX_AIO_AUTO,	/*!< io_uring if available, else libaio */
+	SRV_LINUX_AIO_IO_URING,	/*!< io_uring */
+	SRV_LINUX_AIO_LIBAIO	/*!< libaio */
+};
+/** innodb_linux_aio: which native AIO interface to use */
+extern ulong	srv_linux_aio;
+#endif
 extern my_bool	srv_numa_interleave;
+/** innodb_numa_node_local: bind buffer pool chunks to NUMA nodes */
+extern my_bool	srv_numa_node_local;
 
 /* Use atomic writes i.e disable doublewrite buffer */
 extern my_bool srv_use_atomic_writes;
@@ -356,6 +368,8 @@ extern ulong		srv_buf_pool_chunk_unit;
 extern ulong	srv_n_page_hash_locks;
 /** Scan depth for LRU flush batch i.e.: number of blocks scanned*/
 extern ulong	srv_LRU_scan_depth;
+/** innodb_page_cleaners: number of page cleaner workers */
+extern ulong	srv_n_page_cleaners;
 /** Whether or not to flush neighbors of a block */
 extern ulong	srv_flush_neighbors;
 /** Previously requested size */
@@ -376,8 +390,12 @@ extern ulint	srv_lock_table_size;
 extern ulint	srv_n_file_io_threads;
 extern my_bool	srv_random_read_ahead;
 extern ulong	srv_read_ahead_threshold;
+/** innodb_fetch_cache_size */
+extern ulong	srv_fetch_cache_size;
 extern ulong	srv_n_read_io_threads;
 extern ulong	srv_n_write_io_threads;
+/** innodb_recovery_apply_threads */
+extern ulong	srv_recovery_apply_threads;
 
 /* Defragmentation, Origianlly facebook default value is 100, but it's too high */
 #define SRV_DEFRAGMENT_FREQUENCY_DEFAULT 40
@@ -720,7 +738,7 @@ srv_printf_innodb_monitor(
 /*======================*/
 	FILE*	file,		/*!< in: output stream */
 	ibool	nowait,		/*!< in: whether to wait for the
-				lock_sys_t::mutex */
+				lock_sys_t::latch */
 	ulint*	trx_start,	/*!< out: file position of the start of
 				the list of active transactions */
 	ulint*	trx_end);	/*!< out: file position of the end of
@@ -825,6 +843,8 @@ struct export_var_t{
 	ulint innodb_buffer_pool_pages_free;	/*!< Free pages */
 #ifdef UNIV_DEBUG
 	ulint innodb_buffer_pool_pages_latched;	/*!< Latched pages */
+	ulint innodb_buffer_pool_numa_local;	/*!< buf_pool.stat.n_numa_local */
+	ulint innodb_buffer_pool_numa_remote;	/*!< buf_pool.stat.n_numa_remote */
 #endif /* UNIV_DEBUG */
 	ulint innodb_buffer_pool_pages_made_not_young;
 	ulint innodb_buffer_pool_pages_made_young;
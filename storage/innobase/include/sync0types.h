@@ -144,9 +144,13 @@ V
 lock_sys_wait_mutex			Mutex protecting lock timeout data
 |
 V
-lock_sys_mutex				Mutex protecting lock_sys_t
+lock_sys_latch				Rw-lock protecting lock_sys_t
 |
 V
+lock_sys_shard_mutex			Mutex protecting a partition of
+|					the record lock hash tables, while
+|					lock_sys_latch is held in S mode
+V
 trx_sys.mutex				Mutex protecting trx_sys_t
 |
 V
@@ -222,6 +226,8 @@ enum latch_level_t {
 	SYNC_TRX,
 	SYNC_RW_TRX_HASH_ELEMENT,
 	SYNC_TRX_SYS,
+	SYNC_LOCK_SYS_SHARD,
+	SYNC_LOCK_SYS_DEADLOCK,
 	SYNC_LOCK_SYS,
 	SYNC_LOCK_WAIT_SYS,
 
@@ -327,7 +333,9 @@ enum latch_id_t {
 	LATCH_ID_TRX_POOL,
 	LATCH_ID_TRX_POOL_MANAGER,
 	LATCH_ID_TRX,
-	LATCH_ID_LOCK_SYS,
+	LATCH_ID_LOCK_SYS_SHARD,
+	LATCH_ID_LOCK_SYS_TABLE,
+	LATCH_ID_LOCK_SYS_DEADLOCK,
 	LATCH_ID_LOCK_SYS_WAIT,
 	LATCH_ID_TRX_SYS,
 	LATCH_ID_SRV_SYS,
@@ -354,6 +362,7 @@ enum latch_id_t {
 	LATCH_ID_FTS_CACHE,
 	LATCH_ID_FTS_CACHE_INIT,
 	LATCH_ID_TRX_I_S_CACHE,
+	LATCH_ID_LOCK_SYS,
 	LATCH_ID_TRX_PURGE,
 	LATCH_ID_IBUF_INDEX_TREE,
 	LATCH_ID_INDEX_TREE,
@@ -102,25 +102,8 @@ typedef std::priority_queue<
 	std::vector<TrxUndoRsegs, ut_allocator<TrxUndoRsegs> >,
 	TrxUndoRsegs>	purge_pq_t;
 
-/** Chooses the rollback segment with the oldest committed transaction */
-struct TrxUndoRsegsIterator {
-	/** Constructor */
-	TrxUndoRsegsIterator();
-	/** Sets the next rseg to purge in purge_sys.
-	Executed in the purge coordinator thread.
-	@return whether anything is to be purged */
-	inline bool set_next();
-
-private:
-	// Disable copying
-	TrxUndoRsegsIterator(const TrxUndoRsegsIterator&);
-	TrxUndoRsegsIterator& operator=(const TrxUndoRsegsIterator&);
-
-	/** The current element to process */
-	TrxUndoRsegs			m_rsegs;
-	/** Track the current element in m_rsegs */
-	TrxUndoRsegs::const_iterator	m_iter;
-};
+/** Undo log reader of a purge batch, see trx_purge_attach_undo_recs() */
+struct purge_reader_t;
 
 /** The control structure used in the purge operation */
 class purge_sys_t
@@ -162,31 +145,11 @@ class purge_sys_t
 		undo_no_t	undo_no;
 	};
 
-	/** The tail of the purge queue; the last parsed undo log of a
-	committed transaction. */
-	iterator	tail;
 	/** The head of the purge queue; any older undo logs of committed
-	transactions may be discarded (history list truncation). */
+	transactions may be discarded (history list truncation). This is
+	the oldest position that the last purge batch did not purge in
+	any rollback segment. */
 	iterator	head;
-	/*-----------------------------*/
-	bool		next_stored;	/*!< whether rseg holds the next record
-					to purge */
-	trx_rseg_t*	rseg;		/*!< Rollback segment for the next undo
-					record to purge */
-	uint32_t	page_no;	/*!< Page number for the next undo
-					record to purge, page number of the
-					log header, if dummy record */
-	uint32_t	hdr_page_no;	/*!< Header page of the undo log where
-					the next record to purge belongs */
-	uint16_t	offset;		/*!< Page offset for the next undo
-					record to purge, 0 if the dummy
-					record */
-	uint16_t	hdr_offset;	/*!< Header byte offset on the page */
-
-
-	TrxUndoRsegsIterator
-			rseg_iter;	/*!< Iterator to get the next rseg
-					to process */
 
 	purge_pq_t	purge_queue;	/*!< Binary min-heap, ordered on
 					TrxUndoRsegs::trx_no. It is protected
@@ -202,8 +165,8 @@ class purge_sys_t
 		fil_space_t*	last;
 	} truncate;
 
-	/** Heap for reading the undo log records */
-	mem_heap_t*	heap;
+	/** Undo log readers, one for each purge thread */
+	purge_reader_t*	readers;
   /**
     Constructor.
 
@@ -211,7 +174,7 @@ class purge_sys_t
     uninitialised. Real initialisation happens in create().
   */
 
-  purge_sys_t(): m_enabled(false), heap(nullptr) {}
+  purge_sys_t(): m_enabled(false), readers(nullptr) {}
 
   /** Create the instance */
   void create();
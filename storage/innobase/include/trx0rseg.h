@@ -138,6 +138,18 @@ struct trx_rseg_t {
 	/** Whether the log segment needs purge */
 	bool				needs_purge;
 
+	/** Page number of the next undo record to purge in the last not
+	yet purged log; FIL_NULL if the reading of the log has not started.
+	Like purge_offset and purge_undo_no, only accessed by purge while the
+	rollback segment is not in purge_sys.purge_queue. */
+	uint32_t			purge_page_no;
+
+	/** Byte offset of the next undo record to purge */
+	uint16_t			purge_offset;
+
+	/** Undo number of the next undo record to purge */
+	undo_no_t			purge_undo_no;
+
 	/** Reference counter to track rseg allocated transactions. */
 	ulint				trx_ref_count;
 
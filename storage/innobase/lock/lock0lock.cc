@@ -41,6 +41,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "row0sel.h"
 #include "row0mysql.h"
 #include "row0vers.h"
+#include "sync0sync.h"
 #include "pars0pars.h"
 
 #include <set>
@@ -88,16 +89,11 @@ class DeadlockChecker {
 public:
 	/** Check if a joining lock request results in a deadlock.
 	If a deadlock is found, we will resolve the deadlock by
-	choosing a victim transaction and rolling it back.
+	choosing a victim transaction and cancelling its lock wait.
 	We will attempt to resolve all deadlocks.
 
-	@param[in]	lock	the lock request
-	@param[in,out]	trx	transaction requesting the lock
-
-	@return trx if it was chosen as victim
-	@retval	NULL if another victim was chosen,
-	or there is no deadlock (any more) */
-	static const trx_t* check_and_resolve(const lock_t* lock, trx_t* trx);
+	@param[in,out]	trx	transaction waiting for trx->lock.wait_lock */
+	static void check_and_resolve(trx_t* trx);
 
 private:
 	/** Do a shallow copy. Default destructor OK.
@@ -211,8 +207,26 @@ class DeadlockChecker {
 	@return victim transaction */
 	const trx_t* select_victim() const;
 
-	/** Rollback transaction selected as the victim. */
-	void trx_rollback();
+	/** Cancel the lock wait of the transaction selected as the victim.
+	@param[in,out]	victim		victim transaction
+	@param[in]	wait_lock	the lock that victim was waiting for
+	@param[in]	trx		the transaction that found the deadlock */
+	static void cancel_wait(trx_t* victim, const lock_t* wait_lock,
+				const trx_t* trx);
+
+	/** @return the mutex protecting a lock queue while
+	lock_sys.latch is being held in shared mode
+	@param[in]	lock	record or table lock in the queue */
+	static LockMutex& queue_mutex(const lock_t* lock)
+	{
+		if (lock_get_type_low(lock) == LOCK_REC) {
+			return lock_sys.shard_mutex(lock_rec_hash(
+				lock->un_member.rec_lock.space,
+				lock->un_member.rec_lock.page_no));
+		}
+
+		return lock->un_member.tab_lock.table->lock_mutex;
+	}
 
 	/** Looks iteratively for a deadlock. Note: the joining transaction
 	may have been granted its lock by the deadlock checks.
@@ -251,7 +265,8 @@ class DeadlockChecker {
 		ulint		m_heap_no;	/*!< heap number if rec lock */
 	};
 
-	/** Used in deadlock tracking. Protected by lock_sys.mutex. */
+	/** Used in deadlock tracking.
+	Protected by lock_sys.deadlock_mutex. */
 	static ib_uint64_t	s_lock_mark_counter;
 
 	/** Calculation steps thus far. It is the count of the nodes visited. */
@@ -273,7 +288,8 @@ class DeadlockChecker {
 	/** Number of states pushed onto the stack */
 	size_t			m_n_elems;
 
-	/** This is to avoid malloc/free calls. */
+	/** This is to avoid malloc/free calls.
+	Protected by lock_sys.deadlock_mutex. */
 	static state_t		s_states[MAX_STACK_SIZE];
 
 	/** Set if thd_rpl_deadlock_check() should be called for waits. */
@@ -310,10 +326,13 @@ lock_rec_validate_page(
 lock_sys_t lock_sys;
 
 /** We store info on the latest deadlock error to this buffer. InnoDB
-Monitor will then fetch it and print */
+Monitor will then fetch it and print. Written while holding
+lock_sys.deadlock_mutex, read while holding lock_sys.latch in
+exclusive mode. */
 static bool	lock_deadlock_found = false;
 
-/** Only created if !srv_read_only_mode */
+/** Only created if !srv_read_only_mode. Protected like
+lock_deadlock_found. */
 static FILE*		lock_latest_err_file;
 
 /*********************************************************************//**
@@ -457,7 +476,13 @@ void lock_sys_t::create(ulint n_cells)
 		(ut_zalloc_nokey(srv_max_n_threads * sizeof *waiting_threads));
 	last_slot = waiting_threads;
 
-	mutex_create(LATCH_ID_LOCK_SYS, &mutex);
+	rw_lock_create(lock_sys_latch_key, &latch, SYNC_LOCK_SYS);
+
+	for (ulint i = 0; i < N_SHARDS; i++) {
+		mutex_create(LATCH_ID_LOCK_SYS_SHARD, &shards[i].mutex);
+	}
+
+	mutex_create(LATCH_ID_LOCK_SYS_DEADLOCK, &deadlock_mutex);
 
 	mutex_create(LATCH_ID_LOCK_SYS_WAIT, &wait_mutex);
 
@@ -473,6 +498,35 @@ void lock_sys_t::create(ulint n_cells)
 	timeout_timer_active = false;
 }
 
+#ifdef UNIV_DEBUG
+/**
+  @return whether the record lock queue of a page may be accessed by the
+  current thread
+*/
+bool lock_sys_t::page_locked(ulint space, ulint page_no)
+{
+	if (rw_lock_own(&latch, RW_LOCK_X)) {
+		return true;
+	}
+
+	return rw_lock_own(&latch, RW_LOCK_S)
+		&& shard_mutex(lock_rec_hash(space, page_no)).is_owned();
+}
+
+/**
+  @return whether the lock queue of a table may be accessed by the
+  current thread
+*/
+bool lock_sys_t::table_locked(const dict_table_t *table)
+{
+	if (rw_lock_own(&latch, RW_LOCK_X)) {
+		return true;
+	}
+
+	return rw_lock_own(&latch, RW_LOCK_S) && table->lock_mutex.is_owned();
+}
+#endif /* UNIV_DEBUG */
+
 /** Calculates the fold value of a lock: used in migrating the hash table.
 @param[in]	lock	record lock object
 @return	folded value */
@@ -495,7 +549,7 @@ void lock_sys_t::resize(ulint n_cells)
 {
 	ut_ad(this == &lock_sys);
 
-	mutex_enter(&mutex);
+	lock_mutex_enter();
 
 	hash_table_t* old_hash = rec_hash;
 	rec_hash = hash_create(n_cells);
@@ -528,7 +582,7 @@ void lock_sys_t::resize(ulint n_cells)
 		}
 	}
 	mutex_exit(&buf_pool.mutex);
-	mutex_exit(&mutex);
+	lock_mutex_exit();
 }
 
 
@@ -548,7 +602,11 @@ void lock_sys_t::close()
 	hash_table_free(prdt_hash);
 	hash_table_free(prdt_page_hash);
 
-	mutex_destroy(&mutex);
+	rw_lock_free(&latch);
+	for (ulint i = 0; i < N_SHARDS; i++) {
+		mutex_destroy(&shards[i].mutex);
+	}
+	mutex_destroy(&deadlock_mutex);
 	mutex_destroy(&wait_mutex);
 
 	for (ulint i = srv_max_n_threads; i--; ) {
@@ -985,7 +1043,8 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(block->page.id.space(),
+				block->page.id.page_no()));
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1034,7 +1093,8 @@ lock_rec_other_has_expl_req(
 					are taken into account */
 {
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(block->page.id.space(),
+				block->page.id.page_no()));
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 
 	/* Only GAP lock can be on SUPREMUM, and we are not looking for
@@ -1147,7 +1207,8 @@ lock_rec_other_has_conflicting(
 {
 	lock_t*		lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(block->page.id.space(),
+				block->page.id.page_no()));
 
 	bool	is_supremum = (heap_no == PAGE_HEAP_NO_SUPREMUM);
 
@@ -1228,20 +1289,21 @@ lock_sec_rec_some_has_impl(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys.mutex. */
+The caller must be holding lock_sys.latch. */
 ulint
 lock_number_of_rows_locked(
 /*=======================*/
 	const trx_lock_t*	trx_lock)	/*!< in: transaction locks */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(rw_lock_own_flagged(&lock_sys.latch,
+				  RW_LOCK_FLAG_X | RW_LOCK_FLAG_S));
 
 	return(trx_lock->n_rec_locks);
 }
 
 /*********************************************************************//**
 Return the number of table locks for a transaction.
-The caller must be holding lock_sys.mutex. */
+The caller must be holding lock_sys.latch. */
 ulint
 lock_number_of_tables_locked(
 /*=========================*/
@@ -1326,7 +1388,7 @@ lock_rec_create_low(
 	ulint		n_bits;
 	ulint		n_bytes;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(space, page_no));
 	ut_ad(holds_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1488,8 +1550,9 @@ lock_rec_create_low(
 	if (!holds_trx_mutex) {
 		trx_mutex_exit(trx);
 	}
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	/* We may be holding lock_sys.latch in shared mode only. */
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 
 	return lock;
 }
@@ -1640,7 +1703,8 @@ lock_rec_insert_to_head(
 }
 
 /** Enqueue a waiting request for a lock which cannot be granted immediately.
-Check for deadlocks.
+Deadlocks will be checked for by lock_wait_check_deadlock() before the
+thread is suspended.
 @param[in]	type_mode	the requested lock mode (LOCK_S or LOCK_X)
 				possibly ORed with LOCK_GAP or
 				LOCK_REC_NOT_GAP, ORed with
@@ -1654,9 +1718,8 @@ Check for deadlocks.
 @param[in,out]	thr		query thread
 @param[in]	prdt		minimum bounding box (spatial index)
 @retval	DB_LOCK_WAIT		if the waiting lock was enqueued
-@retval	DB_DEADLOCK		if this transaction was chosen as the victim
-@retval	DB_SUCCESS_LOCKED_REC	if the other transaction was chosen as a victim
-				(or it happened to commit) */
+@retval	DB_LOCK_WAIT_TIMEOUT	if innodb_lock_wait_timeout=0
+@retval	DB_SUCCESS_LOCKED_REC	if the conflicting lock was cancelled */
 dberr_t
 lock_rec_enqueue_waiting(
 #ifdef WITH_WSREP
@@ -1709,17 +1772,9 @@ lock_rec_enqueue_waiting(
 		lock_prdt_set_prdt(lock, prdt);
 	}
 
-	if (ut_d(const trx_t* victim =)
-	    DeadlockChecker::check_and_resolve(lock, trx)) {
-		ut_ad(victim == trx);
-		lock_reset_lock_and_trx_wait(lock);
-		lock_rec_reset_nth_bit(lock, heap_no);
-		return DB_DEADLOCK;
-	}
-
 	if (!trx->lock.wait_lock) {
-		/* If there was a deadlock but we chose another
-		transaction as a victim, it is possible that we
+		/* If the conflicting lock was cancelled by a
+		brute force transaction, it is possible that we
 		already have the lock now granted! */
 #ifdef WITH_WSREP
 		if (wsrep_debug) {
@@ -1783,7 +1838,8 @@ lock_rec_add_to_queue(
 					transaction mutex */
 {
 #ifdef UNIV_DEBUG
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(block->page.id.space(),
+				block->page.id.page_no()));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index)
 	      || dict_index_get_online_status(index) != ONLINE_INDEX_CREATION);
@@ -1887,6 +1943,85 @@ lock_rec_add_to_queue(
 		type_mode, block, heap_no, index, trx, caller_owns_trx_mutex);
 }
 
+/** Try to lock a record without waiting, holding only the latch partition
+of the page (lock_sys.latch in shared mode). Lock requests that conflict
+with other transactions must be enqueued as waiting and checked for
+deadlocks, which needs the exclusive lock_sys.latch; in that case nothing
+is done here.
+@param[in]	impl	if true, no lock is set if no wait is necessary
+@param[in]	mode	lock mode: LOCK_X or LOCK_S possibly ORed to either
+			LOCK_GAP or LOCK_REC_NOT_GAP
+@param[in]	block	buffer block containing the record
+@param[in]	heap_no	heap number of the record
+@param[in]	index	index of the record
+@param[in,out]	trx	transaction
+@param[out]	err	DB_SUCCESS or DB_SUCCESS_LOCKED_REC
+@return whether the request was handled */
+static
+bool
+lock_rec_lock_try(
+	bool			impl,
+	unsigned		mode,
+	const buf_block_t*	block,
+	ulint			heap_no,
+	dict_index_t*		index,
+	trx_t*			trx,
+	dberr_t*		err)
+{
+#ifdef WITH_WSREP
+	/* Conflicts may have to be resolved by killing the other
+	transaction, which needs the exclusive lock_sys.latch. */
+	if (wsrep_on_trx(trx)) {
+		return false;
+	}
+#endif /* WITH_WSREP */
+
+	bool	handled = true;
+
+	*err = DB_SUCCESS;
+
+	lock_sys.page_lock(block);
+
+	if (lock_table_has(trx, index->table,
+			   static_cast<lock_mode>(LOCK_MODE_MASK & mode))) {
+	} else if (lock_t* lock = lock_rec_get_first_on_page(
+			   lock_sys.rec_hash, block)) {
+		trx_mutex_enter(trx);
+		if (lock_rec_get_next_on_page(lock)
+		    || lock->trx != trx
+		    || lock->type_mode != (ulint(mode) | LOCK_REC)
+		    || lock_rec_get_n_bits(lock) <= heap_no) {
+			if (lock_rec_has_expl(mode, block, heap_no, trx)) {
+			} else if (lock_rec_other_has_conflicting(
+					   mode, block, heap_no, trx)) {
+				handled = false;
+			} else if (!impl) {
+				lock_rec_add_to_queue(LOCK_REC | mode, block,
+						      heap_no, index, trx,
+						      true);
+				*err = DB_SUCCESS_LOCKED_REC;
+			}
+		} else if (!impl && !lock_rec_get_nth_bit(lock, heap_no)) {
+			lock_rec_set_nth_bit(lock, heap_no);
+			*err = DB_SUCCESS_LOCKED_REC;
+		}
+		trx_mutex_exit(trx);
+	} else {
+		if (!impl) {
+			lock_rec_create(
+#ifdef WITH_WSREP
+				NULL, NULL,
+#endif
+				mode, block, heap_no, index, trx, false);
+		}
+		*err = DB_SUCCESS_LOCKED_REC;
+	}
+
+	lock_sys.page_unlock(block);
+
+	return handled;
+}
+
 /*********************************************************************//**
 Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
@@ -1923,6 +2058,17 @@ lock_rec_lock(
   ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
   DBUG_EXECUTE_IF("innodb_report_deadlock", return DB_DEADLOCK;);
 
+  if (lock_rec_lock_try(impl, mode, block, heap_no, index, trx, &err))
+  {
+    MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
+    return err;
+  }
+
+  /*
+    The request conflicts with another transaction. Repeat it under
+    the exclusive lock_sys.latch, so that it can be enqueued and
+    checked for deadlocks. The lock queue may have changed meanwhile.
+  */
   lock_mutex_enter();
   ut_ad((LOCK_MODE_MASK & mode) != LOCK_S ||
         lock_table_has(trx, index->table, LOCK_IS));
@@ -3462,7 +3608,7 @@ lock_table_create(
 	lock_t*		lock;
 
 	ut_ad(table && trx);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.table_locked(table));
 	ut_ad(trx_mutex_own(trx));
 
 	check_trx_state(trx);
@@ -3554,8 +3700,9 @@ lock_table_create(
 
 	lock->trx->lock.table_locks.push_back(lock);
 
-	MONITOR_INC(MONITOR_TABLELOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_TABLELOCK);
+	/* We may be holding lock_sys.latch in shared mode only. */
+	MONITOR_ATOMIC_INC(MONITOR_TABLELOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_TABLELOCK);
 
 	return(lock);
 }
@@ -3693,10 +3840,10 @@ lock_table_remove_low(
 
 /*********************************************************************//**
 Enqueues a waiting request for a table lock which cannot be granted
-immediately. Checks for deadlocks.
+immediately. Deadlocks will be checked for by lock_wait_check_deadlock()
+before the thread is suspended.
 @retval	DB_LOCK_WAIT	if the waiting lock was enqueued
-@retval	DB_DEADLOCK	if this transaction was chosen as the victim
-@retval	DB_SUCCESS	if the other transaction committed or aborted */
+@retval	DB_DEADLOCK	if this transaction was chosen as the victim */
 static
 dberr_t
 lock_table_enqueue_waiting(
@@ -3744,25 +3891,7 @@ lock_table_enqueue_waiting(
 #endif
 				 );
 
-	const trx_t*	victim_trx =
-		DeadlockChecker::check_and_resolve(lock, trx);
-
-	if (victim_trx != 0) {
-		ut_ad(victim_trx == trx);
-
-		/* The order here is important, we don't want to
-		lose the state of the lock before calling remove. */
-		lock_table_remove_low(lock);
-		lock_reset_lock_and_trx_wait(lock);
-
-		return(DB_DEADLOCK);
-
-	} else if (trx->lock.wait_lock == NULL) {
-		/* Deadlock resolution chose another transaction as a victim,
-		and we accidentally got our lock granted! */
-
-		return(DB_SUCCESS);
-	}
+	ut_ad(trx->lock.wait_lock == lock);
 
 	trx->lock.que_state = TRX_QUE_LOCK_WAIT;
 
@@ -3794,7 +3923,7 @@ lock_table_other_has_incompatible(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.table_locked(table));
 
 	for (lock = UT_LIST_GET_LAST(table->locks);
 	     lock != NULL;
@@ -3825,6 +3954,45 @@ lock_table_other_has_incompatible(
 	return(NULL);
 }
 
+/** Try to acquire a table lock that does not have to wait, while holding
+lock_sys.latch in shared mode.
+@param[in,out]	table	table
+@param[in]	mode	lock mode
+@param[in,out]	trx	transaction
+@return whether the lock was granted */
+static
+bool
+lock_table_lock_try(dict_table_t* table, lock_mode mode, trx_t* trx)
+{
+#ifdef WITH_WSREP
+	/* Conflicts may have to be resolved by killing the other
+	transaction, which needs the exclusive lock_sys.latch. */
+	if (wsrep_on_trx(trx)) {
+		return false;
+	}
+#endif /* WITH_WSREP */
+
+	rw_lock_s_lock(&lock_sys.latch);
+	mutex_enter(&table->lock_mutex);
+
+	/* Waiting locks can only be enqueued, granted or cancelled
+	while holding the exclusive latch. A granted lock that is
+	appended after all waiting locks does not block any of them. */
+	const bool granted = !lock_table_other_has_incompatible(
+		trx, LOCK_WAIT, table, mode);
+
+	if (granted) {
+		trx_mutex_enter(trx);
+		lock_table_create(table, mode, trx);
+		trx_mutex_exit(trx);
+	}
+
+	mutex_exit(&table->lock_mutex);
+	rw_lock_s_unlock(&lock_sys.latch);
+
+	return granted;
+}
+
 /*********************************************************************//**
 Locks the specified database table in the mode given. If the lock cannot
 be granted immediately, the query thread is put to wait.
@@ -3880,6 +4048,15 @@ lock_table(
 		trx_set_rw_mode(trx);
 	}
 
+	bool	try_shared = true;
+
+	/* Keep holding the exclusive latch while sleeping. */
+	DBUG_EXECUTE_IF("fatal-semaphore-timeout", try_shared = false;);
+
+	if (try_shared && lock_table_lock_try(table, mode, trx)) {
+		return(DB_SUCCESS);
+	}
+
 	lock_mutex_enter();
 
 	DBUG_EXECUTE_IF("fatal-semaphore-timeout",
@@ -4368,7 +4545,9 @@ static
 void
 lock_table_print(FILE* file, const lock_t* lock)
 {
-	ut_ad(lock_mutex_own());
+	/* Deadlock reporting holds lock_sys.latch in shared mode only. */
+	ut_ad(rw_lock_own_flagged(&lock_sys.latch,
+				  RW_LOCK_FLAG_X | RW_LOCK_FLAG_S));
 	ut_a(lock_get_type_low(lock) == LOCK_TABLE);
 
 	fputs("TABLE LOCK table ", file);
@@ -4409,7 +4588,9 @@ static void lock_rec_print(FILE* file, const lock_t* lock, mtr_t& mtr)
 	ulint			space;
 	ulint			page_no;
 
-	ut_ad(lock_mutex_own());
+	/* Deadlock reporting holds lock_sys.latch in shared mode only. */
+	ut_ad(rw_lock_own_flagged(&lock_sys.latch,
+				  RW_LOCK_FLAG_X | RW_LOCK_FLAG_S));
 	ut_a(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -4572,8 +4753,8 @@ lock_print_info_summary(
 		"Purge done for trx's n:o < " TRX_ID_FMT
 		" undo n:o < " TRX_ID_FMT " state: %s\n"
 		"History list length %u\n",
-		purge_sys.tail.trx_no(),
-		purge_sys.tail.undo_no,
+		purge_sys.head.trx_no(),
+		purge_sys.head.undo_no,
 		purge_sys.enabled()
 		? (purge_sys.running() ? "running"
 		   : purge_sys.paused() ? "stopped" : "running but idle")
@@ -4764,7 +4945,7 @@ lock_table_queue_validate(
 	     lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, lock)) {
 
 		/* lock->trx->state cannot change from or to NOT_STARTED
-		while we are holding the lock_sys.mutex. It may change
+		while we are holding the lock_sys.latch. It may change
 		from ACTIVE or PREPARED to PREPARED or COMMITTED. */
 		trx_mutex_enter(lock->trx);
 		check_trx_state(lock->trx);
@@ -5172,7 +5353,7 @@ lock_validate()
 				    (lock_validate_table_locks), 0);
 
 	/* Iterate over all the record locks and validate the locks. We
-	don't want to hog the lock_sys_t::mutex and the trx_sys_t::mutex.
+	don't want to hog the lock_sys_t::latch and the trx_sys_t::mutex.
 	Release both mutexes during the validation check. */
 
 	for (ulint i = 0; i < hash_get_n_cells(lock_sys.rec_hash); i++) {
@@ -5246,7 +5427,6 @@ lock_rec_insert_check_and_lock(
 	ulint		heap_no = page_rec_get_heap_no(next_rec);
 	ut_ad(!rec_is_metadata(next_rec, *index));
 
-	lock_mutex_enter();
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
 	to hold trx->mutex here. */
@@ -5256,13 +5436,23 @@ lock_rec_insert_check_and_lock(
 	BTR_NO_LOCKING_FLAG and skip the locking altogether. */
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX));
 
+	/* Usually there are no locks on the successor record. That can
+	be checked in the latch partition of the page. */
+	lock_sys.page_lock(block);
 	lock = lock_rec_get_first(lock_sys.rec_hash, block, heap_no);
+	lock_sys.page_unlock(block);
+
+	if (lock != NULL) {
+		lock_mutex_enter();
+		lock = lock_rec_get_first(lock_sys.rec_hash, block, heap_no);
+		if (lock == NULL) {
+			lock_mutex_exit();
+		}
+	}
 
 	if (lock == NULL) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
-
 		if (inherit_in && !dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
 			page_update_max_trx_id(block,
@@ -6372,7 +6562,7 @@ is enabled. */
 void
 DeadlockChecker::start_print()
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	rewind(lock_latest_err_file);
 	ut_print_timestamp(lock_latest_err_file);
@@ -6401,7 +6591,7 @@ DeadlockChecker::print(const char* msg)
 void
 DeadlockChecker::print(const trx_t* trx, ulint max_query_len)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	ulint	n_rec_locks = lock_number_of_rows_locked(&trx->lock);
 	ulint	n_trx_locks = UT_LIST_GET_LEN(trx->lock.trx_locks);
@@ -6421,7 +6611,7 @@ DeadlockChecker::print(const trx_t* trx, ulint max_query_len)
 void
 DeadlockChecker::print(const lock_t* lock)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	if (lock_get_type_low(lock) == LOCK_REC) {
 		mtr_t mtr;
@@ -6450,7 +6640,11 @@ Note: "next" here means PREV for table locks.
 const lock_t*
 DeadlockChecker::get_next_lock(const lock_t* lock, ulint heap_no) const
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
+
+	LockMutex&	mutex = queue_mutex(lock);
+
+	mutex_enter(&mutex);
 
 	do {
 		if (lock_get_type_low(lock) == LOCK_REC) {
@@ -6466,6 +6660,8 @@ DeadlockChecker::get_next_lock(const lock_t* lock, ulint heap_no) const
 
 	} while (lock != NULL && is_visited(lock));
 
+	mutex_exit(&mutex);
+
 	ut_ad(lock == NULL
 	      || lock_get_type_low(lock) == lock_get_type_low(m_wait_lock));
 
@@ -6490,9 +6686,12 @@ due to the way the record lock has is implemented.
 const lock_t*
 DeadlockChecker::get_first_lock(ulint* heap_no) const
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	const lock_t*	lock = m_wait_lock;
+	LockMutex&	mutex = queue_mutex(lock);
+
+	mutex_enter(&mutex);
 
 	if (lock_get_type_low(lock) == LOCK_REC) {
 		hash_table_t*	lock_hash;
@@ -6527,6 +6726,8 @@ DeadlockChecker::get_first_lock(ulint* heap_no) const
 		lock = UT_LIST_GET_FIRST(table->locks);
 	}
 
+	mutex_exit(&mutex);
+
 	/* Must find at least two locks, otherwise there cannot be a
 	waiting lock, secondly the first lock cannot be the wait_lock. */
 	ut_a(lock != NULL);
@@ -6547,7 +6748,7 @@ transaction info.
 void
 DeadlockChecker::notify(const lock_t* lock) const
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	start_print();
 
@@ -6584,7 +6785,7 @@ DeadlockChecker::notify(const lock_t* lock) const
 const trx_t*
 DeadlockChecker::select_victim() const
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 	ut_ad(m_start->lock.wait_lock != 0);
 	ut_ad(m_wait_lock->trx != m_start);
 
@@ -6614,7 +6815,7 @@ have been granted its lock by the deadlock checks.
 const trx_t*
 DeadlockChecker::search()
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 	ut_ad(!trx_mutex_own(m_start));
 
 	ut_ad(m_start != NULL);
@@ -6690,9 +6891,12 @@ DeadlockChecker::search()
 					       lock->trx->mysql_thd);
 		}
 
-		if (lock->trx->lock.que_state == TRX_QUE_LOCK_WAIT) {
+		if (lock->trx->lock.que_state == TRX_QUE_LOCK_WAIT
+		    && !lock->trx->lock.victim_wait_lock) {
 			/* Another trx ahead has requested a lock in an
-			incompatible mode, and is itself waiting for a lock. */
+			incompatible mode, and is itself waiting for a lock
+			that is not about to be cancelled because of an
+			earlier deadlock. */
 
 			++m_cost;
 
@@ -6725,7 +6929,7 @@ DeadlockChecker::search()
 void
 DeadlockChecker::rollback_print(const trx_t* trx, const lock_t* lock)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys.deadlock_mutex.is_owned());
 
 	/* If the lock search exceeds the max step
 	or the max depth, the current trx will be
@@ -6744,122 +6948,151 @@ DeadlockChecker::rollback_print(const trx_t* trx, const lock_t* lock)
 	print(lock);
 }
 
-/** Rollback transaction selected as the victim. */
+/** Cancel the lock wait of the transaction selected as the victim.
+@param[in,out]	victim		victim transaction
+@param[in]	wait_lock	the lock that victim was waiting for
+@param[in]	trx		the transaction that found the deadlock */
 void
-DeadlockChecker::trx_rollback()
+DeadlockChecker::cancel_wait(trx_t* victim, const lock_t* wait_lock,
+			     const trx_t* trx)
 {
-	ut_ad(lock_mutex_own());
-
-	trx_t*	trx = m_wait_lock->trx;
+	lock_mutex_enter();
 
-	print("*** WE ROLL BACK TRANSACTION (1)\n");
 #ifdef WITH_WSREP
-	if (wsrep_on(trx->mysql_thd) && wsrep_thd_is_SR(trx->mysql_thd)) {
-		wsrep_handle_SR_rollback(m_start->mysql_thd, trx->mysql_thd);
+	if (wsrep_on(victim->mysql_thd) && wsrep_thd_is_SR(victim->mysql_thd)) {
+		wsrep_handle_SR_rollback(trx->mysql_thd, victim->mysql_thd);
 	}
 #endif
 
-	trx_mutex_enter(trx);
+	trx_mutex_enter(victim);
 
-	trx->lock.was_chosen_as_deadlock_victim = true;
+	/* The wait may have ended while we were not holding
+	lock_sys.latch, because some other transaction in the cycle
+	was rolled back or timed out. */
+	if (victim->lock.wait_lock == wait_lock) {
+		victim->lock.was_chosen_as_deadlock_victim = true;
 
-	lock_cancel_waiting_and_release(trx->lock.wait_lock);
+		lock_cancel_waiting_and_release(victim->lock.wait_lock);
+	}
 
-	trx_mutex_exit(trx);
+	victim->lock.victim_wait_lock = NULL;
+
+	trx_mutex_exit(victim);
+
+	lock_mutex_exit();
 }
 
 /** Check if a joining lock request results in a deadlock.
 If a deadlock is found, we will resolve the deadlock by
-choosing a victim transaction and rolling it back.
+choosing a victim transaction and cancelling its lock wait.
 We will attempt to resolve all deadlocks.
 
-@param[in]	lock	the lock request
-@param[in,out]	trx	transaction requesting the lock
+The search is done while holding lock_sys.latch in shared mode, because
+lock waits can only be enqueued, granted or cancelled while holding the
+latch in exclusive mode, so that the waits-for graph cannot change.
+Concurrent searches are serialized by lock_sys.deadlock_mutex. A chosen
+victim is marked in trx_lock_t::victim_wait_lock, so that other searches
+will ignore its wait until it has been cancelled in exclusive mode.
 
-@return trx if it was chosen as victim
-@retval	NULL if another victim was chosen,
-or there is no deadlock (any more) */
-const trx_t*
-DeadlockChecker::check_and_resolve(const lock_t* lock, trx_t* trx)
+@param[in,out]	trx	transaction waiting for trx->lock.wait_lock */
+void
+DeadlockChecker::check_and_resolve(trx_t* trx)
 {
-	ut_ad(lock_mutex_own());
-	ut_ad(trx_mutex_own(trx));
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
 	check_trx_state(trx);
 	ut_ad(!srv_read_only_mode);
 
 	if (!innobase_deadlock_detect) {
-		return(NULL);
+		return;
 	}
 
-	/*  Release the mutex to obey the latching order.
-	This is safe, because DeadlockChecker::check_and_resolve()
-	is invoked when a lock wait is enqueued for the currently
-	running transaction. Because m_trx is a running transaction
-	(it is not currently suspended because of a lock wait),
-	its state can only be changed by this thread, which is
-	currently associated with the transaction. */
-
-	trx_mutex_exit(trx);
-
-	const trx_t*	victim_trx;
 	const bool	report_waiters = trx->mysql_thd
 		&& thd_need_wait_reports(trx->mysql_thd);
 
 	/* Try and resolve as many deadlocks as possible. */
-	do {
-		DeadlockChecker	checker(trx, lock, s_lock_mark_counter,
-					report_waiters);
+	for (;;) {
+		const trx_t*	victim_trx = NULL;
+		const lock_t*	victim_lock = NULL;
 
-		victim_trx = checker.search();
+		rw_lock_s_lock(&lock_sys.latch);
+		mutex_enter(&lock_sys.deadlock_mutex);
 
-		/* Search too deep, we rollback the joining transaction only
-		if it is possible to rollback. Otherwise we rollback the
-		transaction that is holding the lock that the joining
-		transaction wants. */
-		if (checker.is_too_deep()) {
+		/* The lock may have been granted or the wait cancelled,
+		or another search may have chosen this transaction as
+		the victim already. */
+		if (const lock_t* lock = trx->lock.victim_wait_lock
+		    ? NULL : trx->lock.wait_lock) {
 
-			ut_ad(trx == checker.m_start);
-			ut_ad(trx == victim_trx);
+			DeadlockChecker	checker(trx, lock,
+						s_lock_mark_counter,
+						report_waiters);
 
-			rollback_print(victim_trx, lock);
+			victim_trx = checker.search();
 
-			MONITOR_INC(MONITOR_DEADLOCK);
-			srv_stats.lock_deadlock_count.inc();
+			/* Search too deep, we rollback the joining
+			transaction only if it is possible to rollback.
+			Otherwise we rollback the transaction that is
+			holding the lock that the joining transaction
+			wants. */
+			if (checker.is_too_deep()) {
 
-			break;
+				ut_ad(trx == victim_trx);
 
-		} else if (victim_trx != NULL && victim_trx != trx) {
+				rollback_print(victim_trx, lock);
 
-			ut_ad(victim_trx == checker.m_wait_lock->trx);
+				MONITOR_ATOMIC_INC(MONITOR_DEADLOCK);
+				srv_stats.lock_deadlock_count.inc();
 
-			checker.trx_rollback();
+			} else if (victim_trx != NULL && victim_trx != trx) {
 
-			lock_deadlock_found = true;
+				ut_ad(victim_trx == checker.m_wait_lock->trx);
 
-			MONITOR_INC(MONITOR_DEADLOCK);
-			srv_stats.lock_deadlock_count.inc();
-		}
+				print("*** WE ROLL BACK TRANSACTION (1)\n");
 
-	} while (victim_trx != NULL && victim_trx != trx);
+				MONITOR_ATOMIC_INC(MONITOR_DEADLOCK);
+				srv_stats.lock_deadlock_count.inc();
+			}
 
-	/* If the joining transaction was selected as the victim. */
-	if (victim_trx != NULL) {
+			if (victim_trx == trx) {
+				print("*** WE ROLL BACK TRANSACTION (2)\n");
+			}
 
-		print("*** WE ROLL BACK TRANSACTION (2)\n");
-#ifdef WITH_WSREP
-		if (wsrep_on(trx->mysql_thd)
-		    && wsrep_thd_is_SR(trx->mysql_thd)) {
-			wsrep_handle_SR_rollback(trx->mysql_thd,
-						 victim_trx->mysql_thd);
+			if (victim_trx != NULL) {
+				lock_deadlock_found = true;
+
+				victim_lock = victim_trx->lock.wait_lock;
+				ut_ad(victim_lock);
+
+				const_cast<trx_t*>(victim_trx)
+					->lock.victim_wait_lock = victim_lock;
+			}
 		}
-#endif
 
-		lock_deadlock_found = true;
-	}
+		mutex_exit(&lock_sys.deadlock_mutex);
+		rw_lock_s_unlock(&lock_sys.latch);
 
-	trx_mutex_enter(trx);
+		if (victim_trx == NULL) {
+			return;
+		}
 
-	return(victim_trx);
+		cancel_wait(const_cast<trx_t*>(victim_trx), victim_lock, trx);
+
+		if (victim_trx == trx) {
+			return;
+		}
+	}
+}
+
+/** Check if a lock wait that was just enqueued results in a deadlock,
+and if so, resolve it by cancelling the wait of a victim transaction.
+This is invoked by the thread that is about to suspend itself for the
+lock wait, without holding lock_sys.latch.
+@param[in,out]	trx	transaction that is waiting for a lock */
+void
+lock_wait_check_deadlock(trx_t* trx)
+{
+	DeadlockChecker::check_and_resolve(trx);
 }
 
 /*************************************************************//**
@@ -187,7 +187,7 @@ lock_wait_table_reserve_slot(
 check if lock timeout was for priority thread,
 as a side effect trigger lock monitor
 @param[in]    trx    transaction owning the lock
-@param[in]    locked true if trx and lock_sys.mutex is ownd
+@param[in]    locked true if trx and lock_sys.latch is ownd
 @return	false for regular lock timeout */
 static
 bool
@@ -241,6 +241,13 @@ lock_wait_suspend_thread(
 	ut_a(lock_sys.timeout_timer.get());
 	trx = thr_get_trx(thr);
 
+	/* The lock wait was enqueued without checking for deadlocks,
+	so that the search does not have to hold lock_sys.latch in
+	exclusive mode. If this transaction is chosen as the victim,
+	its wait will be cancelled and thr->state will be
+	QUE_THR_RUNNING below. */
+	lock_wait_check_deadlock(trx);
+
 	if (trx->mysql_thd != 0) {
 		DEBUG_SYNC_C("lock_wait_suspend_thread_enter");
 	}
@@ -60,6 +60,8 @@ Created 9/20/1997 Heikki Tuuri
 
 /** The recovery system */
 recv_sys_t	recv_sys;
+/** Signalled when the last recv_apply_batch task completes */
+static os_event_t	recv_apply_done;
 /** TRUE when applying redo log records during crash recovery; FALSE
 otherwise.  Note that this is FALSE while a background thread is
 rolling back incomplete transactions. */
@@ -902,6 +904,10 @@ void recv_sys_t::close()
 			os_event_destroy(flush_end);
 		}
 
+		if (recv_apply_done) {
+			os_event_destroy(recv_apply_done);
+		}
+
 		if (buf) {
 			ut_free_dodump(buf, RECV_PARSING_BUF_SIZE);
 			buf = NULL;
@@ -1004,6 +1010,8 @@ void recv_sys_t::create()
 		flush_end = os_event_create(0);
 	}
 
+	recv_apply_done = os_event_create(0);
+
 	flush_type = BUF_FLUSH_LRU;
 	apply_log_recs = false;
 	apply_batch_on = false;
@@ -2501,6 +2509,172 @@ static void recv_read_in_area(page_id_t page_id)
 	}
 }
 
+/** Apply buffered redo log to a page that is not being read or processed.
+The page is either looked up in the buffer pool or, if it is going to be
+reinitialized, created there. If the page is not in the buffer pool, it
+will be read in, and the log applied in buf_page_io_complete().
+@param p    recovery address
+@param mtr  mini-transaction */
+static void recv_apply_page(recv_sys_t::map::iterator p, mtr_t& mtr)
+{
+	ut_ad(mutex_own(&recv_sys.mutex));
+	const page_id_t page_id = p->first;
+	page_recv_t& recs = p->second;
+	ut_ad(!recs.log.empty());
+
+	switch (recs.state) {
+	case page_recv_t::RECV_BEING_READ:
+	case page_recv_t::RECV_BEING_PROCESSED:
+		ut_ad("invalid state" == 0);
+		return;
+	case page_recv_t::RECV_NOT_PROCESSED:
+		mtr.start();
+		mtr.set_log_mode(MTR_LOG_NONE);
+		if (buf_block_t* block = buf_page_get_gen(
+			    page_id, 0, RW_X_LATCH, NULL,
+			    BUF_GET_IF_IN_POOL,
+			    __FILE__, __LINE__, &mtr, NULL)) {
+			buf_block_dbg_add_level(block, SYNC_NO_ORDER_CHECK);
+			recv_recover_page(block, mtr, p);
+			ut_ad(mtr.has_committed());
+		} else {
+			mtr.commit();
+			recv_read_in_area(page_id);
+			return;
+		}
+		break;
+	case page_recv_t::RECV_WILL_NOT_READ:
+		mlog_init_t::init& i = mlog_init.last(page_id);
+		const lsn_t end_lsn = recs.log.last()->lsn;
+		if (end_lsn < i.lsn) {
+			DBUG_LOG("ib_log", "skip log for page "
+				 << page_id
+				 << " LSN " << end_lsn
+				 << " < " << i.lsn);
+			break;
+		}
+
+		fil_space_t* space = fil_space_acquire_for_io(
+			page_id.space());
+		if (!space) {
+			break;
+		}
+
+		mtr.start();
+		mtr.set_log_mode(MTR_LOG_NONE);
+		buf_block_t* block = buf_page_create(
+			page_id, space->zip_size(), &mtr);
+		p = recv_sys.pages.find(page_id);
+		if (p == recv_sys.pages.end()) {
+			/* The page happened to exist
+			in the buffer pool, or it was
+			just being read in. Before
+			buf_page_get_with_no_latch()
+			returned, all changes must have
+			been applied to the page already. */
+			mtr.commit();
+		} else {
+			ut_ad(&recs == &p->second);
+			i.created = true;
+			buf_block_dbg_add_level(block, SYNC_NO_ORDER_CHECK);
+			mtr.x_latch_at_savepoint(0, block);
+			recv_recover_page(block, mtr, p, space, &i);
+			ut_ad(mtr.has_committed());
+			p->second.log.clear();
+			recv_sys.pages.erase(p);
+		}
+
+		space->release_for_io();
+		return;
+	}
+
+	p->second.log.clear();
+	recv_sys.pages.erase(p);
+}
+
+/** Number of submitted recv_apply_batch tasks that have not completed;
+protected by recv_sys.mutex */
+static ulint recv_apply_tasks;
+/** Limits the concurrency of recv_apply_batch tasks
+to innodb_recovery_apply_threads */
+static tpool::task_group recv_apply_group;
+
+/** Wait until all submitted recv_apply_batch tasks have completed.
+The caller must hold recv_sys.mutex, which is released while waiting. */
+static void recv_apply_wait_tasks()
+{
+	ut_ad(mutex_own(&recv_sys.mutex));
+
+	while (recv_apply_tasks) {
+		const int64_t sig_count = os_event_reset(recv_apply_done);
+		mutex_exit(&recv_sys.mutex);
+		os_event_wait_low(recv_apply_done, sig_count);
+		mutex_enter(&recv_sys.mutex);
+	}
+}
+
+/** A batch of distinct pages whose buffered redo log is applied in
+srv_thread_pool. Pages that are not found in recv_sys.pages, or that are
+being read or processed by the time the task runs, are skipped: they were
+handled by buf_page_io_complete() meanwhile. */
+struct recv_apply_batch : public tpool::task
+{
+	/** maximum number of pages in a batch */
+	static const size_t N_PAGES = 32;
+
+	recv_apply_batch() : tpool::task(run, this, &recv_apply_group)
+	{
+		pages.reserve(N_PAGES);
+	}
+
+	/** Submit the task for execution. */
+	void submit()
+	{
+		ut_ad(mutex_own(&recv_sys.mutex));
+		recv_apply_tasks++;
+		srv_thread_pool->submit_task(this);
+	}
+
+	void release() override { UT_DELETE(this); }
+
+	/** the pages to process */
+	std::vector<page_id_t, ut_allocator<page_id_t> > pages;
+
+private:
+	/** Apply the log for all pages of the batch. */
+	static void run(void* arg)
+	{
+		recv_apply_batch* batch = static_cast<recv_apply_batch*>(arg);
+		mtr_t mtr;
+
+		mutex_enter(&recv_sys.mutex);
+		for (const page_id_t page_id : batch->pages) {
+			if (recv_sys.found_corrupt_log
+			    || recv_sys.found_corrupt_fs) {
+				break;
+			}
+			recv_sys_t::map::iterator p =
+				recv_sys.pages.find(page_id);
+			if (p == recv_sys.pages.end()) {
+				continue;
+			}
+			switch (p->second.state) {
+			case page_recv_t::RECV_BEING_READ:
+			case page_recv_t::RECV_BEING_PROCESSED:
+				continue;
+			case page_recv_t::RECV_NOT_PROCESSED:
+			case page_recv_t::RECV_WILL_NOT_READ:
+				recv_apply_page(p, mtr);
+			}
+		}
+		ut_ad(recv_apply_tasks);
+		if (!--recv_apply_tasks) {
+			os_event_set(recv_apply_done);
+		}
+		mutex_exit(&recv_sys.mutex);
+	}
+};
+
 /** Apply recv_sys.pages to persistent data pages.
 @param[in]	last_batch	whether redo log writes are possible */
 void recv_apply_hashed_log_recs(bool last_batch)
@@ -2532,6 +2706,9 @@ void recv_apply_hashed_log_recs(bool last_batch)
 	ut_d(recv_no_log_write = recv_no_ibuf_operations);
 
 	mtr_t mtr;
+	const ulonglong	apply_start = my_interval_timer();
+	const ulint	n_pages = recv_sys.pages.size();
+	recv_apply_batch*	batch = NULL;
 
 	if (recv_sys.pages.empty()) {
 		goto done;
@@ -2567,6 +2744,11 @@ void recv_apply_hashed_log_recs(bool last_batch)
 		}
 	}
 
+	if (srv_recovery_apply_threads > 1) {
+		recv_apply_group.set_max_tasks(
+			uint(srv_recovery_apply_threads));
+	}
+
 	for (recv_sys_t::map::iterator p = recv_sys.pages.begin();
 	     p != recv_sys.pages.end();) {
 		const page_id_t page_id = p->first;
@@ -2579,79 +2761,39 @@ void recv_apply_hashed_log_recs(bool last_batch)
 			p++;
 			continue;
 		case page_recv_t::RECV_NOT_PROCESSED:
-			mtr.start();
-			mtr.set_log_mode(MTR_LOG_NONE);
-			if (buf_block_t* block = buf_page_get_gen(
-				    page_id, 0, RW_X_LATCH, NULL,
-				    BUF_GET_IF_IN_POOL,
-				    __FILE__, __LINE__, &mtr, NULL)) {
-				buf_block_dbg_add_level(
-					block, SYNC_NO_ORDER_CHECK);
-				recv_recover_page(block, mtr, p);
-				ut_ad(mtr.has_committed());
-			} else {
-				mtr.commit();
-				recv_read_in_area(page_id);
+		case page_recv_t::RECV_WILL_NOT_READ:
+			if (srv_recovery_apply_threads <= 1) {
 				break;
 			}
-		ignore:
-			{
-				recv_sys_t::map::iterator r = p++;
-				r->second.log.clear();
-				recv_sys.pages.erase(r);
-			}
-			continue;
-		case page_recv_t::RECV_WILL_NOT_READ:
-			mlog_init_t::init& i = mlog_init.last(page_id);
-			const lsn_t end_lsn = recs.log.last()->lsn;
-			if (end_lsn < i.lsn) {
-				DBUG_LOG("ib_log", "skip log for page "
-					 << page_id
-					 << " LSN " << end_lsn
-					 << " < " << i.lsn);
-				goto ignore;
+			if (recs.state == page_recv_t::RECV_NOT_PROCESSED
+			    && !buf_page_hash_get(page_id)) {
+				recv_read_in_area(page_id);
+				p = recv_sys.pages.lower_bound(page_id);
+				continue;
 			}
-
-			fil_space_t* space = fil_space_acquire_for_io(
-				page_id.space());
-			if (!space) {
-				goto ignore;
+			if (!batch) {
+				batch = UT_NEW_NOKEY(recv_apply_batch());
 			}
-
-			mtr.start();
-			mtr.set_log_mode(MTR_LOG_NONE);
-			buf_block_t* block = buf_page_create(
-				page_id, space->zip_size(), &mtr);
-			p = recv_sys.pages.find(page_id);
-			if (p == recv_sys.pages.end()) {
-				/* The page happened to exist
-				in the buffer pool, or it was
-				just being read in. Before
-				buf_page_get_with_no_latch()
-				returned, all changes must have
-				been applied to the page already. */
-				mtr.commit();
-			} else {
-				ut_ad(&recs == &p->second);
-				i.created = true;
-				buf_block_dbg_add_level(
-					block, SYNC_NO_ORDER_CHECK);
-				mtr.x_latch_at_savepoint(0, block);
-				recv_recover_page(block, mtr, p, space, &i);
-				ut_ad(mtr.has_committed());
-				p->second.log.clear();
-				recv_sys.pages.erase(p);
+			batch->pages.push_back(page_id);
+			if (batch->pages.size() == recv_apply_batch::N_PAGES) {
+				batch->submit();
+				batch = NULL;
 			}
-
-			space->release_for_io();
+			p++;
+			continue;
 		}
 
+		recv_apply_page(p, mtr);
 		p = recv_sys.pages.lower_bound(page_id);
 	}
 
+	if (batch) {
+		batch->submit();
+	}
+
 	/* Wait until all the pages have been processed */
 
-	while (!recv_sys.pages.empty()) {
+	while (!recv_sys.pages.empty() || recv_apply_tasks) {
 		const bool abort = recv_sys.found_corrupt_log
 			|| recv_sys.found_corrupt_fs;
 
@@ -2660,17 +2802,36 @@ void recv_apply_hashed_log_recs(bool last_batch)
 				" to ignore corrupted pages.";
 		}
 
-		mutex_exit(&(recv_sys.mutex));
+		if (abort || recv_apply_tasks) {
+			/* The pending tasks will skip their pages
+			if corruption was found. */
+			recv_apply_wait_tasks();
 
-		if (abort) {
-			return;
+			if (abort) {
+				mutex_exit(&recv_sys.mutex);
+				return;
+			}
+
+			continue;
 		}
 
+		mutex_exit(&(recv_sys.mutex));
+
+		/* Wait for the pages that are being read. */
 		os_thread_sleep(500000);
 
 		mutex_enter(&(recv_sys.mutex));
 	}
 
+	{
+		const ulonglong ms = (my_interval_timer() - apply_start)
+			/ 1000000;
+		ib::info() << "Applied redo log to " << n_pages
+			   << " pages in " << ms << " ms ("
+			   << (ms ? n_pages * 1000 / ms : n_pages)
+			   << " pages/s)";
+	}
+
 done:
 	if (!last_batch) {
 		/* Flush all the file pages to disk and invalidate them in
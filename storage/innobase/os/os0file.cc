@@ -1469,6 +1469,11 @@ os_file_create_func(
 	}
 #endif /* USE_FILE_LOCK */
 
+	if (*success && purpose == OS_FILE_AIO && srv_thread_pool) {
+		/* With io_uring, this registers the file with the ring */
+		srv_thread_pool->bind(file);
+	}
+
 	return(file);
 }
 
@@ -1659,6 +1664,8 @@ os_file_get_last_error.
 @return true if success */
 bool os_file_close_func(os_file_t file)
 {
+  if (srv_thread_pool)
+    srv_thread_pool->unbind(file);
   int ret= close(file);
 
   if (!ret)
@@ -4036,13 +4043,38 @@ bool os_aio_init(ulint n_reader_threads, ulint n_writer_threads, ulint)
   int max_read_events= int(n_reader_threads * OS_AIO_N_PENDING_IOS_PER_THREAD);
 	int max_ibuf_events = 1 * OS_AIO_N_PENDING_IOS_PER_THREAD;
 	int max_events = max_read_events + max_write_events + max_ibuf_events;
-	int ret;
-
+	int ret = -1;
+
+#ifdef __linux__
+	if (srv_use_native_aio && srv_linux_aio != SRV_LINUX_AIO_LIBAIO) {
+		ret = srv_thread_pool->configure_aio(true, max_events,
+						     tpool::OS_IO_URING);
+		if (!ret) {
+			ib::info() << "Using Linux io_uring";
+		} else if (srv_linux_aio == SRV_LINUX_AIO_IO_URING) {
+			ib::error() << "innodb_linux_aio=io_uring: io_uring"
+				" could not be set up: " << strerror(errno);
+			return false;
+		} else if (errno == ENOSYS) {
+			/* Not compiled in, or not supported by the kernel */
+			ib::info() << "io_uring is not available;"
+				" using libaio";
+		} else {
+			ib::warn() << "io_uring could not be set up ("
+				   << strerror(errno)
+				   << "); falling back to libaio";
+		}
+	}
+#endif
+	if (ret) {
 #if LINUX_NATIVE_AIO
-	if (srv_use_native_aio && !is_linux_native_aio_supported())
-		srv_use_native_aio = false;
+		if (srv_use_native_aio && !is_linux_native_aio_supported())
+			srv_use_native_aio = false;
 #endif
-	ret = srv_thread_pool->configure_aio(srv_use_native_aio, max_events);
+		ret = srv_thread_pool->configure_aio(srv_use_native_aio,
+						     max_events,
+						     tpool::OS_IO_LIBAIO);
+	}
 	if(ret) {
 		ut_a(srv_use_native_aio);
 		srv_use_native_aio = false;
@@ -164,6 +164,33 @@ row_mysql_prebuilt_free_blob_heap(
 	DBUG_VOID_RETURN;
 }
 
+/** Free the fetch cache of a table handle.
+@param[in,out]	prebuilt	prebuilt struct of a ha_innobase:: handle */
+void row_mysql_prebuilt_free_fetch_cache(row_prebuilt_t* prebuilt)
+{
+	byte*	base = prebuilt->fetch_cache[0] - 4;
+	byte*	ptr = base;
+
+	for (ulint i = 0; i < prebuilt->fetch_cache_size; i++) {
+		ulint	magic1 = mach_read_from_4(ptr);
+		ut_a(magic1 == ROW_PREBUILT_FETCH_MAGIC_N);
+		ptr += 4;
+
+		byte*	row = ptr;
+		ut_a(row == prebuilt->fetch_cache[i]);
+		ptr += prebuilt->mysql_row_len;
+
+		ulint	magic2 = mach_read_from_4(ptr);
+		ut_a(magic2 == ROW_PREBUILT_FETCH_MAGIC_N);
+		ptr += 4;
+	}
+
+	ut_free(base);
+	ut_free(prebuilt->fetch_cache);
+	prebuilt->fetch_cache = NULL;
+	prebuilt->fetch_cache_size = 0;
+}
+
 /*******************************************************************//**
 Stores a >= 5.0.3 format true VARCHAR length to dest, in the MySQL row
 format.
@@ -969,6 +996,7 @@ row_create_prebuilt(
 
 	prebuilt->m_no_prefetch = false;
 	prebuilt->m_read_virtual_key = false;
+	prebuilt->fetch_cache_depth = MYSQL_FETCH_CACHE_SIZE;
 
 	DBUG_RETURN(prebuilt);
 }
@@ -1014,25 +1042,8 @@ row_prebuilt_free(
 		mem_heap_free(prebuilt->old_vers_heap);
 	}
 
-	if (prebuilt->fetch_cache[0] != NULL) {
-		byte*	base = prebuilt->fetch_cache[0] - 4;
-		byte*	ptr = base;
-
-		for (ulint i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
-			ulint	magic1 = mach_read_from_4(ptr);
-			ut_a(magic1 == ROW_PREBUILT_FETCH_MAGIC_N);
-			ptr += 4;
-
-			byte*	row = ptr;
-			ut_a(row == prebuilt->fetch_cache[i]);
-			ptr += prebuilt->mysql_row_len;
-
-			ulint	magic2 = mach_read_from_4(ptr);
-			ut_a(magic2 == ROW_PREBUILT_FETCH_MAGIC_N);
-			ptr += 4;
-		}
-
-		ut_free(base);
+	if (prebuilt->fetch_cache != NULL) {
+		row_mysql_prebuilt_free_fetch_cache(prebuilt);
 	}
 
 	if (prebuilt->rtr_info) {
@@ -54,6 +54,9 @@ Created 12/19/1997 Heikki Tuuri
 #include "buf0lru.h"
 #include "srv0srv.h"
 #include "srv0mon.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #ifdef WITH_WSREP
 #include "mysql/service_wsrep.h" /* For wsrep_thd_skip_locking */
 #endif
@@ -1280,10 +1283,6 @@ void
 row_sel_open_pcur(
 /*==============*/
 	plan_t*		plan,	/*!< in: table plan */
-#ifdef BTR_CUR_HASH_ADAPT
-	rw_lock_t*	ahi_latch,
-				/*!< in: the adaptive hash index latch */
-#endif /* BTR_CUR_HASH_ADAPT */
 	mtr_t*		mtr)	/*!< in/out: mini-transaction */
 {
 	dict_index_t*	index;
@@ -1327,7 +1326,7 @@ row_sel_open_pcur(
 
 		btr_pcur_open_with_no_init(index, plan->tuple, plan->mode,
 					   BTR_SEARCH_LEAF, &plan->pcur,
-					   ahi_latch, mtr);
+					   NULL, mtr);
 	} else {
 		/* Open the cursor to the start or the end of the index
 		(FALSE: no init) */
@@ -1472,16 +1471,12 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->unique_search);
 	ut_ad(!plan->must_get_clust);
 
-	rw_lock_t* ahi_latch = btr_get_search_latch(index);
-	rw_lock_s_lock(ahi_latch);
-
-	row_sel_open_pcur(plan, ahi_latch, mtr);
+	row_sel_open_pcur(plan, mtr);
 
 	const rec_t* rec = btr_pcur_get_rec(&(plan->pcur));
 
 	if (!page_rec_is_user_rec(rec) || rec_is_metadata(rec, *index)) {
 retry:
-		rw_lock_s_unlock(ahi_latch);
 		return(SEL_RETRY);
 	}
 
@@ -1493,7 +1488,6 @@ row_sel_try_search_shortcut(
 
 	if (btr_pcur_get_up_match(&(plan->pcur)) < plan->n_exact_match) {
 exhausted:
-		rw_lock_s_unlock(ahi_latch);
 		return(SEL_EXHAUSTED);
 	}
 
@@ -1539,7 +1533,6 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->pcur.latch_mode == BTR_SEARCH_LEAF);
 
 	plan->n_rows_fetched++;
-	rw_lock_s_unlock(ahi_latch);
 
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
@@ -1661,11 +1654,7 @@ row_sel(
 	if (!plan->pcur_is_open) {
 		/* Evaluate the expressions to build the search tuple and
 		open the cursor */
-		row_sel_open_pcur(plan,
-#ifdef BTR_CUR_HASH_ADAPT
-				  NULL,
-#endif /* BTR_CUR_HASH_ADAPT */
-				  &mtr);
+		row_sel_open_pcur(plan, &mtr);
 
 		cursor_just_opened = TRUE;
 
@@ -3734,23 +3723,57 @@ row_sel_dequeue_cached_row_for_mysql(
 	}
 }
 
-/********************************************************************//**
-Initialise the prefetch cache. */
-UNIV_INLINE
+/** Pop rows from the prefetch cache of a forward scan that was
+started with row_search_mvcc().
+@param[out]	buf		buffer for the rows in MySQL format
+@param[in]	rec_len		distance between the rows in buf
+@param[in]	max_rows	maximum number of rows to pop
+@param[in,out]	prebuilt	prebuilt struct for the table handle
+@return number of rows that were copied to buf */
+ulint
+row_sel_dequeue_cached_rows_for_mysql(
+	byte*		buf,
+	ulint		rec_len,
+	ulint		max_rows,
+	row_prebuilt_t*	prebuilt)
+{
+	if (prebuilt->fetch_direction != ROW_SEL_NEXT) {
+		return(0);
+	}
+
+	const ulint	n = std::min(max_rows, prebuilt->n_fetch_cached);
+
+	for (ulint i = 0; i < n; i++, buf += rec_len) {
+		row_sel_dequeue_cached_row_for_mysql(buf, prebuilt);
+	}
+
+	prebuilt->n_rows_fetched += n;
+
+	return(n);
+}
+
+/** Initialise the prefetch cache for prebuilt->fetch_cache_depth rows.
+@param[in,out]	prebuilt	prebuilt struct */
+static
 void
-row_sel_prefetch_cache_init(
-/*========================*/
-	row_prebuilt_t*	prebuilt)	/*!< in/out: prebuilt struct */
+row_sel_prefetch_cache_init(row_prebuilt_t* prebuilt)
 {
 	ulint	i;
 	ulint	sz;
 	byte*	ptr;
 
+	ut_ad(prebuilt->fetch_cache == NULL);
+	ut_ad(prebuilt->fetch_cache_depth >= MYSQL_FETCH_CACHE_SIZE);
+
+	prebuilt->fetch_cache_size = prebuilt->fetch_cache_depth;
+	prebuilt->fetch_cache = static_cast<byte**>(
+		ut_malloc_nokey(prebuilt->fetch_cache_size * sizeof(byte*)));
+
 	/* Reserve space for the magic number. */
-	sz = UT_ARR_SIZE(prebuilt->fetch_cache) * (prebuilt->mysql_row_len + 8);
+	sz = prebuilt->fetch_cache_size * (prebuilt->mysql_row_len + 8);
 	ptr = static_cast<byte*>(ut_malloc_nokey(sz));
 
-	for (i = 0; i < UT_ARR_SIZE(prebuilt->fetch_cache); i++) {
+	for (i = 0; i < prebuilt->fetch_cache_size; i++) {
 
 		/* A user has reported memory corruption in these
 		buffers in Linux. Put magic numbers there to help
@@ -3767,6 +3790,29 @@ row_sel_prefetch_cache_init(
 	}
 }
 
+/** Increase the prefetch depth after the fetch cache was filled up.
+The depth is doubled, but limited by MYSQL_FETCH_CACHE_MAX_SIZE rows and
+by innodb_fetch_cache_size bytes of buffer memory. Short scans (such as
+those of LIMIT queries) never get past the initial depth, because the
+depth is reset when the cursor is positioned.
+@param[in,out]	prebuilt	prebuilt struct */
+static
+void
+row_sel_grow_fetch_cache_depth(row_prebuilt_t* prebuilt)
+{
+	ulint	max_depth = srv_fetch_cache_size
+		/ (prebuilt->mysql_row_len + 8);
+
+	if (max_depth > MYSQL_FETCH_CACHE_MAX_SIZE) {
+		max_depth = MYSQL_FETCH_CACHE_MAX_SIZE;
+	}
+
+	if (prebuilt->fetch_cache_depth < max_depth) {
+		prebuilt->fetch_cache_depth = std::min(
+			2 * prebuilt->fetch_cache_depth, max_depth);
+	}
+}
+
 /********************************************************************//**
 Get the last fetch cache buffer from the queue.
 @return pointer to buffer. */
@@ -3777,15 +3823,20 @@ row_sel_fetch_last_buf(
 	row_prebuilt_t*	prebuilt)	/*!< in/out: prebuilt struct */
 {
 	ut_ad(!prebuilt->templ_contains_blob);
-	ut_ad(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
+	ut_ad(prebuilt->n_fetch_cached < prebuilt->fetch_cache_depth);
 
-	if (prebuilt->fetch_cache[0] == NULL) {
-		/* Allocate memory for the fetch cache */
-		ut_ad(prebuilt->n_fetch_cached == 0);
+	if (prebuilt->n_fetch_cached == 0
+	    && prebuilt->fetch_cache_size < prebuilt->fetch_cache_depth) {
+		/* Allocate memory for the fetch cache, or replace it
+		with a bigger one now that it is empty. */
+		if (prebuilt->fetch_cache != NULL) {
+			row_mysql_prebuilt_free_fetch_cache(prebuilt);
+		}
 
 		row_sel_prefetch_cache_init(prebuilt);
 	}
 
+	ut_ad(prebuilt->n_fetch_cached < prebuilt->fetch_cache_size);
 	ut_ad(prebuilt->fetch_cache_first == 0);
 	UNIV_MEM_INVALID(prebuilt->fetch_cache[prebuilt->n_fetch_cached],
 			 prebuilt->mysql_row_len);
@@ -3817,8 +3868,7 @@ row_sel_enqueue_cache_row_for_mysql(
 /*********************************************************************//**
 Tries to do a shortcut to fetch a clustered index record with a unique key,
 using the hash index if possible (not always). We assume that the search
-mode is PAGE_CUR_GE, it is a consistent read, there is a read view in trx,
-btr search latch has been locked in S-mode if AHI is enabled.
+mode is PAGE_CUR_GE, it is a consistent read, there is a read view in trx.
 @return SEL_FOUND, SEL_EXHAUSTED, SEL_RETRY */
 static
 ulint
@@ -3839,15 +3889,12 @@ row_sel_try_search_shortcut_for_mysql(
 	ut_ad(dict_index_is_clust(index));
 	ut_ad(!prebuilt->templ_contains_blob);
 
-	rw_lock_t* ahi_latch = btr_get_search_latch(index);
-	rw_lock_s_lock(ahi_latch);
 	btr_pcur_open_with_no_init(index, search_tuple, PAGE_CUR_GE,
-				   BTR_SEARCH_LEAF, pcur, ahi_latch, mtr);
+				   BTR_SEARCH_LEAF, pcur, NULL, mtr);
 	rec = btr_pcur_get_rec(pcur);
 
 	if (!page_rec_is_user_rec(rec) || rec_is_metadata(rec, *index)) {
 retry:
-		rw_lock_s_unlock(ahi_latch);
 		return(SEL_RETRY);
 	}
 
@@ -3857,7 +3904,6 @@ row_sel_try_search_shortcut_for_mysql(
 
 	if (btr_pcur_get_up_match(pcur) < dtuple_get_n_fields(search_tuple)) {
 exhausted:
-		rw_lock_s_unlock(ahi_latch);
 		return(SEL_EXHAUSTED);
 	}
 
@@ -3881,7 +3927,6 @@ row_sel_try_search_shortcut_for_mysql(
 
 	*out_rec = rec;
 
-	rw_lock_s_unlock(ahi_latch);
 	return(SEL_FOUND);
 }
 #endif /* BTR_CUR_HASH_ADAPT */
@@ -4268,6 +4313,7 @@ row_search_mvcc(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		prebuilt->fetch_cache_depth = MYSQL_FETCH_CACHE_SIZE;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -4292,6 +4338,7 @@ row_search_mvcc(
 			prebuilt->n_rows_fetched = 0;
 			prebuilt->n_fetch_cached = 0;
 			prebuilt->fetch_cache_first = 0;
+			prebuilt->fetch_cache_depth = MYSQL_FETCH_CACHE_SIZE;
 
 		} else if (UNIV_LIKELY(prebuilt->n_fetch_cached > 0)) {
 			row_sel_dequeue_cached_row_for_mysql(buf, prebuilt);
@@ -4302,7 +4349,8 @@ row_search_mvcc(
 		}
 
 		if (prebuilt->fetch_cache_first > 0
-		    && prebuilt->fetch_cache_first < MYSQL_FETCH_CACHE_SIZE) {
+		    && prebuilt->fetch_cache_first
+		    < prebuilt->fetch_cache_depth) {
 early_not_found:
 			/* The previous returned row was popped from the fetch
 			cache, but the cache was not full at the time of the
@@ -5360,7 +5408,7 @@ row_search_mvcc(
 		not cache rows because there the cursor is a scrollable
 		cursor. */
 
-		ut_a(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
+		ut_a(prebuilt->n_fetch_cached < prebuilt->fetch_cache_depth);
 
 		/* We only convert from InnoDB row format to MySQL row
 		format when ICP is disabled. */
@@ -5412,10 +5460,14 @@ row_search_mvcc(
 			row_sel_enqueue_cache_row_for_mysql(buf, prebuilt);
 		}
 
-		if (prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE) {
+		if (prebuilt->n_fetch_cached < prebuilt->fetch_cache_depth) {
 			goto next_rec;
 		}
 
+		/* The cache was filled up: the scan is likely to go on,
+		so prefetch more rows next time. */
+		row_sel_grow_fetch_cache_depth(prebuilt);
+
 	} else {
 		if (UNIV_UNLIKELY
 		    (prebuilt->template_type == ROW_MYSQL_DUMMY_TEMPLATE)) {
@@ -5969,3 +6021,472 @@ row_search_max_autoinc(dict_index_t* index)
 	mtr.commit();
 	return(value);
 }
+
+/** A sampled scan of a clustered index. The readers pass the rows that
+they took from one leaf page at a time to the thread of the handle. */
+struct row_sample_t
+{
+	/** Rows in the MySQL format that were read from a leaf page */
+	struct batch_t
+	{
+		explicit batch_t(ulint size) :
+			rows(static_cast<byte*>(ut_malloc_nokey(size))),
+			n_rows(0) {}
+
+		~batch_t()
+		{
+			ut_free(rows);
+			for (ulint i = 0; i < blob_heaps.size(); i++) {
+				mem_heap_free(blob_heaps[i]);
+			}
+		}
+
+		/** the rows, prebuilt->mysql_row_len bytes apart */
+		byte*		rows;
+		/** number of rows */
+		ulint		n_rows;
+		/** the heaps of the BLOB values of the rows */
+		std::vector<mem_heap_t*, ut_allocator<mem_heap_t*> >
+				blob_heaps;
+	};
+
+	row_sample_t(row_prebuilt_t* prebuilt, double fraction, bool pages) :
+		prebuilt(prebuilt),
+		index(dict_table_get_first_index(prebuilt->table)),
+		threshold(fraction * 4294967296.0),
+		take_all(fraction >= 1),
+		pages(pages),
+		heap(mem_heap_create(1024)),
+		next_range(0),
+		aborted(false),
+		n_running(0),
+		err(DB_SUCCESS),
+		current(NULL),
+		current_row(0),
+		task(read, this, &group) {}
+
+	~row_sample_t()
+	{
+		ut_ad(!n_running);
+		while (!queue.empty()) {
+			UT_DELETE(queue.front());
+			queue.pop_front();
+		}
+		UT_DELETE(current);
+		mem_heap_free(heap);
+	}
+
+	/** @return whether to take a page or a row into the sample */
+	bool take() const { return take_all || ut_rnd_gen() < threshold; }
+
+	/** @return number of ranges of the leaf level */
+	ulint n_ranges() const { return bounds.size() + 1; }
+
+	/** Divide the leaf level into ranges at the node pointers of
+	the root page.
+	@param[in]	n	maximum number of ranges */
+	void split(ulint n)
+	{
+		mtr_t	mtr;
+		mtr.start();
+		mtr_s_lock_index(index, &mtr);
+
+		const buf_block_t* root = btr_root_block_get(
+			index, RW_S_LATCH, &mtr);
+
+		if (root && !page_is_leaf(root->frame)) {
+			const ulint n_recs = page_get_n_recs(root->frame);
+			n = std::min(n, n_recs);
+			ulint i = 0;
+
+			for (const rec_t* rec = page_rec_get_next_const(
+				     page_get_infimum_rec(root->frame));
+			     bounds.size() + 1 < n;
+			     rec = page_rec_get_next_const(rec), i++) {
+				ut_ad(page_rec_is_user_rec(rec));
+				if (i < (bounds.size() + 1) * n_recs / n) {
+					continue;
+				}
+				dtuple_t* tuple = dict_index_build_data_tuple(
+					rec, index, false,
+					dict_index_get_n_unique_in_tree(index),
+					heap);
+				dtuple_set_info_bits(tuple, 0);
+				bounds.push_back(tuple);
+			}
+		}
+
+		mtr.commit();
+	}
+
+	/** Pass a batch to the thread of the handle.
+	@param[in,out]	batch	rows read from a page
+	@return whether the scan continues */
+	bool push(batch_t* batch)
+	{
+		std::unique_lock<std::mutex> lk(mutex);
+		while (queue.size() >= 2 * n_running + 2 && !aborted) {
+			consumed.wait(lk);
+		}
+		if (aborted) {
+			lk.unlock();
+			UT_DELETE(batch);
+			return false;
+		}
+		queue.push_back(batch);
+		produced.notify_one();
+		return true;
+	}
+
+	dberr_t read_range(ulint k, row_prebuilt_t& prebuilt);
+	dberr_t next(byte* buf);
+	void end();
+	static void read(void* arg);
+
+	/** the table handle; its template is only read */
+	const row_prebuilt_t* const	prebuilt;
+	/** the clustered index */
+	dict_index_t* const		index;
+	/** ut_rnd_gen() values below this are taken into the sample */
+	const double			threshold;
+	/** whether everything is taken into the sample */
+	const bool			take_all;
+	/** whether leaf pages instead of rows are taken into the sample */
+	const bool			pages;
+	/** heap for bounds */
+	mem_heap_t* const		heap;
+	/** the first keys of the ranges after the first one */
+	std::vector<const dtuple_t*, ut_allocator<const dtuple_t*> >
+					bounds;
+	/** the first range that no reader has started to read */
+	std::atomic<ulint>		next_range;
+	/** set when the scan is stopped before the end */
+	std::atomic<bool>		aborted;
+
+	/** protects the fields below */
+	std::mutex			mutex;
+	/** signalled when a batch was added, or a reader finished */
+	std::condition_variable		produced;
+	/** signalled when a batch was removed, or the scan stopped */
+	std::condition_variable		consumed;
+	/** the batches that were read */
+	std::deque<batch_t*, ut_allocator<batch_t*> >
+					queue;
+	/** number of readers that have not finished */
+	ulint				n_running;
+	/** the first error of a reader */
+	dberr_t				err;
+
+	/** the batch whose rows are being returned (only accessed
+	by the thread of the handle) */
+	batch_t*			current;
+	/** the next row of current to return */
+	ulint				current_row;
+
+	/** limits the concurrency of the readers */
+	tpool::task_group		group;
+	/** the readers */
+	tpool::waitable_task		task;
+};
+
+/** Read a range of the leaf pages of a sampled scan.
+@param[in]	k		range number
+@param[in,out]	prebuilt	copy of the table handle for this reader
+@return error code */
+dberr_t row_sample_t::read_range(ulint k, row_prebuilt_t& prebuilt)
+{
+	const dtuple_t* const	low = k ? bounds[k - 1] : NULL;
+	const dtuple_t* const	high = k < bounds.size() ? bounds[k] : NULL;
+	const bool		comp = dict_table_is_comp(index->table);
+	const ulint		row_len = prebuilt.mysql_row_len;
+	trx_t* const		trx = prebuilt.trx;
+	mem_heap_t*		offsets_heap = NULL;
+	offset_t		offsets_[REC_OFFS_NORMAL_SIZE];
+	offset_t*		offsets = offsets_;
+	btr_pcur_t		pcur;
+	mtr_t			mtr;
+	dberr_t			err;
+
+	rec_offs_init(offsets_);
+
+	mtr.start();
+
+	if (low) {
+		err = btr_pcur_open(index, low, PAGE_CUR_GE, BTR_SEARCH_LEAF,
+				    &pcur, &mtr);
+		/* Position the cursor before the first record to read */
+		if (!btr_pcur_is_before_first_on_page(&pcur)) {
+			btr_pcur_move_to_prev_on_page(&pcur);
+		}
+	} else {
+		err = btr_pcur_open_at_index_side(
+			true, index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+	}
+
+	for (;;) {
+		if (err != DB_SUCCESS
+		    || !btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+			mtr.commit();
+			break;
+		}
+
+		buf_block_t*	block = btr_pcur_get_block(&pcur);
+		const bool	take_page = !pages || take();
+		bool		end = !page_has_next(block->frame);
+		batch_t*	batch = NULL;
+
+		/* If the page is not taken, only check if the range
+		ends on it. */
+		for (const rec_t* rec = take_page
+			     ? btr_pcur_get_rec(&pcur)
+			     : page_rec_get_prev_const(
+				     page_get_supremum_rec(block->frame));
+		     !page_rec_is_supremum(rec);
+		     rec = page_rec_get_next_const(rec)) {
+			if (rec_is_metadata(rec, *index)) {
+				continue;
+			}
+
+			offsets = rec_get_offsets(rec, index, offsets, true,
+						  ULINT_UNDEFINED,
+						  &offsets_heap);
+
+			if (high && cmp_dtuple_rec(high, rec, offsets) <= 0) {
+				end = true;
+				break;
+			}
+
+			if (!take_page || (!pages && !take())) {
+				continue;
+			}
+
+			const rec_t*	row_rec = rec;
+
+			if (trx->isolation_level != TRX_ISO_READ_UNCOMMITTED
+			    && !lock_clust_rec_cons_read_sees(
+				    rec, index, offsets, &trx->read_view)) {
+				rec_t*	old_vers;
+				err = row_sel_build_prev_vers_for_mysql(
+					&trx->read_view, index, &prebuilt,
+					rec, &offsets, &offsets_heap,
+					&old_vers, NULL, &mtr);
+				if (err != DB_SUCCESS) {
+					break;
+				}
+				if (!old_vers) {
+					continue;
+				}
+				row_rec = old_vers;
+			}
+
+			if (rec_get_deleted_flag(row_rec, comp)) {
+				continue;
+			}
+
+			if (!batch) {
+				batch = UT_NEW_NOKEY(batch_t(
+					page_get_n_recs(block->frame)
+					* row_len));
+			}
+
+			byte*	row = batch->rows + batch->n_rows * row_len;
+			memcpy(row, prebuilt.default_rec, row_len);
+
+			/* Keep the BLOB values of every row */
+			prebuilt.blob_heap = NULL;
+			bool	stored = row_sel_store_mysql_rec(
+				row, &prebuilt, row_rec, NULL, true,
+				index, offsets);
+			if (prebuilt.blob_heap) {
+				batch->blob_heaps.push_back(
+					prebuilt.blob_heap);
+				prebuilt.blob_heap = NULL;
+			}
+			batch->n_rows += stored;
+		}
+
+		if (err != DB_SUCCESS) {
+			UT_DELETE(batch);
+			mtr.commit();
+			break;
+		}
+
+		if (!end) {
+			/* Continue after the last record of the page, or
+			after its predecessor if it is purged meanwhile. */
+			page_cur_set_after_last(block,
+						btr_pcur_get_page_cur(&pcur));
+			btr_pcur_move_to_prev_on_page(&pcur);
+			btr_pcur_store_position(&pcur, &mtr);
+		}
+
+		mtr.commit();
+
+		if (!batch || !batch->n_rows) {
+			UT_DELETE(batch);
+		} else if (!push(batch)) {
+			break;
+		}
+
+		if (end) {
+			break;
+		}
+
+		if (trx_is_interrupted(trx)) {
+			err = DB_INTERRUPTED;
+			break;
+		}
+
+		if (aborted) {
+			break;
+		}
+
+		mtr.start();
+		btr_pcur_restore_position(BTR_SEARCH_LEAF, &pcur, &mtr);
+	}
+
+	btr_pcur_close(&pcur);
+
+	if (offsets_heap) {
+		mem_heap_free(offsets_heap);
+	}
+
+	return(err);
+}
+
+/** Read ranges of a sampled scan, in a task of srv_thread_pool.
+@param[in,out]	arg	sampled scan */
+void row_sample_t::read(void* arg)
+{
+	row_sample_t*	sample = static_cast<row_sample_t*>(arg);
+	/* The template is shared, but every reader builds its old
+	versions and copies its BLOB values in heaps of its own. */
+	row_prebuilt_t	prebuilt = *sample->prebuilt;
+	dberr_t		err = DB_SUCCESS;
+
+	prebuilt.blob_heap = NULL;
+	prebuilt.old_vers_heap = NULL;
+
+	while (err == DB_SUCCESS && !sample->aborted) {
+		const ulint	k = sample->next_range++;
+		if (k >= sample->n_ranges()) {
+			break;
+		}
+		err = sample->read_range(k, prebuilt);
+	}
+
+	if (prebuilt.old_vers_heap) {
+		mem_heap_free(prebuilt.old_vers_heap);
+	}
+
+	std::lock_guard<std::mutex> lk(sample->mutex);
+	if (err != DB_SUCCESS && sample->err == DB_SUCCESS) {
+		sample->err = err;
+	}
+	sample->n_running--;
+	sample->produced.notify_one();
+}
+
+/** Fetch the next row of a sampled scan.
+@param[out]	buf	row in the MySQL format
+@return DB_SUCCESS, DB_END_OF_INDEX, or error code */
+dberr_t row_sample_t::next(byte* buf)
+{
+	while (!current || current_row == current->n_rows) {
+		UT_DELETE(current);
+		current = NULL;
+
+		std::unique_lock<std::mutex> lk(mutex);
+		while (queue.empty() && n_running && err == DB_SUCCESS) {
+			produced.wait(lk);
+		}
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+		if (queue.empty()) {
+			return(DB_END_OF_INDEX);
+		}
+		current = queue.front();
+		current_row = 0;
+		queue.pop_front();
+		consumed.notify_one();
+	}
+
+	const ulint	row_len = prebuilt->mysql_row_len;
+	memcpy(buf, current->rows + current_row++ * row_len, row_len);
+	return(DB_SUCCESS);
+}
+
+/** Stop the readers of a sampled scan, and wait for them to finish. */
+void row_sample_t::end()
+{
+	{
+		std::lock_guard<std::mutex> lk(mutex);
+		aborted = true;
+	}
+	consumed.notify_all();
+	task.wait();
+}
+
+/** Start a sampled scan of the clustered index, for collecting statistics.
+The leaf level is divided into ranges at the node pointers of the root page,
+and the ranges are read by up to n_readers tasks of srv_thread_pool. Only
+the records of the leaf pages (or of the rows) that are taken into the
+sample are converted to the MySQL format.
+@param[in,out]	prebuilt	table handle with a non-locking read view
+				and a template for the clustered index
+@param[in]	fraction	probability of taking a page or a row
+@param[in]	pages		whether to take whole leaf pages
+@param[in]	n_readers	maximum number of concurrent readers
+@return the scan, to be freed by row_sample_end() */
+row_sample_t*
+row_sample_start(
+	row_prebuilt_t*	prebuilt,
+	double		fraction,
+	bool		pages,
+	ulint		n_readers)
+{
+	ut_ad(prebuilt->select_lock_type == LOCK_NONE);
+	ut_ad(prebuilt->index->is_primary());
+	ut_ad(n_readers > 0);
+
+	row_sample_t*	sample = UT_NEW_NOKEY(
+		row_sample_t(prebuilt, fraction, pages));
+
+	/* A few ranges per reader even out the work, as the subtrees
+	of the root page are not of the same size. */
+	if (n_readers > 1) {
+		sample->split(4 * n_readers);
+	}
+
+	n_readers = std::min(n_readers, sample->n_ranges());
+	sample->n_running = n_readers;
+	sample->group.set_max_tasks(static_cast<unsigned>(n_readers));
+
+	for (ulint i = 0; i < n_readers; i++) {
+		srv_thread_pool->submit_task(&sample->task);
+	}
+
+	return(sample);
+}
+
+/** Fetch the next row of a sampled scan. The rows of different ranges
+are returned in no particular order.
+@param[in,out]	sample	sampled scan
+@param[out]	buf	row in the MySQL format; any BLOB data is valid
+			until the next call
+@return DB_SUCCESS, DB_END_OF_INDEX, or error code */
+dberr_t
+row_sample_next(row_sample_t* sample, byte* buf)
+{
+	return(sample->next(buf));
+}
+
+/** Stop a sampled scan and free it.
+@param[in,out]	sample	sampled scan */
+void
+row_sample_end(row_sample_t* sample)
+{
+	sample->end();
+	UT_DELETE(sample);
+}
@@ -848,6 +848,22 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_PAGE_HANDLED},
 
+	{"purge_undo_log_records", "purge",
+	 "Number of undo log records read by the purge",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_REC_READ},
+
+	{"purge_undo_log_readers", "purge",
+	 "Number of threads that read undo logs in the last purge batch",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_READERS},
+
+	{"purge_worker_max_records", "purge",
+	 "Largest number of undo log records handed to one purge thread"
+	 " in the last purge batch",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_WORKER_MAX_RECS},
+
 	{"purge_dml_delay_usec", "purge",
 	 "Microseconds DML to be delayed due to purge lagging",
 	 MONITOR_DISPLAY_CURRENT,
@@ -1093,6 +1109,18 @@ static monitor_info_t	innodb_counter_info[] =
 	 "Number of Adaptive Hash Index rows updated",
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_ROW_UPDATED},
+
+	{"adaptive_hash_searches_retried", "adaptive_hash_index",
+	 "Number of Adaptive Hash Index searches without latch that had to"
+	 " be repeated with the latch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_SEARCH_RETRY},
+
+	{"adaptive_hash_index_switched_off", "adaptive_hash_index",
+	 "Number of times the Adaptive Hash Index was switched off for an"
+	 " index because most hash searches on it failed",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_INDEX_OFF},
 #endif /* BTR_CUR_HASH_ADAPT */
 
 	/* ========== Counters for tablespace ========== */
@@ -1664,7 +1692,7 @@ srv_mon_process_existing_counter(
 	case MONITOR_OVLD_BUF_POOL_PAGE_MISC:
 		value = buf_pool.get_n_pages()
 			- UT_LIST_GET_LEN(buf_pool.LRU)
-			- UT_LIST_GET_LEN(buf_pool.free);
+			- buf_pool.free_len();
 		break;
 
 	/* innodb_buffer_pool_pages_data */
@@ -1691,7 +1719,7 @@ srv_mon_process_existing_counter(
 
 	/* innodb_buffer_pool_pages_free */
 	case MONITOR_OVLD_BUF_POOL_PAGES_FREE:
-		value = UT_LIST_GET_LEN(buf_pool.free);
+		value = buf_pool.free_len();
 		break;
 
 	/* innodb_pages_created, the number of pages created */
@@ -143,7 +143,13 @@ OS (provided we compiled Innobase with it in), otherwise we will
 use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 my_bool	srv_use_native_aio;
+#ifdef __linux__
+/** innodb_linux_aio */
+ulong	srv_linux_aio;
+#endif
 my_bool	srv_numa_interleave;
+/** innodb_numa_node_local: bind buffer pool chunks to NUMA nodes */
+my_bool	srv_numa_node_local;
 /** copy of innodb_use_atomic_writes; @see innodb_init_params() */
 my_bool	srv_use_atomic_writes;
 /** innodb_compression_algorithm; used with page compression */
@@ -211,6 +217,9 @@ number of locks to protect buf_pool.page_hash */
 ulong	srv_n_page_hash_locks = 16;
 /** innodb_lru_scan_depth; number of blocks scanned in LRU flush batch */
 ulong	srv_LRU_scan_depth;
+/** innodb_page_cleaners; number of page cleaner workers that flush
+disjoint segments of the LRU list and the flush_list in parallel */
+ulong	srv_n_page_cleaners;
 /** innodb_flush_neighbors; whether or not to flush neighbors of a block */
 ulong	srv_flush_neighbors;
 /** Previously requested size */
@@ -235,6 +244,8 @@ ulong	srv_idle_flush_pct;
 ulong	srv_n_read_io_threads;
 /** innodb_write_io_threads */
 ulong	srv_n_write_io_threads;
+/** innodb_recovery_apply_threads */
+ulong	srv_recovery_apply_threads = 4;
 
 /** innodb_random_read_ahead */
 my_bool	srv_random_read_ahead;
@@ -242,6 +253,8 @@ my_bool	srv_random_read_ahead;
 in the buffer cache and accessed sequentially for InnoDB to trigger a
 readahead request. */
 ulong	srv_read_ahead_threshold;
+/** innodb_fetch_cache_size */
+ulong	srv_fetch_cache_size = 128 << 10;
 
 /** innodb_change_buffer_max_size; maximum on-disk size of change
 buffer in terms of percentage of the buffer pool. */
@@ -1217,18 +1230,22 @@ srv_export_innodb_status(void)
 		buf_pool.stat.flush_list_bytes;
 
 	export_vars.innodb_buffer_pool_pages_free =
-		UT_LIST_GET_LEN(buf_pool.free);
+		buf_pool.free_len();
 
 #ifdef UNIV_DEBUG
 	export_vars.innodb_buffer_pool_pages_latched =
 		buf_get_latched_pages_number();
+	export_vars.innodb_buffer_pool_numa_local =
+		buf_pool.stat.n_numa_local;
+	export_vars.innodb_buffer_pool_numa_remote =
+		buf_pool.stat.n_numa_remote;
 #endif /* UNIV_DEBUG */
 	export_vars.innodb_buffer_pool_pages_total = buf_pool.get_n_pages();
 
 	export_vars.innodb_buffer_pool_pages_misc =
 		buf_pool.get_n_pages()
 		- UT_LIST_GET_LEN(buf_pool.LRU)
-		- UT_LIST_GET_LEN(buf_pool.free);
+		- buf_pool.free_len();
 
 	export_vars.innodb_max_trx_id = trx_sys.get_max_trx_id();
 	export_vars.innodb_history_list_length = trx_sys.rseg_history_len;
@@ -1402,7 +1419,7 @@ void srv_monitor_task(void*)
 		if (srv_print_innodb_monitor) {
 			/* Reset mutex_skipped counter everytime
 			srv_print_innodb_monitor changes. This is to
-			ensure we will not be blocked by lock_sys.mutex
+			ensure we will not be blocked by lock_sys.latch
 			for short duration information printing,
 			such as requested by sync_array_print_long_waits() */
 			if (!monitor_state.last_srv_print_monitor) {
@@ -480,6 +480,8 @@ LatchDebug::LatchDebug()
 	LEVEL_MAP_INSERT(SYNC_TRX);
 	LEVEL_MAP_INSERT(SYNC_RW_TRX_HASH_ELEMENT);
 	LEVEL_MAP_INSERT(SYNC_TRX_SYS);
+	LEVEL_MAP_INSERT(SYNC_LOCK_SYS_SHARD);
+	LEVEL_MAP_INSERT(SYNC_LOCK_SYS_DEADLOCK);
 	LEVEL_MAP_INSERT(SYNC_LOCK_SYS);
 	LEVEL_MAP_INSERT(SYNC_LOCK_WAIT_SYS);
 	LEVEL_MAP_INSERT(SYNC_INDEX_ONLINE_LOG);
@@ -758,6 +760,8 @@ LatchDebug::check_order(
 	case SYNC_SEARCH_SYS:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
+	case SYNC_LOCK_SYS_SHARD:
+	case SYNC_LOCK_SYS_DEADLOCK:
 	case SYNC_LOCK_WAIT_SYS:
 	case SYNC_RW_TRX_HASH_ELEMENT:
 	case SYNC_TRX_SYS:
@@ -807,7 +811,7 @@ LatchDebug::check_order(
 
 	case SYNC_TRX:
 
-		/* Either the thread must own the lock_sys.mutex, or
+		/* Either the thread must own the lock_sys.latch, or
 		it is allowed to own only ONE trx_t::mutex. */
 
 		if (less(latches, level) != NULL) {
@@ -1393,7 +1397,14 @@ sync_latch_meta_init()
 
 	LATCH_ADD_MUTEX(TRX, SYNC_TRX, trx_mutex_key);
 
-	LATCH_ADD_MUTEX(LOCK_SYS, SYNC_LOCK_SYS, lock_mutex_key);
+	LATCH_ADD_MUTEX(LOCK_SYS_SHARD, SYNC_LOCK_SYS_SHARD,
+			lock_sys_shard_mutex_key);
+
+	LATCH_ADD_MUTEX(LOCK_SYS_TABLE, SYNC_LOCK_SYS_SHARD,
+			lock_sys_table_mutex_key);
+
+	LATCH_ADD_MUTEX(LOCK_SYS_DEADLOCK, SYNC_LOCK_SYS_DEADLOCK,
+			lock_sys_deadlock_mutex_key);
 
 	LATCH_ADD_MUTEX(LOCK_SYS_WAIT, SYNC_LOCK_WAIT_SYS,
 			lock_wait_mutex_key);
@@ -1471,6 +1482,8 @@ sync_latch_meta_init()
 
 	LATCH_ADD_RWLOCK(TRX_PURGE, SYNC_PURGE_LATCH, trx_purge_latch_key);
 
+	LATCH_ADD_RWLOCK(LOCK_SYS, SYNC_LOCK_SYS, lock_sys_latch_key);
+
 	LATCH_ADD_RWLOCK(IBUF_INDEX_TREE, SYNC_IBUF_INDEX_TREE,
 			 index_tree_rw_lock_key);
 
@@ -83,7 +83,9 @@ mysql_pfs_key_t	buf_dblwr_mutex_key;
 mysql_pfs_key_t	trx_mutex_key;
 mysql_pfs_key_t	trx_pool_mutex_key;
 mysql_pfs_key_t	trx_pool_manager_mutex_key;
-mysql_pfs_key_t	lock_mutex_key;
+mysql_pfs_key_t	lock_sys_shard_mutex_key;
+mysql_pfs_key_t	lock_sys_table_mutex_key;
+mysql_pfs_key_t	lock_sys_deadlock_mutex_key;
 mysql_pfs_key_t	lock_wait_mutex_key;
 mysql_pfs_key_t	trx_sys_mutex_key;
 mysql_pfs_key_t	srv_sys_mutex_key;
@@ -112,6 +114,7 @@ mysql_pfs_key_t	fts_cache_rw_lock_key;
 mysql_pfs_key_t	fts_cache_init_rw_lock_key;
 mysql_pfs_key_t trx_i_s_cache_lock_key;
 mysql_pfs_key_t	trx_purge_latch_key;
+mysql_pfs_key_t	lock_sys_latch_key;
 #endif /* UNIV_PFS_RWLOCK */
 
 /** For monitoring active mutexes */
@@ -60,71 +60,70 @@ trx_undo_rec_t	trx_purge_dummy_rec;
 my_bool		srv_purge_view_update_only_debug;
 #endif /* UNIV_DEBUG */
 
-/** Sentinel value */
-static const TrxUndoRsegs NullElement;
-
-/** Default constructor */
-TrxUndoRsegsIterator::TrxUndoRsegsIterator()
-	: m_rsegs(NullElement), m_iter(m_rsegs.begin())
+/** An undo log record that was read by a purge_reader_t */
+struct purge_read_rec_t
 {
-}
-
-/** Sets the next rseg to purge in purge_sys.
-Executed in the purge coordinator thread.
-@return whether anything is to be purged */
-inline bool TrxUndoRsegsIterator::set_next()
+	/** the record and its roll pointer */
+	trx_purge_rec_t	rec;
+	/** trx_rseg_t::last_commit of the undo log */
+	trx_id_t	commit;
+	/** the table that the record belongs to */
+	table_id_t	table_id;
+	/** whether rec.undo_rec was copied to purge_batch.carry_heap */
+	bool		carried;
+};
+
+/** Reads undo logs of rollback segments in a purge batch. The readers
+of a batch run in parallel, each of them on one undo log at a time, so that
+the latency of reading the undo log pages is not serialized in the purge
+coordinator. */
+struct purge_reader_t
 {
-	mutex_enter(&purge_sys.pq_mutex);
-
-	/* Only purge consumes events from the priority queue, user
-	threads only produce the events. */
-
-	/* Check if there are more rsegs to process in the
-	current element. */
-	if (m_iter != m_rsegs.end()) {
-		/* We are still processing rollback segment from
-		the same transaction and so expected transaction
-		number shouldn't increase. Undo the increment of
-		expected commit done by caller assuming rollback
-		segments from given transaction are done. */
-		purge_sys.tail.commit = (*m_iter)->last_commit;
-	} else if (!purge_sys.purge_queue.empty()) {
-		m_rsegs = purge_sys.purge_queue.top();
-		purge_sys.purge_queue.pop();
-		ut_ad(purge_sys.purge_queue.empty()
-		      || purge_sys.purge_queue.top() != m_rsegs);
-		m_iter = m_rsegs.begin();
-	} else {
-		/* Queue is empty, reset iterator. */
-		purge_sys.rseg = NULL;
-		mutex_exit(&purge_sys.pq_mutex);
-		m_rsegs = NullElement;
-		m_iter = m_rsegs.begin();
-		return false;
-	}
-
-	purge_sys.rseg = *m_iter++;
-	mutex_exit(&purge_sys.pq_mutex);
-	mutex_enter(&purge_sys.rseg->mutex);
-
-	ut_a(purge_sys.rseg->last_page_no != FIL_NULL);
-	ut_ad(purge_sys.rseg->last_trx_no() == m_rsegs.trx_no());
-
-	/* We assume in purge of externally stored fields that space id is
-	in the range of UNDO tablespace space ids */
-	ut_ad(purge_sys.rseg->space->id == TRX_SYS_SPACE
-	      || srv_is_undo_tablespace(purge_sys.rseg->space->id));
-
-	ut_a(purge_sys.tail.commit <= purge_sys.rseg->last_commit);
-
-	purge_sys.tail.commit = purge_sys.rseg->last_commit;
-	purge_sys.hdr_offset = purge_sys.rseg->last_offset;
-	purge_sys.hdr_page_no = purge_sys.rseg->last_page_no;
-
-	mutex_exit(&purge_sys.rseg->mutex);
-
-	return(true);
-}
+	/** Heap for the copies of the undo log records */
+	mem_heap_t*	heap;
+	/** The undo log records that were read in the current batch */
+	std::vector<purge_read_rec_t, ut_allocator<purge_read_rec_t> >
+			recs;
+
+	purge_reader_t() : heap(mem_heap_create(4096)) {}
+	~purge_reader_t() { mem_heap_free(heap); }
+};
+
+/** State of the undo log reading in the current purge batch */
+static struct
+{
+	/** Number of readers that have been started */
+	std::atomic<ulint>	n_readers;
+	/** Number of undo log pages handled */
+	std::atomic<ulint>	n_pages;
+	/** Maximum number of undo log pages to handle */
+	ulint			batch_size;
+	/** Number of undo logs that were started to be read in the batch */
+	ulint			n_logs;
+	/** Undo logs of transactions that committed at or after this
+	are not purged in the batch */
+	trx_id_t		low_limit_no;
+	/** The records of all readers, in the order of purging */
+	std::vector<purge_read_rec_t, ut_allocator<purge_read_rec_t> >
+				recs;
+	/** Records that were read ahead of the oldest undo log that was
+	not completely read by the previous batch. They are purged by a
+	later batch, so that the records are purged in the order of commit. */
+	std::vector<purge_read_rec_t, ut_allocator<purge_read_rec_t> >
+				carry;
+	/** Number of undo log pages that the records in carry span.
+	They count against batch_size when reading ahead, so that
+	the carry cannot grow beyond one batch. */
+	ulint			carry_pages;
+	/** Heap for the undo log records in carry, or NULL */
+	mem_heap_t*		carry_heap;
+} purge_batch;
+
+static void trx_purge_read_callback(void*);
+
+static tpool::task_group purge_read_task_group;
+static tpool::waitable_task purge_read_task(trx_purge_read_callback, nullptr,
+					    &purge_read_task_group);
 
 /** Build a purge 'query' graph. The actual purge is performed by executing
 this query graph.
@@ -160,28 +159,23 @@ purge_graph_build()
 void purge_sys_t::create()
 {
   ut_ad(this == &purge_sys);
-  ut_ad(!heap);
+  ut_ad(!readers);
   ut_ad(!enabled());
   m_paused= 0;
   query= purge_graph_build();
-  next_stored= false;
-  rseg= NULL;
-  page_no= 0;
-  offset= 0;
-  hdr_page_no= 0;
-  hdr_offset= 0;
   rw_lock_create(trx_purge_latch_key, &latch, SYNC_PURGE_LATCH);
   mutex_create(LATCH_ID_PURGE_SYS_PQ, &pq_mutex);
   truncate.current= NULL;
   truncate.last= NULL;
-  heap= mem_heap_create(4096);
+  readers= UT_NEW_ARRAY_NOKEY(purge_reader_t, srv_n_purge_threads);
+  purge_read_task_group.set_max_tasks(srv_n_purge_threads - 1);
 }
 
 /** Close the purge subsystem on shutdown. */
 void purge_sys_t::close()
 {
   ut_ad(this == &purge_sys);
-  if (!heap)
+  if (!readers)
     return;
 
   ut_ad(!enabled());
@@ -193,8 +187,15 @@ void purge_sys_t::close()
   trx_free(trx);
   rw_lock_free(&latch);
   mutex_free(&pq_mutex);
-  mem_heap_free(heap);
-  heap= nullptr;
+  UT_DELETE_ARRAY(readers);
+  readers= nullptr;
+  purge_batch.carry.clear();
+  purge_batch.carry_pages= 0;
+  if (purge_batch.carry_heap)
+  {
+    mem_heap_free(purge_batch.carry_heap);
+    purge_batch.carry_heap= nullptr;
+  }
 }
 
 /*================ UNDO LOG HISTORY LIST =============================*/
@@ -549,9 +550,7 @@ function is called, the caller must not have any latches on undo log pages!
 */
 static void trx_purge_truncate_history()
 {
-	ut_ad(purge_sys.head <= purge_sys.tail);
-	purge_sys_t::iterator& head = purge_sys.head.commit
-		? purge_sys.head : purge_sys.tail;
+	purge_sys_t::iterator& head = purge_sys.head;
 
 	if (head.trx_no() >= purge_sys.view.low_limit_no()) {
 		/* This is sometimes necessary. TODO: find out why. */
@@ -756,6 +755,7 @@ static void trx_purge_truncate_history()
 			rseg->last_offset = 0;
 			rseg->last_commit = 0;
 			rseg->needs_purge = false;
+			rseg->purge_page_no = FIL_NULL;
 		}
 
 		mtr.commit();
@@ -779,21 +779,6 @@ static void trx_purge_truncate_history()
 		purge_sys.truncate.current->is_being_truncated = false;
 		mutex_exit(&fil_system.mutex);
 
-		if (purge_sys.rseg != NULL
-		    && purge_sys.rseg->last_page_no == FIL_NULL) {
-			/* If purge_sys.rseg is pointing to rseg that
-			was recently truncated then move to next rseg
-			element.  Note: Ideally purge_sys.rseg should
-			be NULL because purge should complete
-			processing of all the records but there is
-			purge_batch_size that can force the purge loop
-			to exit before all the records are purged and
-			in this case purge_sys.rseg could point to a
-			valid rseg waiting for next purge cycle. */
-			purge_sys.next_stored = false;
-			purge_sys.rseg = NULL;
-		}
-
 		DBUG_EXECUTE_IF("ib_undo_trunc",
 				ib::info() << "ib_undo_trunc";
 				log_write_up_to(LSN_MAX, true);
@@ -814,37 +799,32 @@ static void trx_purge_truncate_history()
 	}
 }
 
-/***********************************************************************//**
-Updates the last not yet purged history log info in rseg when we have purged
-a whole undo log. Advances also purge_sys.purge_trx_no past the purged log. */
-static void trx_purge_rseg_get_next_history_log(
-	ulint*		n_pages_handled)/*!< in/out: number of UNDO pages
-					handled */
+/** Advance to the previous undo log in the history list of a rollback
+segment, after the last not yet purged log has been read.
+@param[in,out]	rseg	rollback segment that is being read by purge
+@return whether any history is left in the rollback segment */
+static bool trx_purge_rseg_next_log(trx_rseg_t& rseg)
 {
 	fil_addr_t	prev_log_addr;
 	trx_id_t	trx_no;
 	mtr_t		mtr;
 
-	mutex_enter(&purge_sys.rseg->mutex);
+	mutex_enter(&rseg.mutex);
 
-	ut_a(purge_sys.rseg->last_page_no != FIL_NULL);
+	ut_a(rseg.last_page_no != FIL_NULL);
 
-	purge_sys.tail.commit = purge_sys.rseg->last_commit + 1;
-	purge_sys.tail.undo_no = 0;
-	purge_sys.next_stored = false;
+	rseg.purge_page_no = FIL_NULL;
 
 	mtr.start();
 
 	const buf_block_t* undo_page = trx_undo_page_get_s_latched(
-		page_id_t(purge_sys.rseg->space->id,
-			  purge_sys.rseg->last_page_no), &mtr);
+		page_id_t(rseg.space->id, rseg.last_page_no), &mtr);
 
-	const trx_ulogf_t* log_hdr = undo_page->frame
-		+ purge_sys.rseg->last_offset;
+	const trx_ulogf_t* log_hdr = undo_page->frame + rseg.last_offset;
 
 	/* Increase the purge page count by one for every handled log */
 
-	(*n_pages_handled)++;
+	purge_batch.n_pages++;
 
 	prev_log_addr = flst_get_prev_addr(log_hdr + TRX_UNDO_HISTORY_NODE);
 	prev_log_addr.boffset = static_cast<uint16_t>(prev_log_addr.boffset
@@ -854,22 +834,24 @@ static void trx_purge_rseg_get_next_history_log(
 	const bool empty = prev_log_addr.page == FIL_NULL;
 
 	if (empty) {
-		/* No logs left in the history list */
-		purge_sys.rseg->last_page_no = FIL_NULL;
+		/* No logs left in the history list. From now on,
+		trx_serialise() may add the rollback segment to
+		purge_sys.purge_queue again. */
+		rseg.last_page_no = FIL_NULL;
 	}
 
-	mutex_exit(&purge_sys.rseg->mutex);
+	mutex_exit(&rseg.mutex);
 	mtr.commit();
 
 	if (empty) {
-		return;
+		return(false);
 	}
 
 	/* Read the previous log header. */
 	mtr.start();
 
 	log_hdr = trx_undo_page_get_s_latched(
-		page_id_t(purge_sys.rseg->space->id, prev_log_addr.page),
+		page_id_t(rseg.space->id, prev_log_addr.page),
 		&mtr)->frame
 		+ prev_log_addr.boffset;
 
@@ -879,212 +861,203 @@ static void trx_purge_rseg_get_next_history_log(
 
 	mtr_commit(&mtr);
 
-	mutex_enter(&purge_sys.rseg->mutex);
-
-	purge_sys.rseg->last_page_no = prev_log_addr.page;
-	purge_sys.rseg->last_offset = prev_log_addr.boffset;
-	purge_sys.rseg->set_last_trx_no(trx_no, purge != 0);
-	purge_sys.rseg->needs_purge = purge != 0;
-
-	/* Purge can also produce events, however these are already ordered
-	in the rollback segment and any user generated event will be greater
-	than the events that Purge produces. ie. Purge can never produce
-	events from an empty rollback segment. */
-
-	mutex_enter(&purge_sys.pq_mutex);
+	mutex_enter(&rseg.mutex);
 
-	purge_sys.purge_queue.push(*purge_sys.rseg);
+	rseg.last_page_no = prev_log_addr.page;
+	rseg.last_offset = prev_log_addr.boffset;
+	rseg.set_last_trx_no(trx_no, purge != 0);
+	rseg.needs_purge = purge != 0;
 
-	mutex_exit(&purge_sys.pq_mutex);
+	mutex_exit(&rseg.mutex);
 
-	mutex_exit(&purge_sys.rseg->mutex);
+	return(true);
 }
 
-/** Position the purge sys "iterator" on the undo record to use for purging. */
-static
-void
-trx_purge_read_undo_rec()
+/** Position the purge of a rollback segment on the first undo record
+of its last not yet purged log.
+@param[in,out]	rseg	rollback segment that is being read by purge
+@return whether the undo log contains any records */
+static bool trx_purge_read_first_rec(trx_rseg_t& rseg)
 {
-	uint16_t	offset;
-	uint32_t	page_no;
-	ib_uint64_t	undo_no;
-
-	purge_sys.hdr_offset = purge_sys.rseg->last_offset;
-	page_no = purge_sys.hdr_page_no = purge_sys.rseg->last_page_no;
+	mtr_t		mtr;
+	buf_block_t*	undo_page;
 
-	if (purge_sys.rseg->needs_purge) {
-		mtr_t		mtr;
-		mtr.start();
-		buf_block_t* undo_page;
-		if (trx_undo_rec_t* undo_rec = trx_undo_get_first_rec(
-			    *purge_sys.rseg->space, purge_sys.hdr_page_no,
-			    purge_sys.hdr_offset, RW_S_LATCH,
-			    undo_page, &mtr)) {
-
-			offset = page_offset(undo_rec);
-			undo_no = trx_undo_rec_get_undo_no(undo_rec);
-			page_no = undo_page->page.id.page_no();
-		} else {
-			offset = 0;
-			undo_no = 0;
-		}
+	ut_ad(rseg.purge_page_no == FIL_NULL);
 
-		mtr.commit();
-	} else {
-		offset = 0;
-		undo_no = 0;
-	}
+	mtr.start();
 
-	purge_sys.offset = offset;
-	purge_sys.page_no = page_no;
-	purge_sys.tail.undo_no = undo_no;
+	const trx_undo_rec_t* undo_rec = trx_undo_get_first_rec(
+		*rseg.space, rseg.last_page_no, rseg.last_offset, RW_S_LATCH,
+		undo_page, &mtr);
 
-	purge_sys.next_stored = true;
-}
+	if (undo_rec) {
+		rseg.purge_page_no = undo_page->page.id.page_no();
+		rseg.purge_offset = page_offset(undo_rec);
+		rseg.purge_undo_no = trx_undo_rec_get_undo_no(undo_rec);
+	}
 
-/***********************************************************************//**
-Chooses the next undo log to purge and updates the info in purge_sys. This
-function is used to initialize purge_sys when the next record to purge is
-not known, and also to update the purge system info on the next record when
-purge has handled the whole undo log for a transaction. */
-static
-void
-trx_purge_choose_next_log(void)
-/*===========================*/
-{
-	ut_ad(!purge_sys.next_stored);
+	mtr.commit();
 
-	if (purge_sys.rseg_iter.set_next()) {
-		trx_purge_read_undo_rec();
-	} else {
-		/* There is nothing to do yet. */
-		os_thread_yield();
-	}
+	return(undo_rec != NULL);
 }
 
-/***********************************************************************//**
-Gets the next record to purge and updates the info in the purge system.
-@return copy of an undo log record or pointer to the dummy undo log record */
-static
-trx_undo_rec_t*
-trx_purge_get_next_rec(
-/*===================*/
-	ulint*		n_pages_handled,/*!< in/out: number of UNDO pages
-					handled */
-	mem_heap_t*	heap)		/*!< in: memory heap where copied */
+/** Copy the next undo record of a rollback segment to purge, and advance
+the position of the rollback segment.
+@param[in,out]	rseg	rollback segment that is being read by purge
+@param[in,out]	reader	undo log reader
+@return whether more records are left in the undo log */
+static bool trx_purge_read_rec(trx_rseg_t& rseg, purge_reader_t& reader)
 {
-	mtr_t		mtr;
-
-	ut_ad(purge_sys.next_stored);
-	ut_ad(purge_sys.tail.trx_no() < purge_sys.view.low_limit_no());
-
-	const ulint space = purge_sys.rseg->space->id;
-	const uint32_t page_no = purge_sys.page_no;
-	const uint16_t offset = purge_sys.offset;
-
-	if (offset == 0) {
-		/* It is the dummy undo log record, which means that there is
-		no need to purge this undo log */
-
-		trx_purge_rseg_get_next_history_log(n_pages_handled);
+	mtr_t			mtr;
+	purge_read_rec_t	r;
 
-		/* Look for the next undo log and record to purge */
+	ut_ad(rseg.purge_page_no != FIL_NULL);
 
-		trx_purge_choose_next_log();
-
-		return(&trx_purge_dummy_rec);
-	}
-
-	mtr_start(&mtr);
+	mtr.start();
 
 	buf_block_t* undo_page = trx_undo_page_get_s_latched(
-		page_id_t(space, page_no), &mtr);
-	buf_block_t* rec2_page = undo_page;
-
-	const trx_undo_rec_t* rec2 = trx_undo_page_get_next_rec(
-		undo_page, offset, purge_sys.hdr_page_no, purge_sys.hdr_offset);
-
-	if (rec2 == NULL) {
-		rec2 = trx_undo_get_next_rec(rec2_page, offset,
-					     purge_sys.hdr_page_no,
-					     purge_sys.hdr_offset, &mtr);
+		page_id_t(rseg.space->id, rseg.purge_page_no), &mtr);
+
+	r.rec.undo_rec = trx_undo_rec_copy(undo_page->frame
+					   + rseg.purge_offset, reader.heap);
+	/* row_purge_record_func() will later set ROLL_PTR_INSERT_FLAG
+	for TRX_UNDO_INSERT_REC */
+	r.rec.roll_ptr = trx_undo_build_roll_ptr(
+		false, rseg.id, rseg.purge_page_no, rseg.purge_offset);
+	r.commit = rseg.last_commit;
+	r.table_id = trx_undo_rec_get_table_id(r.rec.undo_rec);
+	r.carried = false;
+	reader.recs.push_back(r);
+
+	buf_block_t* next_page = undo_page;
+
+	const trx_undo_rec_t* next = trx_undo_page_get_next_rec(
+		undo_page, rseg.purge_offset,
+		rseg.last_page_no, rseg.last_offset);
+
+	if (next == NULL) {
+		next = trx_undo_get_next_rec(next_page, rseg.purge_offset,
+					     rseg.last_page_no,
+					     rseg.last_offset, &mtr);
 	}
 
-	if (rec2 == NULL) {
-		mtr_commit(&mtr);
-
-		trx_purge_rseg_get_next_history_log(n_pages_handled);
-
-		/* Look for the next undo log and record to purge */
-
-		trx_purge_choose_next_log();
-
-		mtr_start(&mtr);
-
-		undo_page = trx_undo_page_get_s_latched(
-			page_id_t(space, page_no), &mtr);
+	if (next == NULL) {
+		rseg.purge_page_no = FIL_NULL;
 	} else {
-		purge_sys.offset = page_offset(rec2);
-		purge_sys.page_no = rec2_page->page.id.page_no();
-		purge_sys.tail.undo_no = trx_undo_rec_get_undo_no(rec2);
-
-		if (undo_page != rec2_page) {
+		if (next_page != undo_page) {
 			/* We advance to a new page of the undo log: */
-			(*n_pages_handled)++;
+			purge_batch.n_pages++;
 		}
-	}
 
-	trx_undo_rec_t*	rec_copy = trx_undo_rec_copy(undo_page->frame + offset,
-						     heap);
+		rseg.purge_page_no = next_page->page.id.page_no();
+		rseg.purge_offset = page_offset(next);
+		rseg.purge_undo_no = trx_undo_rec_get_undo_no(next);
+	}
 
-	mtr_commit(&mtr);
+	mtr.commit();
 
-	return(rec_copy);
+	return(next != NULL);
 }
 
-/********************************************************************//**
-Fetches the next undo log record from the history list to purge. It must be
-released with the corresponding release function.
-@return copy of an undo log record or pointer to trx_purge_dummy_rec,
-if the whole undo log can skipped in purge; NULL if none left */
-static MY_ATTRIBUTE((warn_unused_result))
-trx_undo_rec_t*
-trx_purge_fetch_next_rec(
-/*=====================*/
-	roll_ptr_t*	roll_ptr,	/*!< out: roll pointer to undo record */
-	ulint*		n_pages_handled,/*!< in/out: number of UNDO log pages
-					handled */
-	mem_heap_t*	heap)		/*!< in: memory heap where copied */
+/** Read the last not yet purged undo log of a rollback segment for
+a purge batch, until the end of the log or until the batch is full.
+@param[in,out]	rseg	rollback segment that was removed from
+			purge_sys.purge_queue
+@param[in,out]	reader	undo log reader
+@param[in]	limit	maximum value of purge_batch.n_pages
+@return whether any history is left in the rollback segment */
+static bool trx_purge_read_log(trx_rseg_t& rseg, purge_reader_t& reader,
+			       ulint limit)
 {
-	if (!purge_sys.next_stored) {
-		trx_purge_choose_next_log();
-
-		if (!purge_sys.next_stored) {
-			DBUG_PRINT("ib_purge",
-				   ("no logs left in the history list"));
-			return(NULL);
+	/* We assume in purge of externally stored fields that space id is
+	in the range of UNDO tablespace space ids */
+	ut_ad(rseg.space->id == TRX_SYS_SPACE
+	      || srv_is_undo_tablespace(rseg.space->id));
+	ut_ad(rseg.last_page_no != FIL_NULL);
+	ut_ad(rseg.last_trx_no() < purge_batch.low_limit_no);
+
+	/* The fields of the rollback segment that are read here are
+	only modified by trx_purge_add_undo_to_history() when the history
+	list of the rollback segment is empty. */
+	if (rseg.purge_page_no != FIL_NULL
+	    || (rseg.needs_purge && trx_purge_read_first_rec(rseg))) {
+		/* Read at least one record, so that every batch advances
+		the oldest undo log that it started to read. */
+		while (trx_purge_read_rec(rseg, reader)) {
+			if (purge_batch.n_pages >= limit
+			    || (UNIV_UNLIKELY(!srv_undo_sources)
+				&& srv_fast_shutdown)) {
+				return(true);
+			}
 		}
 	}
 
-	if (purge_sys.tail.trx_no() >= purge_sys.view.low_limit_no()) {
+	return(trx_purge_rseg_next_log(rseg));
+}
 
-		return(NULL);
-	}
+/** Read undo logs for a purge batch, until all undo logs that are
+visible to the purge view have been read or the batch is full. The undo
+logs are removed from purge_sys.purge_queue in the order of commit, and
+a rollback segment is returned to the queue when one log has been read.
+This is executed by the purge coordinator and by up to
+n_purge_threads - 1 tasks of srv_thread_pool. */
+static void trx_purge_read_callback(void*)
+{
+	const ulint n = purge_batch.n_readers++;
+	ut_ad(n < srv_n_purge_threads);
+	purge_reader_t& reader = purge_sys.readers[n];
+
+	while (purge_batch.n_pages < purge_batch.batch_size
+	       && (UNIV_LIKELY(srv_undo_sources) || !srv_fast_shutdown)) {
+		trx_rseg_t*	rseg = NULL;
+		/* The oldest undo log is read up to the full batch size,
+		so that the records carried over from the previous batch
+		can eventually be purged. The newer logs are only read
+		ahead as far as the carried records leave room for. */
+		ulint		limit = purge_batch.batch_size;
+
+		mutex_enter(&purge_sys.pq_mutex);
+
+		if (purge_batch.n_logs) {
+			limit = purge_batch.carry_pages < limit
+				? limit - purge_batch.carry_pages : 0;
+		}
 
-	/* fprintf(stderr, "Thread %lu purging trx %llu undo record %llu\n",
-	os_thread_get_curr_id(), iter->trx_no, iter->undo_no); */
+		if (purge_batch.n_pages < limit
+		    && !purge_sys.purge_queue.empty()
+		    && purge_sys.purge_queue.top().trx_no()
+		    < purge_batch.low_limit_no) {
+			purge_batch.n_logs++;
+			TrxUndoRsegs elem = purge_sys.purge_queue.top();
+			purge_sys.purge_queue.pop();
+
+			TrxUndoRsegs::iterator it = elem.begin();
+			ut_ad(it != elem.end());
+			rseg = *it;
+			elem.erase(it);
+			/* Any other rollback segments of the
+			transaction are left to other readers. */
+			if (!elem.empty()) {
+				purge_sys.purge_queue.push(elem);
+			}
+		}
 
-	*roll_ptr = trx_undo_build_roll_ptr(
-		/* row_purge_record_func() will later set
-		ROLL_PTR_INSERT_FLAG for TRX_UNDO_INSERT_REC */
-		false,
-		purge_sys.rseg->id,
-		purge_sys.page_no, purge_sys.offset);
+		mutex_exit(&purge_sys.pq_mutex);
 
-	/* The following call will advance the stored values of the
-	purge iterator. */
+		if (!rseg) {
+			break;
+		}
+
+		ut_ad(rseg->last_trx_no() < purge_batch.low_limit_no);
 
-	return(trx_purge_get_next_rec(n_pages_handled, heap));
+		if (trx_purge_read_log(*rseg, reader, limit)) {
+			mutex_enter(&rseg->mutex);
+			mutex_enter(&purge_sys.pq_mutex);
+			purge_sys.purge_queue.push(*rseg);
+			mutex_exit(&purge_sys.pq_mutex);
+			mutex_exit(&rseg->mutex);
+		}
+	}
 }
 
 /** Run a purge batch.
@@ -1096,13 +1069,10 @@ trx_purge_attach_undo_recs(ulint n_purge_threads)
 {
 	que_thr_t*	thr;
 	ulint		i;
-	ulint		n_pages_handled = 0;
 	ulint		n_thrs = UT_LIST_GET_LEN(purge_sys.query->thrs);
 
 	ut_a(n_purge_threads > 0);
 
-	purge_sys.head = purge_sys.tail;
-
 #ifdef UNIV_DEBUG
 	i = 0;
 	/* Debug code to validate some pre-requisites and reset done flag. */
@@ -1126,55 +1096,205 @@ trx_purge_attach_undo_recs(ulint n_purge_threads)
 	ut_ad(i == n_purge_threads);
 #endif
 
-	/* Fetch and parse the UNDO records. The UNDO records are added
-	to a per purge node vector. */
 	thr = UT_LIST_GET_FIRST(purge_sys.query->thrs);
 	ut_a(n_thrs > 0 && thr != NULL);
 
-	ut_ad(purge_sys.head <= purge_sys.tail);
+	purge_batch.low_limit_no = purge_sys.view.low_limit_no();
+	purge_batch.batch_size = srv_purge_batch_size;
+	purge_batch.n_pages = 0;
+	purge_batch.n_readers = 0;
+	purge_batch.recs.clear();
+
+	purge_batch.n_logs = 0;
+
+	/* The records that were carried over from the previous batch
+	may point to the heaps that are about to be emptied. Each record
+	is copied to carry_heap once; the heap is only rebuilt when most
+	of it is occupied by records that were purged already. */
+	if (purge_batch.carry.empty()) {
+		if (purge_batch.carry_heap) {
+			mem_heap_free(purge_batch.carry_heap);
+			purge_batch.carry_heap = NULL;
+		}
+	} else {
+		ulint	carry_size = 0;
+
+		for (std::vector<purge_read_rec_t,
+			 ut_allocator<purge_read_rec_t> >::const_iterator
+			     it = purge_batch.carry.begin();
+		     it != purge_batch.carry.end(); ++it) {
+			carry_size += mach_read_from_2(it->rec.undo_rec);
+		}
 
-	i = 0;
+		mem_heap_t*	old_heap = NULL;
 
-	const ulint		batch_size = srv_purge_batch_size;
-	std::map<table_id_t, purge_node_t*>	table_id_map;
-	mem_heap_empty(purge_sys.heap);
+		if (!purge_batch.carry_heap) {
+			purge_batch.carry_heap = mem_heap_create(4096);
+		} else if (mem_heap_get_size(purge_batch.carry_heap)
+			   > 2 * carry_size + 4096) {
+			old_heap = purge_batch.carry_heap;
+			purge_batch.carry_heap = mem_heap_create(4096);
+		}
 
-	while (UNIV_LIKELY(srv_undo_sources) || !srv_fast_shutdown) {
-		purge_node_t*		node;
-		trx_purge_rec_t		purge_rec;
+		for (std::vector<purge_read_rec_t,
+			 ut_allocator<purge_read_rec_t> >::iterator
+			     it = purge_batch.carry.begin();
+		     it != purge_batch.carry.end(); ++it) {
+			if (!it->carried || old_heap) {
+				it->rec.undo_rec = static_cast<trx_undo_rec_t*>(
+					mem_heap_dup(purge_batch.carry_heap,
+						     it->rec.undo_rec,
+						     mach_read_from_2(
+							     it->rec.undo_rec)));
+				it->carried = true;
+			}
+		}
 
-		ut_a(!thr->is_active);
+		if (old_heap) {
+			mem_heap_free(old_heap);
+		}
+	}
 
-		/* Get the purge node. */
-		node = (purge_node_t*) thr->child;
-		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+	for (i = 0; i < n_purge_threads; i++) {
+		mem_heap_empty(purge_sys.readers[i].heap);
+		purge_sys.readers[i].recs.clear();
+	}
+
+	/* Only purge consumes events from the priority queue, user threads
+	only produce events for rollback segments that are not in the queue
+	and have no history. */
+	mutex_enter(&purge_sys.pq_mutex);
 
-		/* Track the max {trx_id, undo_no} for truncating the
-		UNDO logs once we have purged the records. */
+	const ulint n_readers = purge_sys.purge_queue.empty()
+		|| purge_sys.purge_queue.top().trx_no()
+		>= purge_batch.low_limit_no
+		? 0
+		: std::min<ulint>(n_purge_threads,
+				  purge_sys.purge_queue.size());
 
-		if (purge_sys.head <= purge_sys.tail) {
-			purge_sys.head = purge_sys.tail;
+	mutex_exit(&purge_sys.pq_mutex);
+
+	if (n_readers) {
+		for (i = 1; i < n_readers; i++) {
+			srv_thread_pool->submit_task(&purge_read_task);
 		}
 
-		/* Fetch the next record, and advance the purge_sys.tail. */
-		purge_rec.undo_rec = trx_purge_fetch_next_rec(
-			&purge_rec.roll_ptr, &n_pages_handled,
-			purge_sys.heap);
+		trx_purge_read_callback(nullptr);
 
-		if (purge_rec.undo_rec == NULL) {
-			break;
-		} else if (purge_rec.undo_rec == &trx_purge_dummy_rec) {
-			continue;
+		bool notify_wait = purge_read_task.is_running();
+
+		if (notify_wait) {
+			tpool::tpool_wait_begin();
 		}
 
-		table_id_t table_id = trx_undo_rec_get_table_id(
-			purge_rec.undo_rec);
+		purge_read_task.wait();
 
-		auto it = table_id_map.find(table_id);
+		if (notify_wait) {
+			tpool::tpool_wait_end();
+		}
+	}
+
+	/* All rollback segments that still have history were returned to
+	the queue. The oldest one of them is the limit of the batch: the
+	records of any newer undo logs that were read by another reader
+	are carried over to a later batch, so that every batch purges the
+	history in the order of commit. Anything older than the limit can
+	be truncated once the records of this batch have been purged. */
+	purge_sys_t::iterator	head;
+	head.reset_trx_no(purge_batch.low_limit_no);
+	head.undo_no = 0;
+
+	mutex_enter(&purge_sys.pq_mutex);
+
+	if (!purge_sys.purge_queue.empty()
+	    && purge_sys.purge_queue.top().trx_no()
+	    < purge_batch.low_limit_no) {
+		const TrxUndoRsegs& elem = purge_sys.purge_queue.top();
+
+		for (TrxUndoRsegs::const_iterator it = elem.begin();
+		     it != elem.end(); ++it) {
+			const trx_rseg_t*	rseg = *it;
+			ut_ad(rseg->last_trx_no() == elem.trx_no());
+
+			purge_sys_t::iterator	pos;
+			pos.commit = rseg->last_commit;
+			pos.undo_no = rseg->purge_page_no == FIL_NULL
+				? 0 : rseg->purge_undo_no;
+
+			if (pos <= head) {
+				head = pos;
+			}
+		}
+	}
+
+	mutex_exit(&purge_sys.pq_mutex);
+
+	purge_sys.head = head;
+
+	/* Purge the records in the order of commit, because changes of
+	a row that were made by different transactions may be in different
+	rollback segments. Each undo log is read by one reader at a time,
+	and any carried over records of a log precede the ones that were
+	read in this batch, so that a stable sort keeps the records of
+	each log in order. */
+	purge_batch.recs.swap(purge_batch.carry);
+
+	ulint	n_read = 0;
+
+	for (i = 0; i < n_readers; i++) {
+		const purge_reader_t& reader = purge_sys.readers[i];
+		purge_batch.recs.insert(purge_batch.recs.end(),
+					reader.recs.begin(),
+					reader.recs.end());
+		n_read += reader.recs.size();
+	}
+
+	std::stable_sort(purge_batch.recs.begin(), purge_batch.recs.end(),
+			 [](const purge_read_rec_t& a,
+			    const purge_read_rec_t& b)
+			 { return a.commit < b.commit; });
+
+	std::vector<purge_read_rec_t, ut_allocator<purge_read_rec_t> >
+		::iterator	end = std::upper_bound(
+			purge_batch.recs.begin(), purge_batch.recs.end(),
+			head.commit,
+			[](trx_id_t commit, const purge_read_rec_t& r)
+			{ return commit < r.commit; });
+
+	purge_batch.carry.assign(end, purge_batch.recs.end());
+	purge_batch.recs.erase(end, purge_batch.recs.end());
+
+	/* The records of an undo log are adjacent in carry. */
+	purge_batch.carry_pages = 0;
+
+	for (std::vector<purge_read_rec_t,
+		 ut_allocator<purge_read_rec_t> >::const_iterator
+		     it = purge_batch.carry.begin();
+	     it != purge_batch.carry.end(); ++it) {
+		if (it == purge_batch.carry.begin()
+		    || (it->rec.roll_ptr >> ROLL_PTR_PAGE_POS)
+		    != (it[-1].rec.roll_ptr >> ROLL_PTR_PAGE_POS)) {
+			purge_batch.carry_pages++;
+		}
+	}
+
+	/* Hand out the records to the purge nodes. All records of a table
+	are handled by the same node, to avoid contention between the
+	purge threads on the table and its indexes. */
+	i = 0;
+
+	std::map<table_id_t, purge_node_t*>	table_id_map;
+
+	for (std::vector<purge_read_rec_t,
+		 ut_allocator<purge_read_rec_t> >::const_iterator
+		     it = purge_batch.recs.begin();
+	     it != purge_batch.recs.end(); ++it) {
+		purge_node_t*& node = table_id_map[it->table_id];
+
+		if (node == NULL) {
+			node = (purge_node_t*) thr->child;
+			ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
 
-		if (it != table_id_map.end()) {
-			node = it->second;
-		} else {
 			thr = UT_LIST_GET_NEXT(thrs, thr);
 
 			if (!(++i % n_purge_threads)) {
@@ -1183,19 +1303,27 @@ trx_purge_attach_undo_recs(ulint n_purge_threads)
 			}
 
 			ut_a(thr != NULL);
-			table_id_map.insert({table_id, node});
 		}
 
-		node->undo_recs.push(purge_rec);
+		node->undo_recs.push(it->rec);
+	}
 
-		if (n_pages_handled >= batch_size) {
-			break;
-		}
+	ulint	max_recs = 0;
+
+	i = 0;
+
+	for (thr = UT_LIST_GET_FIRST(purge_sys.query->thrs);
+	     thr != NULL && i < n_purge_threads;
+	     thr = UT_LIST_GET_NEXT(thrs, thr), ++i) {
+		const purge_node_t* node = (purge_node_t*) thr->child;
+		max_recs = std::max<ulint>(max_recs, node->undo_recs.size());
 	}
 
-	ut_ad(purge_sys.head <= purge_sys.tail);
+	MONITOR_INC_VALUE(MONITOR_PURGE_N_REC_READ, n_read);
+	MONITOR_SET(MONITOR_PURGE_N_READERS, n_readers);
+	MONITOR_SET(MONITOR_PURGE_WORKER_MAX_RECS, max_recs);
 
-	return(n_pages_handled);
+	return(purge_batch.n_pages);
 }
 
 /*******************************************************************//**
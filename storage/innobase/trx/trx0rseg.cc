@@ -399,6 +399,7 @@ trx_rseg_mem_create(ulint id, fil_space_t* space, ulint page_no)
 	rseg->space = space;
 	rseg->page_no = page_no;
 	rseg->last_page_no = FIL_NULL;
+	rseg->purge_page_no = FIL_NULL;
 	rseg->curr_size = 1;
 
 	mutex_create(rseg->is_persistent()
@@ -45,6 +45,7 @@ C_MODE_END
 #include "key.h"
 #include "log.h"
 #include "sql_parse.h"
+#include "sql_i_s.h"
 
 /*
   Note that in future versions, only *transactional* Maria tables can
@@ -59,6 +60,7 @@ C_MODE_END
 #define THD_TRN (TRN*) thd_get_ha_data(thd, maria_hton)
 
 ulong pagecache_division_limit, pagecache_age_threshold, pagecache_file_hash_size;
+ulong pagecache_segments;
 ulonglong pagecache_buffer_size;
 const char *zerofill_error_msg=
   "Table is from another system and must be zerofilled or repaired to be "
@@ -257,6 +259,13 @@ static MYSQL_SYSVAR_ULONG(pagecache_file_hash_size, pagecache_file_hash_size,
        "value is probably 1/10 of number of possible open Aria files.", 0,0,
        512, 128, 16384, 1);
 
+static MYSQL_SYSVAR_ULONG(pagecache_segments, pagecache_segments,
+       PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+       "Number of segments of the page cache. Each segment has its own lock "
+       "and LRU chain and caches the pages chosen by a hash of the file and "
+       "page number. 1 means that the page cache is not segmented.", 0, 0,
+       1, 1, MAX_PAGECACHE_PARTITIONS, 1);
+
 static MYSQL_SYSVAR_SET(recover_options, maria_recover_options, PLUGIN_VAR_OPCMDARG,
        "Specifies how corrupted tables should be automatically repaired",
        NULL, NULL, HA_RECOVER_BACKUP|HA_RECOVER_QUICK, &maria_recover_typelib);
@@ -3667,10 +3676,11 @@ static int ha_maria_init(void *p)
   res= maria_upgrade() || maria_init() || ma_control_file_open(TRUE, TRUE) ||
     ((force_start_after_recovery_failures != 0) &&
      mark_recovery_start(log_dir)) ||
-    !init_pagecache(maria_pagecache,
-                    (size_t) pagecache_buffer_size, pagecache_division_limit,
-                    pagecache_age_threshold, maria_block_size, pagecache_file_hash_size,
-                    0) ||
+    !init_partitioned_pagecache(maria_pagecache, (uint) pagecache_segments,
+                                (size_t) pagecache_buffer_size,
+                                pagecache_division_limit,
+                                pagecache_age_threshold, maria_block_size,
+                                pagecache_file_hash_size, 0) ||
     !init_pagecache(maria_log_pagecache,
                     TRANSLOG_PAGECACHE_SIZE, 0, 0,
                     TRANSLOG_PAGE_SIZE, 0, 0) ||
@@ -3787,6 +3797,7 @@ static struct st_mysql_sys_var *system_variables[]= {
   MYSQL_SYSVAR(pagecache_buffer_size),
   MYSQL_SYSVAR(pagecache_division_limit),
   MYSQL_SYSVAR(pagecache_file_hash_size),
+  MYSQL_SYSVAR(pagecache_segments),
   MYSQL_SYSVAR(recover_options),
   MYSQL_SYSVAR(repair_threads),
   MYSQL_SYSVAR(sort_buffer_size),
@@ -3911,14 +3922,29 @@ static void update_log_file_size(MYSQL_THD thd,
 }
 
 
+static SHOW_VAR pagecache_status_variables[]= {
+  {"blocks_not_flushed", (char*) &maria_pagecache_var.global_blocks_changed, SHOW_LONG},
+  {"blocks_unused",      (char*) &maria_pagecache_var.blocks_unused, SHOW_LONG},
+  {"blocks_used",        (char*) &maria_pagecache_var.blocks_used, SHOW_LONG},
+  {"read_requests",      (char*) &maria_pagecache_var.global_cache_r_requests, SHOW_LONGLONG},
+  {"reads",              (char*) &maria_pagecache_var.global_cache_read, SHOW_LONGLONG},
+  {"write_requests",     (char*) &maria_pagecache_var.global_cache_w_requests, SHOW_LONGLONG},
+  {"writes",             (char*) &maria_pagecache_var.global_cache_write, SHOW_LONGLONG},
+  {NullS, NullS, SHOW_LONG}
+};
+
+/* Sum the statistics of the page cache segments before they are shown */
+
+static int show_pagecache_vars(THD *, SHOW_VAR *var, char *)
+{
+  pagecache_update_stats(maria_pagecache);
+  var->type= SHOW_ARRAY;
+  var->value= (char*) &pagecache_status_variables;
+  return 0;
+}
+
 static SHOW_VAR status_variables[]= {
-  {"pagecache_blocks_not_flushed", (char*) &maria_pagecache_var.global_blocks_changed, SHOW_LONG},
-  {"pagecache_blocks_unused",      (char*) &maria_pagecache_var.blocks_unused, SHOW_LONG},
-  {"pagecache_blocks_used",        (char*) &maria_pagecache_var.blocks_used, SHOW_LONG},
-  {"pagecache_read_requests",      (char*) &maria_pagecache_var.global_cache_r_requests, SHOW_LONGLONG},
-  {"pagecache_reads",              (char*) &maria_pagecache_var.global_cache_read, SHOW_LONGLONG},
-  {"pagecache_write_requests",     (char*) &maria_pagecache_var.global_cache_w_requests, SHOW_LONGLONG},
-  {"pagecache_writes",             (char*) &maria_pagecache_var.global_cache_write, SHOW_LONGLONG},
+  {"pagecache",                    (char*) &show_pagecache_vars, SHOW_FUNC},
   {"transaction_log_syncs",        (char*) &translog_syncs, SHOW_LONGLONG},
   {NullS, NullS, SHOW_LONG}
 };
@@ -4057,6 +4083,100 @@ int ha_maria::find_unique_row(uchar *record, uint constrain_no)
 struct st_mysql_storage_engine maria_storage_engine=
 { MYSQL_HANDLERTON_INTERFACE_VERSION };
 
+/****************************************************************************
+ * INFORMATION_SCHEMA.ARIA_PAGECACHE: statistics of the page cache segments
+ ***************************************************************************/
+
+static struct st_mysql_information_schema aria_pagecache_info=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+namespace Show {
+
+/* Like INFORMATION_SCHEMA.KEY_CACHES */
+static ST_FIELD_INFO aria_pagecache_fields_info[]=
+{
+  Column("SEGMENTS",        ULong(3),       NULLABLE),
+  Column("SEGMENT_NUMBER",  ULong(3),       NULLABLE),
+  Column("FULL_SIZE",       ULonglong(),    NOT_NULL),
+  Column("BLOCK_SIZE",      ULonglong(),    NOT_NULL),
+  Column("USED_BLOCKS",     ULonglong(),    NOT_NULL, "Aria_pagecache_blocks_used"),
+  Column("UNUSED_BLOCKS",   ULonglong(),    NOT_NULL, "Aria_pagecache_blocks_unused"),
+  Column("DIRTY_BLOCKS",    ULonglong(),    NOT_NULL, "Aria_pagecache_blocks_not_flushed"),
+  Column("READ_REQUESTS",   ULonglong(),    NOT_NULL, "Aria_pagecache_read_requests"),
+  Column("READS",           ULonglong(),    NOT_NULL, "Aria_pagecache_reads"),
+  Column("WRITE_REQUESTS",  ULonglong(),    NOT_NULL, "Aria_pagecache_write_requests"),
+  Column("WRITES",          ULonglong(),    NOT_NULL, "Aria_pagecache_writes"),
+  CEnd()
+};
+
+} // namespace Show
+
+
+/**
+  Store one row of INFORMATION_SCHEMA.ARIA_PAGECACHE
+
+  @param segments     number of segments, 0 if the cache is not segmented
+  @param segment_no   number of the segment, 0 for the whole cache
+*/
+
+static int store_aria_pagecache_record(THD *thd, TABLE *table,
+                                       PAGECACHE *pagecache,
+                                       uint segments, uint segment_no)
+{
+  restore_record(table, s->default_values);
+  if (segments)
+  {
+    table->field[0]->set_notnull();
+    table->field[0]->store((long) segments, TRUE);
+  }
+  if (segment_no)
+  {
+    table->field[1]->set_notnull();
+    table->field[1]->store((long) segment_no, TRUE);
+  }
+  table->field[2]->store((ulonglong) pagecache->mem_size, TRUE);
+  table->field[3]->store((ulonglong) pagecache->block_size, TRUE);
+  table->field[4]->store((ulonglong) pagecache->blocks_used, TRUE);
+  table->field[5]->store((ulonglong) pagecache->blocks_unused, TRUE);
+  table->field[6]->store((ulonglong) pagecache->global_blocks_changed, TRUE);
+  table->field[7]->store(pagecache->global_cache_r_requests, TRUE);
+  table->field[8]->store(pagecache->global_cache_read, TRUE);
+  table->field[9]->store(pagecache->global_cache_w_requests, TRUE);
+  table->field[10]->store(pagecache->global_cache_write, TRUE);
+  return schema_table_store_record(thd, table);
+}
+
+
+static int fill_aria_pagecache(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  uint segments= maria_pagecache->partitions;
+  DBUG_ENTER("fill_aria_pagecache");
+
+  if (!maria_pagecache->inited)
+    DBUG_RETURN(0);
+
+  for (uint i= 0; i < segments; i++)
+  {
+    if (store_aria_pagecache_record(thd, table, maria_pagecache->partition + i,
+                                    segments, i + 1))
+      DBUG_RETURN(1);
+  }
+  pagecache_update_stats(maria_pagecache);
+  DBUG_RETURN(store_aria_pagecache_record(thd, table, maria_pagecache,
+                                          segments, 0));
+}
+
+
+static int aria_pagecache_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE*) p;
+  schema->fields_info= Show::aria_pagecache_fields_info;
+  schema->fill_table= fill_aria_pagecache;
+  return 0;
+}
+
+
 maria_declare_plugin(aria)
 {
   MYSQL_STORAGE_ENGINE_PLUGIN,
@@ -4072,5 +4192,20 @@ maria_declare_plugin(aria)
   system_variables,             /* system variables */
   "1.5",                        /* string version   */
   MariaDB_PLUGIN_MATURITY_STABLE /* maturity         */
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &aria_pagecache_info,
+  "ARIA_PAGECACHE",
+  "MariaDB Corporation Ab",
+  "Statistics of the Aria page cache and its segments",
+  PLUGIN_LICENSE_GPL,
+  aria_pagecache_init,          /* Plugin Init      */
+  NULL,                         /* Plugin Deinit    */
+  0x0100,                       /* 1.0              */
+  NULL,                         /* status variables */
+  NULL,                         /* system variables */
+  "1.0",                        /* string version   */
+  MariaDB_PLUGIN_MATURITY_STABLE /* maturity         */
 }
 maria_declare_plugin_end;
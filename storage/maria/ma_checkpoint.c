@@ -538,6 +538,13 @@ static ulong maria_checkpoint_min_cache_activity= 10*1024*1024;
 /* Set in ha_maria.cc */
 ulong maria_checkpoint_min_log_activity= 1*1024*1024;
 
+/** @brief Number of pages written by maria_pagecache, over all partitions */
+static ulonglong pagecache_writes(void)
+{
+  pagecache_update_stats(maria_pagecache);
+  return maria_pagecache->global_cache_write;
+}
+
 pthread_handler_t ma_checkpoint_background(void *arg)
 {
   /** @brief At least this of log/page bytes written between checkpoints */
@@ -551,8 +558,7 @@ pthread_handler_t ma_checkpoint_background(void *arg)
   size_t sleeps, sleep_time;
   TRANSLOG_ADDRESS log_horizon_at_last_checkpoint=
     translog_get_horizon();
-  ulonglong pagecache_flushes_at_last_checkpoint=
-    maria_pagecache->global_cache_write;
+  ulonglong pagecache_flushes_at_last_checkpoint= pagecache_writes();
   uint UNINIT_VAR(pages_bunch_size);
   struct st_filter_param filter_param;
   PAGECACHE_FILE *UNINIT_VAR(dfile); /**< data file currently being flushed */
@@ -605,7 +611,7 @@ pthread_handler_t ma_checkpoint_background(void *arg)
         */
         if ((ulonglong) (horizon - log_horizon_at_last_checkpoint) <=
             maria_checkpoint_min_log_activity &&
-            ((ulonglong) (maria_pagecache->global_cache_write -
+            ((ulonglong) (pagecache_writes() -
                           pagecache_flushes_at_last_checkpoint) *
              maria_pagecache->block_size) <=
             maria_checkpoint_min_cache_activity)
@@ -624,8 +630,7 @@ pthread_handler_t ma_checkpoint_background(void *arg)
           below is possibly greater than last_checkpoint_lsn.
         */
         log_horizon_at_last_checkpoint= translog_get_horizon();
-        pagecache_flushes_at_last_checkpoint=
-          maria_pagecache->global_cache_write;
+        pagecache_flushes_at_last_checkpoint= pagecache_writes();
         /*
           If the checkpoint above succeeded it has set d|kfiles and
           d|kfiles_end. If is has failed, it has set
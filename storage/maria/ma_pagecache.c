@@ -616,6 +616,18 @@ static int ___pagecache_pthread_cond_signal(mysql_cond_t *cond);
 
 extern my_bool translog_flush(TRANSLOG_ADDRESS lsn);
 
+/*
+  The page cache that holds the settings of a page cache.
+  The user of a partitioned page cache changes settings like the flags
+  used for all pread/pwrite calls or extra_debug in the partitioned
+  cache, not in its partitions.
+*/
+#define pagecache_settings(pagecache) \
+  ((pagecache)->parent ? (pagecache)->parent : (pagecache))
+#define pagecache_rw_flags(pagecache) \
+  pagecache_settings(pagecache)->readwrite_flags
+
+
 /*
   Write page to the disk
 
@@ -652,7 +664,7 @@ static my_bool pagecache_fwrite(PAGECACHE *pagecache,
     debug either of the above issues.
   */
 
-  if (pagecache->extra_debug)
+  if (pagecache_settings(pagecache)->extra_debug)
   {
     char buff[80];
     uint len= my_sprintf(buff,
@@ -704,6 +716,43 @@ static my_bool pagecache_fwrite(PAGECACHE *pagecache,
            ((my_off_t) pageno << pagecache->shift), flags)
 
 
+/*
+  Get the partition of a partitioned page cache where a page is cached
+
+  The pages of a file are spread over the partitions like the blocks of
+  a file over the partitions of a partitioned key cache.
+*/
+
+static inline PAGECACHE *get_pagecache_partition(PAGECACHE *pagecache,
+                                                 PAGECACHE_FILE *file,
+                                                 pgcache_page_no_t pageno)
+{
+  DBUG_ASSERT(pagecache->partitions);
+  return pagecache->partition +
+    (uint) ((file->file + pageno) % pagecache->partitions);
+}
+
+
+/*
+  Get the partition of a partitioned page cache that owns a block
+
+  The block must be pinned or locked by the caller, so that it stays
+  assigned to its page, which determines the partition.
+*/
+
+static inline PAGECACHE *get_block_partition(PAGECACHE *pagecache,
+                                             PAGECACHE_BLOCK_LINK *block)
+{
+  PAGECACHE *partition;
+  DBUG_ASSERT(block->hash_link);
+  partition= get_pagecache_partition(pagecache, &block->hash_link->file,
+                                     block->hash_link->pageno);
+  DBUG_ASSERT(block >= partition->block_root &&
+              block < partition->block_root + partition->disk_blocks);
+  return partition;
+}
+
+
 /**
   @brief set rec_lsn of pagecache block (if it is needed)
 
@@ -936,6 +985,90 @@ size_t init_pagecache(PAGECACHE *pagecache, size_t use_mem,
 }
 
 
+/*
+  Initialize a partitioned page cache
+
+  SYNOPSIS
+    init_partitioned_pagecache()
+    pagecache			pointer to a page cache data structure
+    partitions			number of partitions. With 0 or 1 a simple
+                                page cache is initialized
+    use_mem                     total memory to use for all partitions
+    other parameters            as for init_pagecache()
+
+  RETURN VALUE
+    number of blocks in all partitions, if successful,
+    0 - otherwise.
+
+  NOTES.
+    The memory is divided evenly between the partitions. Page caches
+    that read big blocks (S3) must not be partitioned, because the pages
+    of a big block are inserted into the cache together.
+*/
+
+size_t init_partitioned_pagecache(PAGECACHE *pagecache, uint partitions,
+                                  size_t use_mem, uint division_limit,
+                                  uint age_threshold, uint block_size,
+                                  uint changed_blocks_hash_size,
+                                  myf my_readwrite_flags)
+{
+  size_t blocks= 0;
+  uint i;
+  DBUG_ENTER("init_partitioned_pagecache");
+
+  if (partitions <= 1)
+    DBUG_RETURN(init_pagecache(pagecache, use_mem, division_limit,
+                               age_threshold, block_size,
+                               changed_blocks_hash_size, my_readwrite_flags));
+
+  DBUG_ASSERT(partitions <= MAX_PAGECACHE_PARTITIONS);
+  DBUG_ASSERT(!pagecache->inited);
+  if (!(pagecache->partition= (PAGECACHE*)
+        my_malloc(PSI_INSTRUMENT_ME, sizeof(PAGECACHE) * partitions,
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(0);
+
+  for (i= 0; i < partitions; i++)
+  {
+    size_t partition_blocks;
+    pagecache->partition[i].parent= pagecache;
+    if (!(partition_blocks= init_pagecache(pagecache->partition + i,
+                                           use_mem / partitions,
+                                           division_limit, age_threshold,
+                                           block_size,
+                                           changed_blocks_hash_size,
+                                           my_readwrite_flags)))
+    {
+      do
+        end_pagecache(pagecache->partition + i, 1);
+      while (i--);
+      my_free(pagecache->partition);
+      pagecache->partition= NULL;
+      DBUG_RETURN(0);
+    }
+    blocks+= partition_blocks;
+  }
+
+  pagecache->partitions= partitions;
+  pagecache->big_block_read= NULL;
+  pagecache->big_block_free= NULL;
+  pagecache->mem_size= use_mem;
+  pagecache->block_size= block_size;
+  pagecache->shift= my_bit_log2_uint64(block_size);
+  pagecache->readwrite_flags= my_readwrite_flags | MY_NABP | MY_WAIT_IF_FULL;
+  pagecache->org_readwrite_flags= pagecache->readwrite_flags;
+  pagecache->disk_blocks= pagecache->blocks= blocks;
+  pagecache->blocks_unused= blocks;
+  pagecache->blocks_used= pagecache->blocks_changed= 0;
+  pagecache->global_blocks_changed= 0;
+  pagecache->global_cache_w_requests= pagecache->global_cache_r_requests= 0;
+  pagecache->global_cache_read= pagecache->global_cache_write= 0;
+  pagecache->can_be_used= 1;
+  pagecache->inited= 1;
+  DBUG_RETURN(blocks);
+}
+
+
 /*
   Flush all blocks in the key cache to disk
 */
@@ -1125,6 +1258,15 @@ void change_pagecache_param(PAGECACHE *pagecache, uint division_limit,
 {
   DBUG_ENTER("change_pagecache_param");
 
+  if (pagecache->partitions)
+  {
+    uint i;
+    for (i= 0; i < pagecache->partitions; i++)
+      change_pagecache_param(pagecache->partition + i, division_limit,
+                             age_threshold);
+    DBUG_VOID_RETURN;
+  }
+
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   if (division_limit)
     pagecache->min_warm_blocks= (pagecache->disk_blocks *
@@ -1188,6 +1330,21 @@ void end_pagecache(PAGECACHE *pagecache, my_bool cleanup)
   if (!pagecache->inited)
     DBUG_VOID_RETURN;
 
+  if (pagecache->partitions)
+  {
+    uint i;
+    for (i= 0; i < pagecache->partitions; i++)
+      end_pagecache(pagecache->partition + i, cleanup);
+    if (cleanup)
+    {
+      my_free(pagecache->partition);
+      pagecache->partition= NULL;
+      pagecache->partitions= 0;
+      pagecache->inited= pagecache->can_be_used= 0;
+    }
+    DBUG_VOID_RETURN;
+  }
+
   if (pagecache->disk_blocks > 0)
   {
 #ifndef DBUG_OFF
@@ -2217,7 +2374,7 @@ static PAGECACHE_BLOCK_LINK *find_block(PAGECACHE *pagecache,
                                     block->buffer,
                                     block->hash_link->pageno,
                                     block->type,
-                                    pagecache->readwrite_flags);
+                                    pagecache_rw_flags(pagecache));
             pagecache_pthread_mutex_lock(&pagecache->cache_lock);
 	    pagecache->global_cache_write++;
           }
@@ -3004,7 +3161,7 @@ static void read_block(PAGECACHE *pagecache,
       error= pagecache_fread(pagecache, &block->hash_link->file,
                              args.page,
                              block->hash_link->pageno,
-                             pagecache->readwrite_flags);
+                             pagecache_rw_flags(pagecache));
     }
     error= (*block->hash_link->file.post_read_hook)(error != 0, &args);
     pagecache_pthread_mutex_lock(&pagecache->cache_lock);
@@ -3133,6 +3290,8 @@ void pagecache_unlock(PAGECACHE *pagecache,
   DBUG_ASSERT(pin != PAGECACHE_PIN);
   DBUG_ASSERT(lock != PAGECACHE_LOCK_READ && lock != PAGECACHE_LOCK_WRITE);
 
+  if (pagecache->partitions)
+    pagecache= get_pagecache_partition(pagecache, file, pageno);
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   /*
     As soon as we keep lock cache can be used, and we have lock because want
@@ -3221,6 +3380,8 @@ void pagecache_unpin(PAGECACHE *pagecache,
   DBUG_ENTER("pagecache_unpin");
   DBUG_PRINT("enter", ("fd: %u  page: %lu",
                        (uint) file->file, (ulong) pageno));
+  if (pagecache->partitions)
+    pagecache= get_pagecache_partition(pagecache, file, pageno);
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   /*
     As soon as we keep lock cache can be used, and we have lock bacause want
@@ -3309,6 +3470,8 @@ void pagecache_unlock_by_link(PAGECACHE *pagecache,
   DBUG_ASSERT(pin != PAGECACHE_PIN_LEFT_UNPINNED);
   DBUG_ASSERT(lock != PAGECACHE_LOCK_READ);
   DBUG_ASSERT(lock != PAGECACHE_LOCK_WRITE);
+  if (pagecache->partitions)
+    pagecache= get_block_partition(pagecache, block);
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   if (pin == PAGECACHE_PIN_LEFT_UNPINNED &&
       lock == PAGECACHE_LOCK_READ_UNLOCK)
@@ -3411,6 +3574,8 @@ void pagecache_unpin_by_link(PAGECACHE *pagecache,
                        block, (uint) block->hash_link->file.file,
                        (ulong) block->hash_link->pageno));
 
+  if (pagecache->partitions)
+    pagecache= get_block_partition(pagecache, block);
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
   /*
     As soon as we keep lock cache can be used, and we have lock because want
@@ -3646,6 +3811,9 @@ uchar *pagecache_read(PAGECACHE *pagecache,
   DBUG_ASSERT(pageno < ((1ULL) << 40));
 #endif
 
+  if (pagecache->partitions)
+    pagecache= get_pagecache_partition(pagecache, file, pageno);
+
   if (!page_link)
     page_link= &fake_link;
   *page_link= 0;                                 /* Catch errors */
@@ -3836,7 +4004,7 @@ uchar *pagecache_read(PAGECACHE *pagecache,
     if (!error)
     {
       error= pagecache_fread(pagecache, file, args.page, pageno,
-                             pagecache->readwrite_flags) != 0;
+                             pagecache_rw_flags(pagecache)) != 0;
     }
     error= (* file->post_read_hook)(error, &args);
   }
@@ -3916,7 +4084,7 @@ static my_bool pagecache_delete_internal(PAGECACHE *pagecache,
                               block->buffer,
                               block->hash_link->pageno,
                               block->type,
-                              pagecache->readwrite_flags);
+                              pagecache_rw_flags(pagecache));
       pagecache_pthread_mutex_lock(&pagecache->cache_lock);
       pagecache->global_cache_write++;
 
@@ -4011,6 +4179,8 @@ my_bool pagecache_delete_by_link(PAGECACHE *pagecache,
               lock == PAGECACHE_LOCK_LEFT_WRITELOCKED);
   DBUG_ASSERT(block->pins != 0); /* should be pinned */
 
+  if (pagecache->partitions)
+    pagecache= get_block_partition(pagecache, block);
   if (pagecache->can_be_used)
   {
     pagecache_pthread_mutex_lock(&pagecache->cache_lock);
@@ -4123,6 +4293,8 @@ my_bool pagecache_delete(PAGECACHE *pagecache,
               lock == PAGECACHE_LOCK_LEFT_WRITELOCKED);
   DBUG_ASSERT(pin == PAGECACHE_PIN ||
               pin == PAGECACHE_PIN_LEFT_PINNED);
+  if (pagecache->partitions)
+    pagecache= get_pagecache_partition(pagecache, file, pageno);
 restart:
 
   DBUG_ASSERT(pageno < ((1ULL) << 40));
@@ -4309,6 +4481,9 @@ my_bool pagecache_write_part(PAGECACHE *pagecache,
   DBUG_ASSERT(pagecache->big_block_read == 0);
 #endif
 
+  if (pagecache->partitions)
+    pagecache= get_pagecache_partition(pagecache, file, pageno);
+
   if (!page_link)
     page_link= &fake_link;
   *page_link= 0;
@@ -4508,7 +4683,7 @@ my_bool pagecache_write_part(PAGECACHE *pagecache,
         error= pagecache_fread(pagecache, file,
                                page_buffer,
                                pageno,
-                               pagecache->readwrite_flags) != 0;
+                               pagecache_rw_flags(pagecache)) != 0;
       }
       if ((*file->post_read_hook)(error, &args))
       {
@@ -4520,7 +4695,7 @@ my_bool pagecache_write_part(PAGECACHE *pagecache,
       buff= page_buffer;
     }
     if (pagecache_fwrite(pagecache, file, buff, pageno, type,
-                         pagecache->readwrite_flags))
+                         pagecache_rw_flags(pagecache)))
       error= 1;
   }
 
@@ -4740,7 +4915,7 @@ static int flush_cached_blocks(PAGECACHE *pagecache,
                             block->buffer,
                             block->hash_link->pageno,
                             block->type,
-                            pagecache->readwrite_flags);
+                            pagecache_rw_flags(pagecache));
     pagecache_pthread_mutex_lock(&pagecache->cache_lock);
 
     if (make_lock_and_pin(pagecache, block,
@@ -5143,6 +5318,18 @@ int flush_pagecache_blocks_with_filter(PAGECACHE *pagecache,
   DBUG_ENTER("flush_pagecache_blocks_with_filter");
   DBUG_PRINT("enter", ("pagecache: %p", pagecache));
 
+  if (pagecache->partitions)
+  {
+    /* The pages of the file are in all partitions */
+    uint i;
+    res= PCFLUSH_OK;
+    for (i= 0; i < pagecache->partitions; i++)
+      res|= flush_pagecache_blocks_with_filter(pagecache->partition + i,
+                                               file, type, filter,
+                                               filter_arg);
+    DBUG_RETURN(res);
+  }
+
   if (pagecache->disk_blocks <= 0)
     DBUG_RETURN(0);
   pagecache_pthread_mutex_lock(&pagecache->cache_lock);
@@ -5181,6 +5368,13 @@ int reset_pagecache_counters(const char *name __attribute__((unused)),
   }
   DBUG_PRINT("info", ("Resetting counters for key cache %s.", name));
 
+  if (pagecache->partitions)
+  {
+    uint i;
+    for (i= 0; i < pagecache->partitions; i++)
+      reset_pagecache_counters(name, pagecache->partition + i);
+  }
+
   pagecache->global_blocks_changed= 0;   /* Key_blocks_not_flushed */
   pagecache->global_cache_r_requests= 0; /* Key_read_requests */
   pagecache->global_cache_read= 0;       /* Key_reads */
@@ -5190,6 +5384,109 @@ int reset_pagecache_counters(const char *name __attribute__((unused)),
 }
 
 
+/*
+  Update the statistics variables of a partitioned page cache
+
+  SYNOPSIS
+    pagecache_update_stats()
+    pagecache  pointer to the page cache
+
+  DESCRIPTION
+    Sums the statistics of the partitions into the statistics variables
+    of the partitioned page cache. The variables of a simple page cache
+    are always up to date, so nothing is done for it.
+    The partitions are read without locking them, like the key cache
+    statistics are.
+*/
+
+void pagecache_update_stats(PAGECACHE *pagecache)
+{
+  PAGECACHE *partition, *end;
+  size_t blocks_used= 0, blocks_unused= 0, blocks_changed= 0;
+  size_t global_blocks_changed= 0;
+  ulonglong w_requests= 0, writes= 0, r_requests= 0, reads= 0;
+
+  if (!pagecache->partitions)
+    return;
+
+  for (partition= pagecache->partition, end= partition + pagecache->partitions;
+       partition < end; partition++)
+  {
+    blocks_used+= partition->blocks_used;
+    blocks_unused+= partition->blocks_unused;
+    blocks_changed+= partition->blocks_changed;
+    global_blocks_changed+= partition->global_blocks_changed;
+    w_requests+= partition->global_cache_w_requests;
+    writes+= partition->global_cache_write;
+    r_requests+= partition->global_cache_r_requests;
+    reads+= partition->global_cache_read;
+  }
+  pagecache->blocks_used= blocks_used;
+  pagecache->blocks_unused= blocks_unused;
+  pagecache->blocks_changed= blocks_changed;
+  pagecache->global_blocks_changed= global_blocks_changed;
+  pagecache->global_cache_w_requests= w_requests;
+  pagecache->global_cache_write= writes;
+  pagecache->global_cache_r_requests= r_requests;
+  pagecache->global_cache_read= reads;
+}
+
+
+/*
+  Collect the dirty pages of all partitions of a partitioned page cache
+
+  The partitions are locked one by one. This is enough for a checkpoint,
+  as a page that is not found dirty in its partition was either flushed
+  or dirtied after the checkpoint started.
+*/
+
+static my_bool
+collect_partitioned_changed_blocks(PAGECACHE *pagecache, LEX_STRING *str,
+                                   LSN *min_rec_lsn)
+{
+  LEX_STRING part_str[MAX_PAGECACHE_PARTITIONS];
+  LSN minimum_rec_lsn= LSN_MAX;
+  ulonglong stored_list_size= 0;
+  size_t length= 8;
+  char *ptr;
+  uint i;
+
+  for (i= 0; i < pagecache->partitions; i++)
+  {
+    LSN part_min_rec_lsn;
+    part_str[i].str= NULL;
+    if (pagecache_collect_changed_blocks_with_lsn(pagecache->partition + i,
+                                                  part_str + i,
+                                                  &part_min_rec_lsn))
+      goto err;
+    stored_list_size+= uint8korr(part_str[i].str);
+    length+= part_str[i].length - 8;
+    if (cmp_translog_addr(part_min_rec_lsn, minimum_rec_lsn) < 0)
+      minimum_rec_lsn= part_min_rec_lsn;
+  }
+
+  if (NULL == (str->str= my_malloc(PSI_INSTRUMENT_ME, length, MYF(MY_WME))))
+    goto err;
+  str->length= length;
+  ptr= str->str;
+  int8store(ptr, stored_list_size);
+  ptr+= 8;
+  for (i= 0; i < pagecache->partitions; i++)
+  {
+    memcpy(ptr, part_str[i].str + 8, part_str[i].length - 8);
+    ptr+= part_str[i].length - 8;
+    my_free(part_str[i].str);
+  }
+  *min_rec_lsn= minimum_rec_lsn;
+  return 0;
+
+err:
+  while (i--)
+    my_free(part_str[i].str);
+  return 1;
+}
+
+
 /**
    @brief Allocates a buffer and stores in it some info about all dirty pages
 
@@ -5222,6 +5519,9 @@ my_bool pagecache_collect_changed_blocks_with_lsn(PAGECACHE *pagecache,
   DBUG_ENTER("pagecache_collect_changed_blocks_with_LSN");
 
   DBUG_ASSERT(NULL == str->str);
+  if (pagecache->partitions)
+    DBUG_RETURN(collect_partitioned_changed_blocks(pagecache, str,
+                                                   min_rec_lsn));
   /*
     We lock the entire cache but will be quick, just reading/writing a few MBs
     of memory at most.
@@ -5354,6 +5654,13 @@ void pagecache_file_no_dirty_page(PAGECACHE *pagecache, PAGECACHE_FILE *file)
 {
   File fd= file->file;
   PAGECACHE_BLOCK_LINK *block;
+  if (pagecache->partitions)
+  {
+    uint i;
+    for (i= 0; i < pagecache->partitions; i++)
+      pagecache_file_no_dirty_page(pagecache->partition + i, file);
+    return;
+  }
   for (block= pagecache->changed_blocks[FILE_HASH(*file, pagecache)];
        block != NULL;
        block= block->next_changed)
@@ -217,8 +217,22 @@ typedef struct st_pagecache
   my_bool in_init;		/* Set to 1 in MySQL during init/resize     */
   my_bool extra_debug;	        /* set to 1 if one wants extra logging */
   HASH    files_in_flush;       /**< files in flush_pagecache_blocks_int() */
+
+  /*
+    A partitioned page cache consists of 'partitions' simple page caches,
+    each with its own cache_lock, hash and LRU chain. A page is cached in
+    the partition chosen by its file and page number. The partitioned
+    cache itself holds no blocks; its statistics variables are the sums
+    over the partitions, computed by pagecache_update_stats().
+  */
+  uint partitions;              /* number of partitions, 0 if not partitioned */
+  struct st_pagecache *partition;/* array of the partitions                   */
+  struct st_pagecache *parent;  /* partitioned cache of a partition, or NULL */
 } PAGECACHE;
 
+/* Maximum number of partitions of a page cache */
+#define MAX_PAGECACHE_PARTITIONS 64
+
 /** @brief Return values for PAGECACHE_FLUSH_FILTER */
 enum pagecache_flush_filter_result
 {
@@ -239,6 +253,13 @@ extern size_t init_pagecache(PAGECACHE *pagecache, size_t use_mem,
                             uint division_limit, uint age_threshold,
                             uint block_size, uint changed_blocks_hash_size,
                             myf my_read_flags);
+extern size_t init_partitioned_pagecache(PAGECACHE *pagecache,
+                                         uint partitions, size_t use_mem,
+                                         uint division_limit,
+                                         uint age_threshold,
+                                         uint block_size,
+                                         uint changed_blocks_hash_size,
+                                         myf my_read_flags);
 extern size_t resize_pagecache(PAGECACHE *pagecache,
                               size_t use_mem, uint division_limit,
                               uint age_threshold, uint changed_blocks_hash_size);
@@ -339,6 +360,7 @@ extern my_bool pagecache_collect_changed_blocks_with_lsn(PAGECACHE *pagecache,
                                                          LEX_STRING *str,
                                                          LSN *min_lsn);
 extern int reset_pagecache_counters(const char *name, PAGECACHE *pagecache);
+extern void pagecache_update_stats(PAGECACHE *pagecache);
 extern uchar *pagecache_block_link_to_buffer(PAGECACHE_BLOCK_LINK *block);
 
 extern uint pagecache_pagelevel(PAGECACHE_BLOCK_LINK *block);
@@ -2028,6 +2028,55 @@ int ha_myisam::rnd_next(uchar *buf)
   return error;
 }
 
+
+/*
+  With fixed-length rows, the position of every row is known, so the
+  blocks that are not in a HA_SAMPLE_SYSTEM sample are skipped without
+  reading them.
+*/
+
+int ha_myisam::sample_next(uchar *buf)
+{
+  if (sample_mode != HA_SAMPLE_SYSTEM ||
+      file->s->data_file_type != STATIC_RECORD)
+    return handler::sample_next(buf);
+
+  THD *thd= ha_thd();
+  const my_off_t reclength= file->s->base.pack_reclength;
+  if (!sample_rows_left)
+  {
+    my_off_t start= file->nextpos;
+    for (;;)
+    {
+      if (unlikely(thd->killed))
+        return HA_ERR_ABORTED_BY_USER;
+      if (file->nextpos >= file->state->data_file_length ||
+          thd_rnd(thd) <= sample_fraction)
+        break;
+      file->nextpos+= sample_block_rows * reclength;
+    }
+    /*
+      The record cache reads only at its own position. Move it to the
+      next kept block, otherwise the rest of the scan is not cached.
+    */
+    if (file->nextpos != start && (file->opt_flag & READ_CACHE_USED) &&
+        file->nextpos < file->state->data_file_length &&
+        reinit_io_cache(&file->rec_cache, READ_CACHE, file->nextpos, 0, 0))
+      return my_errno ? my_errno : HA_ERR_INTERNAL_ERROR;
+    sample_rows_left= sample_block_rows;
+  }
+  /*
+    mi_scan() skips deleted rows. They count as rows of the block, as they
+    take the same space in the data file.
+  */
+  my_off_t block_end= file->nextpos + sample_rows_left * reclength;
+  int error= ha_rnd_next(buf);
+  if (!error)
+    sample_rows_left= file->nextpos < block_end ?
+                      (ha_rows) ((block_end - file->nextpos) / reclength) : 0;
+  return error;
+}
+
 int ha_myisam::remember_rnd_pos()
 {
   position((uchar*) 0);
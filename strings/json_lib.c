@@ -16,6 +16,7 @@
 #include <my_global.h>
 #include <string.h>
 #include <m_ctype.h>
+#include <my_atomic.h>
 #include "json_lib.h"
 
 /*
@@ -366,11 +367,200 @@ int json_read_string_const_chr(json_string_t *js)
 }
 
 
+/*
+  Skipping the plain part of a string constant.
+
+  Most characters of a string constant or a key name need no handling at
+  all, so for the charsets where a byte below 0x80 at a character boundary
+  is always that ASCII character (see json_plain_ascii()), skip_str_constant()
+  and skip_keyname() jump over the run of such bytes before decoding the
+  next character with mb_wc(). The run ends at a quotation mark, a
+  backslash, a control character or a byte >= 0x80, which are all left to
+  the usual per-character checks.
+
+  The bytes are tested 16 at a time with SSE2, which every x86-64 CPU has,
+  or 32 at a time with AVX2 if the CPU supports it. Elsewhere, and for the
+  tail of the string, a plain byte loop is used.
+*/
+
+#define json_plain_ascii(cs) \
+  ((cs)->mbminlen == 1 && !((cs)->state & MY_CS_NONASCII))
+
+static const uchar json_plain_chr_map[128]=
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+
+static const uchar *skip_plain_chars_generic(const uchar *str,
+                                             const uchar *end)
+{
+  while (str < end && *str < 128 && json_plain_chr_map[*str])
+    str++;
+  return str;
+}
+
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const uchar *skip_plain_chars_sse2(const uchar *str, const uchar *end)
+{
+  const __m128i quote= _mm_set1_epi8('"');
+  const __m128i bksl= _mm_set1_epi8('\\');
+  const __m128i space= _mm_set1_epi8(' ');
+
+  while (end - str >= 16)
+  {
+    __m128i v= _mm_loadu_si128((const __m128i *) str);
+    /* The bytes >= 0x80 are negative, so they are less than ' ' too. */
+    __m128i special= _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                               _mm_cmpeq_epi8(v, bksl)),
+                                  _mm_cmplt_epi8(v, space));
+    int mask= _mm_movemask_epi8(special);
+    if (mask)
+    {
+#ifdef _MSC_VER
+      unsigned long n;
+      _BitScanForward(&n, (unsigned long) mask);
+      return str + n;
+#else
+      return str + __builtin_ctz((unsigned int) mask);
+#endif
+    }
+    str+= 16;
+  }
+  return skip_plain_chars_generic(str, end);
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+static const uchar *skip_plain_chars_avx2(const uchar *str, const uchar *end)
+{
+  const __m256i quote= _mm256_set1_epi8('"');
+  const __m256i bksl= _mm256_set1_epi8('\\');
+  const __m256i space= _mm256_set1_epi8(' ');
+
+  while (end - str >= 32)
+  {
+    __m256i v= _mm256_loadu_si256((const __m256i *) str);
+    __m256i special=
+      _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                      _mm256_cmpeq_epi8(v, bksl)),
+                      _mm256_cmpgt_epi8(space, v));
+    unsigned int mask= (unsigned int) _mm256_movemask_epi8(special);
+    if (mask)
+      return str + __builtin_ctz(mask);
+    str+= 32;
+  }
+  return skip_plain_chars_sse2(str, end);
+}
+
+static const uchar *skip_plain_chars_init(const uchar *str, const uchar *end);
+
+typedef const uchar *(*skip_plain_chars_func)(const uchar *, const uchar *);
+
+/*
+  Set to the best implementation on the first call. Threads may race to
+  do that, but they all store the same value.
+*/
+static skip_plain_chars_func skip_plain_chars_impl= skip_plain_chars_init;
+
+#define skip_plain_chars(str, end) \
+  my_atomic_loadptr_explicit(&skip_plain_chars_impl, \
+                             MY_MEMORY_ORDER_RELAXED)(str, end)
+
+static const uchar *skip_plain_chars_init(const uchar *str, const uchar *end)
+{
+  __builtin_cpu_init();
+  my_atomic_storeptr_explicit(&skip_plain_chars_impl,
+                              __builtin_cpu_supports("avx2") ?
+                              skip_plain_chars_avx2 : skip_plain_chars_sse2,
+                              MY_MEMORY_ORDER_RELAXED);
+  return skip_plain_chars(str, end);
+}
+#else
+#define skip_plain_chars skip_plain_chars_sse2
+#endif /* __GNUC__ && __x86_64__ */
+
+#else
+#define skip_plain_chars skip_plain_chars_generic
+#endif /* __SSE2__ || _M_X64 */
+
+
+/*
+  Skipping whitespace.
+
+  Whitespace runs are usually one byte, so get_first_nonspace() only calls
+  skip_space_chars() when the next byte may be whitespace. Indented
+  documents have longer runs, and these are tested 16 bytes at a time.
+*/
+
+static const uchar *skip_space_chars_generic(const uchar *str,
+                                             const uchar *end)
+{
+  while (str < end &&
+         (*str == ' ' || *str == '\n' || *str == '\r' || *str == '\t'))
+    str++;
+  return str;
+}
+
+
+#if defined(__SSE2__) || defined(_M_X64)
+static const uchar *skip_space_chars(const uchar *str, const uchar *end)
+{
+  const __m128i space= _mm_set1_epi8(' ');
+  const __m128i nl= _mm_set1_epi8('\n');
+  const __m128i cr= _mm_set1_epi8('\r');
+  const __m128i tab= _mm_set1_epi8('\t');
+
+  while (end - str >= 16)
+  {
+    __m128i v= _mm_loadu_si128((const __m128i *) str);
+    __m128i is_space= _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                                _mm_cmpeq_epi8(v, nl)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, cr),
+                                                _mm_cmpeq_epi8(v, tab)));
+    int mask= ~_mm_movemask_epi8(is_space) & 0xFFFF;
+    if (mask)
+    {
+#ifdef _MSC_VER
+      unsigned long n;
+      _BitScanForward(&n, (unsigned long) mask);
+      return str + n;
+#else
+      return str + __builtin_ctz((unsigned int) mask);
+#endif
+    }
+    str+= 16;
+  }
+  return skip_space_chars_generic(str, end);
+}
+#else
+#define skip_space_chars skip_space_chars_generic
+#endif /* __SSE2__ || _M_X64 */
+
+
 static int skip_str_constant(json_engine_t *j)
 {
   int t, c_len;
+  my_bool plain_ascii= json_plain_ascii(j->s.cs);
   for (;;)
   {
+    if (plain_ascii)
+      j->s.c_str= skip_plain_chars(j->s.c_str, j->s.str_end);
     if ((c_len= json_next_char(&j->s)) > 0)
     {
       j->s.c_str+= c_len;
@@ -697,6 +887,20 @@ static int read_keyname(json_engine_t *j)
 
 static void get_first_nonspace(json_string_t *js, int *t_next, int *c_len)
 {
+  /* The ASCII structural characters need no mb_wc() call */
+  if (json_plain_ascii(js->cs))
+  {
+    if (js->c_str < js->str_end && *js->c_str <= ' ')
+      js->c_str= skip_space_chars(js->c_str, js->str_end);
+    if (js->c_str < js->str_end && *js->c_str < 128)
+    {
+      js->c_next= *js->c_str++;
+      *c_len= 1;
+      *t_next= json_chr_map[js->c_next];
+      return;
+    }
+  }
+
   do
   {
     if ((*c_len= json_next_char(js)) <= 0)
@@ -730,6 +934,7 @@ static int next_key(json_engine_t *j)
 
 
 /* Forward declarations. */
+static int skip_keyname(json_engine_t *j);
 static int skip_colon(json_engine_t *j);
 static int skip_key(json_engine_t *j);
 static int struct_end_cb(json_engine_t *j);
@@ -845,9 +1050,7 @@ static int skip_key(json_engine_t *j)
       json_handle_esc(&j->s))
     return 1;
 
-  while (json_read_keyname_chr(j) == 0) {}
-
-  if (j->s.error)
+  if (skip_keyname(j))
     return 1;
 
   get_first_nonspace(&j->s, &t_next, &c_len);
@@ -895,6 +1098,24 @@ static int struct_end_cm(json_engine_t *j)
 { return json_actions[j->stack[j->stack_p]][C_COMMA](j); }
 
 
+/*
+  Skip the rest of the key name, up to and including the colon.
+  Like json_read_keyname_chr() called until it returns 1, but the plain
+  runs of the name are skipped with skip_plain_chars().
+*/
+static int skip_keyname(json_engine_t *j)
+{
+  my_bool plain_ascii= json_plain_ascii(j->s.cs);
+  do
+  {
+    if (plain_ascii)
+      j->s.c_str= skip_plain_chars(j->s.c_str, j->s.str_end);
+  } while (json_read_keyname_chr(j) == 0);
+
+  return j->s.error != 0;
+}
+
+
 int json_read_keyname_chr(json_engine_t *j)
 {
   int c_len, t;
@@ -948,13 +1169,8 @@ int json_read_value(json_engine_t *j)
 {
   int t_next, c_len, res;
 
-  if (j->state == JST_KEY)
-  {
-    while (json_read_keyname_chr(j) == 0) {}
-
-    if (j->s.error)
-      return 1;
-  }
+  if (j->state == JST_KEY && skip_keyname(j))
+    return 1;
 
   get_first_nonspace(&j->s, &t_next, &c_len);
 
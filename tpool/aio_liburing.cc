@@ -0,0 +1,312 @@
+/* Copyright(C) 2020 MariaDB Corporation.
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02111 - 1301 USA*/
+
+#include "tpool_structs.h"
+#include "tpool.h"
+
+#include <liburing.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+  Linux AIO implementation based on io_uring.
+  Needs liburing.h and -luring at compile time, and a kernel with io_uring
+  support at runtime (otherwise create_linux_uring_aio() returns nullptr
+  with errno set).
+
+  Compared to libaio, submission is batched: concurrent submit_io() callers
+  only fill submission queue entries, and whoever is last to leave the
+  submission critical section makes one io_uring_submit() system call for all
+  of them. Completions are reaped in batches by a single thread, which
+  forwards the callbacks to the worker thread pool.
+
+  Files that are "bound" to the AIO handler (see aio::bind()) are registered
+  with the ring as fixed files, which saves the kernel from looking up and
+  reference counting the file for every request.
+*/
+namespace tpool
+{
+
+class aio_uring final : public aio
+{
+  thread_pool *m_pool;
+  io_uring m_ring;
+  /* Protects the submission queue and the fixed file table. */
+  std::mutex m_mutex;
+  /* Signalled by the reaper thread after it has consumed completions. */
+  std::condition_variable m_reaped;
+  /* Number of threads inside, or waiting to enter, submit_io(). */
+  std::atomic<int> m_submitters;
+  std::atomic<bool> m_in_shutdown;
+  std::thread m_thread;
+
+  /* Registered file table: fd -> slot, and free slots. -1 if not fixed. */
+  std::vector<int> m_fixed_slot;
+  std::vector<int> m_free_slots;
+  bool m_use_fixed_files;
+
+  static const int MAX_FIXED_FILES= 1024;
+  static const unsigned MAX_REAP_BATCH= 64;
+
+  static void complete(thread_pool *pool, aiocb *cb, int res)
+  {
+    if (res < 0)
+    {
+      cb->m_err= -res;
+      cb->m_ret_len= 0;
+    }
+    else
+    {
+      cb->m_err= 0;
+      cb->m_ret_len= res;
+    }
+    cb->m_internal_task.m_func= cb->m_callback;
+    cb->m_internal_task.m_arg= cb;
+    cb->m_internal_task.m_group= cb->m_group;
+    pool->submit_task(&cb->m_internal_task);
+  }
+
+  static void thread_routine(aio_uring *aio)
+  {
+    io_uring_cqe *cqes[MAX_REAP_BATCH];
+
+    for (;;)
+    {
+      io_uring_cqe *cqe;
+      int ret= io_uring_wait_cqe(&aio->m_ring, &cqe);
+      if (ret)
+      {
+        if (ret == -EINTR || ret == -EAGAIN)
+          continue;
+        fprintf(stderr, "io_uring_wait_cqe() returned %d\n", ret);
+        abort();
+      }
+
+      /* Reap everything that is available, not only the first one. */
+      unsigned n= io_uring_peek_batch_cqe(&aio->m_ring, cqes, MAX_REAP_BATCH);
+      bool shutdown= false;
+      for (unsigned i= 0; i < n; i++)
+      {
+        aiocb *cb= static_cast<aiocb*>(io_uring_cqe_get_data(cqes[i]));
+        if (!cb)
+        {
+          /* The wakeup NOP from the destructor. */
+          shutdown= true;
+          continue;
+        }
+        complete(aio->m_pool, cb, cqes[i]->res);
+      }
+      io_uring_cq_advance(&aio->m_ring, n);
+      aio->m_reaped.notify_all();
+
+      if (shutdown || aio->m_in_shutdown.load(std::memory_order_relaxed))
+        break;
+    }
+  }
+
+  /**
+    Submit everything that is queued in the submission queue.
+    Called with m_mutex held, through lk.
+
+    The queue can hold the requests of threads that have already returned
+    from submit_io(), leaving the io_uring_submit() call to us, so nothing
+    may be left behind in it. EAGAIN (out of resources for new requests)
+    and EBUSY (the completion queue is full) are transient: we wait for the
+    reaper thread to consume some completions and retry. Any other error
+    means that the ring is unusable, and the requests would never complete.
+  */
+  void submit_queued(std::unique_lock<std::mutex> &lk)
+  {
+    while (io_uring_sq_ready(&m_ring))
+    {
+      int ret= io_uring_submit(&m_ring);
+      if (ret > 0)
+        continue;
+      if (ret < 0 && ret != -EAGAIN && ret != -EBUSY && ret != -EINTR)
+      {
+        fprintf(stderr, "io_uring_submit() returned %d\n", ret);
+        abort();
+      }
+      m_reaped.wait_for(lk, std::chrono::milliseconds(1));
+    }
+  }
+
+  /**
+    Get a submission queue entry, submitting what is already queued
+    if the submission queue is full. Called with m_mutex held, through lk.
+  */
+  io_uring_sqe *get_sqe(std::unique_lock<std::mutex> &lk)
+  {
+    for (;;)
+    {
+      if (io_uring_sqe *sqe= io_uring_get_sqe(&m_ring))
+        return sqe;
+      submit_queued(lk);
+    }
+  }
+
+public:
+  aio_uring(thread_pool *pool)
+    : m_pool(pool), m_submitters(0), m_in_shutdown(false),
+      m_use_fixed_files(false)
+  {
+    memset(&m_ring, 0, sizeof m_ring);
+  }
+
+  /** Set up the ring. @return 0 on success, negative errno on failure */
+  int init(int max_io)
+  {
+    if (int ret= io_uring_queue_init(max_io, &m_ring, 0))
+      return ret;
+
+    /*
+      Reserve a sparse fixed file table. Failure (old kernel, or
+      RLIMIT_NOFILE) is not fatal, we just do not use fixed files then.
+    */
+    std::vector<int> files(MAX_FIXED_FILES, -1);
+    if (!io_uring_register_files(&m_ring, files.data(), MAX_FIXED_FILES))
+    {
+      m_use_fixed_files= true;
+      m_free_slots.reserve(MAX_FIXED_FILES);
+      for (int i= MAX_FIXED_FILES; i--; )
+        m_free_slots.push_back(i);
+    }
+
+    m_thread= std::thread(thread_routine, this);
+    return 0;
+  }
+
+  ~aio_uring()
+  {
+    if (m_thread.joinable())
+    {
+      m_in_shutdown= true;
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        io_uring_sqe *sqe= get_sqe(lk);
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        submit_queued(lk);
+      }
+      m_thread.join();
+    }
+    if (m_ring.ring_fd)
+    {
+      if (m_use_fixed_files)
+        io_uring_unregister_files(&m_ring);
+      io_uring_queue_exit(&m_ring);
+    }
+  }
+
+  int submit_io(aiocb *cb) override
+  {
+    m_submitters.fetch_add(1, std::memory_order_acquire);
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    io_uring_sqe *sqe= get_sqe(lk);
+
+    int fd= cb->m_fh;
+    int slot= -1;
+    if (m_use_fixed_files && size_t(fd) < m_fixed_slot.size())
+      slot= m_fixed_slot[fd];
+
+    if (cb->m_opcode == aio_opcode::AIO_PREAD)
+      io_uring_prep_read(sqe, slot >= 0 ? slot : fd, cb->m_buffer, cb->m_len,
+                         cb->m_offset);
+    else
+      io_uring_prep_write(sqe, slot >= 0 ? slot : fd, cb->m_buffer, cb->m_len,
+                          cb->m_offset);
+    if (slot >= 0)
+      sqe->flags|= IOSQE_FIXED_FILE;
+    io_uring_sqe_set_data(sqe, cb);
+
+    /*
+      If other threads are waiting to queue their requests, leave the
+      io_uring_submit() call to the last of them, so that the whole batch
+      is submitted with a single system call. The last one holds m_mutex
+      until the queue is empty, see submit_queued().
+    */
+    if (m_submitters.fetch_sub(1, std::memory_order_release) == 1)
+      submit_queued(lk);
+    return 0;
+  }
+
+  int bind(native_file_handle &fd) override
+  {
+    if (!m_use_fixed_files || fd < 0)
+      return 0;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_free_slots.empty())
+      return 0;
+    if (size_t(fd) >= m_fixed_slot.size())
+      m_fixed_slot.resize(std::max<size_t>(fd + 1, 2 * m_fixed_slot.size()),
+                          -1);
+    if (m_fixed_slot[fd] >= 0)
+      return 0;
+    int slot= m_free_slots.back();
+    int file= fd;
+    if (io_uring_register_files_update(&m_ring, slot, &file, 1) == 1)
+    {
+      m_free_slots.pop_back();
+      m_fixed_slot[fd]= slot;
+    }
+    return 0;
+  }
+
+  int unbind(const native_file_handle &fd) override
+  {
+    if (!m_use_fixed_files || fd < 0)
+      return 0;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (size_t(fd) >= m_fixed_slot.size() || m_fixed_slot[fd] < 0)
+      return 0;
+    int slot= m_fixed_slot[fd];
+    int file= -1;
+    /*
+      The registration holds a reference to the file, so it must be dropped
+      before the file descriptor is closed and possibly reused.
+    */
+    io_uring_register_files_update(&m_ring, slot, &file, 1);
+    m_fixed_slot[fd]= -1;
+    m_free_slots.push_back(slot);
+    return 0;
+  }
+};
+
+
+aio *create_linux_uring_aio(thread_pool *pool, int max_io)
+{
+  aio_uring *aio= new aio_uring(pool);
+  if (int ret= aio->init(max_io))
+  {
+    /* Let the caller report why io_uring cannot be used */
+    delete aio;
+    errno= -ret;
+    return nullptr;
+  }
+  return aio;
+}
+
+}
@@ -66,7 +66,7 @@ class aio_linux : public aio
         }
         else
         {
-          iocb->m_ret_len = ret;
+          iocb->m_ret_len = res;
           iocb->m_err = 0;
         }
 
@@ -160,9 +160,12 @@ class aio
     On completion, cb->m_callback is executed.
   */
   virtual int submit_io(aiocb *cb)= 0;
-  /** "Bind" file to AIO handler (used on Windows only) */
+  /**
+    "Bind" file to AIO handler (used on Windows, and with io_uring to
+    register the file with the ring)
+  */
   virtual int bind(native_file_handle &fd)= 0;
-  /** "Unind" file to AIO handler (used on Windows only) */
+  /** "Unbind" file from AIO handler, must be called before closing it */
   virtual int unbind(const native_file_handle &fd)= 0;
   virtual ~aio(){};
 };
@@ -179,6 +182,17 @@ class thread_pool;
 
 extern aio *create_simulated_aio(thread_pool *tp);
 
+/** Native AIO implementation to use, where more than one is available */
+enum aio_implementation
+{
+  /** io_uring if available, else libaio */
+  OS_IO_DEFAULT,
+  /** Linux io_uring */
+  OS_IO_URING,
+  /** Linux libaio */
+  OS_IO_LIBAIO
+};
+
 #ifndef DBUG_OFF
 /*
   This function is useful for debugging to make sure all mutexes are released
@@ -196,7 +210,7 @@ class thread_pool
 protected:
   /* AIO handler */
   std::unique_ptr<aio> m_aio;
-  virtual aio *create_native_aio(int max_io)= 0;
+  virtual aio *create_native_aio(int max_io, aio_implementation impl)= 0;
 
   /**
     Functions to be called at worker thread start/end
@@ -216,11 +230,17 @@ class thread_pool
     m_worker_init_callback= init;
     m_worker_destroy_callback= destroy;
   }
-  int configure_aio(bool use_native_aio, int max_io)
+  /**
+    Set up asynchronous IO.
+    @return 0 on success, -1 if the requested native implementation
+    is not available (errno may tell why)
+  */
+  int configure_aio(bool use_native_aio, int max_io,
+                    aio_implementation impl= OS_IO_DEFAULT)
   {
     if (use_native_aio)
-      m_aio.reset(create_native_aio(max_io));
-    if (!m_aio)
+      m_aio.reset(create_native_aio(max_io, impl));
+    else
       m_aio.reset(create_simulated_aio(this));
     return !m_aio ? -1 : 0;
   }
@@ -228,8 +248,8 @@ class thread_pool
   {
     m_aio.reset();
   }
-  int bind(native_file_handle &fd) { return m_aio->bind(fd); }
-  void unbind(const native_file_handle &fd) { m_aio->unbind(fd); }
+  int bind(native_file_handle &fd) { return m_aio ? m_aio->bind(fd) : 0; }
+  void unbind(const native_file_handle &fd) { if (m_aio) m_aio->unbind(fd); }
   int submit_io(aiocb *cb) { return m_aio->submit_io(cb); }
   virtual void wait_begin() {};
   virtual void wait_end() {};
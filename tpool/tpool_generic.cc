@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02111 - 1301 USA*/
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <errno.h>
 #include <iostream>
 #include <limits.h>
 #include <mutex>
@@ -39,6 +40,9 @@ namespace tpool
 
 #ifdef __linux__
   extern aio* create_linux_aio(thread_pool* tp, int max_io);
+#ifdef HAVE_URING
+  extern aio* create_linux_uring_aio(thread_pool* tp, int max_io);
+#endif
 #endif
 #ifdef _WIN32
   extern aio* create_win_aio(thread_pool* tp, int max_io);
@@ -263,11 +267,23 @@ class thread_pool_generic : public thread_pool
   void wait_begin() override;
   void wait_end() override;
   void submit_task(task *task) override;
-  virtual aio *create_native_aio(int max_io) override
+  virtual aio *create_native_aio(int max_io, aio_implementation impl) override
   {
 #ifdef _WIN32
     return create_win_aio(this, max_io);
 #elif defined(__linux__)
+    if (impl != OS_IO_LIBAIO)
+    {
+#ifdef HAVE_URING
+      if (aio *a= create_linux_uring_aio(this, max_io))
+        return a;
+#else
+      errno= ENOSYS;
+#endif
+      /* Only OS_IO_DEFAULT may fall back to libaio */
+      if (impl == OS_IO_URING)
+        return nullptr;
+    }
     return create_linux_aio(this,max_io);
 #else
     return nullptr;
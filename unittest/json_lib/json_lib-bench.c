@@ -0,0 +1,101 @@
+/* Copyright (c) 2020, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+/*
+  Scanning speed of json_lib for a few shapes of documents.
+
+  Usage: json_lib-bench [megabytes per document, 16 by default]
+*/
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <json_lib.h>
+
+struct st_bench_doc
+{
+  const char *name;
+  const char *element;
+};
+
+static const struct st_bench_doc docs[]=
+{
+  { "long strings",
+    "\"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+    "eiusmod tempor incididunt ut labore et dolore magna aliqua.\"" },
+  { "objects",
+    "{\"id\": 12345, \"name\": \"product\", \"price\": 12.5, "
+    "\"tags\": [\"a\", \"b\"], \"ok\": true}" },
+  { "indented",
+    "\n  {\n    \"id\": 12345,\n    \"description\": \"product\",\n"
+    "    \"tags\": [\n      \"a\",\n      \"b\"\n    ]\n  }" },
+  { "escapes",
+    "\"line\\none\\tand \\\"quoted\\\" text \\u00e9 with \\\\ escapes\"" },
+  { "non-ASCII",
+    "\"\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, "
+    "\xd0\xbc\xd0\xb8\xd1\x80! Hello, world!\"" }
+};
+
+
+static size_t fill_doc(uchar *buf, size_t size, const char *element)
+{
+  size_t el_len= strlen(element);
+  uchar *p= buf;
+  *p++= '[';
+  while ((size_t) (p - buf) + el_len + 2 < size)
+  {
+    memcpy(p, element, el_len);
+    p+= el_len;
+    *p++= ',';
+  }
+  p[-1]= ']';
+  return p - buf;
+}
+
+
+int main(int argc, char **argv)
+{
+  size_t size= (argc > 1 ? (size_t) atoi(argv[1]) : 16) << 20;
+  uchar *buf;
+  uint i, n;
+
+  MY_INIT(argv[0]);
+  if (!size || !(buf= (uchar *) my_malloc(PSI_NOT_INSTRUMENTED, size,
+                                          MYF(MY_WME))))
+    return 1;
+
+  for (i= 0; i < array_elements(docs); i++)
+  {
+    size_t length= fill_doc(buf, size, docs[i].element);
+    ulonglong best= ~0ULL;
+
+    for (n= 0; n < 5; n++)
+    {
+      ulonglong start= my_interval_timer(), time;
+      if (!json_valid((const char *) buf, length, &my_charset_utf8mb4_bin))
+      {
+        fprintf(stderr, "%s: the document is not valid JSON\n", docs[i].name);
+        return 1;
+      }
+      time= my_interval_timer() - start;
+      set_if_smaller(best, time);
+    }
+    printf("%-14s %8.1f MB/s\n", docs[i].name,
+           (double) length * 1000.0 / (double) MY_MAX(best, 1));
+  }
+
+  my_free(buf);
+  my_end(0);
+  return 0;
+}
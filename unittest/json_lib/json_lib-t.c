@@ -171,16 +171,156 @@ test_search()
 }
 
 
+/*
+  Test that string constants are scanned right whatever the position
+  of the special characters is relative to the 16 and 32 byte blocks.
+*/
+static void
+test_string_scanning()
+{
+  uchar js[128];
+  const char special[]= {'"', '\\', '\n', '\xd0'};
+  uint pos, c;
+  int errors= 0;
+
+  for (c= 0; c < array_elements(special); c++)
+  {
+    for (pos= 1; pos < 100; pos++)
+    {
+      json_engine_t je;
+      int len, expected_len;
+      int expected_error= special[c] == '\n' ? JE_NOT_JSON_CHR : 0;
+
+      memset(js, 'a', 110);
+      js[0]= '"';
+      js[109]= '"';
+      js[110]= 0;
+      js[pos]= special[c];
+      expected_len= 108;
+      if (special[c] == '"')
+        expected_len= pos - 1;
+      else if (special[c] == '\\')
+        js[pos + 1]= 'n';
+      else if (special[c] == '\xd0')
+        js[pos + 1]= 0xb0;                    /* Cyrillic a */
+
+      if (json_scan_start(&je, ci, s_e(js)) || json_read_value(&je))
+      {
+        if (je.s.error != expected_error)
+          errors++;
+        continue;
+      }
+      len= je.value_len;
+      if (expected_error || len != expected_len ||
+          je.value_escaped != (special[c] == '\\'))
+        errors++;
+    }
+  }
+  ok(errors == 0, "string scanning");
+}
+
+
+/*
+  Test the scanning of whitespace runs and key names of any length,
+  ending or broken at any position of the 16 and 32 byte blocks.
+*/
+static void
+test_space_and_key_scanning()
+{
+  uchar js[256];
+  const char special[]= {'"', '\\', '\v', '\xd0'};
+  uint pos, c;
+  int errors= 0;
+
+  for (pos= 1; pos < 100; pos++)
+  {
+    json_engine_t je;
+    int expected_error= 0;
+
+    /* '[', a run of whitespace, '1', a run of whitespace and ']' */
+    js[0]= '[';
+    for (c= 1; c < pos; c++)
+      js[c]= " \n\t\r"[c % 4];
+    js[pos]= '1';
+    memcpy(js + pos + 1, js + 1, pos - 1);
+    js[2 * pos]= ']';
+    js[2 * pos + 1]= 0;
+    if (pos > 2 && pos % 2)
+    {
+      js[pos / 2]= '\v';
+      expected_error= JE_NOT_JSON_CHR;
+    }
+    if (json_scan_start(&je, ci, s_e(js)) || json_scan_next(&je) ||
+        json_read_value(&je))
+    {
+      if (je.s.error != expected_error)
+        errors++;
+      continue;
+    }
+    if (expected_error || je.value_type != JSON_VALUE_NUMBER ||
+        je.value_len != 1 || json_skip_level(&je) ||
+        !json_scan_next(&je) || je.s.error)
+      errors++;
+  }
+
+  for (c= 0; c < array_elements(special); c++)
+  {
+    for (pos= 2; pos < 100; pos++)
+    {
+      json_engine_t je;
+      int expected_error= special[c] == '\v' ? JE_STRING_CONST : 0;
+
+      /* {"aaa...": 1} with a special character in the key name */
+      memset(js, 'a', 110);
+      js[0]= '{';
+      js[1]= '"';
+      memcpy(js + 108, "\" : 1}", 7);
+      js[pos]= special[c];
+      if (special[c] == '"')
+      {
+        js[pos + 1]= ':';
+        js[pos + 2]= '2';
+        js[pos + 3]= '}';
+        js[pos + 4]= 0;
+      }
+      else if (special[c] == '\\')
+        js[pos + 1]= 'n';
+      else if (special[c] == '\xd0')
+        js[pos + 1]= 0xb0;                      /* Cyrillic a */
+
+      /* Once by json_read_value(), once by json_scan_next() */
+      if (json_scan_start(&je, ci, s_e(js)) || json_scan_next(&je) ||
+          json_scan_next(&je) || json_read_value(&je))
+      {
+        if (je.s.error != expected_error)
+          errors++;
+      }
+      else if (expected_error || je.value_type != JSON_VALUE_NUMBER ||
+               je.value_len != 1 ||
+               *je.value != (special[c] == '"' ? '2' : '1'))
+        errors++;
+
+      if (json_valid((const char *) js, strlen((const char *) js), ci) !=
+          !expected_error)
+        errors++;
+    }
+  }
+  ok(errors == 0, "whitespace and key scanning");
+}
+
+
 int main()
 {
   ci= &my_charset_utf8mb3_general_ci;
 
-  plan(6);
+  plan(8);
   diag("Testing json_lib functions.");
 
   test_json_parsing();
   test_path_parsing();
   test_search();
+  test_string_scanning();
+  test_space_and_key_scanning();
 
   return exit_status();
 }
@@ -0,0 +1,187 @@
+/* Copyright (c) 2020, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+/*
+  Test and microbenchmark for the tpool AIO implementations.
+
+  Writes a file in $TMPDIR (put it on tmpfs or a loop device to measure
+  the submission overhead rather than the disk), reads random pages back
+  and checks their contents. The achieved IOPS of each implementation are
+  printed as diagnostics.
+*/
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <thr_timer.h>
+#include <tap.h>
+#include <tpool.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+static const size_t page_size= 4096;
+static const unsigned N_PAGES= 2048;
+static const unsigned N_READS= 32768;
+static const unsigned MAX_IO= 128;
+
+static std::mutex mtx;
+static std::condition_variable cv;
+static tpool::aiocb *cbs;
+/* Free control blocks (and their buffers), protected by mtx */
+static std::vector<unsigned> free_slots;
+static int n_errors;
+
+static void io_callback(void *arg)
+{
+  tpool::aiocb *cb= static_cast<tpool::aiocb*>(arg);
+  std::unique_lock<std::mutex> lk(mtx);
+  if (cb->m_err || cb->m_ret_len != cb->m_len)
+    n_errors++;
+  else if (cb->m_opcode == tpool::aio_opcode::AIO_PREAD)
+  {
+    /* Each page is filled with its page number. */
+    unsigned page= unsigned(cb->m_offset / page_size);
+    if (memcmp(cb->m_buffer, &page, sizeof page))
+      n_errors++;
+  }
+  free_slots.push_back(unsigned(cb - cbs));
+  cv.notify_all();
+}
+
+
+/* Submit one IO, waiting until there is a free control block. */
+static bool submit(tpool::thread_pool *pool, unsigned char *bufs, int fd,
+                   tpool::aio_opcode op, unsigned page)
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  cv.wait(lk, []{ return !free_slots.empty(); });
+  unsigned slot= free_slots.back();
+  free_slots.pop_back();
+  lk.unlock();
+
+  tpool::aiocb *cb= &cbs[slot];
+  unsigned char *buf= bufs + slot * page_size;
+  if (op == tpool::aio_opcode::AIO_PWRITE)
+    for (size_t i= 0; i < page_size; i+= sizeof page)
+      memcpy(buf + i, &page, sizeof page);
+
+  cb->m_fh= fd;
+  cb->m_opcode= op;
+  cb->m_offset= (unsigned long long) page * page_size;
+  cb->m_buffer= buf;
+  cb->m_len= page_size;
+  cb->m_callback= io_callback;
+  cb->m_group= nullptr;
+  if (!pool->submit_io(cb))
+    return false;
+  lk.lock();
+  free_slots.push_back(slot);
+  return true;
+}
+
+
+static void wait_all()
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  cv.wait(lk, []{ return free_slots.size() == MAX_IO; });
+}
+
+
+static void run(const char *name, bool native, tpool::aio_implementation impl,
+                const char *dir)
+{
+  char path[FN_REFLEN];
+  snprintf(path, sizeof path, "%s/aio-t.XXXXXX", dir);
+  int fd= mkstemp(path);
+  if (fd < 0)
+  {
+    skip(2, "cannot create file in %s", dir);
+    return;
+  }
+  unlink(path);
+
+  tpool::thread_pool *pool= tpool::create_thread_pool_generic(1, 4);
+  if (pool->configure_aio(native, int(MAX_IO), impl))
+  {
+    skip(2, "%s is not available", name);
+    delete pool;
+    close(fd);
+    return;
+  }
+  pool->bind(fd);
+
+  cbs= new tpool::aiocb[MAX_IO];
+  free_slots.clear();
+  for (unsigned i= MAX_IO; i--; )
+    free_slots.push_back(i);
+  unsigned char *bufs= static_cast<unsigned char*>
+    (aligned_alloc(page_size, page_size * MAX_IO));
+  bool failed= false;
+  n_errors= 0;
+
+  for (unsigned i= 0; i < N_PAGES && !failed; i++)
+    failed= submit(pool, bufs, fd, tpool::aio_opcode::AIO_PWRITE, i);
+  wait_all();
+  ok(!failed && !n_errors, "%s: write %u pages", name, N_PAGES);
+
+  srand(1);
+  auto start= std::chrono::steady_clock::now();
+  for (unsigned i= 0; i < N_READS && !failed; i++)
+    failed= submit(pool, bufs, fd, tpool::aio_opcode::AIO_PREAD,
+                   unsigned(rand()) % N_PAGES);
+  wait_all();
+  double secs= std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  ok(!failed && !n_errors, "%s: read and verify %u random pages",
+     name, N_READS);
+  diag("%s: %.0f read IOPS", name, secs > 0 ? N_READS / secs : 0.0);
+
+  pool->unbind(fd);
+  pool->disable_aio();
+  delete pool;
+  free(bufs);
+  delete[] cbs;
+  close(fd);
+}
+
+
+int main(int argc __attribute__((unused)),char *argv[])
+{
+  const char *dir= getenv("TMPDIR");
+  if (!dir || !*dir)
+    dir= "/tmp";
+
+  MY_INIT(argv[0]);
+  /* The generic thread pool uses a maintenance timer */
+  init_thr_timer(4);
+  plan(6);
+
+  run("simulated", false, tpool::OS_IO_DEFAULT, dir);
+#ifdef __linux__
+  run("libaio", true, tpool::OS_IO_LIBAIO, dir);
+  run("io_uring", true, tpool::OS_IO_URING, dir);
+#else
+  skip(4, "Linux only");
+#endif
+
+  end_thr_timer();
+  my_end(0);
+  return exit_status();
+}